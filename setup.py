@@ -37,7 +37,7 @@ need to download a supported version of boost (see variable boost_versions
 below) and uncompress it under the simuPOP source directory.
 
 """
-import os, sys, platform, shutil, glob, re, tempfile, subprocess
+import os, sys, platform, shutil, glob, re, tempfile, subprocess, hashlib
 import distutils.sysconfig
 from distutils.ccompiler import new_compiler
 from distutils.errors import CompileError
@@ -286,6 +286,18 @@ def replaceIntHeader(file):
     except:
         pass
 
+def swigInputSignature():
+    ''' Return a signature of the interface and header files that are parsed
+        by SWIG. It is saved with the wrapper files so that they are generated
+        again whenever any of these files is changed. Modification times are
+        not used because they are not kept by version control systems. '''
+    sig = hashlib.md5()
+    for file in sorted(glob.glob('src/*.i')) + ['config.h'] + ['src/' + x for x in HEADER_FILES]:
+        with open(file, 'rb') as input:
+            sig.update(input.read().replace(b'\r\n', b'\n'))
+    return sig.hexdigest()
+
+
 #
 # SOURCE FILES
 #
@@ -477,6 +489,8 @@ SWIG_RUNTIME_FLAGS = '-python -external-runtime'
 # python setup.py reads py_modules from src so we have to produce simuPOP_std.py
 # etc to this directory.
 SWIG_OUTDIR = 'src'
+# signature of the SWIG input files from which the wrapper files are generated
+SWIG_SIGNATURE_FILE = 'src/simuPOP_swig.md5'
 if not os.path.isdir('build'):
     os.mkdir('build')
                 
@@ -681,9 +695,16 @@ if __name__ == '__main__':
     # Generate Wrapping files
     #
     # if any of the wrap files does not exist
-    # or if the wrap files are older than any of the source files.
+    # or if the wrap files are generated from different source files.
+    swig_signature = swigInputSignature()
+    if os.path.isfile(SWIG_SIGNATURE_FILE):
+        with open(SWIG_SIGNATURE_FILE) as sig:
+            wrap_signature = sig.read().strip()
+    else:
+        wrap_signature = None
     if not os.path.isfile('src/gsl_wrap.c') or (not os.path.isfile('src/swigpyrun.h')) or \
-            False in [os.path.isfile(WRAP_INFO[x][0]) for x in MODULES]:
+            False in [os.path.isfile(WRAP_INFO[x][0]) for x in MODULES] or \
+            wrap_signature != swig_signature:
         # generate header file 
         print("Generating external runtime header file src/swigpyrun.h...")
         os.system('swig {} src/swigpyrun.h'.format(SWIG_RUNTIME_FLAGS))
@@ -699,6 +720,8 @@ if __name__ == '__main__':
             SWIG_OUTDIR, '', 'src/gsl_wrap.c', 'src/gsl.i')) != 0:
             print("Calling swig failed. Please check your swig version.")
             sys.exit(1)
+        with open(SWIG_SIGNATURE_FILE, 'w') as sig:
+            sig.write(swig_signature + '\n')
         print("\nAll wrap files are generated successfully.\n")
 
     # under solaris, there is no stdint.h so I need to replace stdint.h
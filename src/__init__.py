@@ -111,6 +111,7 @@ __all__ = [
     #
     # Major simuPOP classes
     'Population',
+    'MappedPopulation',
     # This is just to make help(Individual) available to users.
     'Individual',
     'Simulator',
@@ -227,6 +228,7 @@ __all__ = [
     'NoneOp',
     'Dumper',
     'SavePopulation',
+    'ExportGenotype',
     'IfElse',
     'Pause',
     'TicToc',
@@ -483,6 +485,19 @@ def as_pedigree(self, idField='ind_id', fatherField='father_id', motherField='mo
 
 Population.asPedigree = as_pedigree
 
+_info_view = Population.infoView
+
+def info_view(self, field, subPop=[]):
+    # a view keeps its population alive through this object, which cannot
+    # be guaranteed if the population is owned by a simulator or a pedigree
+    if not self.thisown:
+        raise ValueError('Information fields cannot be viewed from a population '
+            'that is owned by another object. Please use indInfo and setIndInfo instead.')
+    return _info_view(self, field, subPop, self)
+
+info_view.__doc__ = _info_view.__doc__
+Population.infoView = info_view
+
 def as_population(self):
     '''Convert the existing pedigree object to a population. This function will
     behave like a regular population after this function call.'''
@@ -61,9 +61,15 @@
 
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
 #include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/cstdint.hpp>
 
 #include "boost/lexical_cast.hpp"
+#include <boost/shared_ptr.hpp>
 #include "boost/pending/lowest_bit.hpp"
 
 #include "boost/regex.hpp"
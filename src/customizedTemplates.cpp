@@ -713,6 +713,14 @@ PyObject * newcarrayobject_template<LineageIterator>(LineageIterator begin, Line
 }
 
 
+/// CPPONLY
+/// Arrays do not support the buffer protocol under Python 2.
+template<typename T>
+void setcarrayshape_template(PyObject * /* obj */, int /* ndim */, const Py_ssize_t * /* shape */)
+{
+}
+
+
 #else  // for Python 3
 /* Array object implementation */
 
@@ -722,6 +730,12 @@ struct arrayobject_template
 	PyObject_VAR_HEAD
 	// pointer to the beginning of the genotype
 	T ob_iter;
+	// number of dimensions, shape and strides (in bytes) of the buffer,
+	// which is (individuals, ploidy, loci) if the array holds genotypes
+	// of whole individuals
+	int ob_ndim;
+	Py_ssize_t ob_shape[3];
+	Py_ssize_t ob_strides[3];
 };
 
 template <typename T>
@@ -1335,6 +1349,152 @@ PyObject * array_new_template(PyTypeObject * type, PyObject * args, PyObject * k
 }
 
 
+/// CPPONLY
+/// Set the shape of the buffer of an array that holds genotypes (or
+/// lineages) of whole individuals. The array should have \e ndim (at
+/// most 3) dimensions with \e Py_SIZE(obj) items in total.
+template <typename T>
+void setcarrayshape_template(PyObject * obj, int ndim, const Py_ssize_t * shape)
+{
+	struct arrayobject_template<T> * op = (struct arrayobject_template<T> *)obj;
+
+	op->ob_ndim = ndim;
+	for (int i = 0; i < ndim; ++i)
+		op->ob_shape[i] = shape[i];
+}
+
+
+/// CPPONLY
+/// Expose \e Py_SIZE(obj) items of \e itemsize bytes at \e buf as a
+/// C-contiguous buffer with the shape of the array. The buffer shares
+/// memory with the population and becomes invalid once the population
+/// changes, unless it is a \e readonly copy.
+template <typename T>
+int fill_carray_buffer(struct arrayobject_template<T> * self, void * buf, Py_ssize_t itemsize,
+                       const char * format, bool readonly, Py_buffer * view, int flags)
+{
+	if (view == NULL) {
+		PyErr_SetString(PyExc_BufferError, "NULL view in getbuffer");
+		return -1;
+	}
+	if (readonly && (flags & PyBUF_WRITABLE) == PyBUF_WRITABLE) {
+		PyErr_SetString(PyExc_BufferError, "Genotypes of this module are not stored as an array "
+			                               "of alleles and can only be viewed as a read-only copy.");
+		return -1;
+	}
+	if (self->ob_ndim > 1 && (flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS) {
+		PyErr_SetString(PyExc_BufferError, "Genotypes are not Fortran contiguous.");
+		return -1;
+	}
+	view->buf = buf;
+	view->obj = (PyObject *)self;
+	Py_INCREF(self);
+	view->len = Py_SIZE(self) * itemsize;
+	view->readonly = readonly ? 1 : 0;
+	view->itemsize = itemsize;
+	view->format = (flags & PyBUF_FORMAT) ? const_cast<char *>(format) : NULL;
+	view->ndim = (flags & PyBUF_ND) ? self->ob_ndim : 1;
+	view->shape = (flags & PyBUF_ND) ? self->ob_shape : NULL;
+	view->strides = NULL;
+	if ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) {
+		self->ob_strides[self->ob_ndim - 1] = itemsize;
+		for (int i = self->ob_ndim - 1; i > 0; --i)
+			self->ob_strides[i - 1] = self->ob_strides[i] * self->ob_shape[i];
+		view->strides = self->ob_strides;
+	}
+	view->suboffsets = NULL;
+	view->internal = NULL;
+	return 0;
+}
+
+
+/// CPPONLY
+template <typename T>
+int array_getbuffer_template(struct arrayobject_template<T> * self, Py_buffer * view, int flags)
+{
+	PyErr_SetString(PyExc_BufferError, "This array does not support the buffer protocol.");
+	return -1;
+}
+
+
+/// CPPONLY
+/// Free the copy of alleles exported by binary and mutant modules.
+template <typename T>
+void array_releasebuffer_template(struct arrayobject_template<T> * /* self */, Py_buffer * view)
+{
+	PyMem_Free(view->internal);
+}
+
+
+#if !defined(BINARYALLELE) && !defined(MUTANTALLELE)
+/// CPPONLY
+template <>
+int array_getbuffer_template<GenoIterator>(struct arrayobject_template<GenoIterator> * self,
+                                           Py_buffer * view, int flags)
+{
+#  ifdef LONGALLELE
+	const char * format = "L";
+#  else
+	const char * format = "B";
+#  endif
+	return fill_carray_buffer(self, Py_SIZE(self) == 0 ? NULL : &*self->ob_iter,
+		sizeof(Allele), format, false, view, flags);
+}
+
+
+#else
+/// CPPONLY
+template <>
+int array_getbuffer_template<GenoIterator>(struct arrayobject_template<GenoIterator> * self,
+                                           Py_buffer * view, int flags)
+{
+	// alleles are stored as bits or as mutants and cannot be addressed so
+	// a read-only copy of alleles is exported
+	if (view == NULL || (flags & PyBUF_WRITABLE) == PyBUF_WRITABLE)
+		return fill_carray_buffer(self, NULL, 1, "B", true, view, flags);
+
+	Py_ssize_t size = Py_SIZE(self);
+	unsigned char * buf = NULL;
+	if (size > 0) {
+		buf = (unsigned char *)PyMem_Malloc(size);
+		if (buf == NULL) {
+			PyErr_NoMemory();
+			return -1;
+		}
+#  ifdef MUTANTALLELE
+		memset(buf, 0, size);
+		size_t begin = self->ob_iter.index();
+		vectorm::val_iterator it = self->ob_iter.get_val_iterator();
+		vectorm::val_iterator it_end = (self->ob_iter + size).get_val_iterator();
+		for (; it != it_end; ++it)
+			buf[it->first - begin] = static_cast<unsigned char>(it->second);
+#  else
+		GenoIterator it = self->ob_iter;
+		for (Py_ssize_t i = 0; i < size; ++i, ++it)
+			buf[i] = DEREF_ALLELE(it) ? 1 : 0;
+#  endif
+	}
+	int ret = fill_carray_buffer(self, buf, 1, "B", true, view, flags);
+	if (ret == 0)
+		view->internal = buf;
+	else
+		PyMem_Free(buf);
+	return ret;
+}
+
+
+#endif
+
+/// CPPONLY
+template <>
+int array_getbuffer_template<LineageIterator>(struct arrayobject_template<LineageIterator> * self,
+                                              Py_buffer * view, int flags)
+{
+	return fill_carray_buffer(self, Py_SIZE(self) == 0 ? NULL : &*self->ob_iter,
+		sizeof(long), "l", false, view, flags);
+}
+
+
 extern "C" {
 extern PyTypeObject Arraytype;
 extern PyTypeObject LineageArraytype;
@@ -1511,6 +1671,8 @@ PyObject * newcarrayobject_template<GenoIterator>(GenoIterator begin, GenoIterat
 	//
 	op->ob_iter = begin;
 	Py_SIZE(op) = end - begin;
+	op->ob_ndim = 1;
+	op->ob_shape[0] = Py_SIZE(op);
 	return (PyObject *)op;
 }
 
@@ -1530,6 +1692,8 @@ PyObject * newcarrayobject_template<LineageIterator>(LineageIterator begin, Line
 	//
 	op->ob_iter = begin;
 	Py_SIZE(op) = end - begin;
+	op->ob_ndim = 1;
+	op->ob_shape[0] = Py_SIZE(op);
 	return (PyObject *)op;
 }
 
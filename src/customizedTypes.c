@@ -325,6 +325,13 @@ PyObject * newcarrayobject(GenoIterator begin, GenoIterator end)
 	return(newcarrayobject_template<GenoIterator>(begin, end));
 }
 
+
+/// CPPONLY
+void setcarrayshape(PyObject * op, int ndim, const Py_ssize_t * shape)
+{
+	setcarrayshape_template<GenoIterator>(op, ndim, shape);
+}
+
 /* lineage array type ***************************/
 
 /// CPPONLY
@@ -608,6 +615,22 @@ PyObject * newcarrayobject_lineage(LineageIterator begin, LineageIterator end)
 }
 
 
+/// CPPONLY
+void setcarrayshape_lineage(PyObject * op, int ndim, const Py_ssize_t * shape)
+{
+	setcarrayshape_template<LineageIterator>(op, ndim, shape);
+}
+
+
+/// CPPONLY
+PyObject * newinfoviewobject(PyObject * owner, double * buf, size_t shape,
+                             size_t stride, size_t * exports)
+{
+	PyErr_SetString(PyExc_BufferError, "Views of information fields require Python 3.");
+	return NULL;
+}
+
+
 /* defdict type *********************************************************/
 
 typedef struct
@@ -977,6 +1000,26 @@ PyObject * array_new(PyTypeObject * type, PyObject * args, PyObject * kwds)
 }
 
 
+int
+array_getbuffer(arrayobject * self, Py_buffer * view, int flags)
+{
+	return array_getbuffer_template<GenoIterator>(self, view, flags);
+}
+
+
+void
+array_releasebuffer(arrayobject * self, Py_buffer * view)
+{
+	array_releasebuffer_template<GenoIterator>(self, view);
+}
+
+
+PyBufferProcs array_as_buffer = {
+	(getbufferproc)array_getbuffer,
+	(releasebufferproc)array_releasebuffer
+};
+
+
 PyDoc_STRVAR(arraytype_doc,
 	" \n\
 \n\
@@ -1023,7 +1066,7 @@ PyTypeObject Arraytype = {
 	0,                                          /* tp_str */
 	PyObject_GenericGetAttr,                    /* tp_getattro */
 	0,                                          /* tp_setattro */
-	0,                                          /* tp_as_buffer*/
+	&array_as_buffer,                           /* tp_as_buffer*/
 	Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,   /* tp_flags */
 	arraytype_doc,                              /* tp_doc */
 	0,                                          /* tp_traverse */
@@ -1060,6 +1103,13 @@ PyObject * newcarrayobject(GenoIterator begin, GenoIterator end)
 }
 
 
+/// CPPONLY
+void setcarrayshape(PyObject * op, int ndim, const Py_ssize_t * shape)
+{
+	setcarrayshape_template<GenoIterator>(op, ndim, shape);
+}
+
+
 /** lineage array type ******************* */
 
 typedef struct arrayobject_template<LineageIterator> arrayobject_lineage;
@@ -1227,6 +1277,19 @@ PyObject * array_new_lineage(PyTypeObject * type, PyObject * args, PyObject * kw
 }
 
 
+int
+array_getbuffer_lineage(arrayobject_lineage * self, Py_buffer * view, int flags)
+{
+	return array_getbuffer_template<LineageIterator>(self, view, flags);
+}
+
+
+PyBufferProcs array_as_buffer_lineage = {
+	(getbufferproc)array_getbuffer_lineage,
+	0
+};
+
+
 PyDoc_STRVAR(arraytype_doc_lineage,
 	" \n\
 \n\
@@ -1273,7 +1336,7 @@ PyTypeObject LineageArraytype = {
 	0,                                          /* tp_str */
 	PyObject_GenericGetAttr,                    /* tp_getattro */
 	0,                                          /* tp_setattro */
-	0,                                          /* tp_as_buffer*/
+	&array_as_buffer_lineage,                   /* tp_as_buffer*/
 	Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,   /* tp_flags */
 	arraytype_doc_lineage,                              /* tp_doc */
 	0,                                          /* tp_traverse */
@@ -1310,6 +1373,127 @@ PyObject * newcarrayobject_lineage(LineageIterator begin, LineageIterator end)
 }
 
 
+/// CPPONLY
+void setcarrayshape_lineage(PyObject * op, int ndim, const Py_ssize_t * shape)
+{
+	setcarrayshape_template<LineageIterator>(op, ndim, shape);
+}
+
+
+/**  exporter of information fields ******************************/
+typedef struct
+{
+	PyObject_HEAD
+	// Python object of the population that owns the memory
+	PyObject * owner;
+	// counter shared with the population, which frees it
+	// with its last reference
+	size_t * exports;
+	double * buf;
+	Py_ssize_t shape;
+	// in bytes
+	Py_ssize_t stride;
+} infoviewobject;
+
+
+int
+infoview_getbuffer(infoviewobject * self, Py_buffer * view, int flags)
+{
+	if (view == NULL) {
+		PyErr_SetString(PyExc_BufferError, "NULL view in getbuffer");
+		return -1;
+	}
+	// values are strided if information fields are stored by individual
+	if (self->stride != sizeof(double) && ((flags & PyBUF_STRIDES) != PyBUF_STRIDES
+	                                       || (flags & PyBUF_C_CONTIGUOUS) == PyBUF_C_CONTIGUOUS
+	                                       || (flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS
+	                                       || (flags & PyBUF_ANY_CONTIGUOUS) == PyBUF_ANY_CONTIGUOUS)) {
+		PyErr_SetString(PyExc_BufferError, "Values of an information field are not contiguous.");
+		return -1;
+	}
+	view->buf = self->buf;
+	view->obj = (PyObject *)self;
+	Py_INCREF(self);
+	view->len = self->shape * sizeof(double);
+	view->readonly = 0;
+	view->itemsize = sizeof(double);
+	view->format = (flags & PyBUF_FORMAT) ? const_cast<char *>("d") : NULL;
+	view->ndim = 1;
+	view->shape = (flags & PyBUF_ND) ? &self->shape : NULL;
+	view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &self->stride : NULL;
+	view->suboffsets = NULL;
+	view->internal = NULL;
+	return 0;
+}
+
+
+void
+infoview_dealloc(infoviewobject * self)
+{
+	// the counter is freed here if the population has been destroyed
+	if (--*self->exports == 0)
+		delete self->exports;
+	Py_XDECREF(self->owner);
+	PyObject_Del(self);
+}
+
+
+PyBufferProcs infoview_as_buffer = {
+	(getbufferproc)infoview_getbuffer,
+	0
+};
+
+
+PyTypeObject InfoViewtype = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	"simuPOP.infoview",
+	sizeof(infoviewobject),
+	0,
+	(destructor)infoview_dealloc,               /* tp_dealloc */
+	0,                                          /* tp_print */
+	0,                                          /* tp_getattr */
+	0,                                          /* tp_setattr */
+	0,                                          /* tp_reserved */
+	0,                                          /* tp_repr */
+	0,                                          /* tp_as_number*/
+	0,                                          /* tp_as_sequence*/
+	0,                                          /* tp_as_mapping*/
+	0,                                          /* tp_hash */
+	0,                                          /* tp_call */
+	0,                                          /* tp_str */
+	PyObject_GenericGetAttr,                    /* tp_getattro */
+	0,                                          /* tp_setattro */
+	&infoview_as_buffer,                        /* tp_as_buffer*/
+	Py_TPFLAGS_DEFAULT,                         /* tp_flags */
+	0,                                          /* tp_doc */
+};
+
+
+/// CPPONLY
+/// Return a memoryview of \e shape doubles at \e buf that are \e stride
+/// doubles apart. The view holds a reference to \e owner and to the
+/// reference-counted \e exports, which is shared with the population.
+PyObject * newinfoviewobject(PyObject * owner, double * buf, size_t shape,
+                             size_t stride, size_t * exports)
+{
+	infoviewobject * op = PyObject_New(infoviewobject, &InfoViewtype);
+
+	if (op == NULL)
+		return NULL;
+	Py_INCREF(owner);
+	op->owner = owner;
+	op->exports = exports;
+	++*exports;
+	op->buf = buf;
+	op->shape = static_cast<Py_ssize_t>(shape);
+	op->stride = static_cast<Py_ssize_t>(stride * sizeof(double));
+	PyObject * view = PyMemoryView_FromObject((PyObject *)op);
+	// the memoryview holds the only reference to the exporter
+	Py_DECREF(op);
+	return view;
+}
+
+
 /**  defdict type ******************************/
 typedef struct
 {
@@ -1516,6 +1700,9 @@ int initCustomizedTypes(PyObject * m)
 	Py_TYPE(&Arraytype) = &PyType_Type;
 	if (PyType_Ready(&Arraytype) < 0)
 		return -1;
+	// PyType_Ready sets the type of InfoViewtype, which is left NULL
+	if (PyType_Ready(&InfoViewtype) < 0)
+		return -1;
 	//
 	Py_TYPE(&defdict_type) = &PyType_Type;
 	defdict_type.tp_base = &PyDict_Type;
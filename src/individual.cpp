@@ -43,7 +43,7 @@ Individual & Individual::operator=(const Individual & rhs)
 {
 	m_flags = rhs.m_flags;
 	setGenoPtr(rhs.genoPtr());
-	setInfoPtr(rhs.infoPtr());
+	setInfoPtr(rhs.infoPtr(), rhs.infoStep());
 	LINEAGE_EXPR(setLineagePtr(rhs.lineagePtr()));
 	// also copy genoStru pointer...
 	this->setGenoStruIdx(rhs.genoStruIdx());
@@ -59,7 +59,10 @@ Individual & Individual::copyFrom(const Individual & rhs)
 #else
 	copy(rhs.genoBegin(), rhs.genoEnd(), genoBegin());
 #endif
-	copy(rhs.infoBegin(), rhs.infoEnd(), infoBegin());
+	// the two individuals do not have to store information fields in the
+	// same layout
+	for (size_t i = 0, iEnd = infoSize(); i < iEnd; ++i)
+		m_infoPtr[i * m_infoStep] = rhs.m_infoPtr[i * rhs.m_infoStep];
 	LINEAGE_EXPR(copy(rhs.lineageBegin(), rhs.lineageEnd(), lineageBegin()));
 	// also copy genoStru pointer...
 	this->setGenoStruIdx(rhs.genoStruIdx());
@@ -108,7 +111,7 @@ bool Individual::operator==(const Individual & rhs) const
 #endif
 
 	for (size_t i = 0, iEnd = infoSize(); i < iEnd; ++i)
-		if (*(m_infoPtr + i) != *(rhs.m_infoPtr + i)) {
+		if (m_infoPtr[i * m_infoStep] != rhs.m_infoPtr[i * rhs.m_infoStep]) {
 			DBG_DO(DBG_POPULATION, cerr << "Information field " << infoField(i) << " differ" << endl);
 			return false;
 		}
@@ -284,8 +287,10 @@ PyObject * Individual::genotype(const uintList & ply, const uintList & ch)
 		// has to be all chromosomes
 		DBG_FAILIF(beginCh != 0 || endCh != numChrom(), ValueError,
 			"If multiple ploidy are chosen, all chromosomes has to be chosen.");
+		vectoru shape(2, endP - beginP);
+		shape[1] = totNumLoci();
 		return Allele_Vec_As_NumArray(m_genoPtr + beginP * totNumLoci(),
-			m_genoPtr + endP * totNumLoci());
+			m_genoPtr + endP * totNumLoci(), shape);
 	} else
 		return Allele_Vec_As_NumArray(m_genoPtr + beginP * totNumLoci() + chromBegin(beginCh),
 			m_genoPtr + beginP * totNumLoci() + chromEnd(endCh - 1));
@@ -406,8 +411,10 @@ PyObject * Individual::lineage(const uintList & ply, const uintList & ch)
 		// has to be all chromosomes
 		DBG_FAILIF(beginCh != 0 || endCh != numChrom(), ValueError,
 			"If multiple ploidy are chosen, all chromosomes has to be chosen.");
+		vectoru shape(2, endP - beginP);
+		shape[1] = totNumLoci();
 		return Lineage_Vec_As_NumArray(m_lineagePtr + beginP * totNumLoci(),
-			m_lineagePtr + endP * totNumLoci());
+			m_lineagePtr + endP * totNumLoci(), shape);
 	} else
 		return Lineage_Vec_As_NumArray(m_lineagePtr + beginP * totNumLoci() + chromBegin(beginCh),
 			m_lineagePtr + beginP * totNumLoci() + chromEnd(endCh - 1));
@@ -1031,7 +1038,7 @@ void Individual::display(ostream & out, int width, const vectoru & loci, const v
 		out << "| ";
 		for (vectoru::const_iterator info = infoIdx.begin();
 			info != infoIdx.end(); ++info)
-			out << " " << *(infoBegin() + *info);
+			out << " " << m_infoPtr[*info * m_infoStep];
 	}
 }
 
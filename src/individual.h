@@ -193,7 +193,7 @@ public:
 	 * from a \c Population object using functions such as
 	 * <tt>Population::Individual(idx)</tt>.
 	 */
-	Individual() : m_flags(m_flagVisible)
+	Individual() : m_flags(m_flagVisible), m_infoStep(1)
 	{
 	}
 
@@ -201,6 +201,7 @@ public:
 	/// CPPONLY
 	Individual(const Individual & ind) :
 		GenoStruTrait(ind), m_flags(ind.m_flags),
+		m_infoStep(ind.m_infoStep),
 		m_genoPtr(ind.m_genoPtr),
 #ifdef LINEAGE
 		m_lineagePtr(ind.m_lineagePtr),
@@ -233,10 +234,12 @@ public:
 
 #endif
 
-	/// CPPONLY set pointer to individual info
-	void setInfoPtr(InfoIterator pos)
+	/// CPPONLY set pointer to individual info, with \e step between
+	/// adjacent information fields (\c 1 if fields are stored by individual).
+	void setInfoPtr(InfoIterator pos, size_t step = 1)
 	{
 		m_infoPtr = pos;
+		m_infoStep = static_cast<UINT>(step);
 	}
 
 
@@ -274,6 +277,27 @@ public:
 	}
 
 
+	/// CPPONLY distance between adjacent information fields
+	size_t infoStep() const
+	{
+		return m_infoStep;
+	}
+
+
+	/// CPPONLY all flags (sex, affection status, marks etc) as a byte
+	unsigned char flags() const
+	{
+		return m_flags;
+	}
+
+
+	/// CPPONLY
+	void setFlags(unsigned char flags)
+	{
+		m_flags = flags;
+	}
+
+
 	//@}
 	/// @name allele, info get/set functions
 	//@{
@@ -514,7 +538,7 @@ public:
 		size_t idx = field.empty() ? field.value() : infoIdx(field.name());
 
 		CHECKRANGEINFO(idx);
-		return m_infoPtr[idx];
+		return m_infoPtr[idx * m_infoStep];
 	}
 
 
@@ -527,7 +551,7 @@ public:
 		size_t idx = field.empty() ? field.value() : infoIdx(field.name());
 
 		CHECKRANGEINFO(idx);
-		return static_cast<int>(m_infoPtr[idx]);
+		return static_cast<int>(m_infoPtr[idx * m_infoStep]);
 	}
 
 
@@ -542,7 +566,7 @@ public:
 		size_t idx = field.empty() ? field.value() : infoIdx(field.name());
 
 		CHECKRANGEINFO(idx);
-		m_infoPtr[idx] = value;
+		m_infoPtr[idx * m_infoStep] = value;
 	}
 
 
@@ -663,7 +687,8 @@ public:
 
 #endif
 
-	/// CPPONLY start of info
+	/// CPPONLY start of info, which can only be used as a range with
+	/// \c infoEnd() if information fields are stored by individual.
 	InfoIterator infoBegin() const
 	{
 		return m_infoPtr;
@@ -765,6 +790,11 @@ protected:
 	// bitset<3> was previously used but that will take 4 bytes.
 	mutable unsigned char m_flags;
 
+	/// distance between adjacent information fields, which is the size of
+	/// the population if information fields are stored by field. This member
+	/// fits in the padding after m_flags so it does not enlarge Individual.
+	UINT m_infoStep;
+
 	/// pointer to genotype.
 	GenoIterator m_genoPtr;
 
@@ -820,6 +850,8 @@ private:
     IndividualIterator *will* iterate through only visible individuals, and
     allInds is only provided when we know in advance that all individuals are
     visible. This is a way to obtain better performance in simple cases.
+    If an index of visible individuals is given, the iterator walks the
+    index directly instead of checking the visibility of each individual.
  */
 template <typename T, typename PTR, typename REF>
 class IndividualIterator
@@ -831,13 +863,15 @@ public:
 	typedef REF reference;
 	typedef PTR pointer;
 
-	IndividualIterator() : m_it(), m_end(), m_allInds(true)
+	IndividualIterator() : m_it(), m_end(), m_allInds(true),
+		m_base(), m_idxBegin(NULL), m_idx(NULL), m_idxEnd(NULL)
 	{
 	}
 
 
 	IndividualIterator(T it, T end, bool allInds)
-		: m_it(it), m_end(end), m_allInds(allInds)
+		: m_it(it), m_end(end), m_allInds(allInds),
+		m_base(), m_idxBegin(NULL), m_idx(NULL), m_idxEnd(NULL)
 	{
 		// m_it need to point to the first valid
 		// Individual. otherwise *it will fail.
@@ -847,6 +881,15 @@ public:
 	}
 
 
+	/// iterate through individuals <tt>base + idx[i]</tt> for \c idx in
+	/// <tt>[idx, idxEnd)</tt>, in increasing order and before \e end.
+	IndividualIterator(T base, const size_t * idx, const size_t * idxEnd, T end)
+		: m_it(idx < idxEnd ? base + *idx : end), m_end(end), m_allInds(false),
+		m_base(base), m_idxBegin(idx), m_idx(idx), m_idxEnd(idxEnd)
+	{
+	}
+
+
 	bool valid() const
 	{
 		return m_it < m_end;
@@ -888,6 +931,10 @@ public:
 
 		// save current state
 		IndividualIterator tmp(*this);
+		if (m_idx != NULL) {
+			m_it = ++m_idx < m_idxEnd ? m_base + *m_idx : m_end;
+			return tmp;
+		}
 		while (++m_it < m_end)
 			if (m_it->visible())
 				break;
@@ -904,6 +951,10 @@ public:
 			++m_it;
 			return *this;
 		}
+		if (m_idx != NULL) {
+			m_it = ++m_idx < m_idxEnd ? m_base + *m_idx : m_end;
+			return *this;
+		}
 
 		while (++m_it < m_end)
 			if (m_it->visible())
@@ -926,6 +977,13 @@ public:
 		IndividualIterator tmp(*this);
 		DBG_ASSERT(tmp.m_it < tmp.m_end, ValueError,
 			"Can not advance invalid iterator");
+		if (m_idx != NULL) {
+			DBG_FAILIF(diff > m_idxEnd - m_idx, ValueError,
+				"Can not add to IndIterator");
+			tmp.m_idx += diff;
+			tmp.m_it = tmp.m_idx < m_idxEnd ? m_base + *tmp.m_idx : m_end;
+			return tmp;
+		}
 		difference_type i = 0;
 		while (i < diff && ++tmp.m_it < tmp.m_end)
 			if (tmp.m_it->visible())
@@ -946,6 +1004,11 @@ public:
 			"Can not advance invalid iterator");
 		if (diff == 0)
 			return *this;
+		if (m_idx != NULL) {
+			m_idx = diff < m_idxEnd - m_idx ? m_idx + diff : m_idxEnd;
+			m_it = m_idx < m_idxEnd ? m_base + *m_idx : m_end;
+			return *this;
+		}
 		difference_type i = 0;
 		while (++m_it < m_end) {
 			if (m_it->visible()) {
@@ -963,6 +1026,13 @@ public:
 		if (m_allInds)
 			return IndividualIterator(m_it - diff, m_end, m_allInds);
 		IndividualIterator tmp(*this);
+		if (m_idx != NULL) {
+			DBG_FAILIF(diff > m_idx - m_idxBegin, ValueError,
+				"Can not subtract from IndIterator");
+			tmp.m_idx -= diff;
+			tmp.m_it = m_base + *tmp.m_idx;
+			return tmp;
+		}
 		// can not check. Possible problem
 		for (difference_type i = 0; i < diff; ++i)
 			while (!(--tmp.m_it)->visible()) ;
@@ -974,6 +1044,8 @@ public:
 	{
 		if (m_allInds)
 			return m_it - rhs.m_it;
+		if (m_idx != NULL)
+			return m_idx - rhs.m_idx;
 		difference_type i = 0;
 		for (T it = rhs.m_it; it != m_it; ++it)
 			if (it->visible())
@@ -986,8 +1058,9 @@ public:
 	{
 		if (m_allInds)
 			return IndividualIterator(m_it--, m_end, m_allInds);
+		// return the original one
 		IndividualIterator tmp(*this);
-		while (!(--tmp.m_it)->visible()) ;
+		--*this;
 		return tmp;
 	}
 
@@ -996,7 +1069,11 @@ public:
 	{
 		if (m_allInds)
 			--m_it;
-		else
+		else if (m_idx != NULL) {
+			DBG_FAILIF(m_idx == m_idxBegin, ValueError,
+				"Can not decrease IndIterator");
+			m_it = m_base + *--m_idx;
+		} else
 			while (!(--m_it)->visible()) ;
 		return *this;
 	}
@@ -1036,6 +1113,15 @@ private:
 
 	//
 	bool m_allInds;
+
+	/// beginning of the individuals an index refers to
+	T m_base;
+
+	/// beginning, current and ending position of an index of visible
+	/// individuals, \c NULL if individuals are found by visibility flags.
+	const size_t * m_idxBegin;
+	const size_t * m_idx;
+	const size_t * m_idxEnd;
 };
 
 //
@@ -1101,7 +1187,7 @@ public:
 		if (m_useGappedIterator)
 			return *(m_ptr + m_info);
 		else
-			return *(m_it->infoPtr() + m_info);
+			return *(m_it->infoPtr() + m_info * m_it->infoStep());
 	}
 
 
@@ -1111,7 +1197,7 @@ public:
 		if (m_useGappedIterator)
 			return m_ptr + m_info;
 		else
-			return m_it->infoPtr() + m_info;
+			return m_it->infoPtr() + m_info * m_it->infoStep();
 	}
 
 
@@ -69,18 +69,29 @@ bool InitSex::apply(Population & pop) const
 			for (; ind.valid(); ++ind, ++idx)
 				ind->setSex(m_sex[idx % sexSz] == 1 ? MALE : FEMALE);
 		else {
-			if (numThreads() > 1) {
+			const RNG & rng = getRNG();
+			size_t call = getRNG().newStreamCall();
+			// sex drawn by proportion comes from a shared sequence, which can
+			// be reproduced only if it is used sequentially.
+			if (numThreads() > 1 && !(rng.counterBased() && m_maleProp >= 0)) {
 #ifdef _OPENMP
 #  pragma omp parallel private(ind)
 				{
+					RNGStream stream(rng, INIT_SEX_STREAM, pop.rep(), call);
 					ind = pop.indIterator(sp->subPop(), omp_get_thread_num());
-					for (; ind.valid(); ++ind)
+					for (; ind.valid(); ++ind) {
+						stream.seek(pop.gen(), sp->subPop(), ind.rawIter() - pop.rawIndBegin());
 						ind->setSex(ws.draw() == 0 ? MALE : FEMALE);
+					}
 				}
 #endif
-			} else
-				for (; ind.valid(); ++ind)
+			} else {
+				RNGStream stream(rng, INIT_SEX_STREAM, pop.rep(), call);
+				for (; ind.valid(); ++ind) {
+					stream.seek(pop.gen(), sp->subPop(), ind.rawIter() - pop.rawIndBegin());
 					ind->setSex(ws.draw() == 0 ? MALE : FEMALE);
+				}
+			}
 		}
 		pop.deactivateVirtualSubPop(sp->subPop());
 	}
@@ -131,13 +142,13 @@ bool InitInfo::apply(Population & pop) const
 			{
 				size_t id = omp_get_thread_num();
 				IndIterator ind = pop.indIterator(sp->subPop(), id);
-				idx = idx + id * (pop.subPopSize(sp->subPop()) / numThreads());
+				idx = idx + id * (pop.subPopSize(*sp) / numThreads());
 				for (; ind.valid(); ++ind, ++idx)
 					for (size_t i = 0; i < infoIdx.size(); ++i) {
 						ind->setInfo(values[idx % numValues], infoIdx[i]);
 					}
 			}
-			idx = idx + pop.subPopSize(sp->subPop());
+			idx = idx + pop.subPopSize(*sp);
 #endif
 		} else {
 			IndIterator ind = pop.indIterator(sp->subPop());
@@ -532,16 +543,16 @@ bool InitLineage::apply(Population & pop) const
 				size_t id = omp_get_thread_num();
 				IndIterator it = pop.indIterator(sp->subPop(), id);
 				if (m_mode == PER_ALLELE)
-					idx += id * (pop.subPopSize(sp->subPop()) / numThreads()) *
+					idx += id * (pop.subPopSize(*sp) / numThreads()) *
 					       (ploidy.end() - ploidy.begin()) * (loci.end() - loci.begin());
 				else if (m_mode == PER_CHROMOSOME)
-					idx += id * (pop.subPopSize(sp->subPop()) / numThreads()) *
+					idx += id * (pop.subPopSize(*sp) / numThreads()) *
 					       (ploidy.end() - ploidy.begin()) * nCh;
 				else if (m_mode == PER_PLOIDY)
-					idx += id * (pop.subPopSize(sp->subPop()) / numThreads()) *
+					idx += id * (pop.subPopSize(*sp) / numThreads()) *
 					       (ploidy.end() - ploidy.begin());
 				else
-					idx += id * (pop.subPopSize(sp->subPop()) / numThreads());
+					idx += id * (pop.subPopSize(*sp) / numThreads());
 #  else
 				IndIterator it = pop.indIterator(sp->subPop());
 #  endif
@@ -600,14 +611,14 @@ bool InitLineage::apply(Population & pop) const
 			}
 #  ifdef _OPENMP
 			if (m_mode == PER_ALLELE)
-				idx += pop.subPopSize(sp->subPop()) *
+				idx += pop.subPopSize(*sp) *
 				       (ploidy.end() - ploidy.begin()) * (loci.end() - loci.begin());
 			else if (m_mode == PER_CHROMOSOME)
-				idx += pop.subPopSize(sp->subPop()) * (ploidy.end() - ploidy.begin()) * nCh;
+				idx += pop.subPopSize(*sp) * (ploidy.end() - ploidy.begin()) * nCh;
 			else if (m_mode == PER_PLOIDY)
-				idx += pop.subPopSize(sp->subPop()) * (ploidy.end() - ploidy.begin());
+				idx += pop.subPopSize(*sp) * (ploidy.end() - ploidy.begin());
 			else
-				idx += pop.subPopSize(sp->subPop());
+				idx += pop.subPopSize(*sp);
 #  endif
 		} else {
 #  pragma omp parallel if(numThreads() > 1)
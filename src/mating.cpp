@@ -252,6 +252,19 @@ bool OffspringGenerator::parallelizable() const
 }
 
 
+bool OffspringGenerator::dependsOnReplicateOrder() const
+{
+	opList::const_iterator iop = m_transmitters.begin();
+	opList::const_iterator iopEnd = m_transmitters.end();
+
+	for (; iop != iopEnd; ++iop) {
+		if ((*iop)->dependsOnReplicateOrder())
+			return true;
+	}
+	return false;
+}
+
+
 Sex OffspringGenerator::getSex(UINT count)
 {
 	return m_sexModel->getSex(count);
@@ -1241,6 +1254,8 @@ bool MatingScheme::prepareScratchPop(Population & pop, Population & scratch)
 {
 	if (scratch.genoStruIdx() != pop.genoStruIdx())
 		scratch.fitGenoStru(pop.genoStruIdx());
+	// offspring use the same layout of information fields
+	scratch.setInfoByColumn(pop.infoByColumn());
 
 	// use population structure of pop
 	if (m_subPopSize.empty() && !m_subPopSize.func().isValid())
@@ -1248,6 +1263,8 @@ bool MatingScheme::prepareScratchPop(Population & pop, Population & scratch)
 	else if (!m_subPopSize.empty())                                                     // set subPoplation size
 		scratch.fitSubPopStru(m_subPopSize.elems(), pop.subPopNames());
 	else {                                                                              // use m_subPopSizeFunc
+		// the function can be called by replicates evolved in parallel
+		GILGuard gil(true);
 		const pyFunc & func = m_subPopSize.func();
 		PyObject * args = PyTuple_New(func.numArgs());
 		DBG_ASSERT(args, RuntimeError, "Failed to create a parameter tuple");
@@ -1305,10 +1322,18 @@ bool MatingScheme::mate(Population & pop, Population & scratch)
 	// scrtach will have the right structure.
 	if (!prepareScratchPop(pop, scratch))
 		return false;
+	if (!populate(pop, scratch))
+		return false;
+	submitScratch(pop, scratch);
+	return true;
+}
+
+
+bool MatingScheme::populate(Population & pop, Population & scratch)
+{
 	for (size_t sp = 0; sp < static_cast<size_t>(pop.numSubPop()); ++sp)
 		if (!mateSubPop(pop, scratch, sp, scratch.rawIndBegin(sp), scratch.rawIndEnd(sp)))
 			return false;
-	submitScratch(pop, scratch);
 	return true;
 }
 
@@ -1325,7 +1350,7 @@ HomoMating::HomoMating(ParentChooser & chooser,
 	OffspringGenerator & generator,
 	const uintListFunc & subPopSize,
 	subPopList subPops, double weight)
-	: MatingScheme(subPopSize), m_subPops(subPops), m_weight(weight)
+	: MatingScheme(subPopSize), m_subPops(subPops), m_weight(weight), m_choosers()
 {
 	m_ParentChooser = chooser.clone();
 	m_OffspringGenerator = generator.clone();
@@ -1342,88 +1367,90 @@ string HomoMating::describe(bool format) const
 }
 
 
-bool HomoMating::mateSubPop(Population & pop, Population & offPop, size_t subPop,
-                            RawIndIterator offBegin, RawIndIterator offEnd)
+/** A list of blocks of offspring that are filled by one or more homogeneous
+ *  mating schemes, possibly in different subpopulations. Blocks are small (at
+ *  most 128 offspring, rounded to whole families) and are handed out to
+ *  threads one at a time so that a thread that completes its blocks early
+ *  takes over the remaining blocks instead of waiting for others. With a
+ *  counter-based random number generator, each block draws random numbers
+ *  from its own stream and the block size does not depend on the number of
+ *  threads, so that the offspring generation is reproducible regardless of
+ *  which thread generates which block.
+ */
+class OffspringBlocks
 {
-	// nothing to do.
-	if (offBegin == offEnd)
-		return true;
+public:
+	OffspringBlocks(Population & offPop) : m_ranges(), m_blocks(),
+		m_offBegin(offPop.rawIndBegin()), m_offSize(offPop.popSize()),
+		m_keyed(getRNG().counterBased())
+	{
+	}
 
-	if (!m_ParentChooser->initialized())
-		m_ParentChooser->initialize(pop, subPop);
 
-	if (!m_OffspringGenerator->initialized())
-		m_OffspringGenerator->initialize(pop, subPop);
+	/** Split offspring from \e offBegin to \e offEnd of \e subPop into blocks,
+	 *  which will be generated by mating scheme \e ms using its \e idx-th
+	 *  parent chooser. The offspring generator of \e ms should have been
+	 *  initialized. The parent chooser will be initialized, one at a time,
+	 *  if it has not been initialized.
+	 */
+	void add(HomoMating * ms, size_t idx, ssize_t gen, size_t subPop, RawIndIterator offBegin, RawIndIterator offEnd)
+	{
+		Range range = { ms, ms->parentChooser(idx), subPop };
+		m_ranges.push_back(range);
+
+		size_t offSize = offEnd - offBegin;
+		size_t numOffspring = std::max(ms->numOffspring(gen), 1U);
+		size_t maxBlock = std::max(static_cast<size_t>(128) / numOffspring, static_cast<size_t>(1));
+		size_t nFamilies = maxBlock;
+		// a few blocks for each thread if the subpopulation is small
+		if (!m_keyed)
+			nFamilies = std::max(std::min(offSize / numThreads() / 8 / numOffspring, maxBlock), static_cast<size_t>(1));
+		size_t blockSize = nFamilies * numOffspring;
+		for (RawIndIterator it = offBegin; it < offEnd; it += blockSize) {
+			Block block = { m_ranges.size() - 1, it, offEnd - it > static_cast<ssize_t>(blockSize) ? it + blockSize : offEnd };
+			m_blocks.push_back(block);
+		}
+	}
 
-	// generate scratch.subPopSize(sp) individuals.
-	RawIndIterator it = offBegin;
-	// If the parent chooser is not parallelizable, or if openMP is not supported
-	// or if number of thread is set to 1, use the sequential method.
-	if (!m_ParentChooser->parallelizable() || numThreads() == 1 || !m_OffspringGenerator->parallelizable()) {
-		DBG_DO(DBG_MATING, cerr << "Mating is done in single-thread mode" << endl);
-		while (it != offEnd) {
-			Individual * dad = NULL;
-			Individual * mom = NULL;
-			ParentChooser::IndividualPair const parents = m_ParentChooser->chooseParents();
-			dad = parents.first;
-			mom = parents.second;
 
-			m_OffspringGenerator->generateOffspring(pop, offPop, dad, mom, it, offEnd);
-		}
-	} else {
-		DBG_DO(DBG_MATING, cerr << "Mating is done in " << numThreads() << " threads" << endl);
-		// in this case, openMP must have been supported with numThreads() > 1
-#ifdef _OPENMP
-		size_t offPopSize = offEnd - offBegin;
-		ssize_t nBlocks = numThreads() * 2;
-		ssize_t numOffspring = m_OffspringGenerator->numOffspring(pop.gen());
-		int except = 0;
+	/// generate offspring of all blocks, using up to numThreads() threads
+	void generate(Population & pop, Population & offPop)
+	{
+		int nRanges = static_cast<int>(m_ranges.size());
+		int nBlocks = static_cast<int>(m_blocks.size());
+		const RNG & rng = getRNG();
+		size_t call = getRNG().newStreamCall();
+		volatile int except = 0;
 		string msg;
-#  pragma omp parallel for
-		for (int i = 0; i < nBlocks; i++) {
-			try {
-				RawIndIterator local_it = offBegin + i * (offPopSize / nBlocks / numOffspring) * numOffspring;
-				RawIndIterator local_offEnd = i == nBlocks - 1 ? offEnd : local_it + (offPopSize / nBlocks / numOffspring) * numOffspring ;
-
-				while (local_it != local_offEnd) {
-					if (except)
-						break;
-					Individual * dad = NULL;
-					Individual * mom = NULL;
-					ParentChooser::IndividualPair const parents = m_ParentChooser->chooseParents();
-					dad = parents.first;
-					mom = parents.second;
-					m_OffspringGenerator->generateOffspring(pop, offPop, dad, mom, local_it, local_offEnd);
-				}
-			} catch (StopEvolution e) {
-				if (!except) {
-					except = 1;
-					msg = e.message();
-				}
-			} catch (ValueError e) {
-				if (!except) {
-					except = 2;
-					msg = e.message();
-				}
-			} catch (RuntimeError e) {
-				if (!except) {
-					except = 3;
-					msg = e.message();
-				}
-			} catch (Exception e) {
-				if (!except) {
-					except = 4;
-					msg = e.message();
-				}
-			} catch (...) {
-				if (!except)
-					except = -1;
+
+		// Parent choosers are initialized one by one because they might call
+		// Python functions or change states of the parental population, such
+		// as its activated virtual subpopulation.
+		{
+			RNGStream stream(rng, MATING_STREAM, pop.rep(), call);
+			for (int i = 0; i < nRanges && !except; i++) {
+				if (m_ranges[i].chooser->initialized())
+					continue;
+				// a stream that follows the streams of all offspring
+				stream.seek(pop.gen(), m_ranges[i].subPop, m_offSize);
+				run(pop, offPop, i, -1, except, msg);
 			}
+		}
 
+#pragma omp parallel if(numThreads() > 1)
+		{
+			RNGStream stream(rng, MATING_STREAM, pop.rep(), call);
+#pragma omp for schedule(dynamic, 1)
+			for (int i = 0; i < nBlocks; i++) {
+				if (except)
+					continue;
+				stream.seek(pop.gen(), m_ranges[m_blocks[i].range].subPop, m_blocks[i].begin - m_offBegin);
+				run(pop, offPop, -1, i, except, msg);
+			}
 		}
 
 		if (except == 1)
-			throw  StopEvolution(msg);
+			throw StopEvolution(msg);
 		else if (except == 2)
 			throw ValueError(msg);
 		else if (except == 3)
@@ -1432,10 +1459,216 @@ bool HomoMating::mateSubPop(Population & pop, Population & offPop, size_t subPop
 			throw Exception(msg);
 		else if (except == -1)
 			throw Exception("Unexpected error from openMP parallel region");
+	}
+
+
+private:
+	/// initialize parent chooser of \e range, or generate offspring of \e block,
+	/// saving the first exception to \e except and \e msg.
+	void run(Population & pop, Population & offPop, int range, int block,
+	         volatile int & except, string & msg)
+	{
+		try {
+			if (range >= 0)
+				m_ranges[range].chooser->initialize(pop, m_ranges[range].subPop);
+			else {
+				const Block & b = m_blocks[block];
+				const Range & r = m_ranges[b.range];
+				r.ms->generateOffspring(pop, offPop, r.chooser, b.begin, b.end, &except);
+			}
+		} catch (StopEvolution e) {
+#pragma omp critical
+			if (!except) {
+				except = 1;
+				msg = e.message();
+			}
+		} catch (ValueError e) {
+#pragma omp critical
+			if (!except) {
+				except = 2;
+				msg = e.message();
+			}
+		} catch (RuntimeError e) {
+#pragma omp critical
+			if (!except) {
+				except = 3;
+				msg = e.message();
+			}
+		} catch (Exception e) {
+#pragma omp critical
+			if (!except) {
+				except = 4;
+				msg = e.message();
+			}
+		} catch (...) {
+#pragma omp critical
+			if (!except)
+				except = -1;
+		}
+	}
+
+
+	/// offspring of a subpopulation generated by a mating scheme
+	struct Range
+	{
+		HomoMating * ms;
+		ParentChooser * chooser;
+		size_t subPop;
+	};
+
+	struct Block
+	{
+		size_t range;
+		RawIndIterator begin;
+		RawIndIterator end;
+	};
+
+	vector<Range> m_ranges;
+
+	vector<Block> m_blocks;
+
+	/// first individual and size of the offspring population, used to locate
+	/// random number streams of blocks.
+	RawIndIterator m_offBegin;
+
+	size_t m_offSize;
+
+	bool m_keyed;
+};
+
+
+HomoMating::~HomoMating()
+{
+	delete m_ParentChooser;
+	delete m_OffspringGenerator;
+	for (size_t i = 0; i < m_choosers.size(); ++i)
+		delete m_choosers[i];
+}
+
+
+bool HomoMating::concurrent() const
+{
+	// With a counter-based random number generator, offspring are generated in
+	// blocks even in a single thread so that the results do not depend on the
+	// number of threads. Otherwise, a single thread is used if openMP is not
+	// supported, if number of thread is set to 1, or if we are already in a
+	// parallel region (replicates are evolved in parallel) so that the
+	// offspring generation does not depend on the number of threads.
+	return canPopulateConcurrently() && (getRNG().counterBased() || (numThreads() > 1
+#ifdef _OPENMP
+	                                                                 && !omp_in_parallel()
 #endif
+	                                                                 ));
+}
+
+
+void HomoMating::prepareParentChoosers(size_t num)
+{
+	size_t numCopies = num > 0 ? num - 1 : 0;
+
+	for (size_t i = numCopies; i < m_choosers.size(); ++i)
+		delete m_choosers[i];
+	if (numCopies < m_choosers.size())
+		m_choosers.resize(numCopies);
+	while (m_choosers.size() < numCopies)
+		m_choosers.push_back(m_ParentChooser->clone());
+}
+
+
+ParentChooser * HomoMating::parentChooser(size_t idx)
+{
+	if (idx == 0)
+		return m_ParentChooser;
+	DBG_ASSERT(idx <= m_choosers.size(), SystemError,
+		(boost::format("Parent chooser %1% is not prepared") % idx).str());
+	return m_choosers[idx - 1];
+}
+
+
+ParentChooser * HomoMating::initializeSubPop(Population & pop, size_t subPop, size_t idx)
+{
+	if (!m_OffspringGenerator->initialized())
+		m_OffspringGenerator->initialize(pop, subPop);
+
+	ParentChooser * chooser = parentChooser(idx);
+	if (!chooser->initialized())
+		chooser->initialize(pop, subPop);
+	return chooser;
+}
+
+
+void HomoMating::generateOffspring(Population & pop, Population & offPop, ParentChooser * chooser,
+                                   RawIndIterator offBegin, RawIndIterator offEnd, const volatile int * stop)
+{
+	RawIndIterator it = offBegin;
+
+	while (it != offEnd) {
+		if (stop != NULL && *stop)
+			break;
+		Individual * dad = NULL;
+		Individual * mom = NULL;
+		ParentChooser::IndividualPair const parents = chooser->chooseParents();
+		dad = parents.first;
+		mom = parents.second;
+
+		m_OffspringGenerator->generateOffspring(pop, offPop, dad, mom, it, offEnd);
 	}
+}
+
+
+void HomoMating::finalizeSubPop(Population & pop)
+{
 	m_ParentChooser->finalize();
+	for (size_t i = 0; i < m_choosers.size(); ++i)
+		if (m_choosers[i]->initialized())
+			m_choosers[i]->finalize();
 	m_OffspringGenerator->finalize(pop);
+}
+
+
+bool HomoMating::populate(Population & pop, Population & scratch)
+{
+	if (!concurrent())
+		return MatingScheme::populate(pop, scratch);
+
+	// Offspring of all subpopulations are generated by a pool of threads, each
+	// subpopulation using its own parent chooser, which avoids one parallel
+	// region for each (small) subpopulation.
+	DBG_DO(DBG_MATING, cerr << "Mating is done in " << numThreads() << " threads for all subpopulations" << endl);
+	prepareParentChoosers(pop.numSubPop());
+	OffspringBlocks blocks(scratch);
+	for (size_t sp = 0; sp < static_cast<size_t>(pop.numSubPop()); ++sp) {
+		if (scratch.subPopSize(sp) == 0)
+			continue;
+		if (!m_OffspringGenerator->initialized())
+			m_OffspringGenerator->initialize(pop, sp);
+		blocks.add(this, sp, pop.gen(), sp, scratch.rawIndBegin(sp), scratch.rawIndEnd(sp));
+	}
+	blocks.generate(pop, scratch);
+	finalizeSubPop(pop);
+	return true;
+}
+
+
+bool HomoMating::mateSubPop(Population & pop, Population & offPop, size_t subPop,
+                            RawIndIterator offBegin, RawIndIterator offEnd)
+{
+	// nothing to do.
+	if (offBegin == offEnd)
+		return true;
+
+	ParentChooser * chooser = initializeSubPop(pop, subPop);
+
+	if (!concurrent()) {
+		DBG_DO(DBG_MATING, cerr << "Mating is done in single-thread mode" << endl);
+		generateOffspring(pop, offPop, chooser, offBegin, offEnd);
+	} else {
+		DBG_DO(DBG_MATING, cerr << "Mating is done in " << numThreads() << " threads" << endl);
+		OffspringBlocks blocks(offPop);
+		blocks.add(this, 0, pop.gen(), subPop, offBegin, offEnd);
+		blocks.generate(pop, offPop);
+	}
+	finalizeSubPop(pop);
 	return true;
 }
 
@@ -1451,6 +1684,7 @@ bool PedigreeMating::mate(Population & pop, Population & scratch)
 	//
 	size_t oldGen = m_ped.curAncestralGen();
 	const_cast<Pedigree &>(m_ped).useAncestralGen(m_gen);
+	scratch.setInfoByColumn(pop.infoByColumn());
 	DBG_DO(DBG_MATING, cerr << "Producing offspring generation of size " << m_ped.subPopSizes() <<
 		" using generation " << m_gen << " of the pedigree." << endl);
 	scratch.fitSubPopStru(m_ped.subPopSizes(), m_ped.subPopNames());
@@ -1465,6 +1699,11 @@ bool PedigreeMating::mate(Population & pop, Population & scratch)
 	for (; it != it_end; ++it)
 		idMap[toID(it->info(idIdx))] = &*it;
 
+	// parents are looked up from the pedigree in the parallel region, which
+	// should not build indexes of IDs
+	for (int gen = 0; gen <= m_ped.ancestralGens(); ++gen)
+		m_ped.buildIDIndex(gen, m_ped.idIdx());
+
 	// initialize operator before entering parallel region in order to avoid race condition
 	opList::const_iterator iop = m_transmitters.begin();
 	opList::const_iterator iopEnd = m_transmitters.end();
@@ -1557,6 +1796,19 @@ bool PedigreeMating::parallelizable() const
 }
 
 
+bool PedigreeMating::dependsOnReplicateOrder() const
+{
+	opList::const_iterator iop = m_transmitters.begin();
+	opList::const_iterator iopEnd = m_transmitters.end();
+
+	for (; iop != iopEnd; ++iop) {
+		if ((*iop)->dependsOnReplicateOrder())
+			return true;
+	}
+	return false;
+}
+
+
 HeteroMating::HeteroMating(const vectormating & matingSchemes,
 	const uintListFunc & subPopSize,
 	bool shuffleOffspring, SexChoice weightBy)
@@ -1615,7 +1867,7 @@ HeteroMating::~HeteroMating()
 
 
 HeteroMating::HeteroMating(const HeteroMating & rhs) :
-	MatingScheme(rhs), m_shuffleOffspring(rhs.m_shuffleOffspring)
+	MatingScheme(rhs), m_shuffleOffspring(rhs.m_shuffleOffspring), m_weightBy(rhs.m_weightBy)
 {
 	vectormating::const_iterator it = rhs.m_matingSchemes.begin();
 	vectormating::const_iterator it_end = rhs.m_matingSchemes.end();
@@ -1629,13 +1881,40 @@ HeteroMating::HeteroMating(const HeteroMating & rhs) :
 }
 
 
-bool HeteroMating::mate(Population & pop, Population & scratch)
+bool HeteroMating::canPopulateConcurrently() const
 {
-	// scrtach will have the right structure.
-	if (!prepareScratchPop(pop, scratch))
-		return false;
+	vectormating::const_iterator it = m_matingSchemes.begin();
+	vectormating::const_iterator it_end = m_matingSchemes.end();
 
-	for (size_t sp = 0; sp < static_cast<size_t>(pop.numSubPop()); ++sp) {
+	for (; it != it_end; ++it)
+		if (!(*it)->canPopulateConcurrently())
+			return false;
+	return true;
+}
+
+
+bool HeteroMating::dependsOnReplicateOrder() const
+{
+	vectormating::const_iterator it = m_matingSchemes.begin();
+	vectormating::const_iterator it_end = m_matingSchemes.end();
+
+	for (; it != it_end; ++it)
+		if ((*it)->dependsOnReplicateOrder())
+			return true;
+	return false;
+}
+
+
+bool HeteroMating::populate(Population & pop, Population & scratch)
+{
+	size_t numSP = static_cast<size_t>(pop.numSubPop());
+	// mating schemes, (virtual) subpopulations and number of offspring
+	// in each subpopulation.
+	vector<vectormating> allM(numSP);
+	vector<subPopList> allSps(numSP);
+	vector<vectoru> allSizes(numSP);
+
+	for (size_t sp = 0; sp < numSP; ++sp) {
 		vectormating m;
 		vectorf w_pos;                          // positive weights
 		vectorf w_neg;                          // negative weights
@@ -1741,8 +2020,44 @@ bool HeteroMating::mate(Population & pop, Population & scratch)
 
 		DBG_ASSERT(vspSize.size() == m.size() && m.size() == sps.size(),
 			SystemError, "Failed to determine subpopulation size");
+		allM[sp].swap(m);
+		allSps[sp] = sps;
+		allSizes[sp].swap(vspSize);
+	}
+
+	// If all mating schemes can generate offspring concurrently, offspring of
+	// all (virtual) subpopulations are generated in blocks by a pool of
+	// threads, instead of one mating scheme after another and one
+	// subpopulation after another. Each mating scheme uses a separate parent
+	// chooser for each subpopulation, which is initialized with its virtual
+	// subpopulation activated so this is not possible if a mating scheme is
+	// applied to more than one virtual subpopulation of a subpopulation.
+	bool concurrent = true;
+	vectormating used;
+	for (size_t sp = 0; sp < numSP && concurrent; ++sp) {
+		const vectormating & m = allM[sp];
+		for (size_t i = 0; i < m.size() && concurrent; ++i) {
+			if (allSizes[sp][i] == 0)
+				continue;
+			if (!m[i]->concurrent())
+				concurrent = false;
+			for (size_t j = 0; j < i; ++j)
+				if (allSizes[sp][j] != 0 && m[j] == m[i])
+					concurrent = false;
+			if (std::find(used.begin(), used.end(), m[i]) == used.end())
+				used.push_back(m[i]);
+		}
+	}
+
+	if (concurrent)
+		for (size_t i = 0; i < used.size(); ++i)
+			used[i]->prepareParentChoosers(numSP);
+	OffspringBlocks blocks(scratch);
+	for (size_t sp = 0; sp < numSP; ++sp) {
+		const vectormating & m = allM[sp];
+		const subPopList & sps = allSps[sp];
 		// it points to the first mating scheme.
-		vectoru::iterator itSize = vspSize.begin();
+		vectoru::iterator itSize = allSizes[sp].begin();
 		RawIndIterator ind = scratch.rawIndBegin(sp);
 		DBG_FAILIF(pop.hasActivatedVirtualSubPop(sp), ValueError,
 			(boost::format("SubPopulation %1% has activated virtual subpopulation.") % sp).str());
@@ -1762,6 +2077,12 @@ bool HeteroMating::mate(Population & pop, Population & scratch)
 			else if (pop.hasActivatedVirtualSubPop(sp))
 				pop.deactivateVirtualSubPop(sp);
 
+			if (concurrent) {
+				m[idx]->initializeSubPop(pop, sp, sp);
+				blocks.add(m[idx], sp, pop.gen(), sp, ind, ind + *itSize);
+				ind += *itSize;
+				continue;
+			}
 			// real mating
 			try {
 				if (!m[idx]->mateSubPop(pop, scratch, sp, ind, ind + *itSize))
@@ -1778,19 +2099,33 @@ bool HeteroMating::mate(Population & pop, Population & scratch)
 		// we do not deactivate each time to save some time
 		if (pop.hasActivatedVirtualSubPop(sp))
 			pop.deactivateVirtualSubPop(sp);
-		// if more than two mating schemes working on the same subpopulation,
-		// it is better to shuffle offspring afterwards,
-		if (m.size() > 1 && m_shuffleOffspring) {
-			DBG_DO(DBG_MATING, cerr << "Random shuffle individuals in the offspring generation." << endl);
-			getRNG().randomShuffle(scratch.rawIndBegin(sp), scratch.rawIndEnd(sp));
-			scratch.setIndOrdered(false);
-		}
+		if (!concurrent)
+			shuffleOffspring(scratch, sp, m.size());
 	}                         // each subpopulation.
-	submitScratch(pop, scratch);
+
+	if (concurrent) {
+		blocks.generate(pop, scratch);
+		for (size_t i = 0; i < used.size(); ++i)
+			used[i]->finalizeSubPop(pop);
+		for (size_t sp = 0; sp < numSP; ++sp)
+			shuffleOffspring(scratch, sp, allM[sp].size());
+	}
 	return true;
 }
 
 
+void HeteroMating::shuffleOffspring(Population & scratch, size_t sp, size_t numSchemes)
+{
+	// if more than two mating schemes working on the same subpopulation,
+	// it is better to shuffle offspring afterwards,
+	if (numSchemes > 1 && m_shuffleOffspring) {
+		DBG_DO(DBG_MATING, cerr << "Random shuffle individuals in the offspring generation." << endl);
+		getRNG().randomShuffle(scratch.rawIndBegin(sp), scratch.rawIndEnd(sp));
+		scratch.setIndOrdered(false);
+	}
+}
+
+
 ConditionalMating::ConditionalMating(PyObject * cond, const MatingScheme & ifMatingScheme,
 	const MatingScheme & elseMatingScheme)
 #if PY_VERSION_HEX >= 0x03000000
@@ -1887,6 +2222,12 @@ bool ConditionalMating::mate(Population & pop, Population & scratch)
 }
 
 
+bool ConditionalMating::dependsOnReplicateOrder() const
+{
+	return m_ifMS->dependsOnReplicateOrder() || m_elseMS->dependsOnReplicateOrder();
+}
+
+
 }
 
 
@@ -660,7 +660,11 @@ public:
 
 
 	/// CPPONLY
-	bool parallelizable() const;
+	virtual bool parallelizable() const;
+
+	/// CPPONLY return \c true if any of the transmitters depends on the
+	/// order at which replicates are evolved
+	bool dependsOnReplicateOrder() const;
 
 protected:
 	/// number of offspring
@@ -741,6 +745,16 @@ public:
 	/// HIDDEN describe a controlled offspring generator
 	virtual string describe(bool format = true) const;
 
+	/** CPPONLY This offspring generator calls a Python function and counts
+	 *  alleles of offspring in a subpopulation so it cannot generate offspring
+	 *  in parallel.
+	 */
+	bool parallelizable() const
+	{
+		return false;
+	}
+
+
 private:
 	void getExpectedAlleles(const Population & pop, vectorf & expFreq);
 
@@ -1491,6 +1505,35 @@ public:
 	 */
 	bool prepareScratchPop(Population & pop, Population & scratch);
 
+	/** CPPONLY
+	 *  Populate a prepared scratch population \e scratch from parental
+	 *  population \e pop, without submitting it. \c mate() is equivalent to
+	 *  \c prepareScratchPop(), \c populate() and \c submitScratch().
+	 */
+	virtual bool populate(Population & pop, Population & scratch);
+
+	/** CPPONLY
+	 *  Return \c True if \c populate() does not call any Python function and
+	 *  does not share states between populations, so that clones of this
+	 *  mating scheme can populate offspring generations of different
+	 *  replicates in parallel.
+	 */
+	virtual bool canPopulateConcurrently() const
+	{
+		return true;
+	}
+
+
+	/** CPPONLY
+	 *  Return \c True if any during-mating operator of this mating scheme
+	 *  depends on the order at which replicates are evolved.
+	 */
+	virtual bool dependsOnReplicateOrder() const
+	{
+		return false;
+	}
+
+
 	/** CPPONLY
 	 *  Use to generate a warning when subPopSize is specified in a homogeneous
 	 *  mating scheme called in a heterogeneous mating scheme.
@@ -1542,16 +1585,11 @@ public:
 		double weight = 0);
 
 	/// destructor
-	~HomoMating()
-	{
-		delete m_ParentChooser;
-		delete m_OffspringGenerator;
-	}
-
+	~HomoMating();
 
 	/// CPPONLY
 	HomoMating(const HomoMating & rhs) :
-		MatingScheme(rhs), m_subPops(rhs.m_subPops), m_weight(rhs.m_weight)
+		MatingScheme(rhs), m_subPops(rhs.m_subPops), m_weight(rhs.m_weight), m_choosers()
 	{
 		m_OffspringGenerator = rhs.m_OffspringGenerator->clone();
 		m_ParentChooser = rhs.m_ParentChooser->clone();
@@ -1587,6 +1625,70 @@ public:
 	virtual bool mateSubPop(Population & pop, Population & offPop, size_t subPop,
 		RawIndIterator offBegin, RawIndIterator offEnd);
 
+	/// CPPONLY
+	bool canPopulateConcurrently() const
+	{
+		return m_ParentChooser->parallelizable() && m_OffspringGenerator->parallelizable();
+	}
+
+
+	/// CPPONLY
+	bool dependsOnReplicateOrder() const
+	{
+		return m_OffspringGenerator->dependsOnReplicateOrder();
+	}
+
+
+	/** CPPONLY Populate all subpopulations of \e scratch. If this mating
+	 *  scheme can populate offspring concurrently, offspring of all
+	 *  subpopulations are generated by a pool of threads.
+	 */
+	virtual bool populate(Population & pop, Population & scratch);
+
+	/** CPPONLY Prepare \e num parent choosers for the current generation,
+	 *  namely the parent chooser of this mating scheme and <tt>num - 1</tt>
+	 *  copies of it. Copies left from generations with more subpopulations
+	 *  are freed.
+	 */
+	void prepareParentChoosers(size_t num);
+
+	/** CPPONLY Return the \e idx-th parent chooser of this mating scheme,
+	 *  which is the parent chooser of this mating scheme if \e idx is 0, and
+	 *  a copy of it otherwise. Copies are used to populate several
+	 *  (virtual) subpopulations concurrently and should have been prepared
+	 *  by \c prepareParentChoosers.
+	 */
+	ParentChooser * parentChooser(size_t idx);
+
+	/** CPPONLY Initialize offspring generator and the \e idx-th parent
+	 *  chooser for (virtual) subpopulation \e subPop of \e pop, if they have
+	 *  not been initialized. Return the parent chooser.
+	 */
+	ParentChooser * initializeSubPop(Population & pop, size_t subPop, size_t idx = 0);
+
+	/** CPPONLY Fill offspring in range \e offBegin to \e offEnd, using parents
+	 *  chosen by an initialized parent \e chooser. This function can be
+	 *  called concurrently for disjoint ranges if \c canPopulateConcurrently()
+	 *  returns \c true. Generation stops early if \e *stop becomes non-zero.
+	 */
+	void generateOffspring(Population & pop, Population & offPop, ParentChooser * chooser,
+		RawIndIterator offBegin, RawIndIterator offEnd, const volatile int * stop = NULL);
+
+	/// CPPONLY finalize offspring generator and all parent choosers
+	void finalizeSubPop(Population & pop);
+
+	/** CPPONLY Return \c true if offspring should be generated in blocks by
+	 *  a pool of threads.
+	 */
+	bool concurrent() const;
+
+	/// CPPONLY number of offspring per mating event at generation \e gen.
+	UINT numOffspring(ssize_t gen)
+	{
+		return m_OffspringGenerator->numOffspring(gen);
+	}
+
+
 private:
 	ParentChooser * m_ParentChooser;
 	OffspringGenerator * m_OffspringGenerator;
@@ -1597,6 +1699,8 @@ private:
 	///
 	double m_weight;
 
+	/// copies of m_ParentChooser used to populate subpopulations concurrently
+	vector<ParentChooser *> m_choosers;
 };
 
 
@@ -1657,6 +1761,16 @@ public:
 
 	bool parallelizable() const;
 
+	/// CPPONLY
+	bool canPopulateConcurrently() const
+	{
+		return false;
+	}
+
+
+	/// CPPONLY
+	bool dependsOnReplicateOrder() const;
+
 private:
 	const Pedigree & m_ped;
 
@@ -1748,9 +1862,18 @@ public:
 	/** CPPONLY Call each homogeneous mating scheme to populate offspring
 	 *  generation.
 	 */
-	bool mate(Population & pop, Population & scratch);
+	bool populate(Population & pop, Population & scratch);
+
+	/// CPPONLY
+	bool canPopulateConcurrently() const;
+
+	/// CPPONLY
+	bool dependsOnReplicateOrder() const;
 
 private:
+	/// shuffle offspring of subpopulation sp if it is populated by several mating schemes
+	void shuffleOffspring(Population & scratch, size_t sp, size_t numSchemes);
+
 	vectormating m_matingSchemes;
 	///
 	bool m_shuffleOffspring;
@@ -1802,6 +1925,16 @@ public:
 	 */
 	bool mate(Population & pop, Population & scratch);
 
+	/// CPPONLY
+	bool canPopulateConcurrently() const
+	{
+		return false;
+	}
+
+
+	/// CPPONLY
+	bool dependsOnReplicateOrder() const;
+
 private:
 	Expression m_cond;
 	pyFunc m_func;
@@ -180,13 +180,17 @@ bool Migrator::apply(Population & pop) const
 			}
 		} else if (m_mode == BY_PROBABILITY) {
 			WeightedSampler ws(migrationRate[from]);
+			const RNG & rng = getRNG();
+			size_t call = getRNG().newStreamCall();
 
 			// for each individual, migrate according to migration probability
 			if (numThreads() > 1) {
 #ifdef _OPENMP
 #  pragma omp parallel private(toIndex)
 				{
+					RNGStream stream(rng, MIGRATION_STREAM, pop.rep(), call);
 					for (IndIterator ind = pop.indIterator(spFrom, omp_get_thread_num()); ind.valid(); ++ind) {
+						stream.seek(pop.gen(), spFrom, ind.rawIter() - pop.rawIndBegin());
 						toIndex = ws.draw();
 						DBG_ASSERT(toIndex < migrationRate[from].size(), ValueError,
 							"Return index out of range.");
@@ -196,7 +200,9 @@ bool Migrator::apply(Population & pop) const
 				}
 #endif
 			} else {
+				RNGStream stream(rng, MIGRATION_STREAM, pop.rep(), call);
 				for (IndIterator ind = pop.indIterator(spFrom); ind.valid(); ++ind) {
+					stream.seek(pop.gen(), spFrom, ind.rawIter() - pop.rawIndBegin());
 					//toIndex = getRNG().randIntByFreq( rateSize, &migrationRate[from][0] ) ;
 					toIndex = ws.draw();
 
@@ -154,6 +154,13 @@ public:
 	/// HIDDEN
 	string describe(bool format = true) const;
 
+	/// CPPONLY
+	bool canApplyConcurrently() const
+	{
+		return noOutput();
+	}
+
+
 protected:
 	/// migration rate. its meaning is controled by m_mode
 	const matrixf m_rate;
@@ -246,6 +253,13 @@ public:
 	/// HIDDEN
 	string describe(bool format = true) const;
 
+	/// CPPONLY
+	bool canApplyConcurrently() const
+	{
+		return noOutput();
+	}
+
+
 protected:
 	/// migration rate. its meaning is controled by m_mode
 	const matrixf m_rate;
@@ -28,11 +28,502 @@
 
 #ifdef MUTANTALLELE
 
-#  include <map>
+#  include <vector>
+#  include <algorithm>
 #  include <iostream>
 
 namespace simuPOP {
 
+/** A sorted container of (index, allele) pairs that provides the subset of
+ *  the std::map interface that is used by vectorm. Pairs are stored in
+ *  short sorted arrays (chunks) so that each mutant takes the size of a
+ *  pair instead of a tree node, and iteration scans contiguous memory.
+ *  Inserting or removing an element moves at most one chunk. Unlike
+ *  std::map, these operations invalidate iterators of the container.
+ */
+class chunked_map
+{
+public:
+	typedef std::pair<size_t, Allele> value_type;
+	typedef size_t key_type;
+
+	// maximum number of elements in a chunk
+	static const size_t CHUNK_SIZE = 256;
+
+private:
+	typedef std::vector<value_type> chunk;
+
+	struct key_less
+	{
+		bool operator()(const value_type & v, size_t key) const
+		{
+			return v.first < key;
+		}
+
+
+		bool operator()(size_t key, const value_type & v) const
+		{
+			return key < v.first;
+		}
+
+
+	};
+
+public:
+	class const_iterator
+	{
+public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef chunked_map::value_type value_type;
+		typedef long int difference_type;
+		typedef const value_type * pointer;
+		typedef const value_type & reference;
+
+		const_iterator() : m_map(NULL), m_chunk(0), m_offset(0)
+		{
+		}
+
+
+		const_iterator(const chunked_map * map, size_t c, size_t o)
+			: m_map(map), m_chunk(c), m_offset(o)
+		{
+		}
+
+
+		const value_type & operator*() const
+		{
+			return (*m_map->m_chunks[m_chunk])[m_offset];
+		}
+
+
+		const value_type * operator->() const
+		{
+			return &**this;
+		}
+
+
+		const_iterator & operator++()
+		{
+			if (++m_offset == m_map->m_chunks[m_chunk]->size()) {
+				++m_chunk;
+				m_offset = 0;
+			}
+			return *this;
+		}
+
+
+		const_iterator operator++(int)
+		{
+			const_iterator orig = *this;
+
+			++(*this);
+			return orig;
+		}
+
+
+		friend bool operator==(const const_iterator & lhs, const const_iterator & rhs)
+		{
+			return lhs.m_chunk == rhs.m_chunk && lhs.m_offset == rhs.m_offset;
+		}
+
+
+		friend bool operator!=(const const_iterator & lhs, const const_iterator & rhs)
+		{
+			return lhs.m_chunk != rhs.m_chunk || lhs.m_offset != rhs.m_offset;
+		}
+
+
+protected:
+		const chunked_map * m_map;
+		size_t m_chunk;
+		size_t m_offset;
+
+		friend class chunked_map;
+	};
+
+	class iterator : public const_iterator
+	{
+public:
+		typedef value_type * pointer;
+		typedef value_type & reference;
+
+		iterator() : const_iterator()
+		{
+		}
+
+
+		iterator(chunked_map * map, size_t c, size_t o) : const_iterator(map, c, o)
+		{
+		}
+
+
+		value_type & operator*() const
+		{
+			return const_cast<value_type &>(const_iterator::operator*());
+		}
+
+
+		value_type * operator->() const
+		{
+			return &**this;
+		}
+
+
+		iterator & operator++()
+		{
+			const_iterator::operator++();
+			return *this;
+		}
+
+
+		iterator operator++(int)
+		{
+			iterator orig = *this;
+
+			const_iterator::operator++();
+			return orig;
+		}
+
+
+	};
+
+	chunked_map() : m_chunks(), m_lastKey(), m_size(0)
+	{
+	}
+
+
+	chunked_map(const chunked_map & rhs) : m_chunks(), m_lastKey(rhs.m_lastKey), m_size(rhs.m_size)
+	{
+		m_chunks.reserve(rhs.m_chunks.size());
+		for (size_t c = 0; c < rhs.m_chunks.size(); ++c)
+			m_chunks.push_back(newChunk(rhs.m_chunks[c]->begin(), rhs.m_chunks[c]->end()));
+	}
+
+
+	~chunked_map()
+	{
+		clear();
+	}
+
+
+	chunked_map & operator=(const chunked_map & rhs)
+	{
+		if (this != &rhs) {
+			chunked_map tmp(rhs);
+			swap(tmp);
+		}
+		return *this;
+	}
+
+
+	void swap(chunked_map & rhs)
+	{
+		m_chunks.swap(rhs.m_chunks);
+		m_lastKey.swap(rhs.m_lastKey);
+		std::swap(m_size, rhs.m_size);
+	}
+
+
+	size_t size() const
+	{
+		return m_size;
+	}
+
+
+	bool empty() const
+	{
+		return m_size == 0;
+	}
+
+
+	void clear()
+	{
+		for (size_t c = 0; c < m_chunks.size(); ++c)
+			delete m_chunks[c];
+		m_chunks.clear();
+		m_lastKey.clear();
+		m_size = 0;
+	}
+
+
+	iterator begin()
+	{
+		return iterator(this, 0, 0);
+	}
+
+
+	const_iterator begin() const
+	{
+		return const_iterator(this, 0, 0);
+	}
+
+
+	iterator end()
+	{
+		return iterator(this, m_chunks.size(), 0);
+	}
+
+
+	const_iterator end() const
+	{
+		return const_iterator(this, m_chunks.size(), 0);
+	}
+
+
+	iterator lower_bound(size_t key)
+	{
+		size_t c, o;
+
+		lowerBound(key, c, o);
+		return iterator(this, c, o);
+	}
+
+
+	const_iterator lower_bound(size_t key) const
+	{
+		size_t c, o;
+
+		lowerBound(key, c, o);
+		return const_iterator(this, c, o);
+	}
+
+
+	iterator upper_bound(size_t key)
+	{
+		size_t c, o;
+
+		upperBound(key, c, o);
+		return iterator(this, c, o);
+	}
+
+
+	const_iterator upper_bound(size_t key) const
+	{
+		size_t c, o;
+
+		upperBound(key, c, o);
+		return const_iterator(this, c, o);
+	}
+
+
+	iterator find(size_t key)
+	{
+		iterator it = lower_bound(key);
+
+		return it == end() || it->first != key ? end() : it;
+	}
+
+
+	const_iterator find(size_t key) const
+	{
+		const_iterator it = lower_bound(key);
+
+		return it == end() || it->first != key ? end() : it;
+	}
+
+
+	/** Insert \e v before \e hint if it is the right location, and at the
+	 *  right location otherwise. An existing element with the same key is
+	 *  not replaced. An iterator to the element with key \e v.first is
+	 *  returned so that a sorted sequence can be inserted (merged) in
+	 *  linear time by passing the returned iterator (advanced) as hint.
+	 */
+	iterator insert(const const_iterator & hint, const value_type & v)
+	{
+		size_t c = hint.m_chunk;
+		size_t o = hint.m_offset;
+
+		if (!validHint(c, o, v.first))
+			lowerBound(v.first, c, o);
+		if (c < m_chunks.size() && (*m_chunks[c])[o].first == v.first)
+			return iterator(this, c, o);
+		return insertAt(c, o, v);
+	}
+
+
+	void erase(const const_iterator & pos)
+	{
+		size_t c = pos.m_chunk;
+		chunk & ch = *m_chunks[c];
+
+		ch.erase(ch.begin() + pos.m_offset);
+		--m_size;
+		if (ch.empty())
+			removeChunks(c, c + 1);
+		else {
+			m_lastKey[c] = ch.back().first;
+			mergeIfSparse(c);
+		}
+	}
+
+
+	void erase(const const_iterator & first, const const_iterator & last)
+	{
+		size_t c1 = first.m_chunk;
+		size_t o1 = first.m_offset;
+		size_t c2 = last.m_chunk;
+		size_t o2 = last.m_offset;
+
+		if (c1 == c2) {
+			if (o1 == o2)
+				return;
+			chunk & ch = *m_chunks[c1];
+			ch.erase(ch.begin() + o1, ch.begin() + o2);
+			m_size -= o2 - o1;
+			if (ch.empty())
+				removeChunks(c1, c1 + 1);
+			else {
+				m_lastKey[c1] = ch.back().first;
+				mergeIfSparse(c1);
+			}
+			return;
+		}
+		// tail of the first chunk
+		chunk & head = *m_chunks[c1];
+		m_size -= head.size() - o1;
+		head.erase(head.begin() + o1, head.end());
+		size_t removeBegin = c1;
+		if (!head.empty()) {
+			m_lastKey[c1] = head.back().first;
+			++removeBegin;
+		}
+		// chunks in between
+		for (size_t c = c1 + 1; c < c2; ++c)
+			m_size -= m_chunks[c]->size();
+		// head of the last chunk, which will not be empty
+		if (c2 < m_chunks.size() && o2 > 0) {
+			chunk & tail = *m_chunks[c2];
+			tail.erase(tail.begin(), tail.begin() + o2);
+			m_size -= o2;
+		}
+		removeChunks(removeBegin, c2);
+		if (removeBegin > c1)
+			mergeIfSparse(c1);
+	}
+
+
+private:
+	static chunk * newChunk(chunk::const_iterator first, chunk::const_iterator last)
+	{
+		chunk * ch = new chunk();
+
+		// reserve one more so that a full chunk does not grow before it is split
+		ch->reserve(CHUNK_SIZE + 1);
+		ch->insert(ch->end(), first, last);
+		return ch;
+	}
+
+
+	void lowerBound(size_t key, size_t & c, size_t & o) const
+	{
+		c = std::lower_bound(m_lastKey.begin(), m_lastKey.end(), key) - m_lastKey.begin();
+		if (c == m_chunks.size())
+			o = 0;
+		else {
+			const chunk & ch = *m_chunks[c];
+			o = std::lower_bound(ch.begin(), ch.end(), key, key_less()) - ch.begin();
+		}
+	}
+
+
+	void upperBound(size_t key, size_t & c, size_t & o) const
+	{
+		c = std::upper_bound(m_lastKey.begin(), m_lastKey.end(), key) - m_lastKey.begin();
+		if (c == m_chunks.size())
+			o = 0;
+		else {
+			const chunk & ch = *m_chunks[c];
+			o = std::upper_bound(ch.begin(), ch.end(), key, key_less()) - ch.begin();
+		}
+	}
+
+
+	// if key can be inserted at chunk c, offset o
+	bool validHint(size_t c, size_t o, size_t key) const
+	{
+		size_t n = m_chunks.size();
+
+		if (c >= n)
+			return c == n && (n == 0 || m_lastKey.back() < key);
+		const chunk & ch = *m_chunks[c];
+		if (o >= ch.size() || ch[o].first < key)
+			return false;
+		if (o > 0)
+			return ch[o - 1].first < key;
+		return c == 0 || m_lastKey[c - 1] < key;
+	}
+
+
+	iterator insertAt(size_t c, size_t o, const value_type & v)
+	{
+		++m_size;
+		if (c == m_chunks.size()) {
+			// append to the last chunk, or start a new one
+			if (c == 0 || m_chunks[c - 1]->size() >= CHUNK_SIZE) {
+				m_chunks.push_back(newChunk(chunk::const_iterator(), chunk::const_iterator()));
+				m_lastKey.push_back(v.first);
+			} else {
+				--c;
+				m_lastKey[c] = v.first;
+			}
+			m_chunks[c]->push_back(v);
+			return iterator(this, c, m_chunks[c]->size() - 1);
+		}
+		chunk & ch = *m_chunks[c];
+		ch.insert(ch.begin() + o, v);
+		if (ch.size() > CHUNK_SIZE) {
+			// split the chunk into two halves
+			size_t half = ch.size() / 2;
+			m_chunks.insert(m_chunks.begin() + c + 1, newChunk(ch.begin() + half, ch.end()));
+			m_lastKey.insert(m_lastKey.begin() + c + 1, ch.back().first);
+			ch.erase(ch.begin() + half, ch.end());
+			m_lastKey[c] = ch.back().first;
+			if (o >= half) {
+				++c;
+				o -= half;
+			}
+		}
+		return iterator(this, c, o);
+	}
+
+
+	void removeChunks(size_t first, size_t last)
+	{
+		if (first >= last)
+			return;
+		for (size_t c = first; c < last; ++c)
+			delete m_chunks[c];
+		m_chunks.erase(m_chunks.begin() + first, m_chunks.begin() + last);
+		m_lastKey.erase(m_lastKey.begin() + first, m_lastKey.begin() + last);
+	}
+
+
+	// merge chunk c with its next chunk if one of them is mostly empty.
+	void mergeIfSparse(size_t c)
+	{
+		if (c + 1 >= m_chunks.size())
+			return;
+		chunk & ch = *m_chunks[c];
+		chunk & next = *m_chunks[c + 1];
+		if ((ch.size() < CHUNK_SIZE / 4 || next.size() < CHUNK_SIZE / 4) &&
+		    ch.size() + next.size() <= CHUNK_SIZE) {
+			ch.insert(ch.end(), next.begin(), next.end());
+			m_lastKey[c] = m_lastKey[c + 1];
+			removeChunks(c + 1, c + 2);
+		}
+	}
+
+
+private:
+	std::vector<chunk *> m_chunks;
+
+	// last key of each chunk, used to locate chunks
+	std::vector<size_t> m_lastKey;
+
+	size_t m_size;
+};
+
+
 class vectorm
 {
 public:
@@ -40,7 +531,7 @@ public:
 	typedef const Allele & const_reference;
 	typedef Allele * pointer;
 	typedef const Allele * const_pointer;
-	typedef std::map<size_t, Allele> storage;
+	typedef chunked_map storage;
 	typedef storage::iterator val_iterator;
 	typedef storage::const_iterator const_val_iterator;
 
@@ -165,12 +656,12 @@ public:
 		ssize_t shift = m_size - ibeg.index();
 
 		m_size += iend.index() - ibeg.index();
-		const_val_iterator ptr = beg;
-		for (; ptr != end; ++ptr) {
-			DBG_ASSERT(ptr->second != 0, RuntimeError, "Cannot store zero as mutant");
-			// we are inserting to the end, which should be constant instead of log(n) time
-			m_data.insert(m_data.end(), storage::value_type(ptr->first + shift, ptr->second));
-		}
+		// inserting from itself would invalidate the source
+		if (&ibeg() == this) {
+			std::vector<storage::value_type> src(beg, end);
+			append(src.begin(), src.end(), shift);
+		} else
+			append(beg, end, shift);
 	}
 
 
@@ -181,27 +672,15 @@ public:
 		size_t iend = it.index() + (end - begin);
 		ssize_t lagging = it.index() - begin.index();
 
-		// remove old data
-		if (!m_data.empty() && it.index() <= m_data.rbegin()->first)
-			m_data.erase(m_data.lower_bound(it.index()),
-				iend > m_size ? m_data.end() : m_data.lower_bound(iend));
-		// insert new data
 		const_val_iterator vbeg = begin.get_val_iterator();
 		const_val_iterator vend = (end - (iend > m_size ? iend - m_size : 0)).get_val_iterator();
-		if (vbeg == vend)
-			return;
-		// the first element is insert to get the right location for future insertion
-		DBG_ASSERT(vbeg->second != 0, RuntimeError, "Cannot store zero as mutant");
-		val_iterator dest = m_data.insert(m_data.end(), val_iterator::value_type(vbeg->first + lagging, vbeg->second));
-		++vbeg;
-		// according to the documentation, if ip in insert(ip, val) is set to the position
-		// precedes the value to be inserted, this will make a very fast insertion.
-		// because we are insertion from small to large numbers, we are setting ip to the
-		// location of the last item
-		for (; vbeg != vend; ++vbeg) {
-			DBG_ASSERT(vbeg->second != 0, RuntimeError, "Cannot store zero as mutant");
-			dest = m_data.insert(dest, val_iterator::value_type(vbeg->first + lagging, vbeg->second));
-		}
+		// begin() is the source container, copying within the same container
+		// would invalidate the source
+		if (&begin() == this) {
+			std::vector<storage::value_type> src(vbeg, vend);
+			replace_region(it.index(), iend, src.begin(), src.end(), lagging);
+		} else
+			replace_region(it.index(), iend, vbeg, vend, lagging);
 #  if 0
 		/*
 		   The following code copies elements one by one, which can be more efficient if the
@@ -593,6 +1072,36 @@ public:
 
 
 private:
+	// append sorted mutants with shifted indexes to the end
+	template <typename Iterator>
+	void append(Iterator beg, Iterator end, ssize_t shift)
+	{
+		for (; beg != end; ++beg) {
+			DBG_ASSERT(beg->second != 0, RuntimeError, "Cannot store zero as mutant");
+			// we are inserting to the end, which should be constant instead of log(n) time
+			m_data.insert(m_data.end(), storage::value_type(beg->first + shift, beg->second));
+		}
+	}
+
+
+	// replace mutants in [ibeg, iend) with sorted mutants with shifted indexes
+	template <typename Iterator>
+	void replace_region(size_t ibeg, size_t iend, Iterator vbeg, Iterator vend, ssize_t lagging)
+	{
+		// remove old data
+		m_data.erase(m_data.lower_bound(ibeg),
+			iend > m_size ? m_data.end() : m_data.lower_bound(iend));
+		// merge new data, each mutant is inserted right after the previous one
+		// so no search is needed.
+		val_iterator dest = m_data.lower_bound(ibeg);
+		for (; vbeg != vend; ++vbeg) {
+			DBG_ASSERT(vbeg->second != 0, RuntimeError, "Cannot store zero as mutant");
+			dest = m_data.insert(dest, storage::value_type(vbeg->first + lagging, vbeg->second));
+			++dest;
+		}
+	}
+
+
 	size_t m_size;
 
 	storage m_data;
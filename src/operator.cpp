@@ -339,6 +339,345 @@ opList::~opList()
 }
 
 
+GenoValueCache::GenoValueCache(const pyFunc & func, bool enabled) :
+	m_enabled(enabled), m_useGen(false), m_infoFields(), m_loci(), m_gen(0),
+	m_key(), m_values(), m_hits(0), m_misses(0)
+{
+	if (!m_enabled)
+		return;
+	for (size_t i = 0; i < func.numArgs(); ++i) {
+		const string & arg = func.arg(i);
+		if (arg == "ind" || arg == "pop")
+			throw ValueError("Values returned by function " + func.name() +
+				" cannot be cached because it accepts parameter " + arg + ".");
+		else if (arg == "gen")
+			m_useGen = true;
+		else if (arg != "geno" && arg != "mut")
+			m_infoFields.push_back(arg);
+	}
+}
+
+
+const vectorf * GenoValueCache::find(const Individual & ind, const vectoru & loci, size_t gen)
+{
+	if (loci != m_loci) {
+		m_values.clear();
+		m_loci = loci;
+	}
+	if (m_useGen && gen != m_gen) {
+		m_values.clear();
+		m_gen = gen;
+	}
+	// sex determines which alleles on sex chromosomes are passed
+	m_key.assign(1, ind.sex() == FEMALE ? 'F' : 'M');
+	for (size_t p = 0; p < ind.ploidy(); ++p) {
+		for (size_t i = 0; i < m_loci.size(); ++i) {
+			Allele a = TO_ALLELE(ind.allele(m_loci[i], p));
+			m_key.append(reinterpret_cast<const char *>(&a), sizeof(Allele));
+		}
+	}
+	for (size_t i = 0; i < m_infoFields.size(); ++i) {
+		double v = ind.info(m_infoFields[i]);
+		m_key.append(reinterpret_cast<const char *>(&v), sizeof(double));
+	}
+	ValueMap::const_iterator it = m_values.find(m_key);
+	if (it == m_values.end()) {
+		++m_misses;
+		return NULL;
+	}
+	++m_hits;
+	return &it->second;
+}
+
+
+void GenoValueCache::insert(const vectorf & values)
+{
+	m_values[m_key] = values;
+}
+
+
+void GenoValueCache::clear(bool stats)
+{
+	m_values.clear();
+	if (stats) {
+		m_hits = 0;
+		m_misses = 0;
+	}
+}
+
+
+vectoru GenoValueCache::stats() const
+{
+	vectoru res(2);
+
+	res[0] = m_hits;
+	res[1] = m_misses;
+	return res;
+}
+
+
+// number of genotypes and dictionary lookups above which a dictionary is not
+// expanded into a table
+#define MAX_GENO_TABLE_SIZE   65536
+#define MAX_GENO_TABLE_LOOKUP 67108864
+
+GenoValueTable::GenoValueTable(const tupleDict & dict, const string & name) :
+	m_dict(dict), m_name(name), m_numAlleles(1), m_genoStru(MaxTraitIndex), m_loci()
+{
+	tupleDict::const_iterator it = m_dict.begin();
+	tupleDict::const_iterator itEnd = m_dict.end();
+
+	for (; it != itEnd; ++it)
+		for (size_t i = 0; i < it->first.size(); ++i)
+			if (it->first[i] >= 0 && static_cast<size_t>(it->first[i]) >= m_numAlleles)
+				m_numAlleles = it->first[i] + 1;
+}
+
+
+void GenoValueTable::compile(const GenoStruTrait & geno, const vectoru & loci) const
+{
+	if (geno.genoStruIdx() == m_genoStru && loci == m_loci)
+		return;
+
+	vectoru chromTypes;
+	for (size_t i = 0; i < loci.size(); ++i)
+		chromTypes.push_back(geno.chromType(geno.chromLocusPair(loci[i]).first));
+
+	for (size_t s = 0; s < 2; ++s) {
+		Sex sex = s == 0 ? MALE : FEMALE;
+		size_t ply = geno.ploidy();
+		if (geno.isHaplodiploid() && sex == MALE)
+			ply = 1;
+		// alleles are collected in the same order as in value()
+		vectoru & alleleIdx = m_alleleIdx[s];
+		alleleIdx.clear();
+		for (size_t idx = 0; idx < loci.size(); ++idx) {
+			for (size_t p = 0; p < ply; ++p) {
+				if (chromTypes[idx] == CHROMOSOME_Y && sex == FEMALE)
+					continue;
+				if (((chromTypes[idx] == CHROMOSOME_X && p == 1) ||
+				     (chromTypes[idx] == CHROMOSOME_Y && p == 0)) && sex == MALE)
+					continue;
+				if (chromTypes[idx] == MITOCHONDRIAL && p > 0)
+					continue;
+				alleleIdx.push_back(loci[idx] + p * geno.totNumLoci());
+			}
+		}
+		vectorf & values = m_values[s];
+		values.clear();
+		size_t size = 1;
+		for (size_t i = 0; i < alleleIdx.size() && size <= MAX_GENO_TABLE_SIZE; ++i)
+			size *= m_numAlleles;
+		if (size > MAX_GENO_TABLE_SIZE || size * (m_dict.size() + 1) > MAX_GENO_TABLE_LOOKUP)
+			continue;
+		values.resize(size);
+		vectori alleles(alleleIdx.size());
+		for (size_t code = 0; code < size; ++code) {
+			// the first allele is the most significant digit of code
+			size_t c = code;
+			for (size_t i = alleles.size(); i > 0; --i) {
+				alleles[i - 1] = static_cast<int>(c % m_numAlleles);
+				c /= m_numAlleles;
+			}
+			vectori key(alleles);
+			if (!lookup(key, chromTypes, sex, ply, values[code]))
+				values[code] = std::numeric_limits<double>::quiet_NaN();
+		}
+	}
+	m_genoStru = geno.genoStruIdx();
+	m_loci = loci;
+}
+
+
+double GenoValueTable::value(const Individual & ind, const vectoru & loci) const
+{
+	size_t s = ind.sex() == MALE ? 0 : 1;
+
+	if (ind.genoStruIdx() == m_genoStru && !m_values[s].empty() && loci == m_loci) {
+		const vectoru & alleleIdx = m_alleleIdx[s];
+		size_t code = 0;
+		size_t i = 0;
+		for (; i < alleleIdx.size(); ++i) {
+			size_t a = ind.allele(alleleIdx[i]);
+			if (a >= m_numAlleles)
+				break;
+			code = code * m_numAlleles + a;
+		}
+		if (i == alleleIdx.size()) {
+			double v = m_values[s][code];
+			// NaN for genotypes that are not in the dictionary
+			if (v == v)
+				return v;
+		}
+	}
+
+	vectoru chromTypes;
+	for (size_t i = 0; i < loci.size(); ++i)
+		chromTypes.push_back(ind.chromType(ind.chromLocusPair(loci[i]).first));
+
+	size_t ply = ind.ploidy();
+	if (ind.isHaplodiploid() && ind.sex() == MALE)
+		ply = 1;
+
+	vectori alleles;
+	alleles.reserve(ply * loci.size());
+
+	for (size_t idx = 0; idx < loci.size(); ++idx) {
+		for (size_t p = 0; p < ply; ++p) {
+			if (chromTypes[idx] == CHROMOSOME_Y && ind.sex() == FEMALE)
+				continue;
+			if (((chromTypes[idx] == CHROMOSOME_X && p == 1) ||
+			     (chromTypes[idx] == CHROMOSOME_Y && p == 0)) && ind.sex() == MALE)
+				continue;
+			if (chromTypes[idx] == MITOCHONDRIAL && p > 0)
+				continue;
+			alleles.push_back(ind.allele(loci[idx], p));
+		}
+	}
+
+	double v = 0;
+	if (lookup(alleles, chromTypes, ind.sex(), ply, v))
+		return v;
+
+	// no match
+	ostringstream allele_string;
+	allele_string << "(";
+	for (size_t i = 0; i < alleles.size(); ++i) {
+		if (i != 0)
+			allele_string << ", ";
+		allele_string << alleles[i];
+	}
+	allele_string << ")";
+	throw ValueError("No " + m_name + " value for genotype " + allele_string.str());
+	// this line should not be reached.
+	return 0;
+}
+
+
+bool GenoValueTable::lookup(vectori & alleles, const vectoru & chromTypes, Sex sex, size_t ply, double & value) const
+{
+	tupleDict::const_iterator pos = m_dict.find(alleles);
+
+	if (pos != m_dict.end()) {
+		value = pos->second;
+		return true;
+	}
+
+	if (ply > 1) {
+		// try to look up the key without phase
+		tupleDict::const_iterator it = m_dict.begin();
+		tupleDict::const_iterator itEnd = m_dict.end();
+		for (; it != itEnd; ++it) {
+			bool ok = true;
+			const tupleDict::key_type & key = it->first;
+			size_t begin_idx = 0;
+			size_t end_idx = 0;
+			for (size_t i = 0; i < chromTypes.size(); ++i) {
+				if (chromTypes[i] == CHROMOSOME_Y) {
+					if (sex == FEMALE)
+						continue;
+					else
+						++end_idx;
+				} else if (chromTypes[i] == CHROMOSOME_X && sex == MALE)
+					++end_idx;
+				else if (chromTypes[i] == MITOCHONDRIAL)
+					++end_idx;
+				else
+					end_idx += ply;
+				if (key.size() != end_idx - begin_idx) {
+					ok = false;
+					break;
+				}
+				if (ply == 2) {
+					if ((alleles[begin_idx] != key[0] || alleles[end_idx - 1] != key[1]) &&
+					    (alleles[begin_idx] != key[1] || alleles[end_idx - 1] != key[0])) {
+						ok = false;
+						break;
+					}
+				} else {
+					std::sort(alleles.begin() + begin_idx, alleles.begin() + end_idx);
+					tupleDict::key_type sorted_key = it->first;
+					std::sort(sorted_key.begin(), sorted_key.end());
+					for (size_t j = 0; j < sorted_key.size(); ++j) {
+						if (alleles[ply * i + j] != sorted_key[j]) {
+							ok = false;
+							break;
+						}
+					}
+				}
+				begin_idx = end_idx;
+			}
+			if (ok) {
+				value = it->second;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+
+// alleles smaller than this are tested against a table instead of searched
+// in the list of wildtype alleles
+#define WILDTYPE_TABLE_SIZE 256
+
+WildtypeGenoIndex::WildtypeGenoIndex(const vectoru & wildtype) :
+	m_wildtype(wildtype), m_isWildtype(WILDTYPE_TABLE_SIZE, 0)
+{
+	for (size_t i = 0; i < m_wildtype.size(); ++i)
+		if (m_wildtype[i] < m_isWildtype.size())
+			m_isWildtype[m_wildtype[i]] = 1;
+}
+
+
+size_t WildtypeGenoIndex::index(const Individual & ind, const vectoru & loci) const
+{
+	size_t index = 0;
+	GenoIterator geno = ind.genoBegin();
+	size_t totNumLoci = ind.totNumLoci();
+
+	for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc) {
+		if (ind.ploidy() == 1)
+			index = index * 2 + !isWildtype(ALLELE_AS_UNSINGED(DEREF_ALLELE(geno + *loc)));
+		else
+			index = index * 3 + 2 - isWildtype(ALLELE_AS_UNSINGED(DEREF_ALLELE(geno + *loc)))
+			        - isWildtype(ALLELE_AS_UNSINGED(DEREF_ALLELE(geno + *loc + totNumLoci)));
+	}
+	return index;
+}
+
+
+void WildtypeGenoIndex::index(const vector<RawIndIterator> & inds, size_t first, size_t last,
+                              const vectoru & loci, vectoru & indexes) const
+{
+	size_t n = last - first;
+
+	indexes.assign(n, 0);
+	if (n == 0)
+		return;
+
+	// individuals in a batch share the same genotypic structure
+	size_t ply = inds[first]->ploidy();
+	size_t totNumLoci = inds[first]->totNumLoci();
+	vector<GenoIterator> genos(n);
+	for (size_t i = 0; i < n; ++i)
+		genos[i] = inds[first + i]->genoBegin();
+
+	for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc) {
+		size_t p0 = *loc;
+		size_t p1 = *loc + totNumLoci;
+		if (ply == 1) {
+			for (size_t i = 0; i < n; ++i)
+				indexes[i] = indexes[i] * 2 + !isWildtype(ALLELE_AS_UNSINGED(DEREF_ALLELE(genos[i] + p0)));
+		} else {
+			for (size_t i = 0; i < n; ++i)
+				indexes[i] = indexes[i] * 3 + 2 - isWildtype(ALLELE_AS_UNSINGED(DEREF_ALLELE(genos[i] + p0)))
+				             - isWildtype(ALLELE_AS_UNSINGED(DEREF_ALLELE(genos[i] + p1)));
+		}
+	}
+}
+
+
 vectori Pause::s_cachedKeys = vectori();
 
 string Pause::describe(bool /* format */) const
@@ -472,6 +811,23 @@ string IfElse::describe(bool format) const
 }
 
 
+bool IfElse::dependsOnReplicateOrder() const
+{
+	opList::const_iterator it = m_ifOps.begin();
+	opList::const_iterator itEnd = m_ifOps.end();
+
+	for (; it != itEnd; ++it)
+		if ((*it)->dependsOnReplicateOrder())
+			return true;
+	it = m_elseOps.begin();
+	itEnd = m_elseOps.end();
+	for (; it != itEnd; ++it)
+		if ((*it)->dependsOnReplicateOrder())
+			return true;
+	return false;
+}
+
+
 bool IfElse::applyDuringMating(Population & pop, Population & offPop, RawIndIterator offspring,
                                Individual * dad, Individual * mom) const
 {
@@ -48,6 +48,14 @@ using std::string;
 #include "individual.h"
 #include "population.h"
 
+#if TR1_SUPPORT == 0
+#  include <map>
+#elif TR1_SUPPORT == 1
+#  include <unordered_map>
+#else
+#  include <tr1/unordered_map>
+#endif
+
 namespace simuPOP {
 
 /** Operators are objects that act on populations. They can be applied to
@@ -302,6 +310,31 @@ public:
 	}
 
 
+	/** CPPONLY
+	 *  Return \c True if the operator does not call any Python function, does
+	 *  not write to an output stream, and does not change states shared by
+	 *  replicates, so that clones of the operator can be applied to replicates
+	 *  evolved in parallel without holding the Python GIL.
+	 */
+	virtual bool canApplyConcurrently() const
+	{
+		return false;
+	}
+
+
+	/** CPPONLY
+	 *  Return \c True if the result of the operator depends on the order at
+	 *  which replicates are evolved, for example if it assigns IDs from a
+	 *  counter that is shared by replicates, or stops or reverts the
+	 *  evolution of all replicates. Replicates can not be evolved in
+	 *  parallel by such operators.
+	 */
+	virtual bool dependsOnReplicateOrder() const
+	{
+		return false;
+	}
+
+
 	/// CPPONLY
 	virtual void initialize(const Individual & ind) const
 	{
@@ -424,6 +457,152 @@ protected:
 	vectorop m_elems;
 };
 
+
+/** CPPONLY
+ *  A cache of values returned by a user-defined Python function that is
+ *  called with genotype of individuals at specified loci, and optionally
+ *  values at information fields and generation number. Values are cached by
+ *  sex, genotype and values of information fields of individuals so that the
+ *  function is called only once for each distinct genotype. Cached values are
+ *  discarded if loci change, or if generation number changes and the function
+ *  accepts parameter \c gen.
+ */
+class GenoValueCache
+{
+public:
+	GenoValueCache(const pyFunc & func, bool enabled);
+
+	bool enabled() const
+	{
+		return m_enabled;
+	}
+
+
+	/// return cached values for individual \e ind, NULL if not cached
+	const vectorf * find(const Individual & ind, const vectoru & loci, size_t gen);
+
+	/// cache values for the individual passed to the last call of find
+	void insert(const vectorf & values);
+
+	/// discard cached values, and reset hit and miss counters if \e stats is true
+	void clear(bool stats = false);
+
+	/// number of hits and misses
+	vectoru stats() const;
+
+private:
+	bool m_enabled;
+
+	bool m_useGen;
+
+	/// information fields passed to the function
+	vectorstr m_infoFields;
+
+	vectoru m_loci;
+
+	size_t m_gen;
+
+	/// key of the last individual passed to find
+	string m_key;
+
+#if TR1_SUPPORT == 0
+	typedef std::map<string, vectorf> ValueMap;
+#else
+	typedef std::tr1::unordered_map<string, vectorf> ValueMap;
+#endif
+	ValueMap m_values;
+
+	size_t m_hits;
+
+	size_t m_misses;
+};
+
+
+/** CPPONLY
+ *  A dictionary with genotypes at specified loci as keys. Genotypes of
+ *  individuals are looked up in the dictionary, and again without phase
+ *  information if they cannot be found. If the number of possible genotypes
+ *  is small, the dictionary can be expanded into a dense table of values
+ *  of all genotypes, indexed directly by alleles of individuals.
+ */
+class GenoValueTable
+{
+public:
+	/// \e name is the type of values used in error messages
+	GenoValueTable(const tupleDict & dict, const string & name);
+
+	/** expand the dictionary for individuals with genotypic structure
+	 *  \e geno and genotypes at \e loci, if the table is not too large.
+	 */
+	void compile(const GenoStruTrait & geno, const vectoru & loci) const;
+
+	/** return the value for genotype of \e ind at \e loci. A \c ValueError
+	 *  will be raised if the genotype cannot be found in the dictionary.
+	 */
+	double value(const Individual & ind, const vectoru & loci) const;
+
+private:
+	/// look up \e alleles in the dictionary, return false if not found
+	bool lookup(vectori & alleles, const vectoru & chromTypes, Sex sex, size_t ply, double & value) const;
+
+	const tupleDict m_dict;
+
+	const string m_name;
+
+	/// largest allele in the dictionary plus one
+	size_t m_numAlleles;
+
+	/// genotypic structure and loci for which the table is compiled
+	mutable TraitIndexType m_genoStru;
+
+	mutable vectoru m_loci;
+
+	/// positions of alleles in the genotype of males and females
+	mutable vectoru m_alleleIdx[2];
+
+	/// values of all genotypes of males and females, NaN if a genotype is
+	/// not in the dictionary, empty if the table is too large
+	mutable vectorf m_values[2];
+};
+
+
+/** CPPONLY
+ *  Index of genotypes at specified loci in a table of values of all
+ *  combinations of wildtype and non-wildtype alleles, ordered as \c A, \c a
+ *  for each locus of haploid, and \c AA, \c Aa, \c aa for each locus of
+ *  diploid individuals. Indexes of a batch of individuals are calculated
+ *  locus by locus so that the inner loop runs over individuals.
+ */
+class WildtypeGenoIndex
+{
+public:
+	WildtypeGenoIndex(const vectoru & wildtype);
+
+	/// return the index of genotype of \e ind at \e loci
+	size_t index(const Individual & ind, const vectoru & loci) const;
+
+	/** calculate indexes of genotypes of individuals <tt>inds[first:last]</tt>
+	 *  at \e loci, \e indexes will be resized to <tt>last - first</tt>.
+	 */
+	void index(const vector<RawIndIterator> & inds, size_t first, size_t last,
+		const vectoru & loci, vectoru & indexes) const;
+
+private:
+	bool isWildtype(size_t allele) const
+	{
+		if (allele < m_isWildtype.size())
+			return m_isWildtype[allele] != 0;
+		return find(m_wildtype.begin(), m_wildtype.end(), allele) != m_wildtype.end();
+	}
+
+
+	const vectoru m_wildtype;
+
+	/// whether or not small alleles are wildtype, to avoid searching m_wildtype
+	vector<unsigned char> m_isWildtype;
+};
+
+
 /** This operator pauses the evolution of a simulator at given generations or
  *  at a key stroke. When a simulator is stopped, you can go to a Python
  *  shell to examine the status of an evolutionary process, resume or stop the
@@ -484,6 +663,13 @@ public:
 	/// HIDDEN
 	string describe(bool format = true) const;
 
+	/// CPPONLY
+	bool dependsOnReplicateOrder() const
+	{
+		return true;
+	}
+
+
 private:
 	const bool m_prompt;
 
@@ -608,6 +794,9 @@ public:
 	/// HIDDEN
 	string describe(bool format = true) const;
 
+	/// CPPONLY
+	bool dependsOnReplicateOrder() const;
+
 private:
 	/// These will be kept constant (they are set in constructor only)
 	Expression m_cond;
@@ -663,6 +852,13 @@ public:
 	/// HIDDEN check all alleles in vector allele if they are fixed.
 	bool apply(Population & pop) const;
 
+	/// CPPONLY
+	bool dependsOnReplicateOrder() const
+	{
+		return m_stopAll;
+	}
+
+
 	virtual ~TerminateIf()
 	{
 	}
@@ -720,6 +916,13 @@ public:
 	/// HIDDEN check all alleles in vector allele if they are fixed.
 	bool apply(Population & pop) const;
 
+	/// CPPONLY
+	bool dependsOnReplicateOrder() const
+	{
+		return true;
+	}
+
+
 	virtual ~RevertIf()
 	{
 	}
@@ -875,6 +1078,13 @@ public:
 	}
 
 
+	/// CPPONLY
+	bool dependsOnReplicateOrder() const
+	{
+		return m_stopAfter != 0;
+	}
+
+
 private:
 	const double m_stopAfter;
 	mutable time_t m_startTime;
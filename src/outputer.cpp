@@ -24,6 +24,11 @@
  */
 #include "outputer.h"
 
+#include <fstream>
+#include <sstream>
+using std::ofstream;
+using std::ostringstream;
+
 namespace simuPOP {
 
 bool PyOutput::apply(Population & pop) const
@@ -169,7 +174,8 @@ bool Dumper::apply(Population & pop) const
 
 string SavePopulation::describe(bool /* format */) const
 {
-	return "<simuPOP.SavePopulation> save population to file " + m_filename;
+	return "<simuPOP.SavePopulation> save population to file " + m_filename
+	       + (m_binary ? " in binary format" : "");
 }
 
 
@@ -188,9 +194,380 @@ bool SavePopulation::apply(Population & pop) const
 		filename = filenameParser.valueAsString();
 	}
 	DBG_DO(DBG_POPULATION, cerr << "Save to file " << filename << endl);
-	pop.save(filename);
+	pop.save(filename, m_binary, m_compress);
+	return true;
+}
+
+
+
+ExportGenotype::ExportGenotype(const stringFunc & output, const string & format,
+	const lociList & loci, const string & idField,
+	int begin, int end, int step, const intList & at,
+	const intList & reps, const subPopList & subPops,
+	const stringList & infoFields) :
+	BaseOperator("", begin, end, step, at, reps, subPops, infoFields),
+	m_filename(output.value()), m_format(format), m_loci(loci), m_idField(idField)
+{
+	DBG_WARNIF(output.empty(), "An empty output string is passed to operator ExportGenotype. No file will be saved.");
+	for (size_t i = 0; i < m_format.size(); ++i)
+		m_format[i] = static_cast<char>(toupper(m_format[i]));
+	DBG_FAILIF(m_format != "PLINK" && m_format != "VCF", ValueError,
+		"Only PLINK and VCF formats are supported by operator ExportGenotype.");
+}
+
+
+string ExportGenotype::describe(bool /* format */) const
+{
+	return "<simuPOP.ExportGenotype> export genotypes to " + m_filename + " in " + m_format + " format";
+}
+
+
+bool ExportGenotype::apply(Population & pop) const
+{
+	if (m_filename.empty())
+		return true;
+
+	string filename;
+
+	if (m_filename[0] != '!')
+		filename = m_filename;
+	else {
+		Expression filenameParser(m_filename.substr(1));
+		filenameParser.setLocalDict(pop.dict());
+		filename = filenameParser.valueAsString();
+	}
+
+	vector<const Individual *> inds;
+	subPopList subPops = applicableSubPops(pop);
+	subPopList::const_iterator sp = subPops.begin();
+	subPopList::const_iterator spEnd = subPops.end();
+	for (; sp != spEnd; ++sp) {
+		pop.activateVirtualSubPop(*sp);
+		IndIterator ind = pop.indIterator(sp->subPop());
+		for (; ind.valid(); ++ind)
+			inds.push_back(&*ind);
+		pop.deactivateVirtualSubPop(sp->subPop());
+	}
+
+	const vectoru & loci = m_loci.elems(&pop);
+	DBG_DO(DBG_POPULATION, cerr << "Export " << inds.size() << " individuals at "
+		                        << loci.size() << " loci to " << filename << endl);
+	if (m_format == "PLINK")
+		exportPlink(pop, inds, loci, filename);
+	else
+		exportVCF(pop, inds, loci, filename);
 	return true;
 }
 
 
+string ExportGenotype::indName(const Individual & ind, size_t idx, int idIdx) const
+{
+	if (idIdx < 0)
+		return (boost::format("%1%") % (idx + 1)).str();
+	ostringstream name;
+	name << std::setprecision(15) << ind.info(idIdx);
+	return name.str();
+}
+
+
+/* Fill \e copies with the homologous copies of an individual that carry
+ * alleles on a chromosome of type \e chromType, and return the number of
+ * such copies. Unused copies of sex chromosomes, and the second copy of
+ * haplodiploid males, are left out.
+ */
+static size_t usedCopies(const Population & pop, size_t chromType,
+                         const Individual & ind, vectoru & copies)
+{
+	switch (chromType) {
+	case CHROMOSOME_X:
+		copies[0] = 0;
+		if (ind.sex() == MALE)
+			return 1;
+		copies[1] = 1;
+		return 2;
+	case CHROMOSOME_Y:
+		copies[0] = 1;
+		return ind.sex() == MALE ? 1 : 0;
+	case MITOCHONDRIAL:
+		copies[0] = 0;
+		return 1;
+	default:
+		if (pop.isHaplodiploid() && ind.sex() == MALE) {
+			copies[0] = 0;
+			return 1;
+		}
+		for (size_t p = 0; p < pop.ploidy(); ++p)
+			copies[p] = p;
+		return pop.ploidy();
+	}
+}
+
+
+/* Name of a chromosome in PLINK and VCF files, which defaults to its
+ * 1-based index, or the conventional names of sex and mitochondrial
+ * chromosomes.
+ */
+static string exportedChromName(const Population & pop, size_t chrom)
+{
+	string name = pop.chromName(chrom);
+
+	if (!name.empty())
+		return name;
+	switch (pop.chromType(chrom)) {
+	case CHROMOSOME_X:
+		return "X";
+	case CHROMOSOME_Y:
+		return "Y";
+	case MITOCHONDRIAL:
+		return "MT";
+	default:
+		return (boost::format("%1%") % (chrom + 1)).str();
+	}
+}
+
+
+/* Position of a locus in PLINK and VCF files, which is written as an
+ * integer so that large base-pair positions are not written in scientific
+ * notation. Positions less than \e minPos are not allowed.
+ */
+static unsigned long exportedLocusPos(const Population & pop, size_t loc, double minPos)
+{
+	double pos = pop.locusPos(loc);
+
+	if (pos < minPos)
+		throw ValueError((boost::format("Position %1% of locus %2% is less than %3%, which is not allowed "
+			                            "for the exported format.") % pos % loc % minPos).str());
+	return static_cast<unsigned long>(pos);
+}
+
+
+/* Number of loci encoded at a time, which limits the memory used for
+ * encoded genotypes to about 16M regardless of the number of loci.
+ */
+static size_t exportChunkSize(size_t bytesPerLocus)
+{
+	return std::max<size_t>(1, (1UL << 24) / std::max<size_t>(1, bytesPerLocus));
+}
+
+
+void ExportGenotype::exportPlink(const Population & pop, const vector<const Individual *> & inds,
+                                 const vectoru & loci, const string & prefix) const
+{
+	DBG_FAILIF(pop.ploidy() > 2, ValueError,
+		"PLINK format only supports haploid and diploid populations.");
+
+	int idIdx = pop.hasInfoField(m_idField) ? static_cast<int>(pop.infoIdx(m_idField)) : -1;
+	int fatherIdx = pop.hasInfoField("father_id") ? static_cast<int>(pop.infoIdx("father_id")) : -1;
+	int motherIdx = pop.hasInfoField("mother_id") ? static_cast<int>(pop.infoIdx("mother_id")) : -1;
+
+	// check positions before any file is written
+	for (size_t i = 0; i < loci.size(); ++i)
+		exportedLocusPos(pop, loci[i], 0);
+
+	// individuals
+	ofstream fam((prefix + ".fam").c_str());
+	if (!fam)
+		throw ValueError("Can not open file " + prefix + ".fam");
+	for (size_t i = 0; i < inds.size(); ++i) {
+		const Individual & ind = *inds[i];
+		fam << (i + 1) << ' ' << indName(ind, i, idIdx)
+		    << ' ' << (fatherIdx < 0 ? string("0") : indName(ind, i, fatherIdx))
+		    << ' ' << (motherIdx < 0 ? string("0") : indName(ind, i, motherIdx))
+		    << ' ' << (ind.sex() == MALE ? 1 : 2)
+		    << ' ' << (ind.affected() ? 2 : 1) << '\n';
+	}
+	fam.close();
+
+	// loci
+	ofstream bim((prefix + ".bim").c_str());
+	if (!bim)
+		throw ValueError("Can not open file " + prefix + ".bim");
+	for (size_t i = 0; i < loci.size(); ++i) {
+		size_t loc = loci[i];
+		string name = pop.locusName(loc);
+		bim << exportedChromName(pop, pop.chromLocusPair(loc).first)
+		    << '\t' << (name.empty() ? string(".") : name)
+		    << "\t0\t" << exportedLocusPos(pop, loc, 0)
+		    << '\t' << pop.alleleName(1, loc) << '\t' << pop.alleleName(0, loc) << '\n';
+	}
+	bim.close();
+
+	// genotypes, in SNP-major mode, with four individuals per byte
+	ofstream bed((prefix + ".bed").c_str(), std::ios::binary);
+	if (!bed)
+		throw ValueError("Can not open file " + prefix + ".bed");
+	const char magic[3] = { 0x6c, 0x1b, 0x01 };
+	bed.write(magic, 3);
+
+	size_t bytesPerLocus = (inds.size() + 3) / 4;
+	size_t chunk = exportChunkSize(bytesPerLocus);
+	vector<unsigned char> buf(std::min(chunk, loci.size()) * bytesPerLocus);
+	// there is nothing but the magic number to write if there is no
+	// individual or locus
+	for (size_t start = 0; !buf.empty() && start < loci.size(); start += chunk) {
+		size_t nLoci = std::min(chunk, loci.size() - start);
+		std::fill(buf.begin(), buf.begin() + nLoci * bytesPerLocus, 0);
+#pragma omp parallel for if(numThreads() > 1) schedule(dynamic)
+		for (ssize_t r = 0; r < static_cast<ssize_t>(nLoci); ++r) {
+			size_t loc = loci[start + r];
+			size_t chromType = pop.chromType(pop.chromLocusPair(loc).first);
+			unsigned char * row = buf.data() + r * bytesPerLocus;
+			vectoru copies(pop.ploidy());
+			for (size_t i = 0; i < inds.size(); ++i) {
+				size_t nCopies = usedCopies(pop, chromType, *inds[i], copies);
+				// 00: homozygous first allele, 10: heterozygous,
+				// 11: homozygous second allele, 01: missing
+				unsigned char code = 1;
+				if (nCopies > 0) {
+					size_t cnt = 0;
+					for (size_t p = 0; p < nCopies; ++p)
+						if (DEREF_ALLELE(inds[i]->genoBegin(copies[p]) + loc) != 0)
+							++cnt;
+					code = cnt == 0 ? 3 : (cnt == nCopies ? 0 : 2);
+				}
+				row[i / 4] |= static_cast<unsigned char>(code << (2 * (i % 4)));
+			}
+		}
+		bed.write(reinterpret_cast<const char *>(buf.data()), nLoci * bytesPerLocus);
+	}
+	bed.close();
+}
+
+
+/* Return true if \e name is a valid REF or ALT allele in VCF, namely a
+ * non-empty sequence of bases A, C, G, T and N.
+ */
+static bool isVCFBases(const string & name)
+{
+	if (name.empty())
+		return false;
+	for (size_t i = 0; i < name.size(); ++i)
+		if (strchr("ACGTNacgtn", name[i]) == NULL)
+			return false;
+	return true;
+}
+
+
+void ExportGenotype::exportVCF(const Population & pop, const vector<const Individual *> & inds,
+                               const vectoru & loci, const string & filename) const
+{
+	// VCF positions are 1-based, and are checked before the file is written
+	for (size_t i = 0; i < loci.size(); ++i)
+		exportedLocusPos(pop, loci[i], 1);
+
+	ofstream vcf(filename.c_str());
+
+	if (!vcf)
+		throw ValueError("Can not open file " + filename);
+
+	int idIdx = pop.hasInfoField(m_idField) ? static_cast<int>(pop.infoIdx(m_idField)) : -1;
+
+	// largest allele at each locus, which determines ALT alleles
+	vectoru maxAllele(loci.size());
+#pragma omp parallel for if(numThreads() > 1) schedule(dynamic)
+	for (ssize_t r = 0; r < static_cast<ssize_t>(loci.size()); ++r) {
+		size_t loc = loci[r];
+		size_t chromType = pop.chromType(pop.chromLocusPair(loc).first);
+		vectoru copies(pop.ploidy());
+		size_t maxA = 0;
+		for (size_t i = 0; i < inds.size(); ++i) {
+			size_t nCopies = usedCopies(pop, chromType, *inds[i], copies);
+			for (size_t p = 0; p < nCopies; ++p)
+				maxA = std::max<size_t>(maxA, DEREF_ALLELE(inds[i]->genoBegin(copies[p]) + loc));
+		}
+		maxAllele[r] = maxA;
+	}
+	// Alleles are written by their names only if all of them are distinct
+	// sequences of bases. Otherwise, the reference allele is written as N and
+	// alternative alleles are written as symbolic alleles <A1>, <A2>, ...
+	// (alleleName is not thread safe)
+	vector<bool> symbolic(loci.size(), false);
+	size_t maxSymbolic = 0;
+	for (size_t r = 0; r < loci.size(); ++r) {
+		vectorstr names(maxAllele[r] + 1);
+		for (size_t a = 0; a <= maxAllele[r] && !symbolic[r]; ++a) {
+			names[a] = pop.alleleName(a, loci[r]);
+			symbolic[r] = !isVCFBases(names[a])
+			              || std::find(names.begin(), names.begin() + a, names[a]) != names.begin() + a;
+		}
+		if (symbolic[r])
+			maxSymbolic = std::max(maxSymbolic, maxAllele[r]);
+	}
+
+	vcf << "##fileformat=VCFv4.2\n##source=simuPOP\n";
+	vector<bool> usedChrom(pop.numChrom(), false);
+	for (size_t i = 0; i < loci.size(); ++i)
+		usedChrom[pop.chromLocusPair(loci[i]).first] = true;
+	for (size_t ch = 0; ch < pop.numChrom(); ++ch)
+		if (usedChrom[ch])
+			vcf << "##contig=<ID=" << exportedChromName(pop, ch) << ">\n";
+	for (size_t a = 1; a <= maxSymbolic; ++a)
+		vcf << "##ALT=<ID=A" << a << ",Description=\"Allele " << a << "\">\n";
+	vcf << "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\">\n";
+	vcf << "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT";
+	for (size_t i = 0; i < inds.size(); ++i)
+		vcf << '\t' << indName(*inds[i], i, idIdx);
+	vcf << '\n';
+
+	size_t chunk = exportChunkSize(inds.size() * 2 * (pop.ploidy() + 1));
+	vector<string> rows(std::min(chunk, loci.size()));
+	for (size_t start = 0; start < loci.size(); start += chunk) {
+		size_t nLoci = std::min(chunk, loci.size() - start);
+		// the leading columns are formatted sequentially
+		for (size_t r = 0; r < nLoci; ++r) {
+			size_t loc = loci[start + r];
+			size_t maxA = maxAllele[start + r];
+			bool sym = symbolic[start + r];
+			string name = pop.locusName(loc);
+			ostringstream row;
+			row << exportedChromName(pop, pop.chromLocusPair(loc).first)
+			    << '\t' << exportedLocusPos(pop, loc, 1)
+			    << '\t' << (name.empty() ? string(".") : name)
+			    << '\t' << (sym ? string("N") : pop.alleleName(0, loc)) << '\t';
+			if (maxA == 0)
+				row << '.';
+			for (size_t a = 1; a <= maxA; ++a) {
+				if (a > 1)
+					row << ',';
+				if (sym)
+					row << "<A" << a << '>';
+				else
+					row << pop.alleleName(a, loc);
+			}
+			row << "\t.\tPASS\t.\tGT";
+			rows[r] = row.str();
+		}
+#pragma omp parallel for if(numThreads() > 1) schedule(dynamic)
+		for (ssize_t r = 0; r < static_cast<ssize_t>(nLoci); ++r) {
+			size_t loc = loci[start + r];
+			size_t chromType = pop.chromType(pop.chromLocusPair(loc).first);
+			vectoru copies(pop.ploidy());
+			string & row = rows[r];
+			row.reserve(row.size() + inds.size() * 2 * (pop.ploidy() + 1) + 1);
+			for (size_t i = 0; i < inds.size(); ++i) {
+				size_t nCopies = usedCopies(pop, chromType, *inds[i], copies);
+				row += '\t';
+				if (nCopies == 0)
+					row += '.';
+				for (size_t p = 0; p < nCopies; ++p) {
+					if (p > 0)
+						row += '|';
+					size_t allele = DEREF_ALLELE(inds[i]->genoBegin(copies[p]) + loc);
+					if (allele < 10)
+						row += static_cast<char>('0' + allele);
+					else
+						row += (boost::format("%1%") % allele).str();
+				}
+			}
+			row += '\n';
+		}
+		for (size_t r = 0; r < nLoci; ++r) {
+			vcf << rows[r];
+			string().swap(rows[r]);
+		}
+	}
+	vcf.close();
+}
+
+
 }
@@ -178,15 +178,19 @@ public:
 	 *  specifications (\c '', \c 'filename', \c 'filename' prefixed by one
 	 *  or more '>' characters, and \c '!expr') but output from different
 	 *  operators will always replace existing files (effectively ignore
-	 *  '>' specification). Parameter \e subPops is ignored. Please refer to
-	 *  class \c BaseOperator for a detailed description about common operator
-	 *  parameters such as \e stage and \e begin.
+	 *  '>' specification). If \e binary is set to \c True, the population
+	 *  is saved in a binary format that can be loaded much faster, with
+	 *  data sections compressed if \e compress is \c True (see
+	 *  \c Population.save for details). Parameter \e subPops is ignored.
+	 *  Please refer to class \c BaseOperator for a detailed description
+	 *  about common operator parameters such as \e stage and \e begin.
 	 */
 	SavePopulation(const stringFunc & output = "", int begin = 0, int end = -1,
 		int step = 1, const intList & at = vectori(), const intList & reps = intList(),
-		const subPopList & subPops = subPopList(), const stringList & infoFields = vectorstr()) :
+		const subPopList & subPops = subPopList(), const stringList & infoFields = vectorstr(),
+		bool binary = false, bool compress = false) :
 		BaseOperator("", begin, end, step, at, reps, subPops, infoFields),
-		m_filename(output.value())
+		m_filename(output.value()), m_binary(binary), m_compress(compress)
 	{
 		DBG_WARNIF(output.empty(), "An empty output string is passed to operator SavePopulation. No file will be saved.");
 	}
@@ -214,6 +218,93 @@ public:
 private:
 	/// filename,
 	const string m_filename;
+
+	/// save in the binary format
+	const bool m_binary;
+
+	/// compress data sections of the binary format
+	const bool m_compress;
+};
+
+
+/** An operator that exports genotypes of a population directly from its
+ *  genotype storage, which is much faster than exporters in module
+ *  \c simuPOP.utils that format individuals in Python.
+ */
+class ExportGenotype : public BaseOperator
+{
+public:
+	/** Create an operator that exports genotypes at \e loci (default to all
+	 *  loci) of individuals in (virtual) subpopulations \e subPops (default
+	 *  to all individuals) of the present generation in \e format. If
+	 *  \e format is \c 'PLINK', individuals and loci are written to
+	 *  \e output.fam and \e output.bim, and genotypes are written to
+	 *  \e output.bed in the SNP-major binary format of PLINK. Because this
+	 *  format only supports bi-allelic loci, allele 0 is exported as the
+	 *  second allele and all other alleles are exported as the first allele.
+	 *  If \e format is \c 'VCF', phased genotypes are written to \e output in
+	 *  Variant Call Format, with allele 0 as reference allele. Names of
+	 *  chromosomes and loci are used if they are available. Names of alleles
+	 *  are used as \c REF and \c ALT alleles if they are distinct sequences
+	 *  of bases (\c A, \c C, \c G, \c T and \c N). Otherwise, \c N is
+	 *  written as the reference allele and alleles \c 1, \c 2, ... are
+	 *  written as symbolic alleles \c <A1>, \c <A2>, ... Locus positions
+	 *  are written as integers, and should be at least 1 for \c VCF. Alleles
+	 *  on unused copies of sex chromosomes are exported as missing (\c PLINK)
+	 *  or haploid (\c VCF) genotypes. Individuals are identified by values
+	 *  at information field \e idField if it exists, and by their 1-based
+	 *  indexes otherwise. Genotypes are encoded in parallel in chunks of loci
+	 *  so the memory used does not grow with the number of loci. Parameter
+	 *  \e output can be a filename (or a prefix for format \c 'PLINK') or an
+	 *  expression prefixed by \c '!' that is evaluated in the local namespace
+	 *  of the population. Please refer to class \c BaseOperator for a detailed
+	 *  description about common operator parameters such as \e begin.
+	 */
+	ExportGenotype(const stringFunc & output = "", const string & format = "PLINK",
+		const lociList & loci = lociList(), const string & idField = "ind_id",
+		int begin = 0, int end = -1, int step = 1, const intList & at = vectori(),
+		const intList & reps = intList(), const subPopList & subPops = subPopList(),
+		const stringList & infoFields = vectorstr());
+
+	/// destructor.
+	~ExportGenotype()
+	{
+	}
+
+
+	/// HIDDEN Deep copy of an ExportGenotype operator.
+	virtual BaseOperator * clone() const
+	{
+		return new ExportGenotype(*this);
+	}
+
+
+	/// HIDDEN apply operator to population \e pop.
+	virtual bool apply(Population & pop) const;
+
+	/// HIDDEN
+	string describe(bool format = true) const;
+
+private:
+	void exportPlink(const Population & pop, const vector<const Individual *> & inds,
+		const vectoru & loci, const string & prefix) const;
+
+	void exportVCF(const Population & pop, const vector<const Individual *> & inds,
+		const vectoru & loci, const string & filename) const;
+
+	/// ID of individual \e idx in \e inds
+	string indName(const Individual & ind, size_t idx, int idIdx) const;
+
+private:
+	/// filename or prefix
+	const string m_filename;
+
+	/// PLINK or VCF
+	string m_format;
+
+	const lociList m_loci;
+
+	const string m_idField;
 };
 
 }
@@ -32,6 +32,90 @@ using std::ofstream;
 
 namespace simuPOP {
 
+// compress (key, individual) pairs into keys and offsets of their
+// individuals, with individuals of each key in their original order.
+template <typename KEY>
+static void buildCSR(vector<std::pair<KEY, size_t> > & pairs, vector<KEY> & keys,
+                     vectoru & offset, vectoru & values)
+{
+	std::sort(pairs.begin(), pairs.end());
+	keys.clear();
+	offset.clear();
+	values.resize(pairs.size());
+	for (size_t i = 0; i < pairs.size(); ++i) {
+		if (i == 0 || pairs[i].first != pairs[i - 1].first) {
+			keys.push_back(pairs[i].first);
+			offset.push_back(i);
+		}
+		values[i] = pairs[i].second;
+	}
+	offset.push_back(pairs.size());
+}
+
+
+void OffspringGraph::build(bool couples)
+{
+	size_t size = m_inds.size();
+
+	vector<pairu> pairs(size);
+
+	for (size_t i = 0; i < size; ++i)
+		pairs[i] = pairu(m_ids[i], i);
+	buildCSR(pairs, m_groupIDs, m_groupOffset, m_groupMembers);
+	m_groups.resize(size);
+	for (size_t g = 0; g < m_groupIDs.size(); ++g)
+		for (size_t i = m_groupOffset[g]; i < m_groupOffset[g + 1]; ++i)
+			m_groups[m_groupMembers[i]] = g;
+
+	pairs.clear();
+	pairs.reserve(2 * size);
+	for (size_t i = 0; i < size; ++i) {
+		if (m_fathers[i])
+			pairs.push_back(pairu(m_fathers[i], i));
+		if (m_mothers[i])
+			pairs.push_back(pairu(m_mothers[i], i));
+	}
+	buildCSR(pairs, m_parentIDs, m_parentOffset, m_offspring);
+
+	m_couples.clear();
+	m_coupleOffset.assign(1, 0);
+	m_coupleOffspring.clear();
+	if (!couples)
+		return;
+	vector<std::pair<pairu, size_t> > couplePairs;
+	couplePairs.reserve(size);
+	for (size_t i = 0; i < size; ++i)
+		if (m_fathers[i] && m_mothers[i])
+			couplePairs.push_back(std::pair<pairu, size_t>(pairu(m_fathers[i], m_mothers[i]), i));
+	buildCSR(couplePairs, m_couples, m_coupleOffset, m_coupleOffspring);
+}
+
+
+size_t OffspringGraph::groupIndex(size_t id) const
+{
+	vectoru::const_iterator it = std::lower_bound(m_groupIDs.begin(), m_groupIDs.end(), id);
+
+	return it == m_groupIDs.end() || *it != id ? InvalidValue : static_cast<size_t>(it - m_groupIDs.begin());
+}
+
+
+size_t OffspringGraph::parentIndex(size_t id) const
+{
+	vectoru::const_iterator it = std::lower_bound(m_parentIDs.begin(), m_parentIDs.end(), id);
+
+	return it == m_parentIDs.end() || *it != id ? InvalidValue : static_cast<size_t>(it - m_parentIDs.begin());
+}
+
+
+size_t OffspringGraph::coupleIndex(size_t father, size_t mother) const
+{
+	pairu key(father, mother);
+	vector<pairu>::const_iterator it = std::lower_bound(m_couples.begin(), m_couples.end(), key);
+
+	return it == m_couples.end() || *it != key ? InvalidValue : static_cast<size_t>(it - m_couples.begin());
+}
+
+
 Pedigree::Pedigree(const Population & pop, const lociList & loci,
 	const stringList & infoFields, const uintList & ancGens, const string & idField,
 	const string & fatherField, const string & motherField, bool stealPop)
@@ -94,21 +178,59 @@ Pedigree::Pedigree(const Pedigree & rhs) :
 }
 
 
+void Pedigree::indexIDs() const
+{
+	// Indexes of IDs are built before relatives are looked up so that
+	// individuals can be looked up without changing the pedigree.
+	for (int depth = 0; depth <= ancestralGens(); ++depth)
+		buildIDIndex(depth, m_idIdx, true);
+}
+
+
 void Pedigree::buildIDMap()
 {
-	// build an ID map
-	m_idMap.clear();
-	for (int depth = ancestralGens(); depth >= 0; --depth) {
-		useAncestralGen(depth);
-		for (IndIterator it = indIterator(); it.valid(); ++it) {
-			size_t id = toID(it->info(m_idIdx));
-			DBG_WARNIF(m_idMap.find(id) != m_idMap.end() && *m_idMap[id] != *it,
-				(boost::format("Different individuals share the same ID %1%"
-					           " so only the latest Individual will be used. If this is an "
-					           "age-structured population, you may want to remove parental generations.") % id).str());
-			m_idMap[id] = &*it;
+	indexIDs();
+
+#ifndef OPTIMIZED
+	if (debug(DBG_WARNING)) {
+		for (int depth = ancestralGens(); depth >= 0; --depth) {
+			useAncestralGen(depth);
+			for (IndIterator it = indIterator(); it.valid(); ++it) {
+				size_t id = toID(it->info(m_idIdx));
+				Individual * ind = findByID(id);
+				DBG_WARNIF(ind != &*it && *ind != *it,
+					(boost::format("Different individuals share the same ID %1%"
+						           " so only the latest Individual will be used. If this is an "
+						           "age-structured population, you may want to remove parental generations.") % id).str());
+			}
+		}
+	}
+#endif
+	useAncestralGen(0);
+}
+
+
+void Pedigree::buildOffspringGraph(const vectoru & ancGens, bool markedOnly,
+                                   bool couples, OffspringGraph & graph)
+{
+	indexIDs();
+
+	size_t oldGen = curAncestralGen();
+	for (size_t genIdx = 0; genIdx < ancGens.size(); ++genIdx) {
+		useAncestralGen(ancGens[genIdx]);
+		RawIndIterator it = rawIndBegin();
+		RawIndIterator itEnd = rawIndEnd();
+		for (; it != itEnd; ++it) {
+			if (markedOnly && !it->marked())
+				continue;
+			double father = m_fatherIdx == -1 ? 0 : it->info(m_fatherIdx);
+			double mother = m_motherIdx == -1 ? 0 : it->info(m_motherIdx);
+			graph.addIndividual(&*it, toID(it->info(m_idIdx)),
+				father >= 1 ? toID(father) : 0, mother >= 1 ? toID(mother) : 0);
 		}
 	}
+	useAncestralGen(oldGen);
+	graph.build(couples);
 }
 
 
@@ -151,12 +273,12 @@ void Pedigree::save(const string & filename, const stringList & fieldList,
 			size_t motherID = 0;
 			if (m_fatherIdx != -1) {
 				fatherID = toID(it->info(m_fatherIdx));
-				if (fatherID && m_idMap.find(fatherID) == m_idMap.end())
+				if (fatherID && findByID(fatherID) == NULL)
 					fatherID = 0;
 			}
 			if (m_motherIdx != -1) {
 				motherID = toID(it->info(m_motherIdx));
-				if (motherID && m_idMap.find(motherID) == m_idMap.end())
+				if (motherID && findByID(motherID) == NULL)
 					motherID = 0;
 			}
 			char sexChar = it->sex() == MALE ? 'M' : 'F';
@@ -191,19 +313,12 @@ size_t Pedigree::numParents() const
 
 Individual & Pedigree::indByID(double fid) const
 {
-	// essentially m_idMap(toID(fid))
-	//
 	size_t id = toID(fid);
 
 	DBG_FAILIF(fabs(fid - id) > 1e-8, ValueError,
 		"individual ID has to be integer (or a double round to full iteger).");
 
-	IdMap::iterator it = m_idMap.find(id);
-	// if still cannot be found, raise an IndexError.
-	if (it == m_idMap.end())
-		throw IndexError((boost::format("No individual with ID %1% could be found.") % id).str());
-
-	return *it->second;
+	return indByID(id);
 }
 
 
@@ -376,6 +491,48 @@ void Pedigree::locateSpouse(SexChoice sexChoice, AffectionStatus affectionChoice
 }
 
 
+// add relative \e relID to the next unused field of \e ind unless all fields
+// are used or the relative is already recorded.
+static void addRelative(Individual & ind, size_t relID, const vectoru & fields, size_t & numRel)
+{
+	if (numRel >= fields.size())
+		return;
+	for (size_t s = 0; s < numRel; ++s)
+		if (ind.info(fields[s]) == relID)
+			return;
+	ind.setInfo(static_cast<double>(relID), fields[numRel]);
+	++numRel;
+}
+
+
+void Pedigree::addSiblings(Individual & ind, size_t id, const OffspringGraph & graph,
+                           vectoru::const_iterator begin, vectoru::const_iterator end,
+                           SexChoice sexChoice, AffectionStatus affectionChoice,
+                           const vectoru & siblingIdx, size_t & numSibling)
+{
+	// Siblings are added in the order they would be added if all pairs of
+	// siblings in the family were visited, namely siblings before the
+	// individual, then all siblings when the individual itself is visited.
+	for (vectoru::const_iterator i = begin; i != end; ++i) {
+		if (graph.id(*i) == id) {
+			for (vectoru::const_iterator j = begin; j != end; ++j) {
+				if (j == i)
+					continue;
+				Individual * sibling = findByID(graph.id(*j));
+				if (acceptableSex(ind.sex(), sibling->sex(), sexChoice) &&
+				    acceptableAffectionStatus(sibling->affected(), affectionChoice))
+					addRelative(ind, graph.id(*j), siblingIdx, numSibling);
+			}
+		} else {
+			Individual * sibling = findByID(graph.id(*i));
+			if (acceptableSex(ind.sex(), sibling->sex(), sexChoice) &&
+			    acceptableAffectionStatus(sibling->affected(), affectionChoice))
+				addRelative(ind, graph.id(*i), siblingIdx, numSibling);
+		}
+	}
+}
+
+
 void Pedigree::locateOffspring(SexChoice sexChoice, AffectionStatus affectionChoice, const vectorstr & resultFields, const vectoru & ancGens)
 {
 	DBG_ASSERT(resultFields.size() >= 1, ValueError,
@@ -397,42 +554,45 @@ void Pedigree::locateOffspring(SexChoice sexChoice, AffectionStatus affectionCho
 		}
 	}
 
-	// use individual ID
-	std::map<size_t, size_t> numOffspring;
-	for (unsigned genIdx = 0; genIdx < ancGens.size(); ++genIdx) {
-		useAncestralGen(ancGens[genIdx]);
-		for (size_t i = 0; i < popSize(); ++i) {
-			// everyone has one or two parents.
-			double p = individual(i).info(m_fatherIdx);
-			double m = individual(i).info(m_motherIdx);
-			if (p < 0 || m < 0)
+	OffspringGraph graph;
+	buildOffspringGraph(ancGens, false, false, graph);
+
+	// each parent only writes to its own fields
+#pragma omp parallel for if(numThreads() > 1) schedule(dynamic)
+	for (ssize_t p = 0; p < static_cast<ssize_t>(graph.numParents()); ++p) {
+		size_t parentID = graph.parentID(p);
+		Individual * parent = findByID(parentID);
+		if (parent == NULL)
+			continue;
+		size_t numOffspring = 0;
+		vectoru::const_iterator it = graph.offspringBegin(p);
+		vectoru::const_iterator itEnd = graph.offspringEnd(p);
+		for (; it != itEnd; ++it) {
+			// an offspring is listed twice if both parents share the same ID
+			if (it != graph.offspringBegin(p) && *it == *(it - 1))
 				continue;
-			try {
-				// but the parents might not exist
-				size_t pp = toID(p);
-				size_t mm = toID(m);
-				Individual & fa = indByID(pp);
-				Individual & ma = indByID(mm);
-				// add child as father's offspring
-				if (numOffspring[pp] < maxOffspring &&
-				    acceptableSex(MALE, individual(i).sex(), sexChoice) &&
-				    acceptableAffectionStatus(individual(i).affected(), affectionChoice)) {
-					fa.setInfo(individual(i).info(m_idIdx), offspringIdx[numOffspring[pp]]);
-					++numOffspring[pp];
-				}
-				// add child as mother's offspring
-				if (numOffspring[mm] < maxOffspring &&
-				    acceptableSex(FEMALE, individual(i).sex(), sexChoice) &&
-				    acceptableAffectionStatus(individual(i).affected(), affectionChoice)) {
-					ma.setInfo(individual(i).info(m_idIdx), offspringIdx[numOffspring[mm]]);
-					++numOffspring[mm];
-				}
-			} catch (...) {
-				// does not care if a parent cannot be found
+			size_t fatherID = graph.father(*it);
+			size_t motherID = graph.mother(*it);
+			// does not care if a parent cannot be found
+			if (fatherID == 0 || motherID == 0 || findByID(fatherID) == NULL || findByID(motherID) == NULL)
+				continue;
+			Individual & child = graph.individual(*it);
+			// add child as father's offspring
+			if (fatherID == parentID && numOffspring < maxOffspring &&
+			    acceptableSex(MALE, child.sex(), sexChoice) &&
+			    acceptableAffectionStatus(child.affected(), affectionChoice)) {
+				parent->setInfo(child.info(m_idIdx), offspringIdx[numOffspring]);
+				++numOffspring;
+			}
+			// add child as mother's offspring
+			if (motherID == parentID && numOffspring < maxOffspring &&
+			    acceptableSex(FEMALE, child.sex(), sexChoice) &&
+			    acceptableAffectionStatus(child.affected(), affectionChoice)) {
+				parent->setInfo(child.info(m_idIdx), offspringIdx[numOffspring]);
+				++numOffspring;
 			}
 		}
 	}
-
 }
 
 
@@ -455,76 +615,31 @@ void Pedigree::locateSibling(SexChoice sexChoice, AffectionStatus affectionChoic
 				it->setInfo(-1, siblingIdx[i]);
 	}
 
-	// find all single families
-	map<size_t, vectoru> families;
-	for (unsigned genIdx = 0; genIdx < ancGens.size(); ++genIdx) {
-		useAncestralGen(ancGens[genIdx]);
-		for (size_t i = 0; i < popSize(); ++i) {
-			double f = individual(i).info(m_fatherIdx);
-			double m = individual(i).info(m_motherIdx);
-			if (f >= 1)
-				families[toID(f)].push_back(toID(individual(i).info(m_idIdx)));
-			if (m >= 1)
-				families[toID(m)].push_back(toID(individual(i).info(m_idIdx)));
-		}
-	}
-	// look in each single-parent family
-	std::map<size_t, size_t> numSibling;
-	map<size_t, vectoru>::iterator it = families.begin();
-	map<size_t, vectoru>::iterator itEnd = families.end();
-	for (; it != itEnd; ++it) {
-		// these guys share at least one parent!
-		const vectoru & sibs = it->second;
-		if (sibs.size() <= 1)
-			continue;
-		for (size_t i = 0; i < sibs.size(); ++i) {
-			try {
-				Individual & child = indByID(sibs[i]);
-				for (size_t j = 0; j < sibs.size(); ++j) {
-					if (i == j)
-						continue;
-					try {
-						Individual & sibling = indByID(sibs[j]);
-
-						if (numSibling[sibs[i]] < maxSibling &&
-						    acceptableSex(child.sex(), sibling.sex(), sexChoice) &&
-						    acceptableAffectionStatus(sibling.affected(), affectionChoice)) {
-							bool valid = true;
-							// duplicate sibling
-							for (size_t s = 0; s < numSibling[sibs[i]]; ++s)
-								if (child.info(siblingIdx[s]) == sibs[j]) {
-									valid = false;
-									break;
-								}
-							if (valid) {
-								child.setInfo(static_cast<double>(sibs[j]), siblingIdx[numSibling[sibs[i]]]);
-								++numSibling[sibs[i]];
-							}
-						}
-						if (numSibling[sibs[j]] < maxSibling &&
-						    acceptableSex(sibling.sex(), child.sex(), sexChoice) &&
-						    acceptableAffectionStatus(child.affected(), affectionChoice)) {
-							bool valid = true;
-							// duplicate sibling
-							for (size_t s = 0; s < numSibling[sibs[j]]; ++s)
-								if (sibling.info(siblingIdx[s]) == sibs[i]) {
-									valid = false;
-									break;
-								}
-							if (valid) {
-								sibling.setInfo(static_cast<double>(sibs[i]), siblingIdx[numSibling[sibs[j]]]);
-								++numSibling[sibs[j]];
-							}
-						}
-						// idx
-					} catch (...) {
-						continue;
-					}
-				}
-			} catch (...) {
-				// if does not found, ignore this couple.
-			}
+	// single-parent families are offspring of each parent
+	OffspringGraph graph;
+	buildOffspringGraph(ancGens, false, false, graph);
+
+	// each individual only writes to its own fields
+#pragma omp parallel for if(numThreads() > 1) schedule(dynamic)
+	for (ssize_t g = 0; g < static_cast<ssize_t>(graph.numIDs()); ++g) {
+		size_t id = graph.groupID(g);
+		Individual * ind = findByID(id);
+		// families of this individual, in the order of parental IDs
+		vectoru families;
+		for (vectoru::const_iterator it = graph.groupBegin(g); it != graph.groupEnd(g); ++it) {
+			if (graph.father(*it))
+				families.push_back(graph.parentIndex(graph.father(*it)));
+			if (graph.mother(*it))
+				families.push_back(graph.parentIndex(graph.mother(*it)));
 		}
+		std::sort(families.begin(), families.end());
+		families.erase(std::unique(families.begin(), families.end()), families.end());
+
+		size_t numSibling = 0;
+		for (size_t f = 0; f < families.size(); ++f)
+			addSiblings(*ind, id, graph, graph.offspringBegin(families[f]),
+				graph.offspringEnd(families[f]), sexChoice, affectionChoice,
+				siblingIdx, numSibling);
 	}
 }
 
@@ -551,70 +666,28 @@ void Pedigree::locateFullSibling(SexChoice sexChoice, AffectionStatus affectionC
 				it->setInfo(-1, siblingIdx[i]);
 	}
 
-	// find all full families
-	typedef pairu couple;
-	map<couple, vectoru> families;
-	for (unsigned genIdx = 0; genIdx < ancGens.size(); ++genIdx) {
-		useAncestralGen(ancGens[genIdx]);
-		for (size_t i = 0; i < popSize(); ++i) {
-			double f = individual(i).info(m_fatherIdx);
-			double m = individual(i).info(m_motherIdx);
-			if (f >= 1 && m >= 1)
-				families[couple(toID(f), toID(m))].push_back(toID(individual(i).info(m_idIdx)));
-		}
-	}
-	// look in each single-parent family
-	std::map<size_t, size_t> numSibling;
-	map<couple, vectoru>::iterator it = families.begin();
-	map<couple, vectoru>::iterator itEnd = families.end();
-	for (; it != itEnd; ++it) {
-		// these guys share two parents....
-		const vectoru & sibs = it->second;
-		if (sibs.size() <= 1)
-			continue;
-		for (size_t i = 0; i < sibs.size(); ++i) {
-			try {
-				Individual & child = indByID(sibs[i]);
-				for (size_t j = 0; j < sibs.size(); ++j) {
-					if (i == j)
-						continue;
-					Individual & sibling = indByID(sibs[j]);
-
-					if (numSibling[sibs[i]] < maxSibling &&
-					    acceptableSex(child.sex(), sibling.sex(), sexChoice) &&
-					    acceptableAffectionStatus(sibling.affected(), affectionChoice)) {
-						bool valid = true;
-						// duplicat sibling
-						for (size_t s = 0; s < numSibling[sibs[i]]; ++s)
-							if (child.info(siblingIdx[s]) == sibs[j]) {
-								valid = false;
-								break;
-							}
-						if (valid) {
-							child.setInfo(static_cast<double>(sibs[j]), siblingIdx[numSibling[sibs[i]]]);
-							++numSibling[sibs[i]];
-						}
-					}
-					if (numSibling[sibs[j]] < maxSibling &&
-					    acceptableSex(sibling.sex(), child.sex(), sexChoice) &&
-					    acceptableAffectionStatus(child.affected(), affectionChoice)) {
-						bool valid = true;
-						// duplicate sibling
-						for (size_t s = 0; s < numSibling[sibs[j]]; ++s)
-							if (sibling.info(siblingIdx[s]) == sibs[i]) {
-								valid = false;
-								break;
-							}
-						if (valid) {
-							sibling.setInfo(static_cast<double>(sibs[i]), siblingIdx[numSibling[sibs[j]]]);
-							++numSibling[sibs[j]];
-						}
-					}                                                                                       // idx
-				}
-			} catch (...) {
-				// if does not found, ignore this couple.
-			}
-		}
+	// full families are offspring of each couple
+	OffspringGraph graph;
+	buildOffspringGraph(ancGens, false, true, graph);
+
+	// each individual only writes to its own fields
+#pragma omp parallel for if(numThreads() > 1) schedule(dynamic)
+	for (ssize_t g = 0; g < static_cast<ssize_t>(graph.numIDs()); ++g) {
+		size_t id = graph.groupID(g);
+		Individual * ind = findByID(id);
+		// families of this individual, in the order of parental IDs
+		vectoru families;
+		for (vectoru::const_iterator it = graph.groupBegin(g); it != graph.groupEnd(g); ++it)
+			if (graph.father(*it) && graph.mother(*it))
+				families.push_back(graph.coupleIndex(graph.father(*it), graph.mother(*it)));
+		std::sort(families.begin(), families.end());
+		families.erase(std::unique(families.begin(), families.end()), families.end());
+
+		size_t numSibling = 0;
+		for (size_t f = 0; f < families.size(); ++f)
+			addSiblings(*ind, id, graph, graph.coupleOffspringBegin(families[f]),
+				graph.coupleOffspringEnd(families[f]), sexChoice, affectionChoice,
+				siblingIdx, numSibling);
 	}
 }
 
@@ -646,67 +719,56 @@ void Pedigree::locateCommonOffspring(SexChoice sexChoice, AffectionStatus affect
 		}
 	}
 
-	// find all full families
-	typedef pairu couple;
-	map<couple, vectoru> families;
-	for (unsigned genIdx = 0; genIdx < ancGens.size(); ++genIdx) {
-		useAncestralGen(ancGens[genIdx]);
-		for (size_t i = 0; i < popSize(); ++i) {
-			double f = individual(i).info(m_fatherIdx);
-			double m = individual(i).info(m_motherIdx);
-			if (f >= 1 && m >= 1)
-				families[couple(toID(f), toID(m))].push_back(toID(individual(i).info(m_idIdx)));
-		}
-	}
-	// look in each family
-	map<couple, vectoru>::iterator it = families.begin();
-	map<couple, vectoru>::iterator itEnd = families.end();
-	std::map<size_t, size_t> numOffspring;
-	for (; it != itEnd; ++it) {
-		size_t p = it->first.first;
-		size_t m = it->first.second;
-		// these guys share two parents
-		const vectoru & offspring = it->second;
-		try {
-			Individual & fa = indByID(p);
-			Individual & ma = indByID(m);
-			// spouse
-			double fa_spouse = fa.info(spouseIdx);
-			double ma_spouse = ma.info(spouseIdx);
-			bool valid_fa = fa_spouse != -1 && toID(fa_spouse) == m;
-			bool valid_ma = ma_spouse != -1 && toID(ma_spouse) == p;
-			if (!valid_fa && !valid_ma)
-				continue;
-			// offspring
-			for (size_t j = 0; j < offspring.size(); ++j) {
-				try {
-					Individual & child = indByID(offspring[j]);
-					bool valid = acceptableSex(MALE, child.sex(), sexChoice) &&
-					             acceptableAffectionStatus(child.affected(), affectionChoice);
-					// duplicate child
-					if (valid) {
-						for (size_t s = 0; s < numOffspring[p]; ++s)
-							if (fa.info(offspringIdx[s]) == offspring[j]) {
-								valid = false;
-								break;
-							}
-					}
-					if (valid) {
-						if (valid_fa && numOffspring[p] < maxOffspring) {
-							fa.setInfo(static_cast<double>(offspring[j]), offspringIdx[numOffspring[p]]);
-							++numOffspring[p];
-						}
-						if (valid_ma && numOffspring[m] < maxOffspring) {
-							ma.setInfo(static_cast<double>(offspring[j]), offspringIdx[numOffspring[m]]);
-							++numOffspring[m];
-						}
+	// full families are offspring of each couple
+	OffspringGraph graph;
+	buildOffspringGraph(ancGens, false, true, graph);
+
+	// Couples are visited in order because offspring of a mother are checked
+	// against offspring that are already assigned to her spouse.
+	vectoru numOffspring(graph.numParents(), 0);
+	for (size_t c = 0; c < graph.numCouples(); ++c) {
+		size_t p = graph.couple(c).first;
+		size_t m = graph.couple(c).second;
+		// but these guys might not be in the population...
+		Individual * fa = findByID(p);
+		Individual * ma = findByID(m);
+		if (fa == NULL || ma == NULL)
+			continue;
+		// spouse
+		double fa_spouse = fa->info(spouseIdx);
+		double ma_spouse = ma->info(spouseIdx);
+		bool valid_fa = fa_spouse != -1 && toID(fa_spouse) == m;
+		bool valid_ma = ma_spouse != -1 && toID(ma_spouse) == p;
+		if (!valid_fa && !valid_ma)
+			continue;
+		size_t & numFaOffspring = numOffspring[graph.parentIndex(p)];
+		size_t & numMaOffspring = numOffspring[graph.parentIndex(m)];
+		// offspring
+		vectoru::const_iterator it = graph.coupleOffspringBegin(c);
+		vectoru::const_iterator itEnd = graph.coupleOffspringEnd(c);
+		for (; it != itEnd; ++it) {
+			size_t childID = graph.id(*it);
+			Individual * child = findByID(childID);
+			bool valid = acceptableSex(MALE, child->sex(), sexChoice) &&
+			             acceptableAffectionStatus(child->affected(), affectionChoice);
+			// duplicate child
+			if (valid) {
+				for (size_t s = 0; s < numFaOffspring; ++s)
+					if (fa->info(offspringIdx[s]) == childID) {
+						valid = false;
+						break;
 					}
-				} catch (...) {
-					// if does not found, ignore this offspring
+			}
+			if (valid) {
+				if (valid_fa && numFaOffspring < maxOffspring) {
+					fa->setInfo(static_cast<double>(childID), offspringIdx[numFaOffspring]);
+					++numFaOffspring;
+				}
+				if (valid_ma && numMaOffspring < maxOffspring) {
+					ma->setInfo(static_cast<double>(childID), offspringIdx[numMaOffspring]);
+					++numMaOffspring;
 				}
 			}
-		} catch (...) {
-			// if does not found, ignore this couple.
 		}
 	}
 }
@@ -922,13 +984,22 @@ vectoru Pedigree::individualsWithRelatives(const stringList & infoFieldList, con
 }
 
 
+// root of \e node in a union-find forest, with paths halved
+static size_t familyRoot(vectoru & root, size_t node)
+{
+	while (root[node] != node) {
+		root[node] = root[root[node]];
+		node = root[node];
+	}
+	return node;
+}
+
+
 vectoru Pedigree::identifyFamilies(const string & pedField, const subPopList & subPops,
                                    const uintList & ancGens)
 {
-	// step 1: Mark eligible individuals and collect IDs
-	std::map<size_t, ssize_t> famID;
-
 	vectoru gens = ancGens.elems();
+
 	if (ancGens.allAvail())
 		for (int gen = 0; gen <= ancestralGens(); ++gen)
 			gens.push_back(gen);
@@ -936,8 +1007,10 @@ vectoru Pedigree::identifyFamilies(const string & pedField, const subPopList & s
 		gens.push_back(curAncestralGen());
 
 	size_t oldGen = curAncestralGen();
-	// mark eligible Individuals
+	// step 1: mark eligible Individuals
+	vectoru allGens;
 	for (int ans = 0; ans <= ancestralGens(); ++ans) {
+		allGens.push_back(ans);
 		useAncestralGen(ans);
 		if (std::find(gens.begin(), gens.end(), static_cast<size_t>(ans)) == gens.end()) {
 			markIndividuals(vspID(), false);
@@ -952,117 +1025,72 @@ vectoru Pedigree::identifyFamilies(const string & pedField, const subPopList & s
 			for (; sp != spEnd; ++sp)
 				markIndividuals(*sp, true);
 		}
-		// collect ID.
-		RawIndIterator it = rawIndBegin();
-		RawIndIterator itEnd = rawIndEnd();
-		for (; it != itEnd; ++it)
-			if (it->marked())
-				famID[toID(it->info(m_idIdx))] = -1;
 	}
-	// step 2: decide family ID
-	size_t famCount = 0;
-	//
-	std::map<size_t, ssize_t>::iterator it = famID.begin();
-	std::map<size_t, ssize_t>::iterator it_end = famID.end();
-	for (; it != it_end; ++it) {
-		// CASE ONE: if this guy is someone's parent, and has already been processed
-		if (it->second >= 0)
+	useAncestralGen(oldGen);
+
+	// collect IDs of eligible individuals
+	OffspringGraph graph;
+	buildOffspringGraph(allGens, true, false, graph);
+	size_t numIDs = graph.numIDs();
+
+	// step 2: locate eligible parents of eligible individuals
+	vectoru dads(numIDs, InvalidValue);
+	vectoru moms(numIDs, InvalidValue);
+#pragma omp parallel for if(numThreads() > 1)
+	for (ssize_t g = 0; g < static_cast<ssize_t>(numIDs); ++g) {
+		Individual * ind = findByID(graph.groupID(g));
+		if (m_fatherIdx != -1)
+			dads[g] = graph.groupIndex(toID(ind->info(m_fatherIdx)));
+		if (m_motherIdx != -1)
+			moms[g] = graph.groupIndex(toID(ind->info(m_motherIdx)));
+	}
+
+	// step 3: join individuals with their parents. Individuals are visited
+	// in the order of IDs and the parents of an individual are ignored if
+	// the individual is already joined as the parent of another individual.
+	vectoru root(numIDs);
+	for (size_t g = 0; g < numIDs; ++g)
+		root[g] = g;
+	vector<bool> joined(numIDs, false);
+	for (size_t g = 0; g < numIDs; ++g) {
+		if (joined[g])
 			continue;
-		// this guy should exist
-		Individual * ind = m_idMap[it->first];
-		Individual * dad = NULL;
-		Individual * mom = NULL;
-		ssize_t dadFam = -2;
-		ssize_t momFam = -2;
-		// try to identify father and mother....
-		if (m_fatherIdx != -1) {
-			size_t dad_id = toID(ind->info(m_fatherIdx));
-			// ok father
-			std::map<size_t, ssize_t>::iterator dad_fam = famID.find(dad_id);
-			// because father exists in famID
-			if (dad_fam != famID.end()) {
-				dadFam = dad_fam->second;
-				dad = m_idMap[dad_id];
-			}
-		}
-		if (m_motherIdx != -1) {
-			size_t mom_id = toID(ind->info(m_motherIdx));
-			// ok mother
-			std::map<size_t, ssize_t>::iterator mom_fam = famID.find(mom_id);
-			// because father exists in famID
-			if (mom_fam != famID.end()) {
-				momFam = mom_fam->second;
-				mom = m_idMap[mom_id];
-			}
+		joined[g] = true;
+		size_t parents[2] = { dads[g], moms[g] };
+		for (size_t p = 0; p < 2; ++p) {
+			if (parents[p] == InvalidValue)
+				continue;
+			joined[parents[p]] = true;
+			size_t r1 = familyRoot(root, g);
+			size_t r2 = familyRoot(root, parents[p]);
+			// a family is rooted at its individual with the smallest ID
+			if (r1 < r2)
+				root[r2] = r1;
+			else
+				root[r1] = r2;
 		}
-		// CASE TWO: no parent
-		if (dad == NULL && mom == NULL) {
-			it->second = famCount++;
-		} else if (dad != NULL && mom == NULL) {
-			// CASE THREE: One father
-			if (dadFam >= 0)
-				// follow dad fam
-				it->second = dadFam;
-			else {
-				it->second = famCount;
-				famID[toID(dad->info(m_idIdx))] = famCount;
-				++famCount;
-			}
-		} else if (dad == NULL && mom != NULL) {
-			// CASE FOUR: One mother
-			if (momFam >= 0)
-				// follow mom fam
-				it->second = momFam;
-			else {
-				it->second = famCount;
-				famID[toID(mom->info(m_idIdx))] = famCount;
-				++famCount;
-			}
-		} else if (dadFam < 0 && momFam < 0) {
-			// CASE FIVE: fresh father and mother
-			it->second = famCount;
-			famID[toID(mom->info(m_idIdx))] = famCount;
-			famID[toID(dad->info(m_idIdx))] = famCount;
-			++famCount;
-		} else if (dadFam >= 0 && momFam < 0) {
-			// CASE SIX: fresh mother
-			it->second = dadFam;
-			famID[toID(mom->info(m_idIdx))] = dadFam;
-		} else if (dadFam < 0 && momFam >= 0) {
-			// CASE SEVEN: fresh father
-			it->second = momFam;
-			famID[toID(dad->info(m_idIdx))] = momFam;
-		} else if (dadFam == momFam) {
-			// CASE EIGHT: a sibling?
-			it->second = momFam;
-		} else {
-			// CASE NINE: we have a conflict.
-			ssize_t oldID = std::max(dadFam, momFam);
-			ssize_t newID = std::min(dadFam, momFam);
-			// everyone with the large ID need to be converted to small ID.
-			it->second = newID;
-			std::map<size_t, ssize_t>::iterator iit = famID.begin();
-			std::map<size_t, ssize_t>::iterator iit_end = famID.end();
-			for (; iit != iit_end; ++iit) {
-				if (iit->second == oldID)
-					iit->second = newID;
-				if (iit->second > oldID)
-					--iit->second;
-			}
-			--famCount;
+	}
+
+	// step 4: families are numbered by the smallest IDs of their members
+	vectoru famIDs(numIDs);
+	vectoru famOfRoot(numIDs, InvalidValue);
+	vectoru famSize;
+	for (size_t g = 0; g < numIDs; ++g) {
+		size_t r = familyRoot(root, g);
+		if (famOfRoot[r] == InvalidValue) {
+			famOfRoot[r] = famSize.size();
+			famSize.push_back(0);
 		}
+		famIDs[g] = famOfRoot[r];
+		++famSize[famIDs[g]];
 	}
+
 	int pedIdx = pedField.empty() ? -1 : static_cast<int>(infoIdx(pedField));
-	// return result
-	vectoru famSize(famCount, 0);
-	it = famID.begin();
-	for (; it != it_end; ++it) {
-		ssize_t famID = it->second;
-		++famSize[famID];
-		if (pedIdx >= 0)
-			m_idMap[it->first]->setInfo(static_cast<double>(famID), static_cast<size_t>(pedIdx));
+	if (pedIdx >= 0) {
+#pragma omp parallel for if(numThreads() > 1)
+		for (ssize_t g = 0; g < static_cast<ssize_t>(numIDs); ++g)
+			findByID(graph.groupID(g))->setInfo(static_cast<double>(famIDs[g]), static_cast<size_t>(pedIdx));
 	}
-	useAncestralGen(oldGen);
 	return famSize;
 }
 
@@ -1098,6 +1126,7 @@ vectoru Pedigree::identifyAncestors(const uintList & IDs,
 		}
 	}
 	useAncestralGen(oldGen);
+	indexIDs();
 
 	// step 2: source IDs
 	vectoru res;
@@ -1111,53 +1140,38 @@ vectoru Pedigree::identifyAncestors(const uintList & IDs,
 		const vectoru & inputIDs = IDs.elems();
 		res.reserve(inputIDs.size());
 		for (size_t i = 0; i < inputIDs.size(); ++i)
-			if (m_idMap.find(inputIDs[i]) != m_idMap.end())
+			if (findByID(inputIDs[i]) != NULL)
 				res.push_back(inputIDs[i]);
 	}
 	// step 3: trace back like a spider
 	size_t start = 0;
+	vectoru parents;
 	while (true) {
 		size_t end = res.size();
 		if (start == end)
 			break;
-		for (size_t i = start; i < end; ++i) {
-			size_t ID = res[i];
+		// parents of individuals between start and end are looked up in
+		// parallel, and are added in order if they are not included yet.
+		parents.assign(2 * (end - start), 0);
+#pragma omp parallel for if(numThreads() > 1)
+		for (ssize_t i = static_cast<ssize_t>(start); i < static_cast<ssize_t>(end); ++i) {
+			Individual * ind = findByID(res[i]);
+			if (ind == NULL)
+				continue;
+			if (m_fatherIdx != -1)
+				parents[2 * (i - start)] = toID(ind->info(m_fatherIdx));
+			if (m_motherIdx != -1)
+				parents[2 * (i - start) + 1] = toID(ind->info(m_motherIdx));
+		}
+		for (size_t i = 0; i < parents.size(); ++i) {
 			// true ID starts from 1
-			size_t father_ID = 0;
-			size_t mother_ID = 0;
-			try {
-				// if this ID exists
-				Individual & ind = indByID(ID);
-				if (m_fatherIdx != -1)
-					father_ID = toID(ind.info(m_fatherIdx));
-				if (m_motherIdx != -1)
-					mother_ID = toID(ind.info(m_motherIdx));
-			} catch (IndexError &) {
-				//
-			}
-			if (father_ID) {
-				try {
-					Individual & father = indByID(father_ID);
-					if (father.marked()) {
-						res.push_back(father_ID);
-						// this father is already included
-						father.setMarked(false);
-					}
-				} catch (IndexError &) {
-					///
-				}
-			}
-			if (mother_ID) {
-				try {
-					Individual & mother = indByID(mother_ID);
-					if (mother.marked()) {
-						res.push_back(mother_ID);
-						// this mother is already included
-						mother.setMarked(false);
-					}
-				} catch (IndexError &) {
-					///
-				}
+			if (parents[i] == 0)
+				continue;
+			Individual * parent = findByID(parents[i]);
+			if (parent != NULL && parent->marked()) {
+				res.push_back(parents[i]);
+				// this parent is already included
+				parent->setMarked(false);
 			}
 		}
 		// all parents of individuals between start and end has been located
@@ -1172,9 +1186,8 @@ vectoru Pedigree::identifyOffspring(const uintList & IDs,
                                     const subPopList & subPops,
                                     const uintList & ancGens)
 {
-	// record offspring of everyone
-	std::map<size_t, vectoru> offspringMap;
 	vectoru gens = ancGens.elems();
+
 	if (ancGens.allAvail())
 		for (int gen = 0; gen <= ancestralGens(); ++gen)
 			gens.push_back(gen);
@@ -1183,7 +1196,9 @@ vectoru Pedigree::identifyOffspring(const uintList & IDs,
 
 	// mark eligible Individuals
 	size_t oldGen = curAncestralGen();
+	vectoru allGens;
 	for (int ans = 0; ans <= ancestralGens(); ++ans) {
+		allGens.push_back(ans);
 		useAncestralGen(ans);
 		if (std::find(gens.begin(), gens.end(), static_cast<size_t>(ans)) == gens.end()) {
 			markIndividuals(vspID(), false);
@@ -1198,50 +1213,43 @@ vectoru Pedigree::identifyOffspring(const uintList & IDs,
 			for (; sp != spEnd; ++sp)
 				markIndividuals(*sp, true);
 		}
-		// collect ID.
-		RawIndIterator it = rawIndBegin();
-		RawIndIterator itEnd = rawIndEnd();
-		for (; it != itEnd; ++it) {
-			// I am a valid offspring
-			if (it->marked()) {
-				size_t myID = toID(it->info(m_idIdx));
-				size_t fatherID = m_fatherIdx == -1 ? 0 : toID(it->info(m_fatherIdx));
-				size_t motherID = m_motherIdx == -1 ? 0 : toID(it->info(m_motherIdx));
-				// we do not care if father or mother is valid.
-				if (fatherID) {
-					if (offspringMap.find(fatherID) == offspringMap.end())
-						offspringMap[fatherID] = vectoru(1, myID);
-					else
-						offspringMap[fatherID].push_back(myID);
-				}
-				if (motherID) {
-					if (offspringMap.find(motherID) == offspringMap.end())
-						offspringMap[motherID] = vectoru(1, myID);
-					else
-						offspringMap[motherID].push_back(myID);
-				}
-			}
-		}
 	}
 	useAncestralGen(oldGen);
 
-	// step 2: locate all offspring
+	// record offspring of everyone, we do not care if father or mother is valid.
+	OffspringGraph graph;
+	buildOffspringGraph(allGens, true, false, graph);
+
+	// step 2: locate all offspring, each of them only once
 	vectoru res;
+	vector<bool> located(graph.numIDs(), false);
 	const vectoru & inputIDs = IDs.elems();
 	res.reserve(inputIDs.size());
-	for (size_t i = 0; i < inputIDs.size(); ++i)
-		if (m_idMap.find(inputIDs[i]) != m_idMap.end())
-			res.push_back(inputIDs[i]);
+	for (size_t i = 0; i < inputIDs.size(); ++i) {
+		if (findByID(inputIDs[i]) == NULL)
+			continue;
+		res.push_back(inputIDs[i]);
+		size_t g = graph.groupIndex(inputIDs[i]);
+		if (g != InvalidValue)
+			located[g] = true;
+	}
 	size_t start = 0;
 	while (true) {
 		size_t end = res.size();
 		if (start == end)
 			break;
 		for (size_t i = start; i < end; ++i) {
-			size_t ID = res[i];
-			if (offspringMap.find(ID) == offspringMap.end())
+			size_t p = graph.parentIndex(res[i]);
+			if (p == InvalidValue)
 				continue;
-			res.insert(res.end(), offspringMap[ID].begin(), offspringMap[ID].end());
+			vectoru::const_iterator it = graph.offspringBegin(p);
+			vectoru::const_iterator itEnd = graph.offspringEnd(p);
+			for (; it != itEnd; ++it) {
+				if (located[graph.group(*it)])
+					continue;
+				located[graph.group(*it)] = true;
+				res.push_back(graph.id(*it));
+			}
 		}
 		// all offspring of individuals between start and end has been located
 		// start to find the offspring of these offspring
@@ -36,6 +36,193 @@
 
 namespace simuPOP {
 
+/** CPPONLY
+ *  Offspring of individuals in selected generations of a pedigree, stored
+ *  in compressed sparse row (CSR) format. Individuals are recorded in the
+ *  order of generations and indexes, and offspring of a parent (or a pair
+ *  of parents) are listed in this order so that relatives located from
+ *  the graph are located in the same order as generation by generation.
+ *  Individuals, parents and couples are referred to by their indexes in
+ *  the graph so that relatives of different individuals can be located in
+ *  parallel.
+ */
+class OffspringGraph
+{
+public:
+	OffspringGraph() : m_inds(), m_ids(), m_fathers(), m_mothers(),
+		m_groupIDs(), m_groupOffset(), m_groupMembers(), m_groups(),
+		m_parentIDs(), m_parentOffset(), m_offspring(),
+		m_couples(), m_coupleOffset(), m_coupleOffspring()
+	{
+	}
+
+
+	/// add individual \e ind with \e id, \e father and \e mother (0 for
+	/// unknown parents)
+	void addIndividual(Individual * ind, size_t id, size_t father, size_t mother)
+	{
+		m_inds.push_back(ind);
+		m_ids.push_back(id);
+		m_fathers.push_back(father);
+		m_mothers.push_back(mother);
+	}
+
+
+	/// build the graph after all individuals are added, with offspring of
+	/// couples if \e couples is true
+	void build(bool couples);
+
+	/// number of individuals in the graph
+	size_t size() const
+	{
+		return m_inds.size();
+	}
+
+
+	Individual & individual(size_t ind) const
+	{
+		return *m_inds[ind];
+	}
+
+
+	size_t id(size_t ind) const
+	{
+		return m_ids[ind];
+	}
+
+
+	size_t father(size_t ind) const
+	{
+		return m_fathers[ind];
+	}
+
+
+	size_t mother(size_t ind) const
+	{
+		return m_mothers[ind];
+	}
+
+
+	/// number of distinct IDs, in increasing order
+	size_t numIDs() const
+	{
+		return m_groupIDs.size();
+	}
+
+
+	size_t groupID(size_t group) const
+	{
+		return m_groupIDs[group];
+	}
+
+
+	/// index of distinct ID of individual \e ind
+	size_t group(size_t ind) const
+	{
+		return m_groups[ind];
+	}
+
+
+	/// index of \e id, or \c InvalidValue if no individual has this ID
+	size_t groupIndex(size_t id) const;
+
+	/// individuals with ID \e group, in the order they are added
+	vectoru::const_iterator groupBegin(size_t group) const
+	{
+		return m_groupMembers.begin() + m_groupOffset[group];
+	}
+
+
+	vectoru::const_iterator groupEnd(size_t group) const
+	{
+		return m_groupMembers.begin() + m_groupOffset[group + 1];
+	}
+
+
+	/// number of distinct parental IDs, in increasing order
+	size_t numParents() const
+	{
+		return m_parentIDs.size();
+	}
+
+
+	size_t parentID(size_t parent) const
+	{
+		return m_parentIDs[parent];
+	}
+
+
+	/// index of parent \e id, or \c InvalidValue if \e id has no offspring
+	size_t parentIndex(size_t id) const;
+
+	/// offspring of \e parent in the order they are added. An offspring
+	/// is listed twice if its father and mother share the same ID.
+	vectoru::const_iterator offspringBegin(size_t parent) const
+	{
+		return m_offspring.begin() + m_parentOffset[parent];
+	}
+
+
+	vectoru::const_iterator offspringEnd(size_t parent) const
+	{
+		return m_offspring.begin() + m_parentOffset[parent + 1];
+	}
+
+
+	/// number of distinct pairs of parental IDs, in increasing order
+	size_t numCouples() const
+	{
+		return m_couples.size();
+	}
+
+
+	const pairu & couple(size_t couple) const
+	{
+		return m_couples[couple];
+	}
+
+
+	/// index of couple (\e father, \e mother), or \c InvalidValue if they
+	/// have no offspring
+	size_t coupleIndex(size_t father, size_t mother) const;
+
+	/// offspring of \e couple in the order they are added
+	vectoru::const_iterator coupleOffspringBegin(size_t couple) const
+	{
+		return m_coupleOffspring.begin() + m_coupleOffset[couple];
+	}
+
+
+	vectoru::const_iterator coupleOffspringEnd(size_t couple) const
+	{
+		return m_coupleOffspring.begin() + m_coupleOffset[couple + 1];
+	}
+
+
+private:
+	vector<Individual *> m_inds;
+	vectoru m_ids;
+	vectoru m_fathers;
+	vectoru m_mothers;
+
+	/// individuals grouped by IDs
+	vectoru m_groupIDs;
+	vectoru m_groupOffset;
+	vectoru m_groupMembers;
+	vectoru m_groups;
+
+	/// offspring of each parent
+	vectoru m_parentIDs;
+	vectoru m_parentOffset;
+	vectoru m_offspring;
+
+	/// offspring of each couple
+	vector<pairu> m_couples;
+	vectoru m_coupleOffset;
+	vectoru m_coupleOffspring;
+};
+
+
 /** The pedigree class is derived from the population class. Unlike a
  *  population class that emphasizes on individual properties, the pedigree
  *  class emphasizes on relationship between individuals. An unique ID for
@@ -94,10 +281,10 @@ public:
 	{
 		if (id == 0 || m_fatherIdx == -1)
 			return 0;
-		IdMap::iterator it = m_idMap.find(id);
-		if (it == m_idMap.end())
+		Individual * ind = findByID(id);
+		if (ind == NULL)
 			return 0;
-		return toID(it->second->info(m_fatherIdx));
+		return toID(ind->info(m_fatherIdx));
 	}
 
 
@@ -107,10 +294,10 @@ public:
 	{
 		if (id == 0 || m_motherIdx == -1)
 			return 0;
-		IdMap::iterator it = m_idMap.find(id);
-		if (it == m_idMap.end())
+		Individual * ind = findByID(id);
+		if (ind == NULL)
 			return 0;
-		return toID(it->second->info(m_motherIdx));
+		return toID(ind->info(m_motherIdx));
 	}
 
 
@@ -141,7 +328,9 @@ public:
 
 	/** Return a reference to individual with \e id. An \c IndexError will be
 	 *  raised if no individual with \e id is found. An float \e id is
-	 *  acceptable as long as it rounds closely to an integer.
+	 *  acceptable as long as it rounds closely to an integer. If several
+	 *  individuals share \e id, the latest one (the last individual of the
+	 *  most recent generation) is returned.
 	 *  <group>4-ind</group>
 	 */
 	Individual & indByID(double id) const;
@@ -149,12 +338,12 @@ public:
 	/** CPPONLY */
 	Individual & indByID(size_t id) const
 	{
-		IdMap::iterator it = m_idMap.find(id);
+		Individual * ind = findByID(id);
 
 		// if still cannot be found, raise an IndexError.
-		if (it == m_idMap.end())
+		if (ind == NULL)
 			throw IndexError((boost::format("No individual with ID %1% could be found.") % id).str());
-		return *it->second;
+		return *ind;
 	}
 
 
@@ -353,8 +542,35 @@ public:
 	void setSubPopByIndInfo(const string & field);
 
 private:
+	/// build indexes of IDs of all generations
+	void indexIDs() const;
+
+	/// build indexes of IDs and check if different individuals share IDs
 	void buildIDMap();
 
+	/// individual with \e id in the most recent generation that has it (the
+	/// last one if several individuals in the generation share the ID), or
+	/// \c NULL if there is no such individual. Indexes of IDs are built if
+	/// needed but never rebuilt, so this function can be called from
+	/// multiple threads after the indexes have been built.
+	Individual * findByID(size_t id) const
+	{
+		for (int gen = 0; gen <= ancestralGens(); ++gen) {
+			buildIDIndex(gen, m_idIdx);
+			Individual * ind = findIndByID(id, gen, m_idIdx, false, true);
+			if (ind != NULL)
+				return ind;
+		}
+		return NULL;
+	}
+
+
+	/// collect individuals in generations \e ancGens (only marked ones if
+	/// \e markedOnly is true) and their parents to \e graph. Indexes of IDs
+	/// are rebuilt so that individuals can be looked up in parallel.
+	void buildOffspringGraph(const vectoru & ancGens, bool markedOnly,
+		bool couples, OffspringGraph & graph);
+
 	bool acceptableSex(Sex mySex, Sex relSex, SexChoice choice);
 
 	bool acceptableAffectionStatus(bool affected, AffectionStatus choice);
@@ -381,6 +597,13 @@ private:
 	void locateCommonOffspring(SexChoice relSex, AffectionStatus relAffection,
 		const vectorstr & relFields, const vectoru & ancGens);
 
+	/// add siblings of individual \e ind with \e id in a family of
+	/// individuals between \e begin and \e end in \e graph
+	void addSiblings(Individual & ind, size_t id, const OffspringGraph & graph,
+		vectoru::const_iterator begin, vectoru::const_iterator end,
+		SexChoice relSex, AffectionStatus relAffection,
+		const vectoru & siblingIdx, size_t & numSibling);
+
 private:
 	const string m_idField;
 	const string m_fatherField;
@@ -389,13 +612,6 @@ private:
 	int m_idIdx;
 	int m_fatherIdx;
 	int m_motherIdx;
-
-#if TR1_SUPPORT == 0
-	typedef std::map<size_t, Individual *> IdMap;
-#else
-	typedef std::tr1::unordered_map<size_t, Individual *> IdMap;
-#endif
-	mutable IdMap m_idMap;
 };
 
 
@@ -35,6 +35,20 @@ using std::ostringstream;
 
 namespace simuPOP {
 
+// individuals are evaluated in blocks of this size so that a penetrance
+// operator can process a block locus by locus, and blocks are distributed
+// to threads
+#define PENETRANCE_BLOCK_SIZE 1024
+
+void BasePenetrance::batchPenet(Population * pop, const vector<RawIndIterator> & inds,
+                                size_t first, size_t last, vectorf & values) const
+{
+	values.resize(last - first);
+	for (size_t i = first; i < last; ++i)
+		values[i - first] = penet(pop, inds[i]);
+}
+
+
 // set pentrance to all individuals and record penetrance if requested.
 bool BasePenetrance::apply(Population & pop) const
 {
@@ -52,8 +66,13 @@ bool BasePenetrance::apply(Population & pop) const
 		gens.push_back(pop.curAncestralGen());
 
 	size_t oldGen = pop.curAncestralGen();
+	bool inBlocks = batchable() || (numThreads() > 1 && parallelizable());
+	vector<RawIndIterator> inds;
 	for (unsigned genIdx = 0; genIdx < gens.size(); ++genIdx) {
 		pop.useAncestralGen(gens[genIdx]);
+		// initialize operator before entering parallel region in order to avoid race condition
+		if (pop.popSize() > 0)
+			initializeIfNeeded(*pop.rawIndBegin());
 
 		subPopList subPops = applicableSubPops(pop);
 
@@ -63,36 +82,50 @@ bool BasePenetrance::apply(Population & pop) const
 			if (sp->isVirtual())
 				pop.activateVirtualSubPop(*sp);
 
-			if (numThreads() > 1 && parallelizable()) {
-#pragma omp parallel
-				{
-#ifdef _OPENMP
-					IndIterator ind = pop.indIterator(sp->subPop(), omp_get_thread_num());
-					for (; ind.valid(); ++ind) {
-						double p = penet(&pop, ind.rawIter());
+			// individuals of ancestral generations are keyed by the generation
+			// at which they were produced.
+			size_t gen = pop.gen() - gens[genIdx];
+			const RNG & rng = getRNG();
+			size_t call = getRNG().newStreamCall();
+			IndIterator it = pop.indIterator(sp->subPop());
+			if (!inBlocks) {
+				RNGStream stream(rng, PENETRANCE_STREAM, pop.rep(), call);
+				for (; it.valid(); ++it) {
+					double p = penet(&pop, it.rawIter());
+					stream.seek(gen, sp->subPop(), it.rawIter() - pop.rawIndBegin());
 
-						if (savePene)
-							ind->setInfo(p, infoIdx);
+					if (savePene)
+						it->setInfo(p, infoIdx);
 
-						if (getRNG().randUniform() < p)
-							ind->setAffected(true);
-						else
-							ind->setAffected(false);
-					}
-#endif
+					it->setAffected(getRNG().randUniform() < p);
 				}
-			} else {
-				IndIterator ind = pop.indIterator(sp->subPop());
-				for (; ind.valid(); ++ind) {
-					double p = penet(&pop, ind.rawIter());
+				if (sp->isVirtual())
+					pop.deactivateVirtualSubPop(sp->subPop());
+				continue;
+			}
+			inds.clear();
+			for (; it.valid(); ++it)
+				inds.push_back(it.rawIter());
+
+			long numBlocks = static_cast<long>((inds.size() + PENETRANCE_BLOCK_SIZE - 1) / PENETRANCE_BLOCK_SIZE);
+#pragma omp parallel if(numThreads() > 1 && parallelizable() && numBlocks > 1)
+			{
+				RNGStream stream(rng, PENETRANCE_STREAM, pop.rep(), call);
+				vectorf values;
+#pragma omp for schedule(dynamic)
+				for (long b = 0; b < numBlocks; ++b) {
+					size_t first = b * PENETRANCE_BLOCK_SIZE;
+					size_t last = std::min(first + PENETRANCE_BLOCK_SIZE, inds.size());
+					batchPenet(&pop, inds, first, last, values);
+					for (size_t i = first; i < last; ++i) {
+						double p = values[i - first];
+						stream.seek(gen, sp->subPop(), inds[i] - pop.rawIndBegin());
 
-					if (savePene)
-						ind->setInfo(p, infoIdx);
+						if (savePene)
+							inds[i]->setInfo(p, infoIdx);
 
-					if (getRNG().randUniform() < p)
-						ind->setAffected(true);
-					else
-						ind->setAffected(false);
+						inds[i]->setAffected(getRNG().randUniform() < p);
+					}
 				}
 			}
 			if (sp->isVirtual())
@@ -132,101 +165,9 @@ bool BasePenetrance::applyDuringMating(Population & /* pop */, Population & offP
 }
 
 
-// this function is the same as MapPenetrance.
 double MapPenetrance::penet(Population * /* pop */, RawIndIterator ind) const
 {
-	vectoru chromTypes;
-
-	const vectoru & loci = m_loci.elems(&*ind);
-
-	for (size_t i = 0; i < loci.size(); ++i)
-		chromTypes.push_back(ind->chromType(ind->chromLocusPair(loci[i]).first));
-
-	size_t ply = ind->ploidy();
-	if (ind->isHaplodiploid() && ind->sex() == MALE)
-		ply = 1;
-
-	vectori alleles;
-	alleles.reserve(ply * loci.size());
-
-	for (size_t idx = 0; idx < loci.size(); ++idx) {
-		for (size_t p = 0; p < ply; ++p) {
-			if (chromTypes[idx] == CHROMOSOME_Y && ind->sex() == FEMALE)
-				continue;
-			if (((chromTypes[idx] == CHROMOSOME_X && p == 1) ||
-			     (chromTypes[idx] == CHROMOSOME_Y && p == 0)) && ind->sex() == MALE)
-				continue;
-			if (chromTypes[idx] == MITOCHONDRIAL && p > 0)
-				continue;
-			alleles.push_back(ind->allele(loci[idx], p));
-		}
-	}
-
-	tupleDict::const_iterator pos = m_dict.find(alleles);
-
-	if (pos != m_dict.end())
-		return pos->second;
-
-	if (ply > 1) {
-		// try to look up the key without phase
-		tupleDict::const_iterator it = m_dict.begin();
-		tupleDict::const_iterator itEnd = m_dict.end();
-		for (; it != itEnd; ++it) {
-			bool ok = true;
-			const tupleDict::key_type & key = it->first;
-			size_t begin_idx = 0;
-			size_t end_idx = 0;
-			for (size_t i = 0; i < loci.size(); ++i) {
-				if (chromTypes[i] == CHROMOSOME_Y) {
-					if (ind->sex() == FEMALE)
-						continue;
-					else
-						++end_idx;
-				} else if (chromTypes[i] == CHROMOSOME_X && ind->sex() == MALE)
-					++end_idx;
-				else if (chromTypes[i] == MITOCHONDRIAL)
-					++end_idx;
-				else
-					end_idx += ply;
-				if (key.size() != end_idx - begin_idx) {
-					ok = false;
-					break;
-				}
-				if (ply == 2) {
-					if ((alleles[begin_idx] != key[0] || alleles[end_idx - 1] != key[1]) &&
-					    (alleles[begin_idx] != key[1] || alleles[end_idx - 1] != key[0])) {
-						ok = false;
-						break;
-					}
-				} else {
-					std::sort(alleles.begin() + begin_idx, alleles.begin() + end_idx);
-					tupleDict::key_type sorted_key = it->first;
-					std::sort(sorted_key.begin(), sorted_key.end());
-					for (size_t j = 0; j < sorted_key.size(); ++j) {
-						if (alleles[ply * i + j] != sorted_key[j]) {
-							ok = false;
-							break;
-						}
-					}
-				}
-				begin_idx = end_idx;
-			}
-			if (ok)
-				return it->second;
-		}
-	}
-	// no match
-	ostringstream allele_string;
-	allele_string << "(";
-	for (size_t i = 0; i < alleles.size(); ++i) {
-		if (i != 0)
-			allele_string << ", ";
-		allele_string << alleles[i];
-	}
-	allele_string << ")";
-	throw ValueError("No penetrance value for genotype " + allele_string.str());
-	// this line should not be reached.
-	return 0;
+	return m_table.value(*ind, m_loci.elems(&*ind));
 }
 
 
@@ -236,49 +177,39 @@ string MaPenetrance::describe(bool /* format */) const
 }
 
 
-// this function is the same as MaPenetrance.
 double MaPenetrance::penet(Population * /* pop */, RawIndIterator ind) const
 {
-	UINT index = 0;
-	bool singleST = m_wildtype.size() == 1;
 	const vectoru & loci = m_loci.elems(&*ind);
 
 	DBG_FAILIF((ind->ploidy() == 2 && m_penetrance.size() != static_cast<UINT>(pow(3., static_cast<double>(loci.size())))) ||
 		(ind->ploidy() == 1 && m_penetrance.size() != static_cast<UINT>(pow(2., static_cast<double>(loci.size())))),
 		ValueError, "Please specify penetrance for each combination of genotype.");
+	DBG_FAILIF(ind->ploidy() > 2, ValueError, "The MaPenetrance only supports haploid and diploid populations.");
 
-	for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc) {
-		if (ind->ploidy() == 1) {
-			Allele a = TO_ALLELE(ind->allele(*loc));
-			if (singleST)
-				index = index * 2 + (ALLELE_AS_UNSINGED(a) != m_wildtype[0]);
-			else
-				index = index * 2 + (find(m_wildtype.begin(), m_wildtype.end(), ALLELE_AS_UNSINGED(a)) == m_wildtype.end());
-		} else if (ind->ploidy() == 2) {
-			// get genotype of ind
-			Allele a = TO_ALLELE(ind->allele(*loc, 0));
-			Allele b = TO_ALLELE(ind->allele(*loc, 1));
-
-			int numWildtype = 0;
-
-			// count number of wildtype
-			// this improve the performance a little bit
-			if (singleST) {
-				numWildtype = (ALLELE_AS_UNSINGED(a) == m_wildtype[0]) + (ALLELE_AS_UNSINGED(b) == m_wildtype[0]);
-			} else {
-				if (find(m_wildtype.begin(), m_wildtype.end(), ALLELE_AS_UNSINGED(a)) != m_wildtype.end())
-					numWildtype++;
+	return m_penetrance[m_index.index(*ind, loci)];
+}
 
-				if (find(m_wildtype.begin(), m_wildtype.end(), ALLELE_AS_UNSINGED(b)) != m_wildtype.end())
-					numWildtype++;
-			}
 
-			index = index * 3 + 2 - numWildtype;
-		} else {
-			DBG_FAILIF(true, ValueError, "The MaPenetrance only supports haploid and diploid populations.");
-		}
+// this function is the same as MaSelector::batchFitness
+void MaPenetrance::batchPenet(Population * /* pop */, const vector<RawIndIterator> & inds,
+                              size_t first, size_t last, vectorf & values) const
+{
+	if (first == last) {
+		values.clear();
+		return;
 	}
-	return m_penetrance[index];
+	const vectoru & loci = m_loci.elems(&*inds[first]);
+
+	DBG_FAILIF((inds[first]->ploidy() == 2 && m_penetrance.size() != static_cast<UINT>(pow(3., static_cast<double>(loci.size())))) ||
+		(inds[first]->ploidy() == 1 && m_penetrance.size() != static_cast<UINT>(pow(2., static_cast<double>(loci.size())))),
+		ValueError, "Please specify penetrance for each combination of genotype.");
+	DBG_FAILIF(inds[first]->ploidy() > 2, ValueError, "The MaPenetrance only supports haploid and diploid populations.");
+
+	vectoru indexes;
+	m_index.index(inds, first, last, loci, indexes);
+	values.resize(last - first);
+	for (size_t i = 0; i < indexes.size(); ++i)
+		values[i] = m_penetrance[indexes[i]];
 }
 
 
@@ -327,6 +258,19 @@ private:
 };
 
 
+bool MlPenetrance::canApplyConcurrently() const
+{
+	if (!noOutput())
+		return false;
+	opList::const_iterator it = m_peneOps.begin();
+	opList::const_iterator itEnd = m_peneOps.end();
+	for (; it != itEnd; ++it)
+		if (!(*it)->canApplyConcurrently())
+			return false;
+	return true;
+}
+
+
 double MlPenetrance::penet(Population * pop, RawIndIterator ind) const
 {
 	PenetranceAccumulator p(m_mode);
@@ -345,9 +289,44 @@ double MlPenetrance::penet(Population * pop, RawIndIterator ind) const
 }
 
 
+void MlPenetrance::batchPenet(Population * pop, const vector<RawIndIterator> & inds,
+                              size_t first, size_t last, vectorf & values) const
+{
+	vector<PenetranceAccumulator> pene(last - first, PenetranceAccumulator(m_mode));
+	vectorf opValues;
+
+	vectorop::const_iterator s = m_peneOps.begin();
+	vectorop::const_iterator sEnd = m_peneOps.end();
+
+	for (; s != sEnd; ++s) {
+		if (pop && !(*s)->isActive(pop->rep(), pop->gen()))
+			continue;
+		const BasePenetrance * op = dynamic_cast<const BasePenetrance *>(*s);
+		if (!pop || (*s)->applicableToAllOffspring()) {
+			op->batchPenet(pop, inds, first, last, opValues);
+			for (size_t i = 0; i < opValues.size(); ++i)
+				pene[i].push(opValues[i]);
+		} else {
+			for (size_t i = first; i < last; ++i)
+				if ((*s)->applicableToOffspring(*pop, inds[i]))
+					pene[i - first].push(op->penet(pop, inds[i]));
+		}
+	}
+	values.resize(last - first);
+	for (size_t i = 0; i < pene.size(); ++i)
+		values[i] = pene[i].value();
+}
+
+
 // the same as PyPenetrance
 double PyPenetrance::penet(Population * pop, RawIndIterator ind) const
 {
+	if (m_cache.enabled()) {
+		const vectorf * cached = m_cache.find(*ind, m_loci.elems(&*ind), pop ? pop->gen() : 0);
+		if (cached)
+			return (*cached)[0];
+	}
+
 	PyObject * args = PyTuple_New(m_func.numArgs());
 
 	DBG_ASSERT(args, RuntimeError, "Failed to create a parameter tuple");
@@ -376,6 +355,8 @@ double PyPenetrance::penet(Population * pop, RawIndIterator ind) const
 
 	double penetrance = m_func(PyObj_As_Double, args);
 	Py_XDECREF(args);
+	if (m_cache.enabled())
+		m_cache.insert(vectorf(1, penetrance));
 	return penetrance;
 }
 
@@ -111,6 +111,26 @@ public:
 	}
 
 
+	/** CPPONLY
+	 *  calculate penetrance values of individuals <tt>inds[first:last]</tt>
+	 *  and save them to \e values, which will be resized to
+	 *  <tt>last - first</tt>. The default implementation calls \c penet for
+	 *  each individual.
+	 */
+	virtual void batchPenet(Population * pop, const vector<RawIndIterator> & inds,
+		size_t first, size_t last, vectorf & values) const;
+
+	/** CPPONLY
+	 *  Return \c True if \c batchPenet is faster than calling \c penet for
+	 *  each individual, so individuals are collected and evaluated in blocks
+	 *  even if the operator is applied by a single thread.
+	 */
+	virtual bool batchable() const
+	{
+		return false;
+	}
+
+
 	/// set penetrance to all individuals and record penetrance if requested
 	virtual bool apply(Population & pop) const;
 
@@ -158,14 +178,16 @@ public:
 	 *  genotype still can not be found, a \c ValueError will be raised. This
 	 *  operator supports sex chromosomes and haplodiploid populations. In
 	 *  these cases, only valid genotypes should be used to generator the
-	 *  dictionary keys.
+	 *  dictionary keys. If the number of possible genotypes is small, the
+	 *  dictionary is expanded into a table of penetrance values of all
+	 *  genotypes so that penetrance can be looked up directly.
 	 */
 	MapPenetrance(const lociList & loci, const tupleDict & penetrance,
 		const uintList & ancGens = uintList(NULL), int begin = 0, int end = -1, int step = 1,
 		const intList & at = vectori(), const intList & reps = intList(), const subPopList & subPops = subPopList(),
 		const stringList & infoFields = vectorstr()) :
 		BasePenetrance(ancGens, begin, end, step, at, reps, subPops, infoFields),
-		m_loci(loci), m_dict(penetrance)
+		m_loci(loci), m_table(penetrance, "penetrance")
 	{
 	};
 
@@ -185,6 +207,14 @@ public:
 	/// CPPONLY
 	virtual double penet(Population * pop, RawIndIterator ind) const;
 
+	/// CPPONLY
+	virtual void initializeIfNeeded(const Individual & ind) const
+	{
+		if (!m_loci.fromFunc())
+			m_table.compile(ind, m_loci.elems(&ind));
+	}
+
+
 	/// HIDDEN
 	string describe(bool format = true) const
 	{
@@ -200,12 +230,19 @@ public:
 	}
 
 
+	/// CPPONLY
+	bool canApplyConcurrently() const
+	{
+		return noOutput();
+	}
+
+
 private:
 	/// one locus
 	const lociList m_loci;
 
 	/// penetrance for each genotype
-	const tupleDict m_dict;
+	const GenoValueTable m_table;
 };
 
 /** This operator is called a 'multi-allele' penetrance operator because it
@@ -245,7 +282,7 @@ public:
 		const intList & at = vectori(), const intList & reps = intList(), const subPopList & subPops = subPopList(),
 		const stringList & infoFields = vectorstr()) :
 		BasePenetrance(ancGens, begin, end, step, at, reps, subPops, infoFields),
-		m_loci(loci), m_penetrance(penetrance), m_wildtype(wildtype.elems())
+		m_loci(loci), m_penetrance(penetrance), m_index(wildtype.elems())
 	{
 		DBG_ASSERT(m_penetrance.size() == static_cast<UINT>(pow(static_cast<double>(3),
 																static_cast<double>(m_loci.size()))),
@@ -269,6 +306,17 @@ public:
 	 */
 	virtual double penet(Population * pop, RawIndIterator ind) const;
 
+	/// CPPONLY
+	virtual void batchPenet(Population * pop, const vector<RawIndIterator> & inds,
+		size_t first, size_t last, vectorf & values) const;
+
+	/// CPPONLY
+	bool batchable() const
+	{
+		return true;
+	}
+
+
 	/// HIDDEN
 	string describe(bool format = true) const;
 
@@ -279,6 +327,13 @@ public:
 	}
 
 
+	/// CPPONLY
+	bool canApplyConcurrently() const
+	{
+		return noOutput();
+	}
+
+
 private:
 	/// one locus
 	const lociList m_loci;
@@ -286,8 +341,8 @@ private:
 	/// penetrance for each genotype
 	const vectorf m_penetrance;
 
-	///
-	const vectoru m_wildtype;
+	/// index of genotypes in m_penetrance
+	const WildtypeGenoIndex m_index;
 };
 
 /** This penetrance operator is created by a list of penetrance operators. When
@@ -347,6 +402,28 @@ public:
 	 */
 	virtual double penet(Population * pop, RawIndIterator ind) const;
 
+	/// CPPONLY
+	virtual void batchPenet(Population * pop, const vector<RawIndIterator> & inds,
+		size_t first, size_t last, vectorf & values) const;
+
+	/// CPPONLY
+	bool batchable() const
+	{
+		return true;
+	}
+
+
+	/// CPPONLY initialize all penetrance operators before they are applied in parallel
+	virtual void initializeIfNeeded(const Individual & ind) const
+	{
+		opList::const_iterator p = m_peneOps.begin();
+		opList::const_iterator pEnd = m_peneOps.end();
+
+		for (; p != pEnd; ++p)
+			(*p)->initializeIfNeeded(ind);
+	}
+
+
 	/// HIDDEN
 	string describe(bool format = true) const
 	{
@@ -362,6 +439,10 @@ public:
 	}
 
 
+	/// CPPONLY
+	bool canApplyConcurrently() const;
+
+
 private:
 	/// a list of peneOps
 	const opList m_peneOps;
@@ -396,6 +477,10 @@ public:
 	 *  of chromosome position pairs, \c ALL_AVAIL, or a function with optional
 	 *  parameter \c pop that will be called at each ganeeration to determine
 	 *  indexes of loci. The return value will be treated as Individual penetrance.
+	 *  If \e cache is set to \c True, penetrance values are cached for each
+	 *  distinct genotype (and values of requested information fields) so that
+	 *  \e func is called only once for individuals with the same genotype
+	 *  (see \c PySelector for details).
 	 */
 	PyPenetrance(PyObject * func,
 		const lociList & loci = vectoru(),
@@ -403,9 +488,9 @@ public:
 		int begin = 0, int end = -1, int step = 1,
 		const intList & at = vectori(), const intList & reps = intList(),
 		const subPopList & subPops = subPopList(),
-		const stringList & infoFields = vectorstr()) :
+		const stringList & infoFields = vectorstr(), bool cache = false) :
 		BasePenetrance(ancGens, begin, end, step, at, reps, subPops, infoFields),
-		m_func(func), m_loci(loci)
+		m_func(func), m_loci(loci), m_cache(m_func, cache)
 	{
 		DBG_ASSERT(m_func.isValid(), ValueError, "Passed variable is not a callable python function.");
 	};
@@ -423,6 +508,25 @@ public:
 	 */
 	virtual double penet(Population * pop, RawIndIterator ind) const;
 
+	/** Clear values cached for distinct genotypes and reset the number of
+	 *  hits and misses of the cache (if \e cache is \c True).
+	 */
+	void clearCache()
+	{
+		m_cache.clear(true);
+	}
+
+
+	/** Return the number of cache hits and misses, namely the number of
+	 *  individuals that are assigned a cached value and the number of calls
+	 *  to the user-defined function (if \e cache is \c True).
+	 */
+	vectoru cacheStats() const
+	{
+		return m_cache.stats();
+	}
+
+
 	/// HIDDEN
 	string describe(bool format = true) const
 	{
@@ -444,6 +548,9 @@ private:
 
 	/// susceptibility loci
 	const lociList m_loci;
+
+	/// penetrance values of distinct genotypes
+	mutable GenoValueCache m_cache;
 };
 
 
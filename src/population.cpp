@@ -36,6 +36,10 @@
 using std::max;
 using std::max_element;
 
+// defined in customizedTypes.c which is included in simuPOP_wrap.cpp
+extern "C" PyObject * newinfoviewobject(PyObject * owner, double * buf, size_t shape,
+	size_t stride, size_t * exports);
+
 namespace simuPOP {
 
 Population::Population(const uintList & size,
@@ -48,7 +52,8 @@ Population::Population(const uintList & size,
 	const stringMatrix & alleleNames,
 	const stringList & lociNames,
 	const stringList & subPopNames,
-	const stringList & infoFields)
+	const stringList & infoFields,
+	bool infoByColumn)
 	:
 	GenoStruTrait(),
 	m_popSize(0),
@@ -66,7 +71,14 @@ Population::Population(const uintList & size,
 	m_vars(NULL, true),
 	m_ancestralPops(0),
 	m_curAncestralGen(0),
+	m_compressDepth(-1),
+	m_shareHaplotypes(false),
 	m_indOrdered(true),
+	m_infoByColumn(infoByColumn),
+	m_infoViews(new size_t(1)),
+	m_vspMembers(),
+	m_vspMembersKey(),
+	m_activatedVSP(InvalidValue),
 	m_gen(0),
 	m_rep(0)
 {
@@ -102,6 +114,11 @@ Population::~Population()
 	DBG_DO(DBG_POPULATION,
 		cerr << "Destructor of population is called" << endl);
 
+	DBG_WARNIF(*m_infoViews > 1, "Population is destroyed when its information fields are viewed by infoView.");
+	// views that are still alive release the counter
+	if (--*m_infoViews == 0)
+		delete m_infoViews;
+
 	if (m_vspSplitter)
 		delete m_vspSplitter;
 
@@ -125,7 +142,14 @@ Population::Population(const Population & rhs) :
 	m_ancestralGens(rhs.m_ancestralGens),
 	m_vars(rhs.m_vars),                                                                     // variables will be copied
 	m_curAncestralGen(rhs.m_curAncestralGen),
+	m_compressDepth(rhs.m_compressDepth),
+	m_shareHaplotypes(rhs.m_shareHaplotypes),
 	m_indOrdered(true),
+	m_infoByColumn(rhs.m_infoByColumn),
+	m_infoViews(new size_t(1)),
+	m_vspMembers(),
+	m_vspMembersKey(),
+	m_activatedVSP(InvalidValue),
 	m_gen(rhs.m_gen),
 	m_rep(rhs.m_rep)
 {
@@ -154,7 +178,8 @@ Population::Population(const Population & rhs) :
 	// copy genotype one by one so Individual genoPtr will not
 	// point outside of subpopulation region.
 	InfoIterator infoPtr = m_info.begin();
-	size_t infoStep = infoSize();
+	size_t infoStep = indInfoStep();
+	size_t fieldStep = fieldInfoStep(m_popSize);
 	size_t step = genoSize();
 	GenoIterator ptr = m_genotype.begin();
 #ifdef LINEAGE
@@ -165,7 +190,7 @@ Population::Population(const Population & rhs) :
 	for (size_t i = 0; i < m_popSize; ++i, ptr += step, infoPtr += infoStep) {
 #endif
 		m_inds[i].setGenoPtr(ptr);
-		m_inds[i].setInfoPtr(infoPtr);
+		m_inds[i].setInfoPtr(infoPtr, fieldStep);
 		m_inds[i].copyFrom(rhs.m_inds[i]);
 	}
 
@@ -197,9 +222,14 @@ Population::Population(const Population & rhs) :
 			size_t ps = rinds.size();
 
 			for (size_t i = 0; i < ps; ++i) {
-				linds[i].setGenoPtr(lg + (rinds[i].genoPtr() - rg));
-				linds[i].setInfoPtr(li + (rinds[i].infoPtr() - ri));
-				LINEAGE_EXPR(linds[i].setLineagePtr(rinds[i].lineagePtr() - rlin + llin));
+				// shared or compressed generations have no genotype to point to
+				if (!lp.shared() && !lp.compressed())
+					linds[i].setGenoPtr(lg + (rinds[i].genoPtr() - rg));
+				linds[i].setInfoPtr(li + (rinds[i].infoPtr() - ri), rinds[i].infoStep());
+#ifdef LINEAGE
+				if (!lp.compressed())
+					linds[i].setLineagePtr(rinds[i].lineagePtr() - rlin + llin);
+#endif
 			}
 		}
 	} catch (...) {
@@ -217,6 +247,7 @@ Population::Population(const Population & rhs) :
 
 void Population::popData::swap(Population & pop)
 {
+	materialize();
 #ifdef MUTANTALLELE
 	size_t genoSize = 0;
 	if (m_inds.size() != 0)
@@ -230,6 +261,7 @@ void Population::popData::swap(Population & pop)
 	pop.m_info.swap(m_info);
 	pop.m_inds.swap(m_inds);
 	std::swap(pop.m_indOrdered, m_indOrdered);
+	pop.m_idIndex.swap(m_idIndex);
 #ifdef MUTANTALLELE
 	// vectorm must be setGenoPtr after swap
 	GenoIterator ptr = pop.m_genotype.begin();
@@ -242,6 +274,289 @@ void Population::popData::swap(Population & pop)
 }
 
 
+#ifndef MUTANTALLELE
+// hash of alleles in [it, end), used to look for identical chromosome copies
+static size_t hashAlleles(GenoIterator it, GenoIterator end)
+{
+	size_t h = 0;
+
+	for (; it != end; ++it)
+		h ^= static_cast<size_t>(*it) + 0x9e3779b9 + (h << 6) + (h >> 2);
+	return h;
+}
+
+
+// number of bytes used by a vectora to store n alleles
+static size_t alleleBytes(size_t n)
+{
+#  ifdef BINARYALLELE
+	return (n + WORDBIT - 1) / WORDBIT * sizeof(WORDTYPE);
+#  else
+	return n * sizeof(Allele);
+#  endif
+}
+
+
+// raw storage of alleles in a vectora
+static char * alleleData(vectora & alleles)
+{
+#  ifdef BINARYALLELE
+	return reinterpret_cast<char *>(BITPTR(alleles.begin()));
+#  else
+	return reinterpret_cast<char *>(&alleles[0]);
+#  endif
+}
+
+
+#endif
+
+void Population::popData::materialize()
+{
+#ifndef MUTANTALLELE
+	if (m_haplotypes.empty() && m_compressed.empty())
+		return;
+
+	// use the structure of individuals because the population might
+	// already have a new structure when this generation is materialized
+	const GenoStruTrait & geno = m_inds[0];
+	const size_t genoSize = geno.genoSize();
+	m_genotype.resize(m_inds.size() * genoSize);
+	if (!m_compressed.empty()) {
+		boost::iostreams::filtering_istream in;
+		in.push(boost::iostreams::zlib_decompressor());
+		in.push(boost::iostreams::array_source(m_compressed.data(), m_compressed.size()));
+		// a truncated or corrupt generation must never be used as genotypes,
+		// so this is checked in optimized modules as well
+		bool ok = true;
+		try {
+			in.read(alleleData(m_genotype), alleleBytes(m_genotype.size()));
+#  ifdef LINEAGE
+			m_lineage.resize(m_genotype.size());
+			in.read(reinterpret_cast<char *>(&m_lineage[0]), m_lineage.size() * sizeof(m_lineage[0]));
+#  endif
+			ok = !in.fail();
+		} catch (const std::exception &) {
+			ok = false;
+		}
+		if (!ok)
+			throw SystemError("Failed to decompress genotypes of an ancestral generation");
+#  ifdef LINEAGE
+		LineageIterator lin = m_lineage.begin();
+		for (size_t i = 0; i < m_inds.size(); ++i, lin += genoSize)
+			m_inds[i].setLineagePtr(lin);
+#  endif
+		string().swap(m_compressed);
+	}
+	GenoIterator ptr = m_genotype.begin();
+	vector<HaplotypePtr>::const_iterator hap = m_haplotypes.begin();
+	for (size_t i = 0; i < m_inds.size(); ++i, ptr += genoSize) {
+		m_inds[i].setGenoPtr(ptr);
+		if (m_haplotypes.empty())
+			continue;
+		for (size_t p = 0; p < geno.ploidy(); ++p) {
+			for (size_t ch = 0; ch < geno.numChrom(); ++ch, ++hap) {
+				vectora & alleles = (*hap)->alleles;
+				GenoIterator to = ptr + p * geno.totNumLoci() + geno.chromBegin(ch);
+#  ifdef BINARYALLELE
+				copyGenotype(alleles.begin(), to, alleles.size());
+#  else
+				std::copy(alleles.begin(), alleles.end(), to);
+#  endif
+			}
+		}
+	}
+	// this generation no longer shares haplotypes with others
+	vector<HaplotypePtr>().swap(m_haplotypes);
+#endif
+}
+
+
+void Population::popData::compress()
+{
+#ifndef MUTANTALLELE
+	if (shared() || compressed() || m_inds.empty() || m_genotype.empty())
+		return;
+
+	const size_t genoSize = m_inds[0].genoSize();
+	// genotypes are compressed in the order of individuals
+	bool ordered = m_genotype.size() == m_inds.size() * genoSize;
+	GenoIterator ptr = m_genotype.begin();
+	LINEAGE_EXPR(LineageIterator lin = m_lineage.begin());
+	for (size_t i = 0; i < m_inds.size() && ordered; ++i, ptr += genoSize) {
+		ordered = m_inds[i].genoPtr() == ptr;
+		LINEAGE_EXPR(ordered = ordered && m_inds[i].lineagePtr() == lin);
+		LINEAGE_EXPR(lin += genoSize);
+	}
+	if (!ordered) {
+		vectora genotype(m_inds.size() * genoSize);
+		ptr = genotype.begin();
+		for (size_t i = 0; i < m_inds.size(); ++i, ptr += genoSize) {
+#  ifdef BINARYALLELE
+			copyGenotype(m_inds[i].genoPtr(), ptr, genoSize);
+#  else
+			std::copy(m_inds[i].genoPtr(), m_inds[i].genoPtr() + genoSize, ptr);
+#  endif
+			m_inds[i].setGenoPtr(ptr);
+		}
+		m_genotype.swap(genotype);
+#  ifdef LINEAGE
+		vectori lineage(m_genotype.size());
+		lin = lineage.begin();
+		for (size_t i = 0; i < m_inds.size(); ++i, lin += genoSize) {
+			std::copy(m_inds[i].lineagePtr(), m_inds[i].lineagePtr() + genoSize, lin);
+			m_inds[i].setLineagePtr(lin);
+		}
+		m_lineage.swap(lineage);
+#  endif
+	}
+
+	size_t rawBytes = alleleBytes(m_genotype.size());
+	{
+		boost::iostreams::filtering_ostream out;
+		out.push(boost::iostreams::zlib_compressor(boost::iostreams::zlib::best_speed));
+		out.push(boost::iostreams::back_inserter(m_compressed));
+		out.write(alleleData(m_genotype), rawBytes);
+#  ifdef LINEAGE
+		out.write(reinterpret_cast<const char *>(&m_lineage[0]), m_lineage.size() * sizeof(m_lineage[0]));
+		rawBytes += m_lineage.size() * sizeof(m_lineage[0]);
+#  endif
+	}
+	// not worth it
+	if (m_compressed.size() >= rawBytes) {
+		string().swap(m_compressed);
+		return;
+	}
+	vectora().swap(m_genotype);
+	LINEAGE_EXPR(vectori().swap(m_lineage));
+#endif
+}
+
+
+void Population::shareHaplotypes(size_t genIdx)
+{
+#ifndef MUTANTALLELE
+#  if TR1_SUPPORT == 0
+	typedef std::multimap<size_t, HaplotypePtr> HaplotypeIndex;
+#  else
+	typedef std::tr1::unordered_multimap<size_t, HaplotypePtr> HaplotypeIndex;
+#  endif
+
+	if (!m_shareHaplotypes)
+		return;
+
+	popData & pd = m_ancestralPops[genIdx];
+	if (pd.shared() || pd.compressed() || pd.m_inds.empty() || genoSize() == 0)
+		return;
+
+	const size_t numCopies = ploidy() * numChrom();
+	// The next older generation is shared together with this one if it is
+	// not shared yet because, with clonal or low-recombination inheritance,
+	// most chromosomes of this generation are copied from it.
+	popData * older = genIdx + 1 < m_ancestralPops.size() ? &m_ancestralPops[genIdx + 1] : NULL;
+	popData * gens[2] = { &pd, older != NULL && !older->shared() && !older->compressed() ? older : NULL };
+
+	// haplotypes of neighboring generations that are already shared
+	HaplotypeIndex index;
+	vectoru known;
+	popData * neighbors[2] = { genIdx > 0 ? &m_ancestralPops[genIdx - 1] : NULL, older };
+	for (size_t n = 0; n < 2; ++n) {
+		if (neighbors[n] == NULL || !neighbors[n]->shared())
+			continue;
+		vector<HaplotypePtr>::const_iterator it = neighbors[n]->m_haplotypes.begin();
+		vector<HaplotypePtr>::const_iterator it_end = neighbors[n]->m_haplotypes.end();
+		for (; it != it_end; ++it) {
+			std::pair<HaplotypeIndex::iterator, HaplotypeIndex::iterator> range = index.equal_range((*it)->hash);
+			for (; range.first != range.second; ++range.first)
+				if (range.first->second == *it)
+					break;
+			if (range.first == range.second) {
+				index.insert(std::make_pair((*it)->hash, *it));
+				known.push_back((*it)->hash);
+			}
+		}
+	}
+	std::sort(known.begin(), known.end());
+
+	// estimate memory needed to store the generations as shared haplotypes
+	vectoru hashes[2];
+	vector<std::pair<size_t, size_t> > distinct;
+	size_t numRefs = 0;
+	size_t rawBytes = 0;
+	for (size_t g = 0; g < 2; ++g) {
+		if (gens[g] == NULL)
+			continue;
+		vector<Individual> & inds = gens[g]->m_inds;
+		hashes[g].reserve(inds.size() * numCopies);
+		for (size_t i = 0; i < inds.size(); ++i) {
+			GenoIterator ptr = inds[i].genoPtr();
+			for (size_t p = 0; p < ploidy(); ++p) {
+				for (size_t ch = 0; ch < numChrom(); ++ch) {
+					GenoIterator begin = ptr + p * totNumLoci() + chromBegin(ch);
+					size_t h = hashAlleles(begin, begin + numLoci(ch));
+					hashes[g].push_back(h);
+					distinct.push_back(std::make_pair(h, ch));
+				}
+			}
+		}
+		numRefs += hashes[g].size();
+		rawBytes += alleleBytes(gens[g]->m_genotype.size());
+	}
+	std::sort(distinct.begin(), distinct.end());
+	distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+	size_t sharedBytes = numRefs * sizeof(HaplotypePtr);
+	for (size_t i = 0; i < distinct.size(); ++i)
+		if (!std::binary_search(known.begin(), known.end(), distinct[i].first))
+			sharedBytes += sizeof(haplotype) + 2 * sizeof(HaplotypePtr) + alleleBytes(numLoci(distinct[i].second));
+	if (sharedBytes >= rawBytes)
+		return;
+
+	DBG_DO(DBG_POPULATION, cerr << "Sharing haplotypes of ancestral generation " << genIdx + 1
+		                        << ": " << rawBytes << " bytes stored in " << sharedBytes << " bytes" << endl);
+
+	for (size_t g = 0; g < 2; ++g) {
+		if (gens[g] == NULL)
+			continue;
+		vector<Individual> & inds = gens[g]->m_inds;
+		vector<HaplotypePtr> & haps = gens[g]->m_haplotypes;
+		haps.resize(inds.size() * numCopies);
+		vector<HaplotypePtr>::iterator hap = haps.begin();
+		vectoru::const_iterator h = hashes[g].begin();
+		for (size_t i = 0; i < inds.size(); ++i) {
+			GenoIterator ptr = inds[i].genoPtr();
+			for (size_t p = 0; p < ploidy(); ++p) {
+				for (size_t ch = 0; ch < numChrom(); ++ch, ++hap, ++h) {
+					GenoIterator begin = ptr + p * totNumLoci() + chromBegin(ch);
+					size_t len = numLoci(ch);
+					std::pair<HaplotypeIndex::iterator, HaplotypeIndex::iterator> range = index.equal_range(*h);
+					for (; range.first != range.second; ++range.first) {
+						vectora & alleles = range.first->second->alleles;
+						if (alleles.size() == len && std::equal(alleles.begin(), alleles.end(), begin))
+							break;
+					}
+					if (range.first != range.second) {
+						*hap = range.first->second;
+					} else {
+						HaplotypePtr newHap(new haplotype());
+						newHap->hash = *h;
+#  ifdef BINARYALLELE
+						newHap->alleles.resize(len);
+						copyGenotype(begin, newHap->alleles.begin(), len);
+#  else
+						newHap->alleles.assign(begin, begin + len);
+#  endif
+						index.insert(std::make_pair(*h, newHap));
+						*hap = newHap;
+					}
+				}
+			}
+		}
+		// genotypes are copied back by materialize() when they are needed
+		vectora().swap(gens[g]->m_genotype);
+	}
+#endif
+}
+
+
 Population * Population::clone() const
 {
 	return new Population(*this);
@@ -315,6 +630,7 @@ void Population::setVirtualSplitter(BaseVspSplitter * vsp)
 		delete m_vspSplitter;
 
 	m_vspSplitter = vsp ? vsp->clone() : NULL;
+	m_vspMembersKey.clear();
 }
 
 
@@ -335,6 +651,26 @@ void Population::activateVirtualSubPop(vspID subPop) const
 	m_vspSplitter->activate(*this, subPop.subPop(), subPop.virtualSubPop());
 	DBG_ASSERT(m_vspSplitter->activatedSubPop() == subPop.subPop(), SystemError,
 		"Failed to activate virtual subpopulation");
+	// index members of the VSP so that iterators and size queries do not
+	// have to check the visibility of each individual again. The index is
+	// reused if membership depends only on positions of individuals in a
+	// subpopulation that has not been moved or resized since.
+	vectoru key(4);
+	key[0] = subPop.subPop();
+	key[1] = subPop.virtualSubPop();
+	key[2] = m_subPopIndex[subPop.subPop()];
+	key[3] = m_subPopIndex[subPop.subPop() + 1];
+	if (key != m_vspMembersKey) {
+		m_vspMembers.clear();
+		for (size_t i = key[2]; i < key[3]; ++i)
+			if (m_inds[i].visible())
+				m_vspMembers.push_back(i);
+		if (m_vspSplitter->positional())
+			m_vspMembersKey.swap(key);
+		else
+			m_vspMembersKey.clear();
+	}
+	m_activatedVSP = subPop.virtualSubPop();
 }
 
 
@@ -344,6 +680,9 @@ void Population::deactivateVirtualSubPop(size_t subPop) const
 	if (!hasActivatedVirtualSubPop(subPop))
 		return;
 	m_vspSplitter->deactivate(subPop);
+	m_activatedVSP = InvalidValue;
+	if (m_vspMembersKey.empty())
+		m_vspMembers.clear();
 }
 
 
@@ -384,6 +723,92 @@ int Population::__cmp__(const Population & rhs) const
 }
 
 
+void IdIndex::build(const vector<Individual> & inds, size_t idIdx)
+{
+	// keep the table at most half full
+	size_t capacity = 16;
+
+	while (capacity < 2 * inds.size())
+		capacity <<= 1;
+	m_mask = capacity - 1;
+	m_ids.assign(capacity, 0);
+	m_indexes.assign(capacity, InvalidValue);
+	m_lastIndexes.clear();
+	for (size_t i = 0; i < inds.size(); ++i) {
+		size_t id = toID(inds[i].info(idIdx));
+		size_t slot = hash(id);
+		while (m_indexes[slot] != InvalidValue && m_ids[slot] != id)
+			slot = (slot + 1) & m_mask;
+		// both the first and the last individuals are kept if several
+		// individuals share an ID
+		if (m_indexes[slot] == InvalidValue) {
+			m_ids[slot] = id;
+			m_indexes[slot] = i;
+		} else
+			m_lastIndexes[id] = i;
+	}
+	m_idIdx = idIdx;
+	m_size = inds.size();
+}
+
+
+void Population::buildIDIndex(size_t gen, size_t idIdx, bool force) const
+{
+	const vector<Individual> * inds = &m_inds;
+	IdIndex * index = &m_idIndex;
+
+	if (static_cast<int>(gen) != m_curAncestralGen) {
+		popData & pd = m_ancestralPops[gen == 0 ? m_curAncestralGen - 1 : gen - 1];
+		inds = &pd.m_inds;
+		index = &pd.m_idIndex;
+	}
+	if (force || !index->built(inds->size(), idIdx))
+		index->build(*inds, idIdx);
+}
+
+
+Individual * Population::findIndByID(size_t id, size_t gen, size_t idIdx, bool rebuild, bool last) const
+{
+	const vector<Individual> * inds = &m_inds;
+	IdIndex * index = &m_idIndex;
+
+	if (static_cast<int>(gen) != m_curAncestralGen) {
+		popData & pd = m_ancestralPops[gen == 0 ? m_curAncestralGen - 1 : gen - 1];
+		inds = &pd.m_inds;
+		index = &pd.m_idIndex;
+	}
+	if (inds->empty())
+		return NULL;
+	bool fresh = false;
+	if (!index->built(inds->size(), idIdx)) {
+		if (!rebuild)
+			throw RuntimeError("Individuals cannot be looked up by ID because IDs have not been indexed.");
+		index->build(*inds, idIdx);
+		fresh = true;
+	}
+
+	size_t idx = index->find(id, last);
+	// the ID might have been assigned or changed after the index was built
+	if (idx == InvalidValue || toID((*inds)[idx].info(idIdx)) != id) {
+		if (!rebuild || fresh)
+			return NULL;
+		index->build(*inds, idIdx);
+		idx = index->find(id, last);
+		if (idx == InvalidValue)
+			return NULL;
+	}
+	return const_cast<Individual *>(&(*inds)[idx]);
+}
+
+
+void Population::clearIDIndex() const
+{
+	m_idIndex.clear();
+	for (size_t i = 0; i < m_ancestralPops.size(); ++i)
+		m_ancestralPops[i].m_idIndex.clear();
+}
+
+
 Individual & Population::indByID(double fid, const uintList & ancGens, const string & idField)
 {
 	size_t id = toID(fid);
@@ -400,26 +825,18 @@ Individual & Population::indByID(double fid, const uintList & ancGens, const str
 	else if (ancGens.unspecified())
 		gens.push_back(m_curAncestralGen);
 
+	// indexes are rebuilt if an ID is not found so that IDs assigned
+	// through individuals can be found.
 	for (size_t genIdx = 0; genIdx < gens.size(); ++genIdx) {
 		ssize_t gen = gens[genIdx];
-		vector<Individual> * inds = NULL;
-		// search in current, not necessarily the present generation
-		if (gen == m_curAncestralGen)
-			inds = &m_inds;
-		else
-			inds = &m_ancestralPops[gen == 0 ? m_curAncestralGen - 1 : gen - 1].m_inds;
-		// first try our luck
-		size_t startID = (*inds)[0].intInfo(idx);
-		if (idx >= startID && startID + (*inds).size() > id) {
-			Individual & ind = (*inds)[id - startID];
-			if (toID(ind.intInfo(idx)) == id)
-				return ind;
-		}
-		// now we have to search all individuals
-		for (size_t i = 0; i < (*inds).size(); ++i) {
-			if (toID((*inds)[i].intInfo(idx)) == id)
-				return (*inds)[i];
-		}
+		Individual * ind = findIndByID(id, gen, idx);
+		if (ind == NULL)
+			continue;
+		// IDs are information fields so genotypes are only materialized
+		// for the generation in which the individual is found.
+		if (gen != m_curAncestralGen)
+			ancestralData(gen == 0 ? m_curAncestralGen - 1 : gen - 1);
+		return *ind;
 	}
 	// if still cannot be found, raise an IndexError.
 	throw IndexError((boost::format("No individual with ID %1% could be found.") % id).str());
@@ -474,7 +891,7 @@ Individual & Population::ancestor(double fidx, ssize_t gen, vspID vsp)
 		ssize_t genIdx = gen == 0 ? m_curAncestralGen - 1 : gen - 1;
 		DBG_FAILIF(idx > m_ancestralPops[genIdx].m_inds.size(),
 			IndexError, "individual index out of range");
-		return m_ancestralPops[genIdx].m_inds[idx];
+		return ancestralData(genIdx).m_inds[idx];
 	} else {
 		size_t subPop = vsp.subPop();
 		if (gen == m_curAncestralGen)
@@ -489,7 +906,7 @@ Individual & Population::ancestor(double fidx, ssize_t gen, vspID vsp)
 			for (size_t i = 0; i < subPop; ++i)
 				shift += m_ancestralPops[genIdx].m_subPopSize[i];
 		}
-		return m_ancestralPops[genIdx].m_inds[shift + idx];
+		return ancestralData(genIdx).m_inds[shift + idx];
 	}
 }
 
@@ -511,7 +928,7 @@ const Individual & Population::ancestor(double fidx, ssize_t gen, vspID vsp) con
 		ssize_t genIdx = gen == 0 ? m_curAncestralGen - 1 : gen - 1;
 		DBG_FAILIF(idx > m_ancestralPops[genIdx].m_inds.size(),
 			IndexError, "individual index out of range");
-		return m_ancestralPops[genIdx].m_inds[idx];
+		return ancestralData(genIdx).m_inds[idx];
 	} else {
 		size_t subPop = vsp.subPop();
 		if (gen == m_curAncestralGen)
@@ -526,7 +943,7 @@ const Individual & Population::ancestor(double fidx, ssize_t gen, vspID vsp) con
 			for (size_t i = 0; i < subPop; ++i)
 				shift += m_ancestralPops[genIdx].m_subPopSize[i];
 		}
-		return m_ancestralPops[genIdx].m_inds[shift + idx];
+		return ancestralData(genIdx).m_inds[shift + idx];
 	}
 }
 
@@ -675,14 +1092,19 @@ PyObject * Population::lineage(vspID subPopID)
 		"This operation is not allowed when there is an activated virtual subpopulation");
 
 	syncIndPointers();
+	// buffers of the array have shape (individuals, ploidy, loci)
+	vectoru shape(3, ploidy());
+	shape[2] = totNumLoci();
 	if (!vsp.valid()) {
+		shape[0] = popSize();
 		// directly expose values. Do not copy data over.
-		return Lineage_Vec_As_NumArray(m_lineage.begin(), m_lineage.end());
+		return Lineage_Vec_As_NumArray(m_lineage.begin(), m_lineage.end(), shape);
 	} else {
 		size_t subPop = vsp.subPop();
 		CHECKRANGESUBPOP(subPop);
+		shape[0] = subPopSize(subPop);
 		// directly expose values. Do not copy data over.
-		return Lineage_Vec_As_NumArray(lineageBegin(subPop, true), lineageEnd(subPop, true));
+		return Lineage_Vec_As_NumArray(lineageBegin(subPop, true), lineageEnd(subPop, true), shape);
 	}
 	Py_INCREF(Py_None);
 	return Py_None;
@@ -710,14 +1132,19 @@ PyObject * Population::genotype(vspID subPopID)
 		"This operation is not allowed when there is an activated virtual subpopulation");
 
 	syncIndPointers();
+	// buffers of the array have shape (individuals, ploidy, loci)
+	vectoru shape(3, ploidy());
+	shape[2] = totNumLoci();
 	if (!vsp.valid()) {
+		shape[0] = popSize();
 		// directly expose values. Do not copy data over.
-		return Allele_Vec_As_NumArray(m_genotype.begin(), m_genotype.end());
+		return Allele_Vec_As_NumArray(m_genotype.begin(), m_genotype.end(), shape);
 	} else {
 		size_t subPop = vsp.subPop();
 		CHECKRANGESUBPOP(subPop);
+		shape[0] = subPopSize(subPop);
 		// directly expose values. Do not copy data over.
-		return Allele_Vec_As_NumArray(genoBegin(subPop, true), genoEnd(subPop, true));
+		return Allele_Vec_As_NumArray(genoBegin(subPop, true), genoEnd(subPop, true), shape);
 	}
 	return NULL;
 }
@@ -881,6 +1308,7 @@ void Population::fitSubPopStru(const vectoru & newSubPopSizes,
 	bool needsResize = m_popSize != newSize;
 
 	if (needsResize) {
+		checkInfoViews();
 		size_t is = infoSize();
 		size_t step = genoSize();
 		m_popSize = newSize;
@@ -908,16 +1336,18 @@ void Population::fitSubPopStru(const vectoru & newSubPopSizes,
 		}
 		// reset individual pointers
 		InfoIterator infoPtr = m_info.begin();
+		size_t infoStep = indInfoStep();
+		size_t fieldStep = fieldInfoStep(m_popSize);
 		GenoIterator ptr = m_genotype.begin();
 #ifdef LINEAGE
 		LineageIterator lineagePtr = m_lineage.begin();
-		for (size_t i = 0; i < m_popSize; ++i, ptr += step, infoPtr += is, lineagePtr += step) {
+		for (size_t i = 0; i < m_popSize; ++i, ptr += step, infoPtr += infoStep, lineagePtr += step) {
 			m_inds[i].setLineagePtr(lineagePtr);
 #else
-		for (size_t i = 0; i < m_popSize; ++i, ptr += step, infoPtr += is) {
+		for (size_t i = 0; i < m_popSize; ++i, ptr += step, infoPtr += infoStep) {
 #endif
 			m_inds[i].setGenoPtr(ptr);
-			m_inds[i].setInfoPtr(infoPtr);
+			m_inds[i].setInfoPtr(infoPtr, fieldStep);
 			m_inds[i].setGenoStruIdx(genoStruIdx());
 		}
 		setIndOrdered(true);
@@ -937,6 +1367,7 @@ void Population::fitSubPopStru(const vectoru & newSubPopSizes,
 
 void Population::fitGenoStru(size_t stru)
 {
+	checkInfoViews();
 	// set genotypic structure to a population.
 	// This function will try not to change population size.
 	size_t oldSize = genoSize();
@@ -958,17 +1389,19 @@ void Population::fitGenoStru(size_t stru)
 			m_info.resize(newInfoSize * popSize());
 		// reset structure
 		InfoIterator infoPtr = m_info.begin();
+		size_t infoStep = indInfoStep();
+		size_t fieldStep = fieldInfoStep(m_popSize);
 		GenoIterator ptr = m_genotype.begin();
 #ifdef LINEAGE
 		LineageIterator lineagePtr = m_lineage.begin();
-		for (size_t i = 0; i < m_popSize; ++i, ptr += newSize, infoPtr += newInfoSize, lineagePtr += newSize) {
+		for (size_t i = 0; i < m_popSize; ++i, ptr += newSize, infoPtr += infoStep, lineagePtr += newSize) {
 			m_inds[i].setLineagePtr(lineagePtr);
 #else
-		for (size_t i = 0; i < m_popSize; ++i, ptr += newSize, infoPtr += newInfoSize) {
+		for (size_t i = 0; i < m_popSize; ++i, ptr += newSize, infoPtr += infoStep) {
 #endif
 			m_inds[i].setGenoStruIdx(stru);
 			m_inds[i].setGenoPtr(ptr);
-			m_inds[i].setInfoPtr(infoPtr);
+			m_inds[i].setInfoPtr(infoPtr, fieldStep);
 		}
 	}
 }
@@ -1040,6 +1473,8 @@ size_t Population::popSize(int ancGen, SexChoice sex) const
 				"sex can only be one of ANY_SEX, MALE_ONLY, FEMALE_ONLY, and PAIR_ONLY.");
 		}
 	}
+	// avoid a warning message.
+	return 0;
 }
 
 
@@ -1057,10 +1492,12 @@ size_t Population::subPopSize(vspID subPopID, int ancGen, SexChoice sex) const
         if (ancGen < 0 || ancGen == m_curAncestralGen) {
             CHECKRANGESUBPOP(subPop.subPop());
             CHECKRANGEVIRTUALSUBPOP(subPop.virtualSubPop());
-            if (subPop.isVirtual())
-                return m_vspSplitter->size(*this, subPop.subPop(), subPop.virtualSubPop());
-            else
+            if (!subPop.isVirtual())
                 return m_subPopSize[subPop.subPop()];
+            else if (hasActivatedVirtualSubPop(subPop.subPop()) && m_activatedVSP == subPop.virtualSubPop())
+                return m_vspMembers.size();
+            else
+                return m_vspSplitter->size(*this, subPop.subPop(), subPop.virtualSubPop());
         } else if (subPop.isVirtual()) {
             int curGen = m_curAncestralGen;
             const_cast<Population *>(this)->useAncestralGen(ancGen);
@@ -1122,6 +1559,7 @@ void Population::sortIndividuals(const stringList & infoList, bool reverse)
 
 	if (infoFields.size() == 0)
 		return;
+	m_idIndex.clear();
 	vectoru fields(infoFields.size());
 	for (size_t i = 0; i < infoFields.size(); ++i)
 		fields[i] = infoIdx(infoFields[i]);
@@ -1137,87 +1575,109 @@ void Population::setSubPopByIndInfo(const string & field)
 		"This operation is not allowed when there is an activated virtual subpopulation");
 
 	size_t info = infoIdx(field);
-	DBG_DO(DBG_POPULATION, cerr << "Sorting individuals." << endl);
+	DBG_DO(DBG_POPULATION, cerr << "Moving individuals to new subpopulations." << endl);
+	m_idIndex.clear();
 
 	// if the population is empty, return directly (#19)
 	if (rawIndBegin() == rawIndEnd())
 		return;
-	// sort individuals first
-	parallelSort(rawIndBegin(), rawIndEnd(), indCompare(info));
-	setIndOrdered(false);
 
-	// sort individuals first
-	// remove individuals with negative index.
-	if (indIterator()->info(info) < 0) {
-		// popsize etc will be changed.
-		size_t newPopSize = m_popSize;
-		IndIterator it = indIterator();
-		for (; it.valid(); ++it) {
-			if (it->info(info) < 0)
-				newPopSize-- ;
-			else
-				break;
+	// destination of each individual, InvalidValue for individuals to be removed
+	vectoru dest(m_popSize);
+	size_t newNumSubPop = 0;
+	size_t newPopSize = 0;
+	for (size_t i = 0; i < m_popSize; ++i) {
+		double sp = m_inds[i].info(info);
+		if (sp < 0) {
+			dest[i] = InvalidValue;
+			continue;
 		}
-		// 'it' now point to the one with positive info(info)
-
-		DBG_DO(DBG_POPULATION, cerr << "New pop size" << newPopSize << endl);
-
-		// allocate new genotype and inds
-#ifdef MUTANTALLELE
-		vectorm newGenotype(genoSize() * newPopSize);
-#else
-		vectora newGenotype(genoSize() * newPopSize);
-#endif
-		LINEAGE_EXPR(vectori newLineage(genoSize() * newPopSize));
-		vectorf newInfo(newPopSize * infoSize());
-		vector<Individual> newInds(newPopSize);
-
-		// assign genotype location and set structure information for individuals
-		InfoIterator infoPtr = newInfo.begin();
+		dest[i] = static_cast<size_t>(sp);
+		if (dest[i] >= newNumSubPop)
+			newNumSubPop = dest[i] + 1;
+		++newPopSize;
+	}
+	vectoru newSubPopSize(newNumSubPop, 0);
+	for (size_t i = 0; i < m_popSize; ++i)
+		if (dest[i] != InvalidValue)
+			++newSubPopSize[dest[i]];
+
+	if (newPopSize == m_popSize && newSubPopSize == m_subPopSize) {
+		// If subpopulation sizes are unchanged, each subpopulation receives as
+		// many migrants as it sends out so migrants can take the places of
+		// each other. Only the genotypes of migrants are moved.
+		vectoru migrants;
+		for (size_t sp = 0; sp < newNumSubPop; ++sp)
+			for (size_t i = m_subPopIndex[sp]; i < m_subPopIndex[sp + 1]; ++i)
+				if (dest[i] != sp)
+					migrants.push_back(i);
+		if (migrants.empty())
+			return;
+		DBG_DO(DBG_POPULATION, cerr << "Moving " << migrants.size() << " migrants in place." << endl);
+
+		// order migrants by their destinations (stable counting sort). Because
+		// the number of immigrants and emigrants are the same for each
+		// subpopulation, the k-th immigrant takes the slot of the k-th emigrant.
+		size_t numMigrants = migrants.size();
+		vectoru offset(newNumSubPop + 1, 0);
+		for (size_t k = 0; k < numMigrants; ++k)
+			++offset[dest[migrants[k]] + 1];
+		for (size_t sp = 0; sp < newNumSubPop; ++sp)
+			offset[sp + 1] += offset[sp];
+		vectoru arrivals(numMigrants);
+		for (size_t k = 0; k < numMigrants; ++k)
+			arrivals[offset[dest[migrants[k]]]++] = migrants[k];
+
+		// copy migrants aside before they are overwritten. The temporary
+		// individuals store information fields by individual, and copyFrom
+		// copies them field by field with the step of each side so that they
+		// can be exchanged with individuals that store them by column.
 		size_t step = genoSize();
 		size_t infoStep = infoSize();
-		GenoIterator ptr = newGenotype.begin();
-#ifdef LINEAGE
-		LineageIterator lineagePtr = newLineage.begin();
-		for (size_t i = 0; i < newPopSize; ++i, ptr += step, ++it, lineagePtr += step, infoPtr += infoStep) {
-			newInds[i].setLineagePtr(lineagePtr);
+#ifdef MUTANTALLELE
+		vectorm tmpGenotype(step * numMigrants);
 #else
-		for (size_t i = 0; i < newPopSize; ++i, ptr += step, ++it, infoPtr += infoStep) {
+		vectora tmpGenotype(step * numMigrants);
 #endif
-			newInds[i].setGenoStruIdx(genoStruIdx());
-			newInds[i].setGenoPtr(ptr);
-			newInds[i].setInfoPtr(infoPtr);
-			newInds[i].copyFrom(*it);                         // copy everything, with info value
+		LINEAGE_EXPR(vectori tmpLineage(step * numMigrants));
+		vectorf tmpInfo(infoStep * numMigrants);
+		vector<Individual> tmpInds(numMigrants);
+		GenoIterator ptr = tmpGenotype.begin();
+		InfoIterator infoPtr = tmpInfo.begin();
+		LINEAGE_EXPR(LineageIterator lineagePtr = tmpLineage.begin());
+		for (size_t k = 0; k < numMigrants; ++k, ptr += step, infoPtr += infoStep) {
+			tmpInds[k].setGenoStruIdx(genoStruIdx());
+			tmpInds[k].setGenoPtr(ptr);
+			tmpInds[k].setInfoPtr(infoPtr);
+			LINEAGE_EXPR(tmpInds[k].setLineagePtr(lineagePtr));
+			LINEAGE_EXPR(lineagePtr += step);
+			tmpInds[k].copyFrom(m_inds[arrivals[k]]);
 		}
-		// now, switch!
-		m_genotype.swap(newGenotype);
-		m_info.swap(newInfo);
-		m_inds.swap(newInds);
-		LINEAGE_EXPR(m_lineage.swap(newLineage));
-		m_popSize = newPopSize;
-		setIndOrdered(true);
-#ifdef MUTANTALLELE
-		// vectorm must be setGenoPtr after swap
-		ptr = m_genotype.begin();
-		for (size_t i = 0; i < m_popSize; ++i, ptr += genoSize())
-			m_inds[i].setGenoPtr(ptr);
-
-#endif
+		for (size_t k = 0; k < numMigrants; ++k)
+			m_inds[migrants[k]].copyFrom(tmpInds[k]);
+		return;
 	}
 
+	// Otherwise, scatter individuals to their new subpopulations with a
+	// stable counting sort. Genotypes are moved later by syncIndPointers.
+	vectoru offset(newNumSubPop + 1, 0);
+	for (size_t sp = 0; sp < newNumSubPop; ++sp)
+		offset[sp + 1] = offset[sp] + newSubPopSize[sp];
+	vector<Individual> newInds(newPopSize);
+	for (size_t i = 0; i < m_popSize; ++i)
+		if (dest[i] != InvalidValue)
+			newInds[offset[dest[i]]++] = m_inds[i];
+	m_inds.swap(newInds);
+	setIndOrdered(false);
+	bool removed = newPopSize != m_popSize;
+	m_popSize = newPopSize;
+
 	if (m_inds.empty()) {
-		m_subPopSize.resize(1, 0);
+		m_subPopSize.assign(1, 0);
 		m_subPopIndex.resize(2);
 	} else {
-		// reset indexes etc.
-		size_t numSubPop = static_cast<size_t>(m_inds.back().info(info)) + 1;
-		m_subPopSize.resize(numSubPop);
-		m_subPopIndex.resize(numSubPop + 1);
-
-		// check subpop size
-		fill(m_subPopSize.begin(), m_subPopSize.end(), 0);
-		for (IndIterator it = indIterator(); it.valid(); ++it)
-			m_subPopSize[ static_cast<size_t>(it->info(info)) ]++;
+		m_subPopSize.swap(newSubPopSize);
+		m_subPopIndex.resize(m_subPopSize.size() + 1);
 	}
 	// rebuild index
 	size_t i = 1;
@@ -1226,6 +1686,9 @@ void Population::setSubPopByIndInfo(const string & field)
 	// subpopulation names
 	if (!m_subPopNames.empty())
 		m_subPopNames.resize(numSubPop(), UnnamedSubPop);
+	// release genotypes of removed individuals
+	if (removed)
+		syncIndPointers();
 }
 
 
@@ -1282,12 +1745,16 @@ vectoru Population::splitSubPop(size_t subPop, const vectorf & sizes, const vect
 
 void Population::removeSubPops(const subPopList & subPops)
 {
+	checkInfoViews();
 	syncIndPointers();
+	m_idIndex.clear();
 	vectoru new_size;
 	vectorstr new_spNames;
 
 	size_t step = genoSize();
-	size_t infoStep = infoSize();
+	// information fields stored by field are not moved with individuals but
+	// collected once, through individual info pointers, by layoutInfo
+	size_t infoStep = m_infoByColumn ? 0 : infoSize();
 	RawIndIterator oldInd = m_inds.begin();
 	RawIndIterator newInd = m_inds.begin();
 	GenoIterator oldPtr = m_genotype.begin();
@@ -1402,7 +1869,8 @@ void Population::removeSubPops(const subPopList & subPops)
 #else
 	m_genotype.erase(newPtr, m_genotype.end());
 #endif
-	m_info.erase(newInfoPtr, m_info.end());
+	if (!m_infoByColumn)
+		m_info.erase(newInfoPtr, m_info.end());
 	LINEAGE_EXPR(m_lineage.erase(newLineagePtr, m_lineage.end()));
 	m_popSize = std::accumulate(new_size.begin(), new_size.end(), size_t(0));
 	setSubPopStru(new_size, new_spNames);
@@ -1417,18 +1885,24 @@ void Population::removeSubPops(const subPopList & subPops)
 	for (size_t i = 0; i < m_popSize; ++i, ptr += step, infoPtr += infoStep) {
 #endif
 		m_inds[i].setGenoPtr(ptr);
-		m_inds[i].setInfoPtr(infoPtr);
+		if (!m_infoByColumn)
+			m_inds[i].setInfoPtr(infoPtr);
 	}
+	if (m_infoByColumn)
+		layoutInfo(true);
 }
 
 
 void Population::removeMarkedIndividuals()
 {
+	checkInfoViews();
 	syncIndPointers();
+	m_idIndex.clear();
 	vectoru new_size(numSubPop(), 0);
 
 	size_t step = genoSize();
-	size_t infoStep = infoSize();
+	// information fields stored by field are collected by layoutInfo
+	size_t infoStep = m_infoByColumn ? 0 : infoSize();
 	RawIndIterator oldInd = m_inds.begin();
 	RawIndIterator newInd = m_inds.begin();
 	InfoIterator oldInfoPtr = m_info.begin();
@@ -1488,7 +1962,8 @@ void Population::removeMarkedIndividuals()
 #else
 	m_genotype.erase(newPtr, m_genotype.end());
 #endif
-	m_info.erase(newInfoPtr, m_info.end());
+	if (!m_infoByColumn)
+		m_info.erase(newInfoPtr, m_info.end());
 	LINEAGE_EXPR(m_lineage.erase(newLineagePtr, m_lineage.end()));
 	m_popSize = std::accumulate(new_size.begin(), new_size.end(), size_t(0));
 	setSubPopStru(new_size, m_subPopNames);
@@ -1497,7 +1972,8 @@ void Population::removeMarkedIndividuals()
 	GenoIterator ptr = m_genotype.begin();
 	for (size_t i = 0; i < m_popSize; ++i, ptr += step, infoPtr += infoStep) {
 		m_inds[i].setGenoPtr(ptr);
-		m_inds[i].setInfoPtr(infoPtr);
+		if (!m_infoByColumn)
+			m_inds[i].setInfoPtr(infoPtr);
 	}
 #ifdef LINEAGE
 	LineageIterator lineagePtr = m_lineage.begin();
@@ -1505,6 +1981,8 @@ void Population::removeMarkedIndividuals()
 		m_inds[i].setLineagePtr(lineagePtr);
 	}
 #endif
+	if (m_infoByColumn)
+		layoutInfo(true);
 }
 
 
@@ -1594,6 +2072,7 @@ void Population::removeIndividuals(const uintList & indexList, const floatList &
 
 size_t Population::mergeSubPops(const uintList & subPops, const string & name, int toSubPop)
 {
+	m_idIndex.clear();
 	if (!name.empty() && m_subPopNames.empty())
 		m_subPopNames.resize(numSubPop(), UnnamedSubPop);
 
@@ -1659,6 +2138,7 @@ size_t Population::mergeSubPops(const uintList & subPops, const string & name, i
 		return sps[0];
 	}
 	// difficult case.
+	checkInfoViews();
 	syncIndPointers();
 	// find the new subpop order
 	vectoru sp_order;
@@ -1677,7 +2157,8 @@ size_t Population::mergeSubPops(const uintList & subPops, const string & name, i
 		"Incorrect resulting subpopulation number, maybe caused by duplicate entries in parameter subPops.");
 
 	size_t step = genoSize();
-	size_t infoStep = infoSize();
+	// information fields stored by field are collected by layoutInfo
+	size_t infoStep = m_infoByColumn ? 0 : infoSize();
 	vector<Individual> new_inds;
 	vectorf new_info;
 #ifdef MUTANTALLELE
@@ -1714,7 +2195,8 @@ size_t Population::mergeSubPops(const uintList & subPops, const string & name, i
 	//
 	m_inds.swap(new_inds);
 	m_genotype.swap(new_genotype);
-	m_info.swap(new_info);
+	if (!m_infoByColumn)
+		m_info.swap(new_info);
 	LINEAGE_EXPR(m_lineage.swap(new_lineage));
 	setSubPopStru(new_size, new_names);
 	//
@@ -1722,7 +2204,8 @@ size_t Population::mergeSubPops(const uintList & subPops, const string & name, i
 	GenoIterator ptr = m_genotype.begin();
 	for (size_t i = 0; i < m_popSize; ++i, ptr += step, infoPtr += infoStep) {
 		m_inds[i].setGenoPtr(ptr);
-		m_inds[i].setInfoPtr(infoPtr);
+		if (!m_infoByColumn)
+			m_inds[i].setInfoPtr(infoPtr);
 	}
 #ifdef LINEAGE
 	LineageIterator lineagePtr = m_lineage.begin();
@@ -1730,6 +2213,8 @@ size_t Population::mergeSubPops(const uintList & subPops, const string & name, i
 		m_inds[i].setLineagePtr(lineagePtr);
 	}
 #endif
+	if (m_infoByColumn)
+		layoutInfo(true);
 	return merged_idx;
 }
 
@@ -1816,6 +2301,7 @@ void Population::addChromFrom(const Population & pop)
 
 void Population::addIndFrom(const Population & pop)
 {
+	checkInfoViews();
 	DBG_FAILIF(genoStruIdx() != pop.genoStruIdx(), ValueError,
 		"Cannot add Individual from a population with different genotypic structure.");
 	DBG_FAILIF(ancestralGens() != pop.ancestralGens(), ValueError,
@@ -1823,10 +2309,14 @@ void Population::addIndFrom(const Population & pop)
 	// genotype pointers may be reset so this is needed.
 	syncIndPointers();
 	const_cast<Population &>(pop).syncIndPointers();
+	m_idIndex.clear();
 	// go to the oldest generation
 	for (int depth = ancestralGens(); depth >= 0; --depth) {
 		useAncestralGen(depth);
 		const_cast<Population &>(pop).useAncestralGen(depth);
+		// information fields stored by field in either population are
+		// collected, through individual info pointers, by layoutInfo
+		bool byRow = !m_infoByColumn && !pop.m_infoByColumn;
 		// calculate new population size
 		m_subPopSize.insert(m_subPopSize.end(), pop.m_subPopSize.begin(), pop.m_subPopSize.end());
 		// new population size
@@ -1834,7 +2324,8 @@ void Population::addIndFrom(const Population & pop)
 		//
 		m_inds.insert(m_inds.end(), pop.m_inds.begin(), pop.m_inds.end());
 		m_genotype.insert(m_genotype.end(), pop.m_genotype.begin(), pop.m_genotype.end());
-		m_info.insert(m_info.end(), pop.m_info.begin(), pop.m_info.end());
+		if (byRow)
+			m_info.insert(m_info.end(), pop.m_info.begin(), pop.m_info.end());
 		LINEAGE_EXPR(m_lineage.insert(m_lineage.end(), pop.m_lineage.begin(), pop.m_lineage.end()));
 		// iterators ready
 		InfoIterator infoPtr = m_info.begin();
@@ -1845,7 +2336,8 @@ void Population::addIndFrom(const Population & pop)
 		for (size_t i = 0; i < m_popSize; ++i, ptr += step, infoPtr += infoStep) {
 			m_inds[i].setGenoStruIdx(genoStruIdx());
 			m_inds[i].setGenoPtr(ptr);
-			m_inds[i].setInfoPtr(infoPtr);
+			if (byRow)
+				m_inds[i].setInfoPtr(infoPtr);
 		}
 #ifdef LINEAGE
 		LineageIterator lineagePtr = m_lineage.begin();
@@ -1853,6 +2345,8 @@ void Population::addIndFrom(const Population & pop)
 			m_inds[i].setLineagePtr(lineagePtr);
 		}
 #endif
+		if (!byRow)
+			layoutInfo(m_infoByColumn);
 		// rebuild index
 		m_subPopIndex.resize(numSubPop() + 1);
 		size_t j = 1;
@@ -2112,6 +2606,8 @@ void Population::resize(const uintList & sizeList, bool propagate)
 		"Resize should give subpopulation size for each subpopulation");
 
 	size_t newPopSize = accumulate(newSubPopSizes.begin(), newSubPopSizes.end(), size_t(0));
+	checkInfoViews();
+	m_idIndex.clear();
 
 	// prepare new Population
 	vector<Individual> newInds(newPopSize);
@@ -2119,7 +2615,8 @@ void Population::resize(const uintList & sizeList, bool propagate)
 	// iterators ready
 	InfoIterator infoPtr = newInfo.begin();
 	size_t step = genoSize();
-	size_t infoStep = infoSize();
+	size_t infoStep = indInfoStep();
+	size_t fieldStep = fieldInfoStep(newPopSize);
 #ifdef MUTANTALLELE
 	vectorm newGenotype(genoSize() * newPopSize);
 #else
@@ -2130,7 +2627,7 @@ void Population::resize(const uintList & sizeList, bool propagate)
 		newInds[i].setGenoStruIdx(genoStruIdx());
 		newInds[i].setGenoPtr(ptr);
 		// set pointers
-		newInds[i].setInfoPtr(infoPtr);
+		newInds[i].setInfoPtr(infoPtr, fieldStep);
 	}
 #ifdef LINEAGE
 	vectori newLineage(genoSize() * newPopSize);
@@ -2195,7 +2692,9 @@ Population & Population::extractSubPops(const subPopList & subPops, bool rearran
 	vectorstr new_spNames;
 
 	size_t step = genoSize();
-	size_t infoStep = infoSize();
+	// information fields stored by field are collected by layoutInfo of
+	// the new population, through individual info pointers
+	size_t infoStep = m_infoByColumn ? 0 : infoSize();
 
 	vector<Individual> new_inds;
 #ifdef MUTANTALLELE
@@ -2238,7 +2737,8 @@ Population & Population::extractSubPops(const subPopList & subPops, bool rearran
 #else
 				copy(oldInd->genoBegin(), oldInd->genoEnd(), newPtr);
 #endif
-				copy(oldInd->infoBegin(), oldInd->infoEnd(), newInfoPtr);
+				if (infoStep > 0)
+					copy(oldInd->infoBegin(), oldInd->infoEnd(), newInfoPtr);
 				LINEAGE_EXPR(copy(oldInd->lineageBegin(), oldInd->lineageEnd(), newLineagePtr));
 				++newInd;
 				newPtr += step;
@@ -2358,7 +2858,8 @@ Population & Population::extractSubPops(const subPopList & subPops, bool rearran
 	GenoIterator ptr = pop.m_genotype.begin();
 	for (size_t i = 0; i < pop.m_popSize; ++i, ptr += step, infoPtr += infoStep) {
 		pop.m_inds[i].setGenoPtr(ptr);
-		pop.m_inds[i].setInfoPtr(infoPtr);
+		if (!m_infoByColumn)
+			pop.m_inds[i].setInfoPtr(infoPtr);
 	}
 #ifdef LINEAGE
 	LineageIterator lineagePtr = pop.m_lineage.begin();
@@ -2366,6 +2867,8 @@ Population & Population::extractSubPops(const subPopList & subPops, bool rearran
 		pop.m_inds[i].setLineagePtr(lineagePtr);
 	}
 #endif
+	if (m_infoByColumn)
+		pop.setInfoByColumn(true);
 	return pop;
 }
 
@@ -2382,7 +2885,8 @@ Population & Population::extractMarkedIndividuals() const
 	vectoru new_size;
 
 	size_t step = genoSize();
-	size_t infoStep = infoSize();
+	// see extractSubPops
+	size_t infoStep = m_infoByColumn ? 0 : infoSize();
 	ConstRawIndIterator oldInd = m_inds.begin();
 	ConstGenoIterator oldPtr = m_genotype.begin();
 	LINEAGE_EXPR(ConstLineageIterator oldLineagePtr = m_lineage.begin());
@@ -2448,7 +2952,8 @@ Population & Population::extractMarkedIndividuals() const
 	GenoIterator ptr = pop.m_genotype.begin();
 	for (size_t i = 0; i < pop.m_popSize; ++i, ptr += step, infoPtr += infoStep) {
 		pop.m_inds[i].setGenoPtr(ptr);
-		pop.m_inds[i].setInfoPtr(infoPtr);
+		if (!m_infoByColumn)
+			pop.m_inds[i].setInfoPtr(infoPtr);
 	}
 #ifdef LINEAGE
 	LineageIterator lineagePtr = pop.m_lineage.begin();
@@ -2456,6 +2961,8 @@ Population & Population::extractMarkedIndividuals() const
 		pop.m_inds[i].setLineagePtr(lineagePtr);
 	}
 #endif
+	if (m_infoByColumn)
+		pop.setInfoByColumn(true);
 	return pop;
 }
 
@@ -2649,8 +3156,6 @@ Population & Population::extract(const lociList & extractedLoci, const stringLis
 	vectorstr::const_iterator iit_end = keptInfoFields.end();
 	for (; iit != iit_end; ++iit)
 		infoList.push_back(infoIdx(*iit));
-	vectoru::iterator infoPtr = infoList.begin();
-	vectoru::iterator infoEnd = infoList.end();
 	//
 	vectoru gens = ancGens.elems();
 	if (ancGens.allAvail())
@@ -2662,6 +3167,7 @@ Population & Population::extract(const lociList & extractedLoci, const stringLis
 
 	// ancestral depth can be -1
 	pop.setAncestralDepth(m_ancestralGens);
+	pop.m_infoByColumn = m_infoByColumn;
 	for (ssize_t genIdx = gens.size() - 1; genIdx >= 0; --genIdx) {
 		ssize_t depth = gens[genIdx];
 		const_cast<Population *>(this)->useAncestralGen(depth);
@@ -2709,11 +3215,10 @@ Population & Population::extract(const lociList & extractedLoci, const stringLis
 		vectori new_lineage;
 		new_lineage.reserve(size * step);
 #endif
-		vectorf new_info;
+		vectorf new_info(size * infoStep);
 
 		new_inds.reserve(size);
-		new_info.reserve(size * infoStep);
-		// copy genotype and info...
+		// copy genotype...
 		if (!removeInd) {
 			new_inds.insert(new_inds.end(), m_inds.begin(), m_inds.end());
 			// handle genotype
@@ -2738,18 +3243,6 @@ Population & Population::extract(const lociList & extractedLoci, const stringLis
 					}
 				}
 			}
-			// handle information fields
-			if (!removeInfo)
-				new_info.insert(new_info.end(), m_info.begin(), m_info.end());
-			else {
-				ConstRawIndIterator it = rawIndBegin();
-				ConstRawIndIterator it_end = rawIndEnd();
-				for (; it != it_end; ++it) {
-					InfoIterator iPtr = it->infoBegin();
-					for (infoPtr = infoList.begin(); infoPtr != infoEnd; ++infoPtr)
-						new_info.push_back(*(iPtr + *infoPtr));
-				}
-			}
 		} else {
 			// remove individual
 			for (size_t sp = 0; sp < indIdx.size(); ++sp) {
@@ -2777,14 +3270,6 @@ Population & Population::extract(const lociList & extractedLoci, const stringLis
 							LINEAGE_EXPR(new_lineage.push_back(*(lineagePtr + *lociPtr + p)));
 						}
 					}
-					if (!removeInfo)
-						new_info.insert(new_info.end(), m_inds[*it].infoBegin(),
-							m_inds[*it].infoEnd());
-					else {
-						InfoIterator iPtr = m_inds[*it].infoBegin();
-						for (infoPtr = infoList.begin(); infoPtr != infoEnd; ++infoPtr)
-							new_info.push_back(*(iPtr + *infoPtr));
-					}
 				}
 			}
 		}
@@ -2793,17 +3278,26 @@ Population & Population::extract(const lociList & extractedLoci, const stringLis
 			pop.setSubPopStru(spSizes, vectorstr());
 		else
 			pop.setSubPopStru(spSizes, m_subPopNames);
+		// copy kept information fields, read through individual info
+		// pointers, directly in the layout of this population
+		size_t fieldStep = m_infoByColumn ? size : 1;
+		InfoIterator newInfoPtr = new_info.begin();
+		for (size_t i = 0; i < size; ++i, newInfoPtr += m_infoByColumn ? 1 : infoStep) {
+			InfoIterator oldInfoPtr = new_inds[i].infoPtr();
+			size_t oldStep = new_inds[i].infoStep();
+			for (size_t j = 0; j < infoStep; ++j)
+				newInfoPtr[j * fieldStep] = oldInfoPtr[infoList[j] * oldStep];
+			new_inds[i].setInfoPtr(newInfoPtr, fieldStep);
+		}
 		// set pointer
-		vectorf::iterator infoPtr = new_info.begin();
 #ifdef MUTANTALLELE
 		vectorm::iterator ptr = new_genotype.begin();
 #else
 		vectora::iterator ptr = new_genotype.begin();
 #endif
-		for (size_t i = 0; i < size; ++i, ptr += step, infoPtr += infoStep) {
+		for (size_t i = 0; i < size; ++i, ptr += step) {
 			new_inds[i].setGenoStruIdx(pop.genoStruIdx());
 			new_inds[i].setGenoPtr(ptr);
-			new_inds[i].setInfoPtr(infoPtr);
 		}
 #ifdef LINEAGE
 		vectori::iterator lineagePtr = new_lineage.begin();
@@ -3097,6 +3591,7 @@ void Population::recodeAlleles(const uintListFunc & newAlleles, const lociList &
 
 void Population::push(Population & rhs)
 {
+	checkInfoViews();
 	if (rhs.genoStruIdx() != genoStruIdx()) {
 		if (m_ancestralGens > 0)
 			throw ValueError("Cannot save a population with different structure as an ancestral population to the existing population");
@@ -3121,6 +3616,8 @@ void Population::push(Population & rhs)
 		// swap with real data
 		// current population may *not* be in order
 		pd.swap(*this);
+		shareHaplotypes(0);
+		compressAncestralGens();
 	}
 
 	// then swap out data
@@ -3130,11 +3627,15 @@ void Population::push(Population & rhs)
 	m_subPopNames.swap(rhs.m_subPopNames);
 	m_subPopIndex.swap(rhs.m_subPopIndex);
 	std::swap(m_vspSplitter, rhs.m_vspSplitter);
+	m_vspMembersKey.clear();
+	rhs.m_vspMembersKey.clear();
 	m_genotype.swap(rhs.m_genotype);
 	LINEAGE_EXPR(m_lineage.swap(rhs.m_lineage));
 	m_info.swap(rhs.m_info);
 	m_inds.swap(rhs.m_inds);
 	std::swap(m_indOrdered, rhs.m_indOrdered);
+	// the index of the previous generation has been moved with it
+	m_idIndex.clear();
 
 #ifdef MUTANTALLELE
 	// vectorm must be setGenoPtr after swap
@@ -3156,6 +3657,11 @@ void Population::push(Population & rhs)
 		rhs.m_popSize = rhs.m_inds.size();
 		rhs.setSubPopStru(rhs.m_subPopSize, rhs.m_subPopNames);
 	}
+	// the two populations may store information fields differently
+	if (m_infoByColumn != rhs.m_infoByColumn) {
+		layoutInfo(m_infoByColumn);
+		rhs.layoutInfo(rhs.m_infoByColumn);
+	}
 	validate("Current population after push and discard:");
 	rhs.validate("Outside Population after push and discard:");
 }
@@ -3177,8 +3683,47 @@ vectorf Population::indInfo(const uintString & field, vspID subPopID)
 }
 
 
+PyObject * Population::infoView(const uintString & field, vspID subPopID, PyObject * owner)
+{
+	if (owner == NULL)
+		throw ValueError("The Python object of the population is required to view its information fields.");
+
+	vspID vsp = subPopID.resolve(*this);
+
+	DBG_FAILIF(vsp.isVirtual(), ValueError,
+		"Function infoView currently does not support virtual subpopulation");
+	DBG_FAILIF(hasActivatedVirtualSubPop(), ValueError,
+		"This operation is not allowed when there is an activated virtual subpopulation");
+
+	size_t idx = field.empty() ? field.value() : infoIdx(field.name());
+	// values of a field are contiguous or strided in m_info only if
+	// individuals are in order
+	syncIndPointers(true);
+
+	size_t begin = 0;
+	size_t end = popSize();
+	if (vsp.valid()) {
+		size_t subPop = vsp.subPop();
+		CHECKRANGESUBPOP(subPop);
+		begin = subPopBegin(subPop);
+		end = subPopEnd(subPop);
+	}
+	// a memoryview cannot be created from a NULL pointer
+	static double empty = 0;
+	size_t shape = end - begin;
+	double * buf = shape == 0 ? &empty : &m_info[m_infoByColumn ? idx * m_popSize + begin : begin * infoSize() + idx];
+	// the exporter of the view holds a reference to the population and
+	// to the counter m_infoViews while it is alive
+	PyObject * view = newinfoviewobject(owner, buf, shape, indInfoStep(), m_infoViews);
+	if (view == NULL)
+		throw RuntimeError("Failed to create a view of information fields.");
+	return view;
+}
+
+
 void Population::addInfoFields(const stringList & fieldList, double init)
 {
+	checkInfoViews();
 	const vectorstr & fields = fieldList.elems();
 
 	DBG_ASSERT(m_info.size() == infoSize() * popSize(), SystemError,
@@ -3215,15 +3760,19 @@ void Population::addInfoFields(const stringList & fieldList, double init)
 		int oldAncPop = m_curAncestralGen;
 		for (size_t anc = 0; anc <= m_ancestralPops.size(); anc++) {
 			useAncestralGen(anc);
-			vectorf newInfo(is * popSize(), 0.);
+			vectorf newInfo(is * popSize(), init);
 			// copy the old stuff in
 			InfoIterator ptr = newInfo.begin();
+			size_t infoStep = indInfoStep();
+			size_t fieldStep = fieldInfoStep(popSize());
 			for (IndIterator ind = indIterator(); ind.valid(); ++ind) {
-				copy(ind->infoBegin(), ind->infoBegin() + os, ptr);
-				ind->setInfoPtr(ptr);
+				InfoIterator oldPtr = ind->infoPtr();
+				size_t oldStep = ind->infoStep();
+				for (size_t i = 0; i < os; ++i)
+					ptr[i * fieldStep] = oldPtr[i * oldStep];
+				ind->setInfoPtr(ptr, fieldStep);
 				ind->setGenoStruIdx(genoStruIdx());
-				fill(ind->infoBegin() + os, ind->infoEnd(), init);
-				ptr += is;
+				ptr += infoStep;
 			}
 			m_info.swap(newInfo);
 		}
@@ -3234,6 +3783,7 @@ void Population::addInfoFields(const stringList & fieldList, double init)
 
 void Population::setInfoFields(const stringList & fieldList, double init)
 {
+	checkInfoViews();
 	const vectorstr & fields = fieldList.elems();
 
 	setGenoStructure(gsSetInfoFields(fields));
@@ -3244,8 +3794,10 @@ void Population::setInfoFields(const stringList & fieldList, double init)
 		useAncestralGen(anc);
 		vectorf newInfo(is * popSize(), init);
 		InfoIterator ptr = newInfo.begin();
-		for (IndIterator ind = indIterator(); ind.valid(); ++ind, ptr += is) {
-			ind->setInfoPtr(ptr);
+		size_t infoStep = indInfoStep();
+		size_t fieldStep = fieldInfoStep(popSize());
+		for (IndIterator ind = indIterator(); ind.valid(); ++ind, ptr += infoStep) {
+			ind->setInfoPtr(ptr, fieldStep);
 			ind->setGenoStruIdx(genoStruIdx());
 		}
 		m_info.swap(newInfo);
@@ -3256,6 +3808,7 @@ void Population::setInfoFields(const stringList & fieldList, double init)
 
 void Population::removeInfoFields(const stringList & fieldList)
 {
+	checkInfoViews();
 	const vectorstr & fields = fieldList.elems();
 
 	if (fields.size() == 0)
@@ -3283,13 +3836,16 @@ void Population::removeInfoFields(const stringList & fieldList)
 		vectorf newInfo(sz * popSize(), 0.);
 		// copy the old stuff in
 		InfoIterator ptr = newInfo.begin();
+		size_t infoStep = indInfoStep();
+		size_t fieldStep = fieldInfoStep(popSize());
 
-		for (IndIterator ind = indIterator(); ind.valid(); ++ind) {
+		for (IndIterator ind = indIterator(); ind.valid(); ++ind, ptr += infoStep) {
 			InfoIterator oldptr = ind->infoPtr();
-			ind->setInfoPtr(ptr);
+			size_t oldStep = ind->infoStep();
+			ind->setInfoPtr(ptr, fieldStep);
 			ind->setGenoStruIdx(genoStruIdx());
 			for (size_t i = 0; i < sz; ++i)
-				*(ptr++) = *(oldptr + oldIdx[i]);
+				ptr[i * fieldStep] = oldptr[oldIdx[i] * oldStep];
 		}
 		m_info.swap(newInfo);
 	}
@@ -3338,6 +3894,7 @@ void Population::setIndInfo(const floatList & valueList, const uintString &
 		"This operation is not allowed when there is an activated virtual subpopulation");
 
 	size_t idx = field.empty() ? field.value() : infoIdx(field.name());
+	m_idIndex.clear();
 
 	CHECKRANGEINFO(idx);
 	const vectorf & values = valueList.elems();
@@ -3379,6 +3936,7 @@ void Population::setAncestralDepth(int depth)
 	useAncestralGen(0);
 	//
 	if (depth >= 0 && m_ancestralPops.size() > static_cast<size_t>(depth)) {
+		checkInfoViews();
 		ssize_t numRemove = m_ancestralPops.size() - depth;
 		while (numRemove-- > 0)
 			m_ancestralPops.pop_back();
@@ -3390,8 +3948,43 @@ void Population::setAncestralDepth(int depth)
 }
 
 
+void Population::setAncestralCompression(int depth)
+{
+	m_compressDepth = depth;
+	compressAncestralGens();
+}
+
+
+void Population::setAncestralSharing(bool share)
+{
+	m_shareHaplotypes = share;
+	// older generations first so that younger ones can share with them
+	for (size_t ap = m_ancestralPops.size(); ap > 0; --ap) {
+		if (m_curAncestralGen != 0 && ap == static_cast<size_t>(m_curAncestralGen))
+			continue;
+		shareHaplotypes(ap - 1);
+	}
+}
+
+
+void Population::compressAncestralGens()
+{
+	if (m_compressDepth < 0)
+		return;
+
+	for (size_t genIdx = m_compressDepth; genIdx < m_ancestralPops.size(); ++genIdx) {
+		// this slot holds the present generation if an ancestral generation
+		// is being used
+		if (m_curAncestralGen != 0 && genIdx + 1 == static_cast<size_t>(m_curAncestralGen))
+			continue;
+		m_ancestralPops[genIdx].compress();
+	}
+}
+
+
 void Population::keepAncestralGens(const uintList & ancGens)
 {
+	checkInfoViews();
 	if (ancGens.allAvail())
 		return;
 
@@ -3422,6 +4015,11 @@ void Population::keepAncestralGens(const uintList & ancGens)
 				pd1.m_info.swap(pd.m_info);
 				pd1.m_inds.swap(pd.m_inds);
 				std::swap(pd1.m_indOrdered, pd.m_indOrdered);
+#ifndef MUTANTALLELE
+				pd1.m_haplotypes.swap(pd.m_haplotypes);
+#endif
+				pd1.m_compressed.swap(pd.m_compressed);
+				pd1.m_idIndex.swap(pd.m_idIndex);
 #ifdef MUTANTALLELE
 				GenoIterator ptr = pd1.m_genotype.begin();
 				for (size_t i = 0; i < pd1.m_inds.size(); ++i, ptr += pd1.m_genotype.size() / pd1.m_inds.size())
@@ -3450,9 +4048,13 @@ void Population::useAncestralGen(ssize_t idx)
 		" Current ancestral index: " << m_curAncestralGen << endl);
 
 	if (idx == 0 || m_curAncestralGen != 0) {         // recover pop.
-		popData & pd = m_ancestralPops[ m_curAncestralGen - 1];
+		size_t genIdx = m_curAncestralGen - 1;
+		popData & pd = m_ancestralPops[genIdx];
 		pd.swap(*this);
 		m_curAncestralGen = 0;
+		// the ancestral generation was materialized when it was used
+		shareHaplotypes(genIdx);
+		compressAncestralGens();
 		if (idx == 0) {                                               // restore key parameters from data
 			m_popSize = m_inds.size();
 			setSubPopStru(m_subPopSize, m_subPopNames);
@@ -3475,6 +4077,21 @@ void Population::useAncestralGen(ssize_t idx)
 }
 
 
+// information fields of individuals, read through their info pointers and
+// arranged by individual, which is how they are saved in text archives.
+static void infoByIndividual(const vector<Individual> & inds, size_t infoSize, vectorf & info)
+{
+	info.resize(inds.size() * infoSize);
+	InfoIterator ptr = info.begin();
+	for (size_t i = 0; i < inds.size(); ++i, ptr += infoSize) {
+		ConstInfoIterator oldPtr = inds[i].infoPtr();
+		size_t oldStep = inds[i].infoStep();
+		for (size_t j = 0; j < infoSize; ++j)
+			ptr[j] = oldPtr[j * oldStep];
+	}
+}
+
+
 void Population::save(boost::archive::text_oarchive & ar, const unsigned int version) const
 {
 	// deep adjustment: everyone in order
@@ -3591,7 +4208,13 @@ void Population::save(boost::archive::text_oarchive & ar, const unsigned int ver
 	ar & has_lineage;
 #endif
 	DBG_DO(DBG_POPULATION, cerr << "Handling information" << endl);
-	ar & m_info;
+	// information fields are always saved by individual
+	if (m_infoByColumn) {
+		vectorf info;
+		infoByIndividual(m_inds, infoSize(), info);
+		ar & info;
+	} else
+		ar & m_info;
 	DBG_DO(DBG_POPULATION, cerr << "Handling Individuals" << endl);
 	ar & m_inds;
 	DBG_DO(DBG_POPULATION, cerr << "Handling ancestral populations" << endl);
@@ -3706,10 +4329,16 @@ void Population::save(boost::archive::text_oarchive & ar, const unsigned int ver
 		ar & has_lineage;
 #endif
 
-		ar & m_info;
+		if (m_infoByColumn) {
+			vectorf info;
+			infoByIndividual(m_inds, infoSize(), info);
+			ar & info;
+		} else
+			ar & m_info;
 		ar & m_inds;
 	}
 	const_cast<Population *>(this)->useAncestralGen(0);
+	const_cast<Population *>(this)->compressAncestralGens();
 
 	// save shared variables as string.
 	// note that many format are not supported.
@@ -4142,6 +4771,9 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 		}
 #endif
 	}
+	// older generations first so that younger ones can share with them
+	for (size_t ap = m_ancestralPops.size(); ap > 0; --ap)
+		shareHaplotypes(ap - 1);
 
 	// load vars from string
 	DBG_DO(DBG_POPULATION, cerr << "Handling shared variables" << endl);
@@ -4156,9 +4788,701 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 }
 
 
-void Population::save(const string & filename) const
+// The binary population format starts with a fixed-size header, followed by
+// data sections aligned to BinaryPopAlign bytes, a text archive with the
+// genotypic structure, subpopulations and variables of the population, and
+// a table of sections (genotype, mutant index, lineage, info and flags of
+// each generation). Data are saved in native byte order.
+static const char BinaryPopMagic[] = "SIMUPOPB";
+// version 1 saves only sex and affection status of individuals
+static const boost::uint32_t BinaryPopVersion = 2;
+static const boost::uint32_t BinaryPopByteOrder = 0x01020304;
+static const size_t BinaryPopAlign = 64;
+static const size_t BinaryPopSections = 5;
+// sections are compressed in blocks that can be decompressed independently
+static const size_t BinaryPopBlockSize = 1 << 22;
+
+enum BinaryPopEncoding {
+	BitAlleles = 0,
+	DenseAlleles = 1,
+	SparseAlleles = 2
+};
+
+struct BinaryPopHeader
 {
-	boost::iostreams::filtering_ostream ofs;
+	char magic[8];
+	boost::uint32_t version;
+	boost::uint32_t byteOrder;
+	boost::uint32_t encoding;
+	boost::uint32_t alleleBytes;
+	boost::uint64_t numGens;
+	boost::uint64_t metaOffset;
+	boost::uint64_t metaSize;
+	boost::uint64_t tableOffset;
+	// 1 if information fields are saved by field
+	boost::uint32_t infoByColumn;
+	char reserved[4];
+};
+
+struct BinaryPopSection
+{
+	// location and number of bytes in the file
+	boost::uint64_t offset;
+	boost::uint64_t size;
+	// number of bytes after decompression
+	boost::uint64_t rawSize;
+	// 0 for raw data, 1 for blocks compressed by zlib
+	boost::uint32_t codec;
+	boost::uint32_t elemSize;
+};
+
+
+class BinaryPopWriter
+{
+public:
+	BinaryPopWriter(std::ofstream & out, bool compress) : m_out(out), m_compress(compress), m_sections()
+	{
+	}
+
+
+	// pad the file to the next aligned position and return it
+	boost::uint64_t align()
+	{
+		static const char zeros[BinaryPopAlign] = { 0 };
+		boost::uint64_t pos = static_cast<boost::uint64_t>(m_out.tellp());
+
+		if (pos % BinaryPopAlign != 0) {
+			m_out.write(zeros, BinaryPopAlign - pos % BinaryPopAlign);
+			pos += BinaryPopAlign - pos % BinaryPopAlign;
+		}
+		return pos;
+	}
+
+
+	void write(const char * data, size_t bytes, size_t elemSize)
+	{
+		BinaryPopSection sec;
+
+		sec.offset = align();
+		sec.size = bytes;
+		sec.rawSize = bytes;
+		sec.codec = 0;
+		sec.elemSize = static_cast<boost::uint32_t>(elemSize);
+		if (m_compress && bytes > 0) {
+			size_t numBlocks = (bytes + BinaryPopBlockSize - 1) / BinaryPopBlockSize;
+			// number of blocks, followed by raw and compressed size of each block
+			vector<boost::uint64_t> index(1 + 2 * numBlocks);
+			index[0] = numBlocks;
+			string blocks;
+			for (size_t b = 0; b < numBlocks; ++b) {
+				size_t rawSize = std::min(BinaryPopBlockSize, bytes - b * BinaryPopBlockSize);
+				size_t start = blocks.size();
+				{
+					boost::iostreams::filtering_ostream out;
+					out.push(boost::iostreams::zlib_compressor(boost::iostreams::zlib::best_speed));
+					out.push(boost::iostreams::back_inserter(blocks));
+					out.write(data + b * BinaryPopBlockSize, rawSize);
+				}
+				index[1 + 2 * b] = rawSize;
+				index[2 + 2 * b] = blocks.size() - start;
+			}
+			size_t indexBytes = index.size() * sizeof(boost::uint64_t);
+			// keep raw data if compression does not help
+			if (indexBytes + blocks.size() < bytes) {
+				m_out.write(reinterpret_cast<const char *>(&index[0]), indexBytes);
+				m_out.write(blocks.data(), blocks.size());
+				sec.size = indexBytes + blocks.size();
+				sec.codec = 1;
+				m_sections.push_back(sec);
+				return;
+			}
+		}
+		if (bytes > 0)
+			m_out.write(data, bytes);
+		m_sections.push_back(sec);
+	}
+
+
+	const vector<BinaryPopSection> & sections() const
+	{
+		return m_sections;
+	}
+
+
+private:
+	std::ofstream & m_out;
+
+	bool m_compress;
+
+	vector<BinaryPopSection> m_sections;
+};
+
+
+// locate the compressed blocks of a section, from and to are the starting
+// positions of compressed and decompressed blocks, with an extra element
+// for the end of the section
+static void binarySectionBlocks(const char * data, const BinaryPopSection & sec,
+                                vector<boost::uint64_t> & from, vector<boost::uint64_t> & to)
+{
+	if (sec.codec != 1 || sec.size < sizeof(boost::uint64_t))
+		throw ValueError("Unsupported compression method in binary population file.");
+
+	boost::uint64_t numBlocks = 0;
+	memcpy(&numBlocks, data, sizeof(boost::uint64_t));
+	if (numBlocks > (sec.size - sizeof(boost::uint64_t)) / (2 * sizeof(boost::uint64_t)))
+		throw ValueError("Binary population file is corrupted.");
+	vector<boost::uint64_t> index(2 * numBlocks);
+	if (numBlocks > 0)
+		memcpy(&index[0], data + sizeof(boost::uint64_t), index.size() * sizeof(boost::uint64_t));
+	from.resize(numBlocks + 1);
+	to.resize(numBlocks + 1);
+	from[0] = (1 + index.size()) * sizeof(boost::uint64_t);
+	to[0] = 0;
+	for (size_t b = 0; b < numBlocks; ++b) {
+		to[b + 1] = to[b] + index[2 * b];
+		from[b + 1] = from[b] + index[2 * b + 1];
+	}
+	if (to[numBlocks] != sec.rawSize || from[numBlocks] > sec.size)
+		throw ValueError("Binary population file is corrupted.");
+}
+
+
+// decompress a block of compSize bytes to dest, return false if failed
+static bool decompressBinaryBlock(const char * data, size_t compSize, char * dest, size_t rawSize)
+{
+	boost::iostreams::filtering_istream in;
+
+	in.push(boost::iostreams::zlib_decompressor());
+	in.push(boost::iostreams::array_source(data, compSize));
+	in.read(dest, static_cast<std::streamsize>(rawSize));
+	return !in.fail();
+}
+
+
+// copy (and decompress) a section to dest, which should have sec.rawSize bytes
+static void readBinarySection(const char * base, size_t fileSize, const BinaryPopSection & sec, char * dest)
+{
+	if (sec.offset > fileSize || sec.size > fileSize - sec.offset)
+		throw ValueError("Binary population file is truncated.");
+	const char * data = base + sec.offset;
+	if (sec.codec == 0) {
+		if (sec.size != sec.rawSize)
+			throw ValueError("Binary population file is corrupted.");
+		if (sec.size > 0)
+			memcpy(dest, data, sec.size);
+		return;
+	}
+	vector<boost::uint64_t> from;
+	vector<boost::uint64_t> to;
+	binarySectionBlocks(data, sec, from, to);
+
+	// blocks are independent so they can be decompressed in parallel
+	long numBlocks = static_cast<long>(to.size() - 1);
+	int failed = 0;
+#ifdef _OPENMP
+#  pragma omp parallel for if(numThreads() > 1 && numBlocks > 1) reduction(+ : failed)
+#endif
+	for (long b = 0; b < numBlocks; ++b) {
+		if (!decompressBinaryBlock(data + from[b], static_cast<size_t>(from[b + 1] - from[b]),
+			    dest + to[b], static_cast<size_t>(to[b + 1] - to[b])))
+			++failed;
+	}
+	if (failed)
+		throw ValueError("Failed to decompress binary population file.");
+}
+
+
+static void readBinarySection(const char * base, size_t fileSize, const BinaryPopSection & sec, string & dest)
+{
+	dest.resize(static_cast<size_t>(sec.rawSize));
+	if (!dest.empty())
+		readBinarySection(base, fileSize, sec, &dest[0]);
+}
+
+
+// read an unsigned integer of elemSize bytes
+static size_t binaryValue(const char * data, size_t elemSize)
+{
+	switch (elemSize) {
+	case 1:
+		return static_cast<unsigned char>(*data);
+	case 2: {
+		boost::uint16_t v;
+		memcpy(&v, data, 2);
+		return v;
+	}
+	case 4: {
+		boost::uint32_t v;
+		memcpy(&v, data, 4);
+		return v;
+	}
+	case 8: {
+		boost::uint64_t v;
+		memcpy(&v, data, 8);
+		return static_cast<size_t>(v);
+	}
+	default:
+		throw ValueError("Unsupported element size in binary population file.");
+	}
+	return 0;
+}
+
+
+// read parts of a section, decompressing only the blocks that are needed
+class BinaryPopSectionReader
+{
+public:
+	BinaryPopSectionReader(const char * base, size_t fileSize, const BinaryPopSection & sec) :
+		m_data(NULL), m_sec(sec), m_from(), m_to(), m_block(0), m_cached(false), m_buffer()
+	{
+		if (sec.offset > fileSize || sec.size > fileSize - sec.offset)
+			throw ValueError("Binary population file is truncated.");
+		m_data = base + sec.offset;
+		if (sec.codec == 0) {
+			if (sec.size != sec.rawSize)
+				throw ValueError("Binary population file is corrupted.");
+		} else
+			binarySectionBlocks(m_data, sec, m_from, m_to);
+	}
+
+
+	// number of elements in the section
+	size_t size() const
+	{
+		return m_sec.elemSize == 0 ? 0 : static_cast<size_t>(m_sec.rawSize / m_sec.elemSize);
+	}
+
+
+	// copy bytes from start to start + bytes of the decompressed section to dest
+	void read(size_t start, size_t bytes, char * dest)
+	{
+		if (start > m_sec.rawSize || bytes > m_sec.rawSize - start)
+			throw ValueError("Binary population file is corrupted.");
+		if (m_sec.codec == 0) {
+			if (bytes > 0)
+				memcpy(dest, m_data + start, bytes);
+			return;
+		}
+		while (bytes > 0) {
+			// the last decompressed block is kept because individuals are
+			// usually read in order
+			if (!m_cached || start < m_to[m_block] || start >= m_to[m_block + 1]) {
+				m_block = std::upper_bound(m_to.begin(), m_to.end(), start) - m_to.begin() - 1;
+				m_buffer.resize(static_cast<size_t>(m_to[m_block + 1] - m_to[m_block]));
+				m_cached = decompressBinaryBlock(m_data + m_from[m_block],
+					static_cast<size_t>(m_from[m_block + 1] - m_from[m_block]), &m_buffer[0], m_buffer.size());
+				if (!m_cached)
+					throw ValueError("Failed to decompress binary population file.");
+			}
+			size_t offset = start - static_cast<size_t>(m_to[m_block]);
+			size_t cnt = std::min(bytes, m_buffer.size() - offset);
+			memcpy(dest, m_buffer.data() + offset, cnt);
+			dest += cnt;
+			start += cnt;
+			bytes -= cnt;
+		}
+	}
+
+
+	// read the idx-th element as an unsigned integer
+	size_t value(size_t idx)
+	{
+		char data[8];
+
+		if (m_sec.elemSize > sizeof(data))
+			throw ValueError("Unsupported element size in binary population file.");
+		read(idx * m_sec.elemSize, m_sec.elemSize, data);
+		return binaryValue(data, m_sec.elemSize);
+	}
+
+
+private:
+	const char * m_data;
+
+	BinaryPopSection m_sec;
+
+	vector<boost::uint64_t> m_from;
+
+	vector<boost::uint64_t> m_to;
+
+	size_t m_block;
+
+	bool m_cached;
+
+	string m_buffer;
+};
+
+
+// read genotype of a generation from its genotype and mutant index sections
+static void readBinaryGenotype(const char * base, size_t fileSize, const BinaryPopSection * sec,
+#ifdef MUTANTALLELE
+                               boost::uint32_t encoding, size_t size, vectorm & geno, size_t & maxAllele)
+#else
+                               boost::uint32_t encoding, size_t size, vectora & geno, size_t & maxAllele)
+#endif
+{
+	geno.resize(size);
+	if (encoding == SparseAlleles) {
+		string values;
+		string index;
+		readBinarySection(base, fileSize, sec[0], values);
+		readBinarySection(base, fileSize, sec[1], index);
+		if (sec[0].elemSize != 1 || index.size() != values.size() * sizeof(boost::uint64_t))
+			throw ValueError("Binary population file is corrupted.");
+		for (size_t i = 0; i < values.size(); ++i) {
+			size_t value = static_cast<unsigned char>(values[i]);
+			size_t pos = binaryValue(index.data() + i * sizeof(boost::uint64_t), sizeof(boost::uint64_t));
+			if (pos >= size)
+				throw ValueError("Binary population file is corrupted.");
+			maxAllele = max(maxAllele, value);
+#ifdef MUTANTALLELE
+			geno.push_back(pos, TO_ALLELE(value));
+#else
+			geno[pos] = TO_ALLELE(value);
+#endif
+		}
+		return;
+	}
+#ifdef BINARYALLELE
+	if (encoding == BitAlleles) {
+		if (sec[0].rawSize != (size + 7) / 8)
+			throw ValueError("Binary population file is corrupted.");
+		if (size == 0)
+			return;
+		char * data = reinterpret_cast<char *>(BITPTR(geno.begin()));
+		readBinarySection(base, fileSize, sec[0], data);
+		// clear unused bits of the last byte
+		if (size % 8 != 0)
+			data[size / 8] &= static_cast<char>((1 << (size % 8)) - 1);
+		return;
+	}
+#elif !defined(MUTANTALLELE)
+	if (encoding == DenseAlleles && sec[0].elemSize == sizeof(Allele)) {
+		if (sec[0].rawSize != size * sizeof(Allele))
+			throw ValueError("Binary population file is corrupted.");
+		if (size == 0)
+			return;
+		readBinarySection(base, fileSize, sec[0], reinterpret_cast<char *>(&geno[0]));
+		return;
+	}
+#endif
+	// saved by a different module, convert allele by allele
+	string data;
+	readBinarySection(base, fileSize, sec[0], data);
+	size_t elemSize = encoding == BitAlleles ? 0 : sec[0].elemSize;
+	if (elemSize == 0 ? data.size() != (size + 7) / 8 : data.size() != size * elemSize)
+		throw ValueError("Binary population file is corrupted.");
+	for (size_t i = 0; i < size; ++i) {
+		size_t value = elemSize == 0 ? (data[i / 8] >> (i % 8)) & 1 : binaryValue(data.data() + i * elemSize, elemSize);
+		if (value == 0)
+			continue;
+		maxAllele = max(maxAllele, value);
+#ifdef MUTANTALLELE
+		geno.push_back(i, TO_ALLELE(value));
+#else
+		geno[i] = TO_ALLELE(value);
+#endif
+	}
+}
+
+
+#ifdef LINEAGE
+static void readBinaryLineage(const char * base, size_t fileSize, const BinaryPopSection & sec,
+                              size_t size, vectori & lineage)
+{
+	lineage.clear();
+	lineage.resize(size, 0);
+	// saved by a module without lineage
+	if (sec.rawSize == 0)
+		return;
+	if (sec.rawSize != size * sec.elemSize)
+		throw ValueError("Binary population file is corrupted.");
+	if (sec.elemSize == sizeof(long)) {
+		readBinarySection(base, fileSize, sec, reinterpret_cast<char *>(&lineage[0]));
+		return;
+	}
+	string data;
+	readBinarySection(base, fileSize, sec, data);
+	for (size_t i = 0; i < size; ++i) {
+		if (sec.elemSize == 4) {
+			boost::int32_t v;
+			memcpy(&v, data.data() + i * 4, 4);
+			lineage[i] = v;
+		} else if (sec.elemSize == 8) {
+			boost::int64_t v;
+			memcpy(&v, data.data() + i * 8, 8);
+			lineage[i] = static_cast<long>(v);
+		} else
+			throw ValueError("Unsupported element size in binary population file.");
+	}
+}
+
+
+#endif
+
+// read and validate the header of a mapped binary population file
+static void readBinaryHeader(const char * base, size_t fileSize, const string & filename, BinaryPopHeader & header)
+{
+	if (fileSize < sizeof(header))
+		throw ValueError("Binary population file is truncated.");
+	memcpy(&header, base, sizeof(header));
+	if (memcmp(header.magic, BinaryPopMagic, sizeof(header.magic)) != 0)
+		throw ValueError(filename + " is not a binary population file.");
+	if (header.byteOrder != BinaryPopByteOrder)
+		throw ValueError("Binary population file was saved on a platform with a different byte order.");
+	if (header.version > BinaryPopVersion)
+		throw ValueError("Binary population file was saved by a newer version of simuPOP.");
+	if (header.numGens == 0 || header.metaOffset > fileSize || header.metaSize > fileSize - header.metaOffset
+	    || header.tableOffset > fileSize
+	    || header.numGens * BinaryPopSections > (fileSize - header.tableOffset) / sizeof(BinaryPopSection))
+		throw ValueError("Binary population file is truncated.");
+}
+
+
+// read genotypic structure, subpopulations and variables of all generations
+// set flags of an individual from a binary population file
+static void setBinaryFlags(Individual & ind, char flags, boost::uint32_t version)
+{
+	if (version < 2) {
+		ind.setSex((flags & 1) ? FEMALE : MALE);
+		ind.setAffected((flags & 2) != 0);
+	} else
+		ind.setFlags(static_cast<unsigned char>(flags));
+	// virtual subpopulations are not activated in a loaded population
+	ind.setVisible(true);
+}
+
+
+static void readBinaryMeta(const char * base, const BinaryPopHeader & header, GenoStructure & stru,
+                           int & ancestralGens, vector<vectoru> & subPopSizes, vector<vectorstr> & subPopNames,
+                           vectoru & genoSizes, string & vars)
+{
+	{
+		std::istringstream meta(string(base + header.metaOffset, static_cast<size_t>(header.metaSize)));
+		boost::archive::text_iarchive ar(meta);
+		ar & stru;
+		ar & ancestralGens;
+		ar & subPopSizes;
+		ar & subPopNames;
+		ar & genoSizes;
+		ar & vars;
+	}
+	size_t numGens = static_cast<size_t>(header.numGens);
+	if (subPopSizes.size() != numGens || subPopNames.size() != numGens || genoSizes.size() != numGens)
+		throw ValueError("Binary population file is corrupted.");
+}
+
+
+void Population::saveBinary(const string & filename, bool compress) const
+{
+	std::ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+
+	if (!out)
+		throw ValueError("Cannot write to file " + filename);
+
+	BinaryPopHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, BinaryPopMagic, sizeof(header.magic));
+	header.version = BinaryPopVersion;
+	header.byteOrder = BinaryPopByteOrder;
+#ifdef BINARYALLELE
+	header.encoding = BitAlleles;
+#elif defined(MUTANTALLELE)
+	header.encoding = SparseAlleles;
+#else
+	header.encoding = DenseAlleles;
+#endif
+	header.alleleBytes = sizeof(Allele);
+	header.numGens = m_ancestralPops.size() + 1;
+	header.infoByColumn = m_infoByColumn ? 1 : 0;
+	// placeholder, rewritten after all sections are written
+	out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+	BinaryPopWriter writer(out, compress);
+	vector<vectoru> subPopSizes;
+	vector<vectorstr> subPopNames;
+	vectoru genoSizes;
+	Population & pop = const_cast<Population &>(*this);
+	int curGen = m_curAncestralGen;
+	for (size_t gen = 0; gen <= m_ancestralPops.size(); ++gen) {
+		pop.useAncestralGen(gen);
+		// columns are saved in the order of individuals
+		pop.syncIndPointers();
+		subPopSizes.push_back(m_subPopSize);
+		subPopNames.push_back(m_subPopNames);
+		genoSizes.push_back(m_genotype.size());
+#ifdef MUTANTALLELE
+		vector<unsigned char> values;
+		vector<boost::uint64_t> index;
+		vectorm::const_val_iterator ptr = m_genotype.begin().get_val_iterator();
+		vectorm::const_val_iterator end = m_genotype.end().get_val_iterator();
+		for (; ptr != end; ++ptr) {
+			index.push_back(ptr->first);
+			values.push_back(ptr->second);
+		}
+		writer.write(values.empty() ? NULL : reinterpret_cast<const char *>(&values[0]), values.size(), 1);
+		writer.write(index.empty() ? NULL : reinterpret_cast<const char *>(&index[0]),
+			index.size() * sizeof(boost::uint64_t), sizeof(boost::uint64_t));
+#else
+#  ifdef BINARYALLELE
+		writer.write(m_genotype.empty() ? NULL : alleleData(pop.m_genotype), (m_genotype.size() + 7) / 8, 0);
+#  else
+		writer.write(m_genotype.empty() ? NULL : alleleData(pop.m_genotype), m_genotype.size() * sizeof(Allele), sizeof(Allele));
+#  endif
+		writer.write(NULL, 0, sizeof(boost::uint64_t));
+#endif
+#ifdef LINEAGE
+		writer.write(m_lineage.empty() ? NULL : reinterpret_cast<const char *>(&m_lineage[0]),
+			m_lineage.size() * sizeof(long), sizeof(long));
+#else
+		writer.write(NULL, 0, sizeof(long));
+#endif
+		// information fields are saved in the layout of the population
+		writer.write(m_info.empty() ? NULL : reinterpret_cast<const char *>(&m_info[0]),
+			m_info.size() * sizeof(double), sizeof(double));
+		vector<unsigned char> flags(m_inds.size());
+		for (size_t i = 0; i < m_inds.size(); ++i)
+			flags[i] = m_inds[i].flags();
+		writer.write(flags.empty() ? NULL : reinterpret_cast<const char *>(&flags[0]), flags.size(), 1);
+	}
+	pop.useAncestralGen(curGen);
+	pop.compressAncestralGens();
+
+	std::ostringstream meta;
+	{
+		boost::archive::text_oarchive ar(meta);
+		ar & genoStru();
+		ar & m_ancestralGens;
+		ar & subPopSizes;
+		ar & subPopNames;
+		ar & genoSizes;
+		string vars = varsAsString(true);
+		ar & vars;
+	}
+	string metaStr = meta.str();
+	header.metaOffset = writer.align();
+	header.metaSize = metaStr.size();
+	out.write(metaStr.data(), metaStr.size());
+	header.tableOffset = writer.align();
+	const vector<BinaryPopSection> & sections = writer.sections();
+	out.write(reinterpret_cast<const char *>(&sections[0]), sections.size() * sizeof(BinaryPopSection));
+	out.seekp(0);
+	out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	if (!out)
+		throw ValueError("Cannot save population to file " + filename);
+}
+
+
+void Population::loadBinary(const string & filename)
+{
+	boost::iostreams::mapped_file_source file;
+
+	try {
+		file.open(filename);
+	} catch (...) {
+		throw ValueError("Can not open file " + filename);
+	}
+	const char * base = file.data();
+	size_t fileSize = file.size();
+
+	BinaryPopHeader header;
+	readBinaryHeader(base, fileSize, filename, header);
+	size_t numGens = static_cast<size_t>(header.numGens);
+	vector<BinaryPopSection> sections(numGens * BinaryPopSections);
+	memcpy(&sections[0], base + header.tableOffset, sections.size() * sizeof(BinaryPopSection));
+
+	GenoStructure stru;
+	vector<vectoru> subPopSizes;
+	vector<vectorstr> subPopNames;
+	vectoru genoSizes;
+	string vars;
+	readBinaryMeta(base, header, stru, m_ancestralGens, subPopSizes, subPopNames, genoSizes, vars);
+
+	// set genostructure, check duplication
+	this->setGenoStructure(stru);
+	size_t step = genoSize();
+	size_t infoStep = infoSize();
+	size_t max_allele = 0;
+
+	m_infoByColumn = header.infoByColumn != 0;
+	m_ancestralPops.clear();
+	for (size_t gen = 0; gen < numGens; ++gen) {
+		popData pd;
+		const BinaryPopSection * sec = &sections[gen * BinaryPopSections];
+		size_t popSize = accumulate(subPopSizes[gen].begin(), subPopSizes[gen].end(), size_t(0));
+		if (genoSizes[gen] != popSize * step || sec[3].rawSize != popSize * infoStep * sizeof(double)
+		    || sec[3].elemSize != sizeof(double) || sec[4].rawSize != popSize)
+			throw ValueError("Binary population file is corrupted.");
+
+		if (gen > 0)
+			m_ancestralPops.push_back(pd);
+		popData & p = gen == 0 ? pd : m_ancestralPops.back();
+		p.m_subPopSize.swap(subPopSizes[gen]);
+		p.m_subPopNames.swap(subPopNames[gen]);
+		readBinaryGenotype(base, fileSize, sec, header.encoding, genoSizes[gen], p.m_genotype, max_allele);
+#ifdef LINEAGE
+		readBinaryLineage(base, fileSize, sec[2], genoSizes[gen], p.m_lineage);
+#endif
+		p.m_info.resize(popSize * infoStep);
+		if (!p.m_info.empty())
+			readBinarySection(base, fileSize, sec[3], reinterpret_cast<char *>(&p.m_info[0]));
+		string flags;
+		readBinarySection(base, fileSize, sec[4], flags);
+		p.m_inds.resize(popSize);
+		for (size_t i = 0; i < popSize; ++i)
+			setBinaryFlags(p.m_inds[i], flags[i], header.version);
+		if (gen == 0) {
+			m_subPopSize.swap(p.m_subPopSize);
+			m_subPopNames.swap(p.m_subPopNames);
+			m_genotype.swap(p.m_genotype);
+			LINEAGE_EXPR(m_lineage.swap(p.m_lineage));
+			m_info.swap(p.m_info);
+			m_inds.swap(p.m_inds);
+		}
+		// set pointers after data are in place
+		vector<Individual> & inds = gen == 0 ? m_inds : p.m_inds;
+		GenoIterator ptr = gen == 0 ? m_genotype.begin() : p.m_genotype.begin();
+		InfoIterator infoPtr = gen == 0 ? m_info.begin() : p.m_info.begin();
+		for (size_t i = 0; i < popSize; ++i, ptr += step) {
+			inds[i].setGenoStruIdx(genoStruIdx());
+			inds[i].setGenoPtr(ptr);
+			if (m_infoByColumn)
+				inds[i].setInfoPtr(infoPtr + i, popSize);
+			else
+				inds[i].setInfoPtr(infoPtr + i * infoStep);
+		}
+#ifdef LINEAGE
+		LineageIterator lineagePtr = gen == 0 ? m_lineage.begin() : p.m_lineage.begin();
+		for (size_t i = 0; i < popSize; ++i, lineagePtr += step)
+			inds[i].setLineagePtr(lineagePtr);
+#endif
+	}
+	m_popSize = m_inds.size();
+	m_subPopIndex.resize(m_subPopSize.size() + 1);
+	m_subPopIndex[0] = 0;
+	for (size_t i = 1; i <= m_subPopSize.size(); ++i)
+		m_subPopIndex[i] = m_subPopIndex[i - 1] + m_subPopSize[i - 1];
+
+	// older generations first so that younger ones can share with them
+	for (size_t ap = m_ancestralPops.size(); ap > 0; --ap)
+		shareHaplotypes(ap - 1);
+
+	varsFromString(vars, true);
+	setIndOrdered(true);
+	DBG_WARNIF(max_allele > ModuleMaxAllele, (boost::format("Warning: the maximum allele of the loaded population is %1%"
+												            " which is larger than the maximum allowed allele of this module. "
+												            "These alleles have been truncated.") % max_allele).str());
+}
+
+
+void Population::save(const string & filename, bool binary, bool compress) const
+{
+	if (binary) {
+		saveBinary(filename, compress);
+		return;
+	}
+
+	boost::iostreams::filtering_ostream ofs;
 
 	// compress output
 	ofs.push(boost::iostreams::gzip_compressor());
@@ -4178,6 +5502,23 @@ void Population::save(const string & filename) const
 
 void Population::load(const string & filename)
 {
+	// files in the binary format are recognized by their magic string
+	{
+		std::ifstream bin(filename.c_str(), std::ios::binary);
+		char magic[8];
+		if (bin.read(magic, sizeof(magic)) && memcmp(magic, BinaryPopMagic, sizeof(magic)) == 0) {
+			bin.close();
+			try {
+				loadBinary(filename);
+			} catch (const ValueError &) {
+				throw;
+			} catch (const std::exception & e) {
+				throw ValueError("Failed to load Population " + filename + " (" + e.what() + ")\n");
+			}
+			return;
+		}
+	}
+
 	boost::iostreams::filtering_istream ifs;
 
 	ifs.push(boost::iostreams::gzip_decompressor());
@@ -4269,25 +5610,10 @@ void Population::syncIndPointers(bool infoOnly) const
 
 	if (infoOnly) {
 		DBG_DO(DBG_POPULATION, cerr << "Adjust info position " << endl);
-		size_t is = infoSize();
-		if (is == 0) {
-			setIndOrdered(true);
-			return;
-		}
-		vectorf tmpInfo(m_popSize * is);
-		vectorf::iterator infoPtr = tmpInfo.begin();
-
-		IndIterator ind = const_cast<Population *>(this)->indIterator();
-		for (; ind.valid(); ++ind) {
-			copy(ind->infoBegin(), ind->infoEnd(), infoPtr);
-			ind->setInfoPtr(infoPtr);
-			infoPtr += is;
-		}
-		const_cast<Population *>(this)->m_info.swap(tmpInfo);
+		layoutInfo(m_infoByColumn);
 	} else {
 		DBG_DO(DBG_POPULATION, cerr << "Adjust geno and info position " << endl);
 
-		size_t is = infoSize();
 		size_t sz = genoSize();
 #ifdef MUTANTALLELE
 		vectorm tmpGenotype(m_popSize * genoSize());
@@ -4301,9 +5627,6 @@ void Population::syncIndPointers(bool infoOnly) const
 		vectori::iterator lineagePtr = tmpLineage.begin();
 #endif
 
-		vectorf tmpInfo(m_popSize * infoSize());
-		vectorf::iterator infoPtr = tmpInfo.begin();
-
 		IndIterator ind = const_cast<Population *>(this)->indIterator();
 		for (; ind.valid(); ++ind) {
 #ifdef BINARYALLELE
@@ -4320,19 +5643,56 @@ void Population::syncIndPointers(bool infoOnly) const
 			LINEAGE_EXPR(ind->setLineagePtr(lineagePtr));
 			it += sz;
 			LINEAGE_EXPR(lineagePtr += sz);
-			copy(ind->infoBegin(), ind->infoEnd(), infoPtr);
-			ind->setInfoPtr(infoPtr);
-			infoPtr += is;
 		}
 		// discard original genotype
 		const_cast<Population *>(this)->m_genotype.swap(tmpGenotype);
-		const_cast<Population *>(this)->m_info.swap(tmpInfo);
 		LINEAGE_EXPR(const_cast<Population *>(this)->m_lineage.swap(tmpLineage));
+		layoutInfo(m_infoByColumn);
 	}
 	setIndOrdered(true);
 }
 
 
+void Population::layoutInfo(bool byColumn) const
+{
+	checkInfoViews();
+	size_t is = infoSize();
+	size_t size = m_inds.size();
+
+	if (is == 0)
+		return;
+
+	vectorf info(size * is);
+	size_t infoStep = byColumn ? 1 : is;
+	size_t fieldStep = byColumn ? size : 1;
+	vector<Individual> & inds = const_cast<vector<Individual> &>(m_inds);
+	InfoIterator ptr = info.begin();
+	for (size_t i = 0; i < size; ++i, ptr += infoStep) {
+		InfoIterator oldPtr = inds[i].infoPtr();
+		size_t oldStep = inds[i].infoStep();
+		for (size_t j = 0; j < is; ++j)
+			ptr[j * fieldStep] = oldPtr[j * oldStep];
+		inds[i].setInfoPtr(ptr, fieldStep);
+	}
+	const_cast<Population *>(this)->m_info.swap(info);
+}
+
+
+void Population::setInfoByColumn(bool byColumn)
+{
+	checkInfoViews();
+	if (m_infoByColumn == byColumn)
+		return;
+	m_infoByColumn = byColumn;
+	int curGen = m_curAncestralGen;
+	for (int depth = ancestralGens(); depth >= 0; --depth) {
+		useAncestralGen(depth);
+		layoutInfo(byColumn);
+	}
+	useAncestralGen(curGen);
+}
+
+
 Population & loadPopulation(const string & file)
 {
 	Population * p = new Population();
@@ -4342,6 +5702,191 @@ Population & loadPopulation(const string & file)
 }
 
 
+MappedPopulation::MappedPopulation(const string & filename) :
+	GenoStruTrait(), m_filename(filename), m_file(), m_version(0), m_encoding(0), m_infoByColumn(false),
+	m_numGens(0), m_tableOffset(0), m_subPopSize(), m_subPopNames(), m_vars()
+{
+	try {
+		m_file.open(filename);
+	} catch (...) {
+		throw ValueError("Can not open file " + filename);
+	}
+	const char * base = m_file.data();
+
+	BinaryPopHeader header;
+	readBinaryHeader(base, m_file.size(), filename, header);
+	m_version = header.version;
+	m_encoding = header.encoding;
+	m_infoByColumn = header.infoByColumn != 0;
+	m_numGens = static_cast<size_t>(header.numGens);
+	m_tableOffset = static_cast<size_t>(header.tableOffset);
+
+	GenoStructure stru;
+	int ancestralGens = 0;
+	vector<vectoru> subPopSizes;
+	vector<vectorstr> subPopNames;
+	vectoru genoSizes;
+	readBinaryMeta(base, header, stru, ancestralGens, subPopSizes, subPopNames, genoSizes, m_vars);
+	m_subPopSize.swap(subPopSizes[0]);
+	m_subPopNames.swap(subPopNames[0]);
+	setGenoStructure(stru);
+	if (genoSizes[0] != popSize() * genoSize()) {
+		decGenoStruRef();
+		throw ValueError("Binary population file is corrupted.");
+	}
+}
+
+
+MappedPopulation::~MappedPopulation()
+{
+	decGenoStruRef();
+}
+
+
+Population & MappedPopulation::extractIndividuals(const uintList & indexList) const
+{
+	vectoru indexes = indexList.elems();
+	size_t size = popSize();
+
+	std::sort(indexes.begin(), indexes.end());
+	indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+	if (!indexes.empty() && indexes.back() >= size)
+		throw IndexError((boost::format("individual index %1% out of range of 0 ~ %2%.") % indexes.back() % size).str());
+
+	// extracted individuals stay in their subpopulations
+	vectoru spSizes(m_subPopSize.size(), 0);
+	size_t sp = 0;
+	size_t spEnd = m_subPopSize.empty() ? 0 : m_subPopSize[0];
+	for (size_t i = 0; i < indexes.size(); ++i) {
+		while (indexes[i] >= spEnd)
+			spEnd += m_subPopSize[++sp];
+		++spSizes[sp];
+	}
+
+	// sections of the present generation
+	const char * base = m_file.data();
+	size_t fileSize = m_file.size();
+	BinaryPopSection sec[BinaryPopSections];
+	memcpy(sec, base + m_tableOffset, sizeof(sec));
+	size_t step = genoSize();
+	size_t infoStep = infoSize();
+	if (sec[3].rawSize != size * infoStep * sizeof(double) || sec[3].elemSize != sizeof(double)
+	    || sec[4].rawSize != size)
+		throw ValueError("Binary population file is corrupted.");
+	if (m_encoding == SparseAlleles) {
+		if (sec[0].elemSize != 1 || sec[1].elemSize != sizeof(boost::uint64_t)
+		    || sec[1].rawSize != sec[0].rawSize * sizeof(boost::uint64_t))
+			throw ValueError("Binary population file is corrupted.");
+	} else if (m_encoding == BitAlleles ? sec[0].rawSize != (size * step + 7) / 8
+	           : sec[0].rawSize != size * step * sec[0].elemSize)
+		throw ValueError("Binary population file is corrupted.");
+	if (sec[2].rawSize != 0 && sec[2].rawSize != size * step * sec[2].elemSize)
+		throw ValueError("Binary population file is corrupted.");
+
+	BinaryPopSectionReader genoReader(base, fileSize, sec[0]);
+	BinaryPopSectionReader indexReader(base, fileSize, sec[1]);
+#ifdef LINEAGE
+	BinaryPopSectionReader lineageReader(base, fileSize, sec[2]);
+#endif
+	BinaryPopSectionReader infoReader(base, fileSize, sec[3]);
+	BinaryPopSectionReader flagsReader(base, fileSize, sec[4]);
+
+	Population & pop = *new Population();
+	try {
+		pop.setGenoStruIdx(genoStruIdx());
+		incGenoStruRef();
+		pop.fitSubPopStru(spSizes, m_subPopNames);
+
+		size_t maxAllele = 0;
+		// mutants before this position belong to previous individuals
+		size_t mutant = 0;
+		size_t numMutants = indexReader.size();
+		string data;
+		vectorf info(infoStep);
+		RawIndIterator ind = pop.rawIndBegin();
+		for (size_t i = 0; i < indexes.size(); ++i, ++ind) {
+			size_t start = indexes[i] * step;
+			if (m_encoding == SparseAlleles) {
+				// mutants are saved in the order of their locations
+				size_t hi = numMutants;
+				while (mutant < hi) {
+					size_t mid = mutant + (hi - mutant) / 2;
+					if (indexReader.value(mid) < start)
+						mutant = mid + 1;
+					else
+						hi = mid;
+				}
+				for (; mutant < numMutants; ++mutant) {
+					size_t pos = indexReader.value(mutant);
+					if (pos >= start + step)
+						break;
+					size_t value = genoReader.value(mutant);
+					maxAllele = max(maxAllele, value);
+					ind->setAllele(value, pos - start);
+				}
+			} else if (step > 0) {
+				size_t elemSize = m_encoding == BitAlleles ? 0 : sec[0].elemSize;
+				// bytes that hold the genotype of the individual
+				size_t first = elemSize == 0 ? start / 8 : start * elemSize;
+				size_t last = elemSize == 0 ? (start + step - 1) / 8 + 1 : (start + step) * elemSize;
+				data.resize(last - first);
+				genoReader.read(first, data.size(), &data[0]);
+				for (size_t j = 0; j < step; ++j) {
+					size_t bit = start + j - first * 8;
+					size_t value = elemSize == 0 ? (data[bit / 8] >> (bit % 8)) & 1
+					               : binaryValue(data.data() + j * elemSize, elemSize);
+					if (value == 0)
+						continue;
+					maxAllele = max(maxAllele, value);
+					ind->setAllele(value, j);
+				}
+			}
+#ifdef LINEAGE
+			// saved by a module without lineage
+			if (sec[2].rawSize != 0 && step > 0) {
+				size_t elemSize = sec[2].elemSize;
+				data.resize(step * elemSize);
+				lineageReader.read(start * elemSize, data.size(), &data[0]);
+				for (size_t j = 0; j < step; ++j) {
+					if (elemSize == 4) {
+						boost::int32_t v;
+						memcpy(&v, data.data() + j * 4, 4);
+						ind->setAlleleLineage(v, j);
+					} else if (elemSize == 8) {
+						boost::int64_t v;
+						memcpy(&v, data.data() + j * 8, 8);
+						ind->setAlleleLineage(static_cast<long>(v), j);
+					} else
+						throw ValueError("Unsupported element size in binary population file.");
+				}
+			}
+#endif
+			if (infoStep > 0 && m_infoByColumn) {
+				for (size_t j = 0; j < infoStep; ++j)
+					infoReader.read((j * size + indexes[i]) * sizeof(double), sizeof(double),
+						reinterpret_cast<char *>(&info[j]));
+			} else if (infoStep > 0)
+				infoReader.read(indexes[i] * infoStep * sizeof(double), infoStep * sizeof(double),
+					reinterpret_cast<char *>(&info[0]));
+			for (size_t j = 0; j < infoStep; ++j)
+				ind->setInfo(info[j], j);
+			char flags = 0;
+			flagsReader.read(indexes[i], 1, &flags);
+			setBinaryFlags(*ind, flags, m_version);
+		}
+		pop.setInfoByColumn(m_infoByColumn);
+		pop.varsFromString(m_vars, true);
+		DBG_WARNIF(maxAllele > ModuleMaxAllele, (boost::format("Warning: the maximum allele of the extracted individuals is %1%"
+													           " which is larger than the maximum allowed allele of this module. "
+													           "These alleles have been truncated.") % maxAllele).str());
+	} catch (...) {
+		delete &pop;
+		throw;
+	}
+	return pop;
+}
+
+
 }
 
 
@@ -141,6 +141,94 @@ private:
 class Pedigree;
 
 
+/** CPPONLY
+ *  An open-addressing hash table that maps IDs of individuals of a
+ *  generation, stored in an information field, to their indexes. The index
+ *  is built when it is first used, stays with its generation when the
+ *  generation becomes an ancestral generation, and is cleared when
+ *  individuals of the generation are reordered or removed.
+ */
+class IdIndex
+{
+public:
+	IdIndex() : m_idIdx(0), m_size(0), m_mask(0), m_ids(), m_indexes(), m_lastIndexes()
+	{
+	}
+
+
+	/// index IDs at information field \e idIdx of \e inds
+	void build(const vector<Individual> & inds, size_t idIdx);
+
+	/// whether or not the index is built for \e size individuals with IDs
+	/// at information field \e idIdx
+	bool built(size_t size, size_t idIdx) const
+	{
+		return !m_indexes.empty() && m_size == size && m_idIdx == idIdx;
+	}
+
+
+	/// index of the first (or the last if \e last is \c true) individual
+	/// with \e id, or \c InvalidValue
+	size_t find(size_t id, bool last = false) const
+	{
+		if (last && !m_lastIndexes.empty()) {
+			std::map<size_t, size_t>::const_iterator it = m_lastIndexes.find(id);
+			if (it != m_lastIndexes.end())
+				return it->second;
+		}
+		// the table is at most half full so the probe always reaches an
+		// empty slot
+		for (size_t slot = hash(id); ; slot = (slot + 1) & m_mask) {
+			if (m_indexes[slot] == InvalidValue || m_ids[slot] == id)
+				return m_indexes[slot];
+		}
+	}
+
+
+	void clear()
+	{
+		m_ids.clear();
+		m_indexes.clear();
+		m_lastIndexes.clear();
+	}
+
+
+	void swap(IdIndex & rhs)
+	{
+		std::swap(m_idIdx, rhs.m_idIdx);
+		std::swap(m_size, rhs.m_size);
+		std::swap(m_mask, rhs.m_mask);
+		m_ids.swap(rhs.m_ids);
+		m_indexes.swap(rhs.m_indexes);
+		m_lastIndexes.swap(rhs.m_lastIndexes);
+	}
+
+
+private:
+	size_t hash(size_t id) const
+	{
+		// Fibonacci hashing spreads consecutive IDs across the table
+		return static_cast<size_t>((static_cast<boost::uint64_t>(id) * 0x9E3779B97F4A7C15ULL) >> 32) & m_mask;
+	}
+
+
+	size_t m_idIdx;
+
+	size_t m_size;
+
+	size_t m_mask;
+
+	vectoru m_ids;
+
+	/// indexes of individuals, InvalidValue for empty slots
+	vectoru m_indexes;
+
+	/// indexes of the last individuals with IDs that are shared by
+	/// several individuals
+	std::map<size_t, size_t> m_lastIndexes;
+};
+
+
 /**
  *  A simuPOP population consists of individuals of the same genotypic
  *  structure, organized by generations, subpopulations and virtual
@@ -242,6 +330,13 @@ public:
 	 *    will have name \c '' if this parameter is not specified.
 	 *  \param infoFields Names of information fields (named float number) that
 	 *    will be attached to each individual.
+	 *  \param infoByColumn If set to \c True, values of each information field
+	 *    are stored contiguously for all individuals in a generation, instead
+	 *    of being stored individual by individual. This layout speeds up
+	 *    operations that read or write a single information field (e.g.
+	 *    \c fitness) of all individuals, at the cost of slower operations
+	 *    that rearrange individuals (e.g. sorting or removing individuals).
+	 *    This layout is kept in binary but not in text population files.
 	 */
 	Population(const uintList & size = vectoru(),
 		float ploidy = 2,
@@ -253,7 +348,8 @@ public:
 		const stringMatrix & alleleNames = stringMatrix(),
 		const stringList & lociNames = vectorstr(),
 		const stringList & subPopNames = vectorstr(),
-		const stringList & infoFields = vectorstr());
+		const stringList & infoFields = vectorstr(),
+		bool infoByColumn = false);
 
 	/// CPPONLY copy constructor
 	Population(const Population & rhs);
@@ -272,6 +368,8 @@ public:
 	 */
 	void swap(Population & rhs)
 	{
+		checkInfoViews();
+		rhs.checkInfoViews();
 		GenoStruTrait::swap(rhs);
 		std::swap(m_popSize, rhs.m_popSize);
 
@@ -288,7 +386,14 @@ public:
 		m_vars.swap(rhs.m_vars);
 		m_ancestralPops.swap(rhs.m_ancestralPops);
 		std::swap(m_curAncestralGen, rhs.m_curAncestralGen);
+		std::swap(m_compressDepth, rhs.m_compressDepth);
+		std::swap(m_shareHaplotypes, rhs.m_shareHaplotypes);
 		std::swap(m_indOrdered, rhs.m_indOrdered);
+		std::swap(m_infoByColumn, rhs.m_infoByColumn);
+		m_vspMembers.swap(rhs.m_vspMembers);
+		m_vspMembersKey.swap(rhs.m_vspMembersKey);
+		std::swap(m_activatedVSP, rhs.m_activatedVSP);
+		m_idIndex.swap(rhs.m_idIndex);
 		std::swap(m_vspSplitter, rhs.m_vspSplitter);
 		std::swap(rhs.m_gen, m_gen);
 		std::swap(rhs.m_rep, m_rep);
@@ -606,14 +711,46 @@ public:
 	 *  parental generations) or \c UNSPECIFIED to search only the current
 	 *  generation. If no individual with \e id is found, an \c IndexError will
 	 *  be raised. A float \e id is acceptable as long as it rounds closely to
-	 *  an integer. Note that this function uses a dynamic searching algorithm
-	 *  which tends to be slow. If you need to look for multiple individuals
-	 *  from a static population, you might want to convert a population
-	 *  object to a pedigree object and use function <tt>Pedigree.indByID</tt>.
+	 *  an integer. If several individuals in a generation share \e id, the
+	 *  first one is returned. IDs of each generation are indexed when they
+	 *  are first searched so that subsequent searches do not scan the
+	 *  population again. The index of a generation is rebuilt if \e id is
+	 *  not found in it, so IDs that are changed directly through individuals
+	 *  can be found, at the cost of scanning the generation for each
+	 *  missing ID.
 	 *  <group>4-ind</group>
 	 */
 	Individual & indByID(double id, const uintList & ancGens = uintList(), const string & idField = "ind_id");
 
+	/** CPPONLY
+	 *  Build the index of IDs at information field \e idIdx of ancestral
+	 *  generation \e gen if it has not been built, or if \e force is
+	 *  \c true. This function should be called before individuals are
+	 *  looked up from multiple threads.
+	 */
+	void buildIDIndex(size_t gen, size_t idIdx, bool force = false) const;
+
+	/** CPPONLY
+	 *  Return a pointer to the individual with \e id at information field
+	 *  \e idIdx in ancestral generation \e gen, or \c NULL if there is no
+	 *  such individual. Genotypes of individuals in an ancestral generation
+	 *  that is not the current generation may not be available. If
+	 *  \e rebuild is \c true, the index of IDs of the generation is built
+	 *  if needed and rebuilt once if \e id is not found or if an ID has been
+	 *  changed after the index was built. Otherwise the index is not changed so that this function can
+	 *  be called from multiple threads, a \c RuntimeError is raised if the
+	 *  index has not been built, and \c NULL is returned for changed IDs.
+	 *  If several individuals share \e id, the first one is returned, or
+	 *  the last one if \e last is \c true.
+	 */
+	Individual * findIndByID(size_t id, size_t gen, size_t idIdx, bool rebuild = true, bool last = false) const;
+
+	/** CPPONLY
+	 *  Clear indexes of IDs of all generations. This function should be
+	 *  called after IDs are changed through individuals.
+	 */
+	void clearIDIndex() const;
+
 	/** CPPONLY: const version of the ind function.
 	 */
 	const Individual & individual(double idx, vspID subPop = vspID()) const
@@ -674,6 +811,18 @@ public:
 	}
 
 
+	/// CPPONLY whether or not information fields are stored by field
+	bool infoByColumn() const
+	{
+		return m_infoByColumn;
+	}
+
+
+	/// CPPONLY store information fields of all generations by field
+	/// (\e byColumn is \c true) or by individual.
+	void setInfoByColumn(bool byColumn);
+
+
 	/// CPPONLY Individual iterator: without subPop info
 	IndIterator indIterator()
 	{
@@ -688,6 +837,9 @@ public:
 	{
 		CHECKRANGESUBPOP(subPop);
 
+		if (hasActivatedVirtualSubPop(subPop) && m_activatedVSP != InvalidValue)
+			return IndIterator(m_inds.begin(), vspMembersBegin(), vspMembersEnd(),
+				m_inds.begin() + m_subPopIndex[subPop + 1]);
 		return IndIterator(m_inds.begin() + m_subPopIndex[subPop],
 			m_inds.begin() + m_subPopIndex[subPop + 1], !hasActivatedVirtualSubPop(subPop));
 	}
@@ -702,6 +854,13 @@ public:
 		CHECKRANGESUBPOP(subPop);
 		DBG_FAILIF(threadID >= numThreads(), RuntimeError,
 			(boost::format("Thread ID %1% execeed total number of threads %2%") % threadID % numThreads()).str());
+		if (hasActivatedVirtualSubPop(subPop) && m_activatedVSP != InvalidValue) {
+			// split members of the virtual subpopulation evenly
+			size_t blockSize = m_vspMembers.size() / numThreads();
+			return IndIterator(m_inds.begin(), vspMembersBegin() + blockSize * threadID,
+				threadID + 1 != numThreads() ? vspMembersBegin() + blockSize * (threadID + 1) : vspMembersEnd(),
+				m_inds.begin() + m_subPopIndex[subPop + 1]);
+		}
 		size_t blockSize = m_subPopSize[subPop] / numThreads();
 		if (threadID + 1 != numThreads())
 			return IndIterator(m_inds.begin() + m_subPopIndex[subPop] + blockSize * threadID,
@@ -731,6 +890,9 @@ public:
 	{
 		CHECKRANGESUBPOP(subPop);
 
+		if (hasActivatedVirtualSubPop(subPop) && m_activatedVSP != InvalidValue)
+			return ConstIndIterator(m_inds.begin(), vspMembersBegin(), vspMembersEnd(),
+				m_inds.begin() + m_subPopIndex[subPop + 1]);
 		return ConstIndIterator(m_inds.begin() + m_subPopIndex[subPop],
 			m_inds.begin() + m_subPopIndex[subPop + 1], !hasActivatedVirtualSubPop(subPop));
 	}
@@ -1050,7 +1212,12 @@ public:
 
 	/** Return an editable array of the genotype of all individuals in
 	 *  a population (if <tt>subPop=[]</tt>, default), or individuals in a
-	 *  subpopulation \e subPop. Virtual subpopulation is unsupported.
+	 *  subpopulation \e subPop. Virtual subpopulation is unsupported. The
+	 *  array supports the buffer protocol so that it can be viewed by
+	 *  \c memoryview or \c numpy.asarray as an array of shape
+	 *  <tt>(individuals, ploidy, loci)</tt> without copying genotypes.
+	 *  Binary and mutant modules do not store alleles as an array so they
+	 *  export a read-only copy of genotypes instead.
 	 *  <group>5-genotype</group>
 	 */
 	PyObject * genotype(vspID subPop = vspID());
@@ -1069,7 +1236,9 @@ public:
 
 	/** Return an editable array of the lineage of alleles for all individuals in
 	 *  a population (if <tt>subPop=[]</tt>, default), or individuals in a
-	 *  subpopulation \e subPop. Virtual subpopulation is unsupported. <bf>
+	 *  subpopulation \e subPop. Virtual subpopulation is unsupported. The
+	 *  array supports the buffer protocol with shape
+	 *  <tt>(individuals, ploidy, loci)</tt>. <bf>
 	 *  This function returns \c None for modules without lineage information.</bf>
 	 *  <group>5-genotype</group>
 	 */
@@ -1420,6 +1589,8 @@ public:
 		// use Individual based
 		if (hasActivatedVirtualSubPop() || !indOrdered())
 			return IndInfoIterator(idx, indIterator());
+		else if (m_infoByColumn)
+			return IndInfoIterator(0, m_info.begin() + idx * m_popSize, 1);
 		else
 			// if not required order, or if the information is ordered
 			return IndInfoIterator(idx, m_info.begin(), infoSize());
@@ -1432,6 +1603,8 @@ public:
 		CHECKRANGEINFO(idx);
 		if (hasActivatedVirtualSubPop() || !indOrdered())
 			return IndInfoIterator(idx, IndIterator(m_inds.end(), m_inds.end(), false));
+		else if (m_infoByColumn)
+			return IndInfoIterator(0, m_info.begin() + (idx + 1) * m_popSize, 1);
 		else
 			return IndInfoIterator(idx, m_info.end(), infoSize());
 	}
@@ -1454,6 +1627,8 @@ public:
 		//
 		if (vsp.isVirtual() || !indOrdered())
 			return IndInfoIterator(idx, indIterator(subPop));
+		else if (m_infoByColumn)
+			return IndInfoIterator(0, m_info.begin() + idx * m_popSize + m_subPopIndex[subPop], 1);
 		else
 			return IndInfoIterator(idx, m_info.begin() + m_subPopIndex[subPop] * infoSize(), infoSize());
 	}
@@ -1470,6 +1645,8 @@ public:
 		// has to adjust order because of parameter subPop
 		if (vsp.isVirtual() || hasActivatedVirtualSubPop(subPop) || !indOrdered())
 			return IndInfoIterator(idx, IndIterator(rawIndEnd(subPop), rawIndEnd(subPop), true));
+		else if (m_infoByColumn)
+			return IndInfoIterator(0, m_info.begin() + idx * m_popSize + m_subPopIndex[subPop + 1], 1);
 		else
 			return IndInfoIterator(idx, m_info.begin() + m_subPopIndex[subPop + 1] * infoSize(), infoSize());
 	}
@@ -1483,6 +1660,25 @@ public:
 	 */
 	vectorf indInfo(const uintString & field, vspID subPop = vspID());
 
+	/** Return a writable \c memoryview of information field \c field (by
+	 *  index or name) of all individuals (if <tt>subPop=[]</tt>, default), or
+	 *  individuals in a subpopulation \e subPop, without copying the values.
+	 *  The view strides through the information fields of individuals so it
+	 *  can be passed directly to \c numpy.asarray. Virtual subpopulation is
+	 *  unsupported. The view keeps the population alive, and functions that
+	 *  reallocate or move information fields (e.g. \c addInfoFields,
+	 *  \c setInfoByColumn, \c push, \c resize, \c removeIndividuals and
+	 *  evolving the population) raise a \c RuntimeError until all views are
+	 *  released. A view created for an ancestral generation keeps referring
+	 *  to that generation after \c useAncestralGen is called. \e owner is
+	 *  the Python object of the population, which is passed automatically.
+	 *  Because a view has to keep its population alive, this function
+	 *  cannot be called for a population that is owned by another object,
+	 *  such as a population returned by \c Simulator.population().
+	 *  <group>8-info</group>
+	 */
+	PyObject * infoView(const uintString & field, vspID subPop = vspID(), PyObject * owner = NULL);
+
 
 	/** Add a list of information fields \e fields to a population and
 	 *  initialize their values to \e init. If an information field alreay
@@ -1523,6 +1719,31 @@ public:
 	 */
 	void setAncestralDepth(int depth);
 
+	/** Keep genotypes of ancestral generations older than \e depth
+	 *  compressed in memory. Compressed generations are decompressed when
+	 *  they are used (e.g. by \c useAncestralGen, \c ancestor, \c indByID
+	 *  or by a pedigree), and compressed again when the present generation
+	 *  is restored or the population evolves to the next generation.
+	 *  Information fields are not compressed so
+	 *  individuals can be located by their IDs without decompressing their
+	 *  generation. A negative \e depth (default) keeps all ancestral
+	 *  generations uncompressed.
+	 *  <group>6-ancestral</group>
+	 */
+	void setAncestralCompression(int depth);
+
+	/** Let ancestral generations share identical chromosome copies with
+	 *  their neighboring generations if \e share is \c True. This saves
+	 *  memory for clonal, haplodiploid or low-recombination populations in
+	 *  which consecutive generations carry mostly the same chromosomes, but
+	 *  costs a hashing pass each time a generation is stored, so it is
+	 *  disabled by default. Shared generations are copied back when they
+	 *  are used (e.g. by \c useAncestralGen, \c ancestor or \c indByID).
+	 *  Chromosomes of the current generation are not shared.
+	 *  <group>6-ancestral</group>
+	 */
+	void setAncestralSharing(bool share);
+
 	/// CPPONLY remove certain ancestral generations
 	void keepAncestralGens(const uintList & ancGens);
 
@@ -1549,16 +1770,48 @@ public:
 	void syncIndPointers(bool infoOnly = false) const;
 
 	/** Save population to a file \e filename, which can be loaded by a global
-	 *  function <tt>loadPopulation(filename)</tt>.
+	 *  function <tt>loadPopulation(filename)</tt>. By default, the population
+	 *  is saved in a compressed text format that can be loaded by all
+	 *  modules. If \e binary is set to \c True, genotype, lineage,
+	 *  information fields and individual flags of all generations are saved
+	 *  as aligned columns of a binary file, which can be mapped into memory
+	 *  and loaded much faster. Such sections can be compressed in independent
+	 *  blocks if \e compress is set to \c True. Individuals of the present
+	 *  generation can also be extracted from such a file without loading
+	 *  the whole population (see \c MappedPopulation).
 	 *  <group>8-pop</group>
 	 */
-	void save(const string & filename) const;
+	void save(const string & filename, bool binary = false, bool compress = false) const;
 
 	/** CPPONLY load Population from file \e filename
 	 *  <group>8-pop</group>
 	 */
 	void load(const string & filename);
 
+	/** CPPONLY
+	 *  Raise a \c RuntimeError if information fields are viewed by
+	 *  \c infoView, because views would be invalidated by functions that
+	 *  reallocate or move information fields.
+	 */
+	void checkInfoViews() const
+	{
+		if (*m_infoViews > 1)
+			throw RuntimeError((boost::format("Information fields of the population cannot be changed when "
+											  "they are viewed by %1% memoryview(s) returned by infoView.") % (*m_infoViews - 1)).str());
+	}
+
+
+private:
+	/// populations are copied by the copy constructor, which does not
+	/// share the counter of views of information fields.
+	Population & operator=(const Population &);
+
+	/// save population in the binary format
+	void saveBinary(const string & filename, bool compress) const;
+
+	/// load population from a file in the binary format
+	void loadBinary(const string & filename);
+
 public:
 	/** return variables of a population as a Python dictionary. If a valid
 	 *  subpopulation \e subPop is specified, a dictionary
@@ -1678,6 +1931,18 @@ private:
 	/// shared variables for this population
 	mutable SharedVariables m_vars;
 
+#ifndef MUTANTALLELE
+	/// alleles on one homologous copy of a chromosome, shared read-only by
+	/// all ancestral generations that carry an identical copy.
+	struct haplotype
+	{
+		size_t hash;
+		vectora alleles;
+	};
+
+	typedef boost::shared_ptr<haplotype> HaplotypePtr;
+#endif
+
 	/// store previous populations
 	/// need to store: subPopSize, genotype and m_inds
 	struct popData
@@ -1698,20 +1963,159 @@ private:
 		vector<Individual> m_inds;
 		bool m_indOrdered;
 
+#ifndef MUTANTALLELE
+		/// chromosome copies of all individuals, in the order of individuals,
+		/// homologous copies and chromosomes. If not empty, m_genotype is
+		/// released and genotypes of individuals are only available after
+		/// materialize().
+		vector<HaplotypePtr> m_haplotypes;
+#endif
+
+		/// genotypes (and lineages) of individuals in the order of
+		/// individuals, compressed by zlib. If not empty, m_genotype (and
+		/// m_lineage) are released until materialize() is called.
+		string m_compressed;
+
+		/// index of IDs of individuals
+		IdIndex m_idIndex;
+
 		// swap between a popData and existing data.
 		void swap(Population & pop);
 
+		// whether or not genotypes are stored as shared haplotypes.
+		bool shared() const
+		{
+#ifdef MUTANTALLELE
+			return false;
+#else
+			return !m_haplotypes.empty();
+#endif
+		}
+
+
+		bool compressed() const
+		{
+			return !m_compressed.empty();
+		}
+
+
+		// compress genotypes if this saves memory.
+		void compress();
+
+		// copy shared haplotypes back to m_genotype, or decompress
+		// genotypes, so that genotype pointers of individuals become valid.
+		void materialize();
+
 	};
 
-	std::deque<popData> m_ancestralPops;
+	/// ancestral generations, which are materialized on demand by const
+	/// accessors.
+	mutable std::deque<popData> m_ancestralPops;
+
+	/// let ancestral generation \e genIdx (index to m_ancestralPops) share
+	/// identical chromosome copies with its neighboring generations, if this
+	/// saves memory. The current generation is not shared because raw
+	/// genotype iterators and array views point into m_genotype.
+	void shareHaplotypes(size_t genIdx);
+
+	/// compress ancestral generations older than m_compressDepth.
+	void compressAncestralGens();
+
+	/// beginning of indexes of individuals in the activated virtual
+	/// subpopulation, which is never NULL.
+	const size_t * vspMembersBegin() const
+	{
+		static const size_t noMember = 0;
+
+		return m_vspMembers.empty() ? &noMember : &m_vspMembers[0];
+	}
+
+
+	/// end of indexes of individuals in the activated virtual subpopulation
+	const size_t * vspMembersEnd() const
+	{
+		return vspMembersBegin() + m_vspMembers.size();
+	}
+
+
+	/// distance between information fields of adjacent individuals
+	size_t indInfoStep() const
+	{
+		return m_infoByColumn && infoSize() > 0 ? 1 : infoSize();
+	}
+
+
+	/// distance between adjacent information fields of an individual in a
+	/// generation with \e size individuals.
+	size_t fieldInfoStep(size_t size) const
+	{
+		return m_infoByColumn ? size : 1;
+	}
+
+
+	/// rearrange information fields of the current generation in the order
+	/// of individuals, stored by field (\e byColumn is \c true) or by
+	/// individual. Fields are read through individual info pointers so
+	/// functions that move individuals can leave information fields stored
+	/// by field in place and call this function once afterwards.
+	void layoutInfo(bool byColumn) const;
+
+	/// ancestral generation \e genIdx with genotypes of individuals
+	/// materialized. Materializing a shared or compressed generation does
+	/// not change its content, so it is also done for const populations,
+	/// one thread at a time. The state of the generation is checked in the
+	/// same critical section because another thread might be materializing
+	/// it.
+	popData & ancestralData(size_t genIdx) const
+	{
+		popData & pd = m_ancestralPops[genIdx];
+
+#pragma omp critical(materializeAncestralGen)
+		{
+			if (pd.shared() || pd.compressed())
+				pd.materialize();
+		}
+		return pd;
+	}
+
 
 	/// current ancestral depth
 	int m_curAncestralGen;
 
+	/// number of ancestral generations that are not compressed, -1 for all
+	int m_compressDepth;
+
+	/// whether or not ancestral generations share chromosome copies
+	bool m_shareHaplotypes;
+
 	/// whether or not individual genotype and information are in order
 	/// within a population.
 	mutable bool m_indOrdered;
 
+	/// whether or not information fields are stored by field
+	bool m_infoByColumn;
+
+	/// references to a counter shared with views of information fields
+	/// returned by infoView, one by the population and one by each view.
+	/// The last holder frees it so that a view can be released after the
+	/// population is destroyed.
+	size_t * m_infoViews;
+
+	/// indexes of individuals in the activated virtual subpopulation,
+	/// collected when the virtual subpopulation is activated
+	mutable vectoru m_vspMembers;
+
+	/// subpopulation, virtual subpopulation and range of individuals for
+	/// which m_vspMembers were collected by a splitter with positional
+	/// membership, empty if m_vspMembers cannot be reused.
+	mutable vectoru m_vspMembersKey;
+
+	/// activated virtual subpopulation of the activated subpopulation
+	mutable size_t m_activatedVSP;
+
+	/// index of IDs of individuals in the current generation
+	mutable IdIndex m_idIndex;
+
 	mutable size_t m_gen;
 	mutable size_t m_rep;
 
@@ -1755,10 +2159,100 @@ public:
 
 };
 
-/** load a population from a file saved by <tt>Population::save()</tt>.
+/** load a population from a file saved by <tt>Population::save()</tt>. The
+ *  format (text or binary) of the file is detected automatically.
  */
 Population & loadPopulation(const string & file);
 
+
+/** A read-only view of a population saved by <tt>Population::save()</tt>
+ *  in the binary format. The file is mapped into memory and only its
+ *  header, genotypic structure and subpopulation sizes are read when the
+ *  view is created, so that individuals can be extracted (e.g. sampled)
+ *  from a large population without loading all its individuals. Only the
+ *  present generation of the saved population is accessible from a view.
+ */
+class MappedPopulation : public GenoStruTrait
+{
+public:
+	/** Map a file \e filename that is saved by <tt>Population::save()</tt>
+	 *  with \e binary set to \c True. A \c ValueError will be raised if the
+	 *  file is not in the binary format. The file should not be changed when
+	 *  the view exists.
+	 */
+	MappedPopulation(const string & filename);
+
+	/// destructor
+	~MappedPopulation();
+
+	/** Return the total number of individuals of the present generation of
+	 *  the saved population.
+	 */
+	size_t popSize() const
+	{
+		return accumulate(m_subPopSize.begin(), m_subPopSize.end(), size_t(0));
+	}
+
+
+	/** Return the sizes of all subpopulations of the present generation of
+	 *  the saved population.
+	 */
+	vectoru subPopSizes() const
+	{
+		return m_subPopSize;
+	}
+
+
+	/** Return the number of ancestral generations saved in the file.
+	 */
+	size_t ancestralGens() const
+	{
+		return m_numGens - 1;
+	}
+
+
+	/** Extract individuals with given absolute \e indexes from the present
+	 *  generation of the saved population and return them as a new
+	 *  population with the subpopulation structure (subpopulations can be
+	 *  empty) and variables of the saved population. Individuals are
+	 *  extracted in the order they appear in the saved population and
+	 *  duplicated indexes are ignored. Only sections of the file that hold
+	 *  the extracted individuals are read (and decompressed if the file
+	 *  is compressed) so this function can be used to draw samples from a
+	 *  population that is too large to be loaded.
+	 */
+	Population & extractIndividuals(const uintList & indexes = vectoru()) const;
+
+private:
+	MappedPopulation(const MappedPopulation &);
+
+	string m_filename;
+
+	boost::iostreams::mapped_file_source m_file;
+
+	/// version of the file format
+	size_t m_version;
+
+	/// allele encoding of the file
+	size_t m_encoding;
+
+	/// if information fields are saved by field
+	bool m_infoByColumn;
+
+	/// number of saved generations
+	size_t m_numGens;
+
+	/// location of the table of sections in the file
+	size_t m_tableOffset;
+
+	vectoru m_subPopSize;
+
+	vectorstr m_subPopNames;
+
+	/// pickled population variables
+	string m_vars;
+};
+
 }
 
 
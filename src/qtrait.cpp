@@ -92,6 +92,14 @@ bool BaseQuanTrait::applyDuringMating(Population & pop, Population & offPop, Raw
 
 void PyQuanTrait::qtrait(Individual * ind, size_t gen, vectorf & traits) const
 {
+	if (m_cache.enabled()) {
+		const vectorf * cached = m_cache.find(*ind, m_loci.elems(ind), gen);
+		if (cached) {
+			traits = *cached;
+			return;
+		}
+	}
+
 	PyObject * args = PyTuple_New(m_func.numArgs());
 
 	DBG_ASSERT(args, RuntimeError, "Failed to create a parameter tuple");
@@ -135,6 +143,8 @@ void PyQuanTrait::qtrait(Individual * ind, size_t gen, vectorf & traits) const
 	} else {
 		DBG_FAILIF(true, RuntimeError, "Invalid return value from penetrance function.");
 	}
+	if (m_cache.enabled())
+		m_cache.insert(traits);
 	return;
 }
 
@@ -146,14 +146,17 @@ public:
 	 *  trait fields (\e infoField). If only one trait field is specified, a
 	 *  number or a sequence of one element is acceptable. Otherwise, a
 	 *  sequence of values will be accepted and be assigned to each trait
-	 *  field.
+	 *  field. If \e cache is set to \c True, trait values are cached for each
+	 *  distinct genotype (and values of requested information fields) so that
+	 *  \e func is called only once for individuals with the same genotype
+	 *  (see \c PySelector for details).
 	 */
 	PyQuanTrait(PyObject * func, const lociList & loci = vectoru(),
 		const uintList ancGens = uintList(NULL), int begin = 0, int end = -1, int step = 1,
 		const intList & at = vectori(), const intList & reps = intList(), const subPopList & subPops = subPopList(),
-		const stringList & infoFields = vectorstr()) :
+		const stringList & infoFields = vectorstr(), bool cache = false) :
 		BaseQuanTrait(ancGens, begin, end, step, at, reps, subPops, infoFields),
-		m_func(func), m_loci(loci)
+		m_func(func), m_loci(loci), m_cache(m_func, cache)
 	{
 		DBG_ASSERT(m_func.isValid(), ValueError, "Passed variable is not a callable python function.");
 
@@ -171,6 +174,25 @@ public:
 	 */
 	virtual void qtrait(Individual * ind, size_t gen, vectorf & traits) const;
 
+	/** Clear values cached for distinct genotypes and reset the number of
+	 *  hits and misses of the cache (if \e cache is \c True).
+	 */
+	void clearCache()
+	{
+		m_cache.clear(true);
+	}
+
+
+	/** Return the number of cache hits and misses, namely the number of
+	 *  individuals that are assigned a cached value and the number of calls
+	 *  to the user-defined function (if \e cache is \c True).
+	 */
+	vectoru cacheStats() const
+	{
+		return m_cache.stats();
+	}
+
+
 	/// HIDDEN
 	string describe(bool format = true) const
 	{
@@ -185,6 +207,9 @@ private:
 
 	/// susceptibility loci
 	const lociList m_loci;
+
+	/// trait values of distinct genotypes
+	mutable GenoValueCache m_cache;
 };
 
 }
@@ -34,32 +34,62 @@ using std::ostringstream;
 
 namespace simuPOP {
 
+// individuals are evaluated in blocks of this size so that a selector can
+// process a block locus by locus, and blocks are distributed to threads
+#define FITNESS_BLOCK_SIZE 1024
+
+void BaseSelector::batchFitness(Population & pop, const vector<RawIndIterator> & inds,
+                                size_t first, size_t last, vectorf & fitness) const
+{
+	fitness.resize(last - first);
+	for (size_t i = first; i < last; ++i)
+		fitness[i - first] = indFitness(pop, inds[i]);
+}
+
+
 bool BaseSelector::apply(Population & pop) const
 {
 	size_t fit_id = pop.infoIdx(this->infoField(0));
 
+	// initialize operator before entering parallel region in order to avoid race condition
+	if (pop.popSize() > 0)
+		initializeIfNeeded(*pop.rawIndBegin());
+
 	subPopList subPops = applicableSubPops(pop);
 
 	subPopList::const_iterator sp = subPops.begin();
 	subPopList::const_iterator spEnd = subPops.end();
 
+	bool inBlocks = batchable() || (numThreads() > 1 && parallelizable());
+	vector<RawIndIterator> inds;
 	for (; sp != spEnd; ++sp) {
 		if (sp->isVirtual())
 			pop.activateVirtualSubPop(*sp);
-		if (numThreads() > 1 && parallelizable()) {
-#pragma omp parallel
-			{
-#ifdef _OPENMP
-				IndIterator ind = pop.indIterator(sp->subPop(), omp_get_thread_num());
-				for (; ind.valid(); ++ind)
-					ind->setInfo(indFitness(pop, ind.rawIter()), fit_id);
-#endif
-			}
 
-		} else {
-			IndIterator ind = pop.indIterator(sp->subPop());
-			for (; ind.valid(); ++ind)
-				ind->setInfo(indFitness(pop, ind.rawIter()), fit_id);
+		IndIterator it = pop.indIterator(sp->subPop());
+		if (!inBlocks) {
+			for (; it.valid(); ++it)
+				it->setInfo(indFitness(pop, it.rawIter()), fit_id);
+			if (sp->isVirtual())
+				pop.deactivateVirtualSubPop(sp->subPop());
+			continue;
+		}
+		inds.clear();
+		for (; it.valid(); ++it)
+			inds.push_back(it.rawIter());
+
+		long numBlocks = static_cast<long>((inds.size() + FITNESS_BLOCK_SIZE - 1) / FITNESS_BLOCK_SIZE);
+#pragma omp parallel if(numThreads() > 1 && parallelizable() && numBlocks > 1)
+		{
+			vectorf fitness;
+#pragma omp for schedule(dynamic)
+			for (long b = 0; b < numBlocks; ++b) {
+				size_t first = b * FITNESS_BLOCK_SIZE;
+				size_t last = std::min(first + FITNESS_BLOCK_SIZE, inds.size());
+				batchFitness(pop, inds, first, last, fitness);
+				for (size_t i = first; i < last; ++i)
+					inds[i]->setInfo(fitness[i - first], fit_id);
+			}
 		}
 		if (sp->isVirtual())
 			pop.deactivateVirtualSubPop(sp->subPop());
@@ -71,143 +101,43 @@ bool BaseSelector::apply(Population & pop) const
 
 double MapSelector::indFitness(Population & pop, RawIndIterator ind) const
 {
-	vectoru chromTypes;
-	const vectoru & loci = m_loci.elems(&pop);
-
-	for (size_t i = 0; i < loci.size(); ++i)
-		chromTypes.push_back(ind->chromType(ind->chromLocusPair(loci[i]).first));
-
-	size_t ply = ind->ploidy();
-	if (ind->isHaplodiploid() && (*ind).sex() == MALE)
-		ply = 1;
-
-	vectori alleles;
-	alleles.reserve(ply * loci.size());
-
-	for (size_t idx = 0; idx < loci.size(); ++idx) {
-		for (size_t p = 0; p < ply; ++p) {
-			if (chromTypes[idx] == CHROMOSOME_Y && ind->sex() == FEMALE)
-				continue;
-			if (((chromTypes[idx] == CHROMOSOME_X && p == 1) ||
-			     (chromTypes[idx] == CHROMOSOME_Y && p == 0)) && ind->sex() == MALE)
-				continue;
-			if (chromTypes[idx] == MITOCHONDRIAL && p > 0)
-				continue;
-			alleles.push_back(ind->allele(loci[idx], p));
-		}
-	}
-
-	tupleDict::const_iterator pos = m_dict.find(alleles);
-
-	if (pos != m_dict.end())
-		return pos->second;
-
-	if (ply > 1) {
-		// try to look up the key without phase
-		tupleDict::const_iterator it = m_dict.begin();
-		tupleDict::const_iterator itEnd = m_dict.end();
-		for (; it != itEnd; ++it) {
-			bool ok = true;
-			const tupleDict::key_type & key = it->first;
-			size_t begin_idx = 0;
-			size_t end_idx = 0;
-			for (size_t i = 0; i < loci.size(); ++i) {
-				if (chromTypes[i] == CHROMOSOME_Y) {
-					if (ind->sex() == FEMALE)
-						continue;
-					else
-						++end_idx;
-				} else if (chromTypes[i] == CHROMOSOME_X && ind->sex() == MALE)
-					++end_idx;
-				else if (chromTypes[i] == MITOCHONDRIAL)
-					++end_idx;
-				else
-					end_idx += ply;
-				if (key.size() != end_idx - begin_idx) {
-					ok = false;
-					break;
-				}
-				if (ply == 2) {
-					if ((alleles[begin_idx] != key[0] || alleles[end_idx - 1] != key[1]) &&
-					    (alleles[begin_idx] != key[1] || alleles[end_idx - 1] != key[0])) {
-						ok = false;
-						break;
-					}
-				} else {
-					std::sort(alleles.begin() + begin_idx, alleles.begin() + end_idx);
-					tupleDict::key_type sorted_key = it->first;
-					std::sort(sorted_key.begin(), sorted_key.end());
-					for (size_t j = 0; j < sorted_key.size(); ++j) {
-						if (alleles[ply * i + j] != sorted_key[j]) {
-							ok = false;
-							break;
-						}
-					}
-				}
-				begin_idx = end_idx;
-			}
-			if (ok)
-				return it->second;
-		}
-	}
-	// no match
-	ostringstream allele_string;
-	allele_string << "(";
-	for (size_t i = 0; i < alleles.size(); ++i) {
-		if (i != 0)
-			allele_string << ", ";
-		allele_string << alleles[i];
-	}
-	allele_string << ")";
-	throw ValueError("No fitness value for genotype " + allele_string.str());
-	// this line should not be reached.
-	return 0;
+	return m_table.value(*ind, m_loci.elems(&pop));
 }
 
 
 // currently assuming diploid
 double MaSelector::indFitness(Population & pop, RawIndIterator ind) const
 {
-	UINT index = 0;
-	bool singleST = m_wildtype.size() == 1;
 	const vectoru & loci = m_loci.elems(&pop);
 
 	DBG_FAILIF((ind->ploidy() == 2 && m_fitness.size() != static_cast<UINT>(pow(3., static_cast<double>(loci.size())))) ||
 		(ind->ploidy() == 1 && m_fitness.size() != static_cast<UINT>(pow(2., static_cast<double>(loci.size())))),
 		ValueError, "Please specify fitness for each combination of genotype.");
+	DBG_FAILIF(ind->ploidy() > 2, ValueError, "The MaSelector only supports haploid and diploid populations.");
 
-	for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc) {
-		if (ind->ploidy() == 1) {
-			Allele a = TO_ALLELE(ind->allele(*loc));
-			if (singleST)
-				index = index * 2 + (ALLELE_AS_UNSINGED(a) != m_wildtype[0]);
-			else
-				index = index * 2 + (find(m_wildtype.begin(), m_wildtype.end(), ALLELE_AS_UNSINGED(a)) == m_wildtype.end());
-		} else if (ind->ploidy() == 2) {
-			// get genotype of ind
-			Allele a = TO_ALLELE(ind->allele(*loc, 0));
-			Allele b = TO_ALLELE(ind->allele(*loc, 1));
-
-			int numWildtype = 0;
-
-			// count number of wildtype
-			// this improve the performance a little bit
-			if (singleST) {
-				numWildtype = (ALLELE_AS_UNSINGED(a) == m_wildtype[0]) + (ALLELE_AS_UNSINGED(b) == m_wildtype[0]);
-			} else {
-				if (find(m_wildtype.begin(), m_wildtype.end(), ALLELE_AS_UNSINGED(a)) != m_wildtype.end())
-					numWildtype++;
+	return m_fitness[m_index.index(*ind, loci)];
+}
 
-				if (find(m_wildtype.begin(), m_wildtype.end(), ALLELE_AS_UNSINGED(b)) != m_wildtype.end())
-					numWildtype++;
-			}
 
-			index = index * 3 + 2 - numWildtype;
-		} else {
-			DBG_FAILIF(true, ValueError, "The MaSelector only supports haploid and diploid populations.");
-		}
+void MaSelector::batchFitness(Population & pop, const vector<RawIndIterator> & inds,
+                              size_t first, size_t last, vectorf & fitness) const
+{
+	if (first == last) {
+		fitness.clear();
+		return;
 	}
-	return m_fitness[index];
+	const vectoru & loci = m_loci.elems(&pop);
+
+	DBG_FAILIF((inds[first]->ploidy() == 2 && m_fitness.size() != static_cast<UINT>(pow(3., static_cast<double>(loci.size())))) ||
+		(inds[first]->ploidy() == 1 && m_fitness.size() != static_cast<UINT>(pow(2., static_cast<double>(loci.size())))),
+		ValueError, "Please specify fitness for each combination of genotype.");
+	DBG_FAILIF(inds[first]->ploidy() > 2, ValueError, "The MaSelector only supports haploid and diploid populations.");
+
+	vectoru indexes;
+	m_index.index(inds, first, last, loci, indexes);
+	fitness.resize(last - first);
+	for (size_t i = 0; i < indexes.size(); ++i)
+		fitness[i] = m_fitness[indexes[i]];
 }
 
 
@@ -260,6 +190,19 @@ private:
 };
 
 
+bool MlSelector::canApplyConcurrently() const
+{
+	if (!noOutput())
+		return false;
+	opList::const_iterator it = m_selectors.begin();
+	opList::const_iterator itEnd = m_selectors.end();
+	for (; it != itEnd; ++it)
+		if (!(*it)->canApplyConcurrently())
+			return false;
+	return true;
+}
+
+
 double MlSelector::indFitness(Population & pop, RawIndIterator ind) const
 {
 	FitnessAccumulator fit(m_mode);
@@ -277,8 +220,43 @@ double MlSelector::indFitness(Population & pop, RawIndIterator ind) const
 }
 
 
+void MlSelector::batchFitness(Population & pop, const vector<RawIndIterator> & inds,
+                              size_t first, size_t last, vectorf & fitness) const
+{
+	vector<FitnessAccumulator> fit(last - first, FitnessAccumulator(m_mode));
+	vectorf values;
+
+	opList::const_iterator s = m_selectors.begin();
+	opList::const_iterator sEnd = m_selectors.end();
+
+	for (; s != sEnd; ++s) {
+		if (!(*s)->isActive(pop.rep(), pop.gen()))
+			continue;
+		const BaseSelector * sel = dynamic_cast<const BaseSelector * >(*s);
+		if ((*s)->applicableToAllOffspring()) {
+			sel->batchFitness(pop, inds, first, last, values);
+			for (size_t i = 0; i < values.size(); ++i)
+				fit[i].push(values[i]);
+		} else {
+			for (size_t i = first; i < last; ++i)
+				if ((*s)->applicableToOffspring(pop, inds[i]))
+					fit[i - first].push(sel->indFitness(pop, inds[i]));
+		}
+	}
+	fitness.resize(last - first);
+	for (size_t i = 0; i < fit.size(); ++i)
+		fitness[i] = fit[i].value();
+}
+
+
 double PySelector::indFitness(Population & pop, RawIndIterator ind) const
 {
+	if (m_cache.enabled()) {
+		const vectorf * cached = m_cache.find(*ind, m_loci.elems(&*ind), pop.gen());
+		if (cached)
+			return (*cached)[0];
+	}
+
 	PyObject * args = PyTuple_New(m_func.numArgs());
 
 	DBG_ASSERT(args, RuntimeError, "Failed to create a parameter tuple");
@@ -305,6 +283,8 @@ double PySelector::indFitness(Population & pop, RawIndIterator ind) const
 
 	double fitness = m_func(PyObj_As_Double, args);
 	Py_XDECREF(args);
+	if (m_cache.enabled())
+		m_cache.insert(vectorf(1, fitness));
 	return fitness;
 }
 
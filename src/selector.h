@@ -148,6 +148,26 @@ public:
 	}
 
 
+	/** CPPONLY
+	 *  calculate fitness values of individuals <tt>inds[first:last]</tt> and
+	 *  save them to \e fitness, which will be resized to <tt>last - first</tt>.
+	 *  Derived selectors can evaluate the whole batch locus by locus, the
+	 *  default implementation calls \c indFitness for each individual.
+	 */
+	virtual void batchFitness(Population & pop, const vector<RawIndIterator> & inds,
+		size_t first, size_t last, vectorf & fitness) const;
+
+	/** CPPONLY
+	 *  Return \c True if \c batchFitness is faster than calling \c indFitness
+	 *  for each individual, so individuals are collected and evaluated in
+	 *  blocks even if the selector is applied by a single thread.
+	 */
+	virtual bool batchable() const
+	{
+		return false;
+	}
+
+
 	/// HIDDEN set fitness to all individuals. No selection will happen!
 	bool apply(Population & pop) const;
 
@@ -205,14 +225,16 @@ public:
 	 *  still can not be found, a \c ValueError will be raised. This
 	 *  operator supports sex chromosomes and haplodiploid populations. In
 	 *  these cases, only valid genotypes should be used to generator the
-	 *  dictionary keys.
+	 *  dictionary keys. If the number of possible genotypes is small, the
+	 *  dictionary is expanded into a table of fitness values of all genotypes
+	 *  so that fitness of individuals can be looked up directly.
 	 */
 	MapSelector(const lociList & loci, const tupleDict & fitness,
 		int begin = 0, int end = -1, int step = 1, const intList & at = vectori(),
 		const intList & reps = intList(), const subPopList & subPops = subPopList(),
 		const stringList & infoFields = stringList("fitness")) :
 		BaseSelector("", begin, end, step, at, reps, subPops, infoFields),
-		m_loci(loci), m_dict(fitness)
+		m_loci(loci), m_table(fitness, "fitness")
 	{
 	};
 
@@ -233,6 +255,15 @@ public:
 	 */
 	virtual double indFitness(Population & pop, RawIndIterator ind) const;
 
+	/// CPPONLY
+	virtual void initializeIfNeeded(const Individual & ind) const
+	{
+		// loci returned from a function can change from generation to generation
+		if (!m_loci.fromFunc())
+			m_table.compile(ind, m_loci.elems(&ind));
+	}
+
+
 	/// HIDDEN
 	string describe(bool format = true) const
 	{
@@ -248,12 +279,19 @@ public:
 	}
 
 
+	/// CPPONLY
+	bool canApplyConcurrently() const
+	{
+		return noOutput();
+	}
+
+
 private:
 	///
 	const lociList m_loci;
 
 	/// fitness for each genotype
-	const tupleDict m_dict;
+	const GenoValueTable m_table;
 };
 
 /** This operator is called a 'multi-allele' selector because it groups
@@ -293,9 +331,9 @@ public:
 		const intList & at = vectori(), const intList & reps = intList(), const subPopList & subPops = subPopList(),
 		const stringList & infoFields = stringList("fitness")) :
 		BaseSelector("", begin, end, step, at, reps, subPops, infoFields),
-		m_loci(loci), m_fitness(fitness), m_wildtype(wildtype.elems())
+		m_loci(loci), m_fitness(fitness), m_index(wildtype.elems())
 	{
-		DBG_WARNIF(m_wildtype.empty(), "No wild type allele is defined.");
+		DBG_WARNIF(wildtype.elems().empty(), "No wild type allele is defined.");
 	};
 
 	virtual ~MaSelector()
@@ -314,6 +352,17 @@ public:
 	/// calculate/return the fitness value, currently assuming diploid
 	virtual double indFitness(Population & pop, RawIndIterator ind) const;
 
+	/// CPPONLY
+	virtual void batchFitness(Population & pop, const vector<RawIndIterator> & inds,
+		size_t first, size_t last, vectorf & fitness) const;
+
+	/// CPPONLY
+	bool batchable() const
+	{
+		return true;
+	}
+
+
 	/// HIDDEN
 	string describe(bool format = true) const
 	{
@@ -329,6 +378,13 @@ public:
 	}
 
 
+	/// CPPONLY
+	bool canApplyConcurrently() const
+	{
+		return noOutput();
+	}
+
+
 private:
 	/// one locus
 	const lociList m_loci;
@@ -336,8 +392,8 @@ private:
 	/// fitness for each genotype
 	const vectorf m_fitness;
 
-	///
-	const vectoru m_wildtype;
+	/// index of genotypes in m_fitness
+	const WildtypeGenoIndex m_index;
 };
 
 
@@ -394,6 +450,28 @@ public:
 	 */
 	virtual double indFitness(Population & pop, RawIndIterator ind) const;
 
+	/// CPPONLY
+	virtual void batchFitness(Population & pop, const vector<RawIndIterator> & inds,
+		size_t first, size_t last, vectorf & fitness) const;
+
+	/// CPPONLY
+	bool batchable() const
+	{
+		return true;
+	}
+
+
+	/// CPPONLY initialize all selectors before they are applied in parallel
+	virtual void initializeIfNeeded(const Individual & ind) const
+	{
+		opList::const_iterator s = m_selectors.begin();
+		opList::const_iterator sEnd = m_selectors.end();
+
+		for (; s != sEnd; ++s)
+			(*s)->initializeIfNeeded(ind);
+	}
+
+
 	/// HIDDEN
 	string describe(bool format = true) const
 	{
@@ -409,6 +487,10 @@ public:
 	}
 
 
+	/// CPPONLY
+	bool canApplyConcurrently() const;
+
+
 private:
 	/// a list of selectors
 	const opList m_selectors;
@@ -441,15 +523,21 @@ public:
 	/** Create a Python hybrid selector that passes genotype at specified
 	 *  \e loci, values at specified information fields (if requested) and
 	 *  a generation number to a user-defined function \e func. The return
-	 *  value will be treated as individual fitness.
+	 *  value will be treated as individual fitness. If \e cache is set to
+	 *  \c True, fitness values are cached for each distinct genotype (and
+	 *  values of requested information fields) so that \e func is called
+	 *  only once for individuals with the same genotype. The cache is
+	 *  cleared at each generation if \e func accepts parameter \c gen, so
+	 *  \e func should return the same value for the same parameters. This
+	 *  option cannot be used if \e func accepts parameter \c ind or \c pop.
 	 */
 	PySelector(PyObject * func, lociList loci = vectoru(),
 		int begin = 0, int end = -1, int step = 1,
 		const intList & at = vectori(), const intList & reps = intList(), const stringFunc & output = "",
 		const subPopList & subPops = subPopList(),
-		const stringList & infoFields = stringList("fitness")) :
+		const stringList & infoFields = stringList("fitness"), bool cache = false) :
 		BaseSelector(output, begin, end, step, at, reps, subPops, infoFields),
-		m_func(func), m_loci(loci)
+		m_func(func), m_loci(loci), m_cache(m_func, cache)
 	{
 		DBG_ASSERT(m_func.isValid(), ValueError, "Passed variable is not a callable python function.");
 	}
@@ -467,6 +555,25 @@ public:
 	 */
 	virtual double indFitness(Population & pop, RawIndIterator ind) const;
 
+	/** Clear values cached for distinct genotypes and reset the number of
+	 *  hits and misses of the cache (if \e cache is \c True).
+	 */
+	void clearCache()
+	{
+		m_cache.clear(true);
+	}
+
+
+	/** Return the number of cache hits and misses, namely the number of
+	 *  individuals that are assigned a cached value and the number of calls
+	 *  to the user-defined function (if \e cache is \c True).
+	 */
+	vectoru cacheStats() const
+	{
+		return m_cache.stats();
+	}
+
+
 	/// HIDDEN
 	string describe(bool format = true) const
 	{
@@ -489,6 +596,8 @@ private:
 	/// susceptibility loci
 	const lociList m_loci;
 
+	/// fitness values of distinct genotypes
+	mutable GenoValueCache m_cache;
 };
 
 
@@ -416,7 +416,7 @@ public:
 
 
 	/// return error message
-	const char * message()
+	const char * message() const
 	{
 		return m_msg.c_str();
 	}
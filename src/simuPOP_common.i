@@ -240,6 +240,7 @@ namespace std
 %newobject simuPOP::Population::extractSubPops;
 %newobject simuPOP::Population::extractIndividuals;
 %newobject simuPOP::Population::clone;
+%newobject simuPOP::MappedPopulation::extractIndividuals;
 %newobject simuPOP::Simulator::extract;
 %newobject simuPOP::Simulator::clone;
 %newobject simuPOP::BaseOperator::clone;
@@ -808,6 +808,8 @@ Details:
 
 "; 
 
+%ignore simuPOP::BaseVspSplitter::positional() const;
+
 %ignore simuPOP::BaseVspSplitter::size(const Population &pop, size_t subPop, size_t virtualSubPop) const;
 
 %feature("docstring") simuPOP::BaseVspSplitter::vspByName "
@@ -1369,6 +1371,8 @@ Details:
 
 "; 
 
+%ignore simuPOP::CombinedSplitter::positional() const;
+
 %ignore simuPOP::CombinedSplitter::size(const Population &pop, size_t subPop, size_t virtualSubPop) const;
 
 %feature("docstring") simuPOP::CombinedSplitter::~CombinedSplitter "
@@ -1741,6 +1745,73 @@ Usage:
 
 %ignore simuPOP::Expression;
 
+%feature("docstring") simuPOP::ExportGenotype "
+
+Details:
+
+    An operator that exports genotypes of a population directly from
+    its genotype storage, which is much faster than exporters in
+    module simuPOP.utils that format individuals in Python.
+
+"; 
+
+%feature("docstring") simuPOP::ExportGenotype::ExportGenotype "
+
+Usage:
+
+    ExportGenotype(output=\"\", format=\"PLINK\", loci=ALL_AVAIL,
+      idField=\"ind_id\", begin=0, end=-1, step=1, at=[],
+      reps=ALL_AVAIL, subPops=ALL_AVAIL, infoFields=[])
+
+Details:
+
+    Create an operator that exports genotypes at loci (default to all
+    loci) of individuals in (virtual) subpopulations subPops (default
+    to all individuals) of the present generation in format. If format
+    is 'PLINK', individuals and loci are written to output.fam and
+    output.bim, and genotypes are written to output.bed in the
+    SNP-major binary format of PLINK. Because this format only
+    supports bi-allelic loci, allele 0 is exported as the second
+    allele and all other alleles are exported as the first allele. If
+    format is 'VCF', phased genotypes are written to output in Variant
+    Call Format, with allele 0 as reference allele. Names of
+    chromosomes and loci are used if they are available. Names of
+    alleles are used as REF and ALT alleles if they are distinct
+    sequences of bases (A, C, G, T and N). Otherwise, N is written as
+    the reference allele and alleles 1, 2, ... are written as symbolic
+    alleles <A1>, <A2>, ... Locus positions are written as integers,
+    and should be at least 1 for VCF. Alleles on unused copies of sex
+    chromosomes are exported as missing (PLINK) or haploid (VCF)
+    genotypes. Individuals are identified by values at information
+    field idField if it exists, and by their 1-based indexes
+    otherwise. Genotypes are encoded in parallel in chunks of loci so
+    the memory used does not grow with the number of loci. Parameter
+    output can be a filename (or a prefix for format 'PLINK') or an
+    expression prefixed by '!' that is evaluated in the local
+    namespace of the population. Please refer to class BaseOperator
+    for a detailed description about common operator parameters such
+    as begin.
+
+"; 
+
+%feature("docstring") simuPOP::ExportGenotype::apply "Obsolete or undocumented function."
+
+%feature("docstring") simuPOP::ExportGenotype::clone "Obsolete or undocumented function."
+
+%feature("docstring") simuPOP::ExportGenotype::describe "Obsolete or undocumented function."
+
+%feature("docstring") simuPOP::ExportGenotype::~ExportGenotype "
+
+Description:
+
+    destructor.
+
+Usage:
+
+    x.~ExportGenotype()
+
+"; 
+
 %feature("docstring") simuPOP::Expression::Expression "
 
 Usage:
@@ -3935,6 +4006,105 @@ Usage:
 
 %ignore simuPOP::LineageVecAsNumArray(LineageIterator begin, LineageIterator end);
 
+%feature("docstring") simuPOP::MappedPopulation "
+
+Details:
+
+    A read-only view of a population saved by Population::save() in
+    the binary format. The file is mapped into memory and only its
+    header, genotypic structure and subpopulation sizes are read when
+    the view is created, so that individuals can be extracted (e.g.
+    sampled) from a large population without loading all its
+    individuals. Only the present generation of the saved population
+    is accessible from a view.
+
+"; 
+
+%feature("docstring") simuPOP::MappedPopulation::MappedPopulation "
+
+Usage:
+
+    MappedPopulation(filename)
+
+Details:
+
+    Map a file filename that is saved by Population::save() with
+    binary set to True. A ValueError will be raised if the file is not
+    in the binary format. The file should not be changed when the view
+    exists.
+
+"; 
+
+%feature("docstring") simuPOP::MappedPopulation::~MappedPopulation "
+
+Description:
+
+    destructor
+
+Usage:
+
+    x.~MappedPopulation()
+
+"; 
+
+%feature("docstring") simuPOP::MappedPopulation::popSize "
+
+Usage:
+
+    x.popSize()
+
+Details:
+
+    Return the total number of individuals of the present generation
+    of the saved population.
+
+"; 
+
+%feature("docstring") simuPOP::MappedPopulation::subPopSizes "
+
+Usage:
+
+    x.subPopSizes()
+
+Details:
+
+    Return the sizes of all subpopulations of the present generation
+    of the saved population.
+
+"; 
+
+%feature("docstring") simuPOP::MappedPopulation::ancestralGens "
+
+Usage:
+
+    x.ancestralGens()
+
+Details:
+
+    Return the number of ancestral generations saved in the file.
+
+"; 
+
+%feature("docstring") simuPOP::MappedPopulation::extractIndividuals "
+
+Usage:
+
+    x.extractIndividuals(indexes=[])
+
+Details:
+
+    Extract individuals with given absolute indexes from the present
+    generation of the saved population and return them as a new
+    population with the subpopulation structure (subpopulations can be
+    empty) and variables of the saved population. Individuals are
+    extracted in the order they appear in the saved population and
+    duplicated indexes are ignored. Only sections of the file that
+    hold the extracted individuals are read (and decompressed if the
+    file is compressed) so this function can be used to draw samples
+    from a population that is too large to be loaded.
+
+"; 
+
 %feature("docstring") simuPOP::MaPenetrance "
 
 Details:
@@ -5877,7 +6047,8 @@ Usage:
 
     Population(size=[], ploidy=2, loci=[], chromTypes=[],
       lociPos=[], ancGen=0, chromNames=[], alleleNames=[],
-      lociNames=[], subPopNames=[], infoFields=[])
+      lociNames=[], subPopNames=[], infoFields=[],
+      infoByColumn=False)
 
 Details:
 
@@ -5953,6 +6124,15 @@ Arguments:
                     specified.
     infoFields:     Names of information fields (named float number)
                     that will be attached to each individual.
+    infoByColumn:   If set to True, values of each information field
+                    are stored contiguously for all individuals in a
+                    generation, instead of being stored individual by
+                    individual. This layout speeds up operations that
+                    read or write a single information field (e.g.
+                    fitness) of all individuals, at the cost of slower
+                    operations that rearrange individuals (e.g.
+                    sorting or removing individuals). This layout is
+                    kept in binary but not in text population files.
 
 "; 
 
@@ -6257,7 +6437,12 @@ Details:
 
     Return an editable array of the genotype of all individuals in a
     population (if subPop=[], default), or individuals in a
-    subpopulation subPop. Virtual subpopulation is unsupported.
+    subpopulation subPop. Virtual subpopulation is unsupported. The
+    array supports the buffer protocol so that it can be viewed by
+    memoryview or numpy.asarray as an array of shape (individuals,
+    ploidy, loci) without copying genotypes. Binary and mutant modules
+    do not store alleles as an array so they export a read-only copy
+    of genotypes instead.
 
 "; 
 
@@ -6285,10 +6470,12 @@ Details:
     generations) or UNSPECIFIED to search only the current generation.
     If no individual with id is found, an IndexError will be raised. A
     float id is acceptable as long as it rounds closely to an integer.
-    Note that this function uses a dynamic searching algorithm which
-    tends to be slow. If you need to look for multiple individuals
-    from a static population, you might want to convert a population
-    object to a pedigree object and use function Pedigree.indByID.
+    If several individuals in a generation share id, the first one is
+    returned. IDs of each generation are indexed when they are first
+    searched so that subsequent searches do not scan the population
+    again. The index of a generation is rebuilt if id is not found in
+    it, so IDs that are changed directly through individuals can be
+    found, at the cost of scanning the generation for each missing ID.
 
 "; 
 
@@ -6357,8 +6544,36 @@ Details:
 
 %ignore simuPOP::Population::infoBegin(size_t idx);
 
+%ignore simuPOP::Population::infoByColumn() const;
+
 %ignore simuPOP::Population::infoEnd(size_t idx);
 
+%feature("docstring") simuPOP::Population::infoView "
+
+Usage:
+
+    x.infoView(field, subPop=[])
+
+Details:
+
+    Return a writable memoryview of information field field (by index
+    or name) of all individuals (if subPop=[], default), or
+    individuals in a subpopulation subPop, without copying the values.
+    The view strides through the information fields of individuals so
+    it can be passed directly to numpy.asarray. Virtual subpopulation
+    is unsupported. The view keeps the population alive, and functions
+    that reallocate or move information fields (e.g. addInfoFields,
+    setInfoByColumn, push, resize, removeIndividuals and evolving the
+    population) raise a RuntimeError until all views are released. A
+    view created for an ancestral generation keeps referring to that
+    generation after useAncestralGen is called. owner is the Python
+    object of the population, which is passed automatically. Because a
+    view has to keep its population alive, this function cannot be
+    called for a population that is owned by another object, such as
+    a population returned by Simulator.population().
+
+"; 
+
 %ignore simuPOP::Population::keepAncestralGens(const uintList &ancGens);
 
 %feature("docstring") simuPOP::Population::lineage "
@@ -6372,8 +6587,9 @@ Details:
     Return an editable array of the lineage of alleles for all
     individuals in a population (if subPop=[], default), or
     individuals in a subpopulation subPop. Virtual subpopulation is
-    unsupported. This function returns None for modules without
-    lineage information.
+    unsupported. The array supports the buffer protocol with shape
+    (individuals, ploidy, loci). This function returns None for
+    modules without lineage information.
 
 "; 
 
@@ -6626,12 +6842,40 @@ Details:
 
 Usage:
 
-    x.save(filename)
+    x.save(filename, binary=False, compress=False)
 
 Details:
 
     Save population to a file filename, which can be loaded by a
-    global function loadPopulation(filename).
+    global function loadPopulation(filename). By default, the
+    population is saved in a compressed text format that can be loaded
+    by all modules. If binary is set to True, genotype, lineage,
+    information fields and individual flags of all generations are
+    saved as aligned columns of a binary file, which can be mapped into
+    memory and loaded much faster. Such sections can be compressed in
+    independent blocks if compress is set to True. Individuals of the
+    present generation can also be extracted from such a file without
+    loading the whole population (see MappedPopulation).
+
+"; 
+
+%feature("docstring") simuPOP::Population::setAncestralCompression "
+
+Usage:
+
+    x.setAncestralCompression(depth)
+
+Details:
+
+    Keep genotypes of ancestral generations older than depth
+    compressed in memory. Compressed generations are decompressed when
+    they are used (e.g. by useAncestralGen, ancestor, indByID or by a
+    pedigree), and compressed again when the present generation is
+    restored or the population evolves to the next generation.
+    Information fields are not compressed so individuals can be
+    located by their IDs without decompressing their generation. A
+    negative depth (default) keeps all ancestral generations
+    uncompressed.
 
 "; 
 
@@ -6652,6 +6896,25 @@ Details:
 
 "; 
 
+%feature("docstring") simuPOP::Population::setAncestralSharing "
+
+Usage:
+
+    x.setAncestralSharing(share)
+
+Details:
+
+    Let ancestral generations share identical chromosome copies with
+    their neighboring generations if share is True. This saves memory
+    for clonal, haplodiploid or low-recombination populations in which
+    consecutive generations carry mostly the same chromosomes, but
+    costs a hashing pass each time a generation is stored, so it is
+    disabled by default. Shared generations are copied back when they
+    are used (e.g. by useAncestralGen, ancestor or indByID).
+    Chromosomes of the current generation are not shared.
+
+"; 
+
 %ignore simuPOP::Population::setDict(PyObject *dict);
 
 %ignore simuPOP::Population::setGen(size_t gen);
@@ -6689,6 +6952,8 @@ Details:
 
 %ignore simuPOP::Population::setIndOrdered(bool s) const;
 
+%ignore simuPOP::Population::setInfoByColumn(bool byColumn);
+
 %feature("docstring") simuPOP::Population::setInfoFields "
 
 Usage:
@@ -7113,6 +7378,8 @@ Details:
 
 "; 
 
+%ignore simuPOP::ProductSplitter::positional() const;
+
 %ignore simuPOP::ProductSplitter::size(const Population &pop, size_t subPop, size_t virtualSubPop) const;
 
 %feature("docstring") simuPOP::ProductSplitter::~ProductSplitter "
@@ -7180,6 +7447,8 @@ Details:
 
 "; 
 
+%ignore simuPOP::ProportionSplitter::positional() const;
+
 %ignore simuPOP::ProportionSplitter::size(const Population &pop, size_t subPop, size_t virtualSubPop) const;
 
 %feature("docstring") simuPOP::PyEval "
@@ -7692,7 +7961,7 @@ Usage:
 
     PyPenetrance(func, loci=[], ancGens=UNSPECIFIED, begin=0,
       end=-1, step=1, at=[], reps=ALL_AVAIL, subPops=ALL_AVAIL,
-      infoFields=[])
+      infoFields=[], cache=False)
 
 Details:
 
@@ -7703,7 +7972,37 @@ Details:
     chromosome position pairs, ALL_AVAIL, or a function with optional
     parameter pop that will be called at each ganeeration to determine
     indexes of loci. The return value will be treated as Individual
-    penetrance.
+    penetrance. If cache is set to True, penetrance values are cached
+    for each distinct genotype (and values of requested information
+    fields) so that func is called only once for individuals with the
+    same genotype (see PySelector for details).
+
+"; 
+
+%feature("docstring") simuPOP::PyPenetrance::cacheStats "
+
+Usage:
+
+    x.cacheStats()
+
+Details:
+
+    Return the number of cache hits and misses, namely the number of
+    individuals that are assigned a cached value and the number of
+    calls to the user-defined function (if cache is True).
+
+"; 
+
+%feature("docstring") simuPOP::PyPenetrance::clearCache "
+
+Usage:
+
+    x.clearCache()
+
+Details:
+
+    Clear values cached for distinct genotypes and reset the number of
+    hits and misses of the cache (if cache is True).
 
 "; 
 
@@ -7741,7 +8040,8 @@ Details:
 Usage:
 
     PyQuanTrait(func, loci=[], ancGens=UNSPECIFIED, begin=0, end=-1,
-      step=1, at=[], reps=ALL_AVAIL, subPops=ALL_AVAIL, infoFields=[])
+      step=1, at=[], reps=ALL_AVAIL, subPops=ALL_AVAIL, infoFields=[],
+      cache=False)
 
 Details:
 
@@ -7753,7 +8053,37 @@ Details:
     be assigned to specified trait fields (infoField). If only one
     trait field is specified, a number or a sequence of one element is
     acceptable. Otherwise, a sequence of values will be accepted and
-    be assigned to each trait field.
+    be assigned to each trait field. If cache is set to True, trait
+    values are cached for each distinct genotype (and values of
+    requested information fields) so that func is called only once for
+    individuals with the same genotype (see PySelector for details).
+
+"; 
+
+%feature("docstring") simuPOP::PyQuanTrait::cacheStats "
+
+Usage:
+
+    x.cacheStats()
+
+Details:
+
+    Return the number of cache hits and misses, namely the number of
+    individuals that are assigned a cached value and the number of
+    calls to the user-defined function (if cache is True).
+
+"; 
+
+%feature("docstring") simuPOP::PyQuanTrait::clearCache "
+
+Usage:
+
+    x.clearCache()
+
+Details:
+
+    Clear values cached for distinct genotypes and reset the number of
+    hits and misses of the cache (if cache is True).
 
 "; 
 
@@ -7794,14 +8124,47 @@ Usage:
 
     PySelector(func, loci=[], begin=0, end=-1, step=1, at=[],
       reps=ALL_AVAIL, output=\"\", subPops=ALL_AVAIL,
-      infoFields=ALL_AVAIL)
+      infoFields=ALL_AVAIL, cache=False)
 
 Details:
 
     Create a Python hybrid selector that passes genotype at specified
     loci, values at specified information fields (if requested) and a
     generation number to a user-defined function func. The return
-    value will be treated as individual fitness.
+    value will be treated as individual fitness. If cache is set to
+    True, fitness values are cached for each distinct genotype (and
+    values of requested information fields) so that func is called
+    only once for individuals with the same genotype. The cache is
+    cleared at each generation if func accepts parameter gen, so func
+    should return the same value for the same parameters. This option
+    cannot be used if func accepts parameter ind or pop.
+
+"; 
+
+%feature("docstring") simuPOP::PySelector::cacheStats "
+
+Usage:
+
+    x.cacheStats()
+
+Details:
+
+    Return the number of cache hits and misses, namely the number of
+    individuals that are assigned a cached value and the number of
+    calls to the user-defined function (if cache is True).
+
+"; 
+
+%feature("docstring") simuPOP::PySelector::clearCache "
+
+Usage:
+
+    x.clearCache()
+
+Details:
+
+    Clear values cached for distinct genotypes and reset the number of
+    hits and misses of the cache (if cache is True).
 
 "; 
 
@@ -8336,6 +8699,8 @@ Details:
 
 "; 
 
+%ignore simuPOP::RangeSplitter::positional() const;
+
 %ignore simuPOP::RangeSplitter::size(const Population &pop, size_t subPop, size_t virtualSubPop) const;
 
 %feature("docstring") simuPOP::Recombinator "
@@ -8378,7 +8743,8 @@ Usage:
 
     Recombinator(rates=[], intensity=-1, loci=ALL_AVAIL,
       convMode=NO_CONVERSION, output=\"\", begin=0, end=-1, step=1,
-      at=[], reps=ALL_AVAIL, subPops=ALL_AVAIL, infoFields=[])
+      at=[], reps=ALL_AVAIL, subPops=ALL_AVAIL, infoFields=[],
+      sparse=False)
 
 Details:
 
@@ -8438,7 +8804,16 @@ Details:
     conversion to recombination events in the literature. This ratio
     varies greatly from study to study, ranging from 0.1 to 15 (Chen
     et al, Nature Review Genetics, 2007). This translate to
-    0.1/0.9~0.1 to 15/16~0.94 of the gene conversion probability.  A
+    0.1/0.9~0.1 to 15/16~0.94 of the gene conversion probability.  By
+    default, a Recombinator draws a random number for each interval
+    between adjacent loci. If sparse is set to True, it draws the
+    locations of crossovers directly, using exponentially distributed
+    gaps along the cumulative genetic map, so that the cost of
+    transmitting a chromosome is proportional to the number of
+    crossovers instead of the number of loci. The crossovers follow
+    the same distribution but a different sequence of random numbers
+    is used. This option is recommended for long chromosomes with
+    dense markers and low recombination rates between them.  A
     Recombinator usually does not send any output. However, if an
     information field is given (parameter infoFields), this operator
     will treat this information field as an unique ID of parents and
@@ -8689,7 +9064,8 @@ Details:
 Usage:
 
     SavePopulation(output=\"\", begin=0, end=-1, step=1, at=[],
-      reps=ALL_AVAIL, subPops=ALL_AVAIL, infoFields=[])
+      reps=ALL_AVAIL, subPops=ALL_AVAIL, infoFields=[], binary=False,
+      compress=False)
 
 Details:
 
@@ -8698,7 +9074,10 @@ Details:
     specifications ('', 'filename', 'filename' prefixed by one or more
     '>' characters, and '!expr') but output from different operators
     will always replace existing files (effectively ignore '>'
-    specification). Parameter subPops is ignored. Please refer to
+    specification). If binary is set to True, the population is saved
+    in a binary format that can be loaded much faster, with data
+    sections compressed if compress is True (see Population.save for
+    details). Parameter subPops is ignored. Please refer to
     class BaseOperator for a detailed description about common
     operator parameters such as stage and begin.
 
@@ -9014,6 +9393,8 @@ Usage:
 
 %ignore simuPOP::SharedVariables::setDict(PyObject *dict);
 
+%ignore simuPOP::SharedVariables::setMatrixVar(const string &name, matrixf &val);
+
 %ignore simuPOP::SharedVariables::setVar(const string &name, const PyObject *val);
 
 %ignore simuPOP::SharedVariables::setVar(const string &name, const bool val);
@@ -9134,7 +9515,8 @@ Details:
 Usage:
 
     x.evolve(initOps=[], preOps=[], matingScheme=MatingScheme,
-      postOps=[], finalOps=[], gen=-1, dryrun=False)
+      postOps=[], finalOps=[], gen=-1, dryrun=False,
+      parallelReps=False)
 
 Details:
 
@@ -9180,7 +9562,27 @@ Details:
     population, including those that have stopped before others.  If
     parameter dryrun is set to True, this function will print a
     description of the evolutionary process generated by function
-    describeEvolProcess() and exits.
+    describeEvolProcess() and exits.  If parameter parallelReps is set
+    to True, up to numThreads() replicates are evolved in parallel,
+    generation by generation. Operators that do not call any Python
+    function or write to an output stream (e.g. Stat, Migrator and
+    MapSelector) are cloned for and applied to replicates
+    simultaneously, and so is the mating scheme if it does not call
+    any Python function. Other operators are applied to one replicate
+    at a time, with the Python GIL held. Each replicate uses its own
+    random number generator, seeded from the current random number
+    generator, so that the evolution of a replicate does not depend on
+    the order at which replicates are evolved, or the number of
+    threads used to evolve them. Python operators (e.g. PyOperator and
+    PyEval) are however applied to replicates in an order that varies
+    from run to run, although operators are still applied in order to
+    each replicate. They should not change the genotypic structure of
+    populations because other replicates might be evolved at the same
+    time. Operators whose results depend on the order at which
+    replicates are evolved, namely IdTagger (which assigns IDs from a
+    counter shared by replicates), RevertIf, Pause, TerminateIf with
+    stopAll set to True and TicToc with stopAfter, cannot be used in
+    this mode and a ValueError will be raised if any of them is used.
 
 "; 
 
@@ -9359,7 +9761,7 @@ Usage:
       neutrality=[], structure=[], HWE=[], inbreeding=[],
       effectiveSize=[], vars=ALL_AVAIL, suffix=\"\", output=\"\", begin=0,
       end=-1, step=1, at=[], reps=ALL_AVAIL, subPops=ALL_AVAIL,
-      infoFields=[])
+      infoFields=[], LDMatrix=[], LDWindow=0)
 
 Details:
 
@@ -9367,8 +9769,9 @@ Details:
     population when it is applied to this population. This operator
     can be applied to specified replicates (parameter rep) at
     specified generations (parameter begin, end, step, and at). This
-    operator does not produce any output (ignore parameter output)
-    after statistics are calculated. Instead, it stores results in the
+    operator does not produce any output (ignore parameter output,
+    except for statistic LDMatrix) after statistics are calculated.
+    Instead, it stores results in the
     local namespace of the population being applied. Other operators
     can retrieve these variables or evalulate expression directly in
     this local namespace. Please refer to operator BaseOperator for a
@@ -9643,7 +10046,28 @@ Details:
     *   LD_ChiSq_p_sp p value for the ChiSq statistics for each
     (virtual) subpopulation.
     *   CramerV_sp Cramer V statistics for each (virtual)
-    subpopulation.association: Parameter association accepts a list of
+    subpopulation.LDMatrix: Parameter LDMatrix accepts a list of loci
+    (indexes, names, or ALL_AVAIL) and calculates LD between all pairs
+    of them, or between pairs of loci on the same chromosome that are
+    at most LDWindow apart if a positive LDWindow is given. This
+    statistic is designed for a large number of diallelic loci. Its
+    values are the same as those of statistic LD without primary
+    alleles, and are set to MISSING_VALUE for pairs of loci with more
+    than two alleles, on chromosomes of different types, or out of the
+    window. If parameter output is specified, a line with two loci and
+    requested measures is written for each calculated pair of loci.
+    Otherwise, the following variables are set to matrices with rows
+    of loci in ascending order. Each row is an array.array of doubles
+    so a matrix can be converted to a NumPy array with numpy.array(m).
+    Columns are also loci in ascending order so that m[i][j] is the
+    value between the i-th and j-th loci, unless a positive LDWindow
+    is given. In this case, matrices are stored by band with 2w+1
+    columns, where w is the largest number of loci between two paired
+    loci, and the value between the i-th and j-th loci is m[i][w+j-i]:
+    *   LD_matrix Basic LD measure between pairs of loci.
+    *   LD_prime_matrix Lewontin's D' measure between pairs of loci.
+    *   R2_matrix (default) R2 measure between pairs of
+    loci.association: Parameter association accepts a list of
     loci, which can be a list of indexes, names, or ALL_AVAIL. At each
     locus, one or more statistical tests will be performed to test
     association between this locus and individual affection status.
@@ -11368,6 +11792,39 @@ Usage:
 
 "; 
 
+%ignore simuPOP::statLDMatrix;
+
+%feature("docstring") simuPOP::statLDMatrix::apply "
+
+Usage:
+
+    x.apply(pop, out)
+
+Details:
+
+    Calculate the LD matrix and write pairs of loci to out, or save
+    the matrix to population variables if out is NULL.
+
+"; 
+
+%feature("docstring") simuPOP::statLDMatrix::describe "
+
+Usage:
+
+    x.describe(format=True)
+
+"; 
+
+%ignore simuPOP::statLDMatrix::empty() const;
+
+%feature("docstring") simuPOP::statLDMatrix::statLDMatrix "
+
+Usage:
+
+    statLDMatrix(loci, window, subPops, vars, suffix)
+
+"; 
+
 %ignore simuPOP::statNeutrality;
 
 %feature("docstring") simuPOP::statNeutrality::apply "
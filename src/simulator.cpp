@@ -194,7 +194,7 @@ vectoru Simulator::evolve(
                           const MatingScheme & matingScheme,
                           const opList & postOps,
                           const opList & finalOps,
-                          int gens, bool dryrun)
+                          int gens, bool dryrun, bool parallelReps)
 {
 	if (dryrun) {
 		cerr << describeEvolProcess(initOps, preOps, matingScheme, postOps, finalOps, gens, numRep()) << endl;
@@ -231,6 +231,22 @@ vectoru Simulator::evolve(
 
 	elapsedTime("Start evolution.");
 
+#if defined(_OPENMP) && THREADPRIVATE_SUPPORT == 0 && _OPENMP < 200805
+	// without threadprivate variables or the API of nested parallel regions,
+	// a thread that evolves a replicate cannot keep its random number
+	// generator in parallel regions of operators and mating schemes.
+	DBG_WARNIF(parallelReps, "Replicates are evolved sequentially because parallelReps is not supported by this build.");
+	parallelReps = false;
+#endif
+	if (parallelReps) {
+		evolveParallel(preOps, matingScheme, postOps, gens, evolvedGens);
+		if (!finalOps.empty())
+			apply(finalOps);
+		ostreamManager().closeAll();
+		cleanupCircularRefs();
+		return evolvedGens;
+	}
+
 	while (1) {
 		// save refcount at the beginning
 #ifdef Py_REF_DEBUG
@@ -412,6 +428,330 @@ vectoru Simulator::evolve(
 }
 
 
+// Exceptions can not leave an OpenMP parallel region, so exceptions raised
+// while replicates are evolved in parallel are saved as codes and messages,
+// and are raised again after the parallel region.
+enum SavedException {
+	NoException = 0, SavedStopEvolution, SavedRevertEvolution, SavedIndexError,
+	SavedValueError, SavedSystemError, SavedRuntimeError, SavedStopIteration,
+	SavedOtherException, SavedUnknownException
+};
+
+// save the exception that is being handled, must be called from a catch block
+static SavedException saveException(string & msg)
+{
+	try {
+		throw;
+	} catch (const StopEvolution & e) {
+		msg = e.message();
+		return SavedStopEvolution;
+	} catch (const RevertEvolution & e) {
+		msg = e.message();
+		return SavedRevertEvolution;
+	} catch (const IndexError & e) {
+		msg = e.message();
+		return SavedIndexError;
+	} catch (const ValueError & e) {
+		msg = e.message();
+		return SavedValueError;
+	} catch (const SystemError & e) {
+		msg = e.message();
+		return SavedSystemError;
+	} catch (const RuntimeError & e) {
+		msg = e.message();
+		return SavedRuntimeError;
+	} catch (const StopIteration & e) {
+		msg = e.message();
+		return SavedStopIteration;
+	} catch (const Exception & e) {
+		msg = e.message();
+		return SavedOtherException;
+	} catch (...) {
+		return SavedUnknownException;
+	}
+}
+
+
+static void raiseSavedException(SavedException code, const string & msg)
+{
+	switch (code) {
+	case NoException:
+		return;
+	case SavedStopEvolution:
+		throw StopEvolution(msg);
+	case SavedRevertEvolution:
+		throw RevertEvolution(msg);
+	case SavedIndexError:
+		throw IndexError(msg);
+	case SavedValueError:
+		throw ValueError(msg);
+	case SavedSystemError:
+		throw SystemError(msg);
+	case SavedRuntimeError:
+		throw RuntimeError(msg);
+	case SavedStopIteration:
+		throw StopIteration(msg);
+	case SavedOtherException:
+		throw Exception(msg);
+	default:
+		throw Exception("Unexpected error from openMP parallel region");
+	}
+}
+
+
+// Operators that call Python functions, or change states shared by
+// replicates, are applied one at a time with the Python GIL held, while
+// other replicates are evolved by operators that do not need it.
+static bool applyOperator(const BaseOperator & op, Population & pop)
+{
+	if (op.canApplyConcurrently())
+		return op.apply(pop);
+	GILGuard gil(true);
+	return op.apply(pop);
+}
+
+
+// Operators and mating schemes used by each replicate that is evolved in
+// parallel, and a scratch population for each thread. Operators and mating
+// schemes that can be applied concurrently are cloned for each replicate,
+// others are shared. Clones and scratch populations are released when the
+// evolution ends, normally or with an exception.
+class ReplicateClones
+{
+public:
+	ReplicateClones(const opList & preOps, const MatingScheme & matingScheme,
+		const opList & postOps, size_t numReps, size_t numScratches) :
+		preOps(numReps), postOps(numReps), schemes(numReps), scratches(numScratches),
+		m_preOps(preOps), m_postOps(postOps), m_matingScheme(matingScheme)
+	{
+		bool concurrent = matingScheme.canPopulateConcurrently();
+
+		for (size_t rep = 0; rep < numReps; ++rep) {
+			for (size_t it = 0; it < preOps.size(); ++it)
+				this->preOps[rep].push_back(preOps[it]->canApplyConcurrently() ?
+					preOps[it]->clone() : const_cast<BaseOperator *>(preOps[it]));
+			for (size_t it = 0; it < postOps.size(); ++it)
+				this->postOps[rep].push_back(postOps[it]->canApplyConcurrently() ?
+					postOps[it]->clone() : const_cast<BaseOperator *>(postOps[it]));
+			schemes[rep] = concurrent ? matingScheme.clone() : const_cast<MatingScheme *>(&matingScheme);
+		}
+		for (size_t i = 0; i < numScratches; ++i)
+			scratches[i] = new Population();
+	}
+
+
+	~ReplicateClones()
+	{
+		for (size_t rep = 0; rep < schemes.size(); ++rep) {
+			for (size_t it = 0; it < preOps[rep].size(); ++it)
+				if (preOps[rep][it] != m_preOps[it])
+					delete preOps[rep][it];
+			for (size_t it = 0; it < postOps[rep].size(); ++it)
+				if (postOps[rep][it] != m_postOps[it])
+					delete postOps[rep][it];
+			if (schemes[rep] != &m_matingScheme)
+				delete schemes[rep];
+		}
+		for (size_t i = 0; i < scratches.size(); ++i)
+			delete scratches[i];
+	}
+
+
+	vector<vectorop> preOps;
+	vector<vectorop> postOps;
+	vector<MatingScheme *> schemes;
+	vector<Population *> scratches;
+
+private:
+	const opList & m_preOps;
+	const opList & m_postOps;
+	const MatingScheme & m_matingScheme;
+};
+
+
+bool Simulator::applyToReplicate(const vectorop & ops, size_t rep, long curGen, ssize_t end,
+                                 const vector<bool> & activeReps)
+{
+	Population & curPop = *m_pops[rep];
+
+	for (size_t it = 0; it < ops.size(); ++it) {
+		if (!ops[it]->isActive(rep, curGen, end, activeReps))
+			continue;
+
+		if (!applyOperator(*ops[it], curPop)) {
+			DBG_DO(DBG_SIMULATOR, cerr << "Operator " << ops[it]->describe() <<
+				" stops at replicate " << rep << endl);
+			return false;
+		}
+		elapsedTime("Applied " + ops[it]->describe());
+	}
+	return true;
+}
+
+
+bool Simulator::evolveReplicate(size_t rep, const vectorop & preOps, MatingScheme & matingScheme,
+                                Population & scratch, const vectorop & postOps, const vector<bool> & activeReps,
+                                long & remainingGens, bool & evolved)
+{
+	Population & curPop = *m_pops[rep];
+	// sync population variable gen with gen(). This allows
+	// users to set population variable to change generation number.
+	long curGen = curPop.getVars().getVarAsInt("gen");
+
+	if (curGen != static_cast<long>(curPop.gen()))
+		curPop.setGen(curGen);
+	ssize_t end = -1;
+	if (remainingGens > 0)
+		end = curGen + remainingGens - 1;
+
+	// apply pre-mating ops to current gen()
+	if (!applyToReplicate(preOps, rep, curGen, end, activeReps)) {
+		--remainingGens;
+		return false;
+	}
+
+	elapsedTime((boost::format("Start mating at generation %1%") % curGen).str());
+	// start mating, with a clone of the mating scheme for this replicate if
+	// it can populate offspring concurrently, otherwise with the GIL held.
+	bool mated;
+	if (matingScheme.canPopulateConcurrently())
+		mated = matingScheme.mate(curPop, scratch);
+	else {
+		GILGuard gil(true);
+		mated = matingScheme.mate(curPop, scratch);
+	}
+	if (!mated) {
+		DBG_DO(DBG_SIMULATOR, cerr << "Mating stops at replicate " << rep << endl);
+		--remainingGens;
+		return false;
+	}
+	elapsedTime("Mating finished.");
+
+	--remainingGens;
+	// apply post-mating ops to next gen()
+	bool active = applyToReplicate(postOps, rep, curGen, end, activeReps);
+	// if a replicate stops at a post mating operator, consider one evolved generation.
+	evolved = true;
+	curPop.setGen(curGen + 1);
+	return active;
+}
+
+
+// return true if any of the operators depends on the order at which
+// replicates are evolved
+static bool dependsOnReplicateOrder(const opList & ops)
+{
+	opList::const_iterator it = ops.begin();
+	opList::const_iterator itEnd = ops.end();
+
+	for (; it != itEnd; ++it)
+		if ((*it)->dependsOnReplicateOrder())
+			return true;
+	return false;
+}
+
+
+void Simulator::evolveParallel(const opList & preOps, const MatingScheme & matingScheme,
+                               const opList & postOps, int gens, vectoru & evolvedGens)
+{
+	PARAM_FAILIF(dependsOnReplicateOrder(preOps) || dependsOnReplicateOrder(postOps) ||
+		matingScheme.dependsOnReplicateOrder(), ValueError,
+		"Replicates cannot be evolved in parallel by operators that depend on the order at which "
+		"replicates are evolved, such as IdTagger, RevertIf, Pause, TerminateIf(stopAll=True) "
+		"and TicToc(stopAfter).");
+
+	size_t numReps = m_pops.size();
+	// Each replicate has its own random number generator, seeded from the
+	// current one, so that the evolution of a replicate does not depend on
+	// the number of threads or the order at which replicates are evolved.
+	vector<RNG> repRNGs;
+
+	repRNGs.reserve(numReps);
+	for (size_t rep = 0; rep < numReps; ++rep)
+		repRNGs.push_back(RNG(getRNG().name(),
+				1 + static_cast<unsigned long>(getRNG().randUniform() * 4294967294.)));
+
+	// Each replicate is evolved by its own clones of operators and mating
+	// scheme that can be applied concurrently. Others are shared and are
+	// applied with the GIL held.
+	ReplicateClones clones(preOps, matingScheme, postOps, numReps, numThreads());
+
+	vector<bool> activeReps(numReps, true);
+	vectori remainingGens(numReps, gens);
+
+#if _OPENMP >= 200805
+	// Parallel regions encountered while a replicate is evolved are run by
+	// the thread that evolves the replicate, which keeps its random number
+	// generator and scratch population.
+	int maxActiveLevels = omp_get_max_active_levels();
+	omp_set_max_active_levels(1);
+#endif
+	while (true) {
+		if (PyErr_CheckSignals()) {
+			cerr << "Evolution stopped due to keyboard interruption." << endl;
+			break;
+		}
+		vectoru reps;
+		for (size_t rep = 0; rep < numReps; ++rep)
+			if (activeReps[rep] && remainingGens[rep] != 0)
+				reps.push_back(rep);
+		if (reps.empty())
+			break;
+
+		// status of replicates at the beginning of this generation, used
+		// to determine applicability of operators (e.g. REP_LAST).
+		const vector<bool> curActiveReps = activeReps;
+		// results of replicates, which are written by different threads
+		// and can therefore not be saved to vector<bool>
+		vector<char> active(reps.size(), 0);
+		vector<char> evolved(reps.size(), 0);
+		vector<SavedException> except(reps.size(), NoException);
+		vectorstr msgs(reps.size());
+
+		DBG_DO(DBG_SIMULATOR, cerr << "Evolving " << reps.size() << " replicates in parallel." << endl);
+		Py_BEGIN_ALLOW_THREADS
+		GILGuard::setEnabled(true);
+#pragma omp parallel for schedule(dynamic) num_threads(numThreads())
+		for (int i = 0; i < static_cast<int>(reps.size()); ++i) {
+			size_t rep = reps[i];
+#ifdef _OPENMP
+			Population & scratch = *clones.scratches[omp_get_thread_num()];
+#else
+			Population & scratch = *clones.scratches[0];
+#endif
+			setThreadRNG(&repRNGs[rep]);
+			try {
+				bool repEvolved = false;
+				active[i] = evolveReplicate(rep, clones.preOps[rep], *clones.schemes[rep], scratch,
+					clones.postOps[rep], curActiveReps, remainingGens[rep], repEvolved);
+				evolved[i] = repEvolved;
+			} catch (...) {
+				except[i] = saveException(msgs[i]);
+			}
+			setThreadRNG(NULL);
+		}
+		GILGuard::setEnabled(false);
+		Py_END_ALLOW_THREADS
+
+		// handle results and exceptions in the order of replicates
+		for (size_t i = 0; i < reps.size(); ++i) {
+			if (except[i] != NoException) {
+#if _OPENMP >= 200805
+				omp_set_max_active_levels(maxActiveLevels);
+#endif
+				raiseSavedException(except[i], msgs[i]);
+			}
+			activeReps[reps[i]] = active[i] != 0;
+			if (evolved[i])
+				++evolvedGens[reps[i]];
+		}
+	}
+#if _OPENMP >= 200805
+	omp_set_max_active_levels(maxActiveLevels);
+#endif
+}
+
+
 bool Simulator::apply(const opList & ops)
 {
 	// really apply
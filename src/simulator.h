@@ -215,6 +215,27 @@ public:
 	 *  If parameter \e dryrun is set to \c True, this function will print a
 	 *  description of the evolutionary process generated by function
 	 *  \c describeEvolProcess() and exits.
+	 *
+	 *  If parameter \e parallelReps is set to \c True, up to \c numThreads()
+	 *  replicates are evolved in parallel, generation by generation. Operators
+	 *  that do not call any Python function or write to an output stream
+	 *  (e.g. \c Stat, \c Migrator and \c MapSelector) are cloned for and
+	 *  applied to replicates simultaneously, and so is the mating scheme if it
+	 *  does not call any Python function. Other operators are applied to one
+	 *  replicate at a time, with the Python GIL held. Each replicate uses its
+	 *  own random number generator, seeded from the current random number
+	 *  generator, so that the evolution of a replicate does not depend on the
+	 *  order at which replicates are evolved, or the number of threads used
+	 *  to evolve them. Python operators (e.g. \c PyOperator and \c PyEval)
+	 *  are however applied to replicates in an order that varies from run to
+	 *  run, although operators are still applied in order to each replicate.
+	 *  They should not change the genotypic structure of populations because
+	 *  other replicates might be evolved at the same time. Operators whose
+	 *  results depend on the order at which replicates are evolved, namely
+	 *  \c IdTagger (which assigns IDs from a counter shared by replicates),
+	 *  \c RevertIf, \c Pause, \c TerminateIf with \e stopAll set to \c True
+	 *  and \c TicToc with \e stopAfter, cannot be used in this mode and a
+	 *  \c ValueError will be raised if any of them is used.
 	 *  <group>2-evolve</group>
 	 */
 	vectoru evolve(
@@ -223,7 +244,8 @@ public:
 		const MatingScheme & matingScheme = MatingScheme(),
 		const opList & postOps = opList(),
 		const opList & finalOps = opList(),
-		int gen = -1, bool dryrun = false);
+		int gen = -1, bool dryrun = false,
+		bool parallelReps = false);
 
 
 	/// CPPONLY apply a list of operators to all populations
@@ -254,6 +276,22 @@ private:
 	}
 
 
+	/// evolve replicates in parallel, called by evolve()
+	void evolveParallel(const opList & preOps, const MatingScheme & matingScheme,
+		const opList & postOps, int gens, vectoru & evolvedGens);
+
+	/// apply operators to a replicate evolved in parallel, return false if
+	/// the replicate is stopped.
+	bool applyToReplicate(const vectorop & ops, size_t rep, long curGen, ssize_t end,
+		const vector<bool> & activeReps);
+
+	/// evolve a replicate for a generation in parallel with others, return
+	/// false if the replicate is stopped.
+	bool evolveReplicate(size_t rep, const vectorop & preOps, MatingScheme & matingScheme,
+		Population & scratch, const vectorop & postOps, const vector<bool> & activeReps,
+		long & remainingGens, bool & evolved);
+
+
 private:
 	/// replicate pointers
 	vector<Population *> m_pops;
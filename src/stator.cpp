@@ -389,8 +389,11 @@ Stat::Stat(
 	// regular parameters
 	const stringFunc & output,
 	int begin, int end, int step, const intList & at,
-	const intList & reps, const subPopList & subPops, const stringList & infoFields)
-	: BaseOperator("", begin, end, step, at, reps, subPops, infoFields),
+	const intList & reps, const subPopList & subPops, const stringList & infoFields,
+	//
+	const lociList & LDMatrix,
+	double LDWindow)
+	: BaseOperator(output, begin, end, step, at, reps, subPops, infoFields),
 	// the order of initialization is meaningful since they may depend on each other
 	m_popSize(popSize, subPops, vars, suffix),
 	m_numOfMales(numOfMales, subPops, vars, suffix),
@@ -404,6 +407,7 @@ Stat::Stat(
 	m_haploHomoFreq(haploHeteroFreq, haploHomoFreq, subPops, vars, suffix),
 	m_info(sumOfInfo.elems(), meanOfInfo.elems(), varOfInfo.elems(), maxOfInfo.elems(), minOfInfo.elems(), subPops, vars, suffix),
 	m_LD(LD, subPops, vars, suffix),
+	m_LDMatrix(LDMatrix, LDWindow, subPops, vars, suffix),
 	m_association(association, subPops, vars, suffix),
 	m_neutrality(neutrality, subPops, vars, suffix),
 	m_structure(structure, subPops, vars, suffix),
@@ -411,7 +415,6 @@ Stat::Stat(
 	m_Inbreeding(Inbreeding, subPops, vars, suffix),
 	m_effectiveSize(effectiveSize, subPops, vars, suffix)
 {
-	(void)output;  // avoid warning about unused parameter
 }
 
 
@@ -431,6 +434,7 @@ string Stat::describe(bool /* format */) const
 	descs.push_back(m_haploFreq.describe(false));
 	descs.push_back(m_info.describe(false));
 	descs.push_back(m_LD.describe(false));
+	descs.push_back(m_LDMatrix.describe(false));
 	descs.push_back(m_association.describe(false));
 	descs.push_back(m_neutrality.describe(false));
 	descs.push_back(m_structure.describe(false));
@@ -448,27 +452,56 @@ string Stat::describe(bool /* format */) const
 
 bool Stat::apply(Population & pop) const
 {
+	// Statistics that can be derived from genotype counts share counts that
+	// are gathered in a single pass through each (virtual) subpopulation.
+	vectoru loci;
+	bool alleleFreqUser = m_alleleFreq.useGenoCounts(pop, loci);
+	bool heteroFreqUser = m_heteroFreq.useGenoCounts(pop, loci);
+	bool genoFreqUser = m_genoFreq.useGenoCounts(pop, loci);
+	bool HWEUser = m_HWE.useGenoCounts(pop, loci);
+	size_t numUsers = alleleFreqUser + heteroFreqUser + genoFreqUser + HWEUser;
+	statGenoCounts genoCounts;
+
+	if (numUsers > 1)
+		genoCounts.count(pop, loci, applicableSubPops(pop).expandFrom(pop));
+	const statGenoCounts * counts = numUsers > 1 ? &genoCounts : NULL;
+
 	return m_popSize.apply(pop) &&
 	       m_numOfMales.apply(pop) &&
 	       m_numOfAffected.apply(pop) &&
 	       m_numOfSegSites.apply(pop) &&
 	       m_numOfMutants.apply(pop) &&
-	       m_alleleFreq.apply(pop) &&
-	       m_heteroFreq.apply(pop) &&
-	       m_genoFreq.apply(pop) &&
+	       m_alleleFreq.apply(pop, alleleFreqUser ? counts : NULL) &&
+	       m_heteroFreq.apply(pop, heteroFreqUser ? counts : NULL) &&
+	       m_genoFreq.apply(pop, genoFreqUser ? counts : NULL) &&
 	       m_haploFreq.apply(pop) &&
 	       m_haploHomoFreq.apply(pop) &&
 	       m_info.apply(pop) &&
 	       m_LD.apply(pop) &&
+	       applyLDMatrix(pop) &&
 	       m_association.apply(pop) &&
 	       m_neutrality.apply(pop) &&
 	       m_structure.apply(pop) &&
-	       m_HWE.apply(pop) &&
+	       m_HWE.apply(pop, HWEUser ? counts : NULL) &&
 	       m_Inbreeding.apply(pop) &&
 	       m_effectiveSize.apply(pop);
 }
 
 
+bool Stat::applyLDMatrix(Population & pop) const
+{
+	if (m_LDMatrix.empty())
+		return true;
+	if (this->noOutput())
+		return m_LDMatrix.apply(pop, NULL);
+
+	ostream & out = this->getOstream(pop.dict());
+	bool res = m_LDMatrix.apply(pop, &out);
+	this->closeOstream();
+	return res;
+}
+
+
 statPopSize::statPopSize(bool popSize, const subPopList & subPops,
 	const stringList & vars, const string & suffix)
 	: m_isActive(popSize), m_subPops(subPops), m_vars(), m_suffix(suffix)
@@ -951,6 +984,118 @@ bool statNumOfMutants::apply(Population & pop) const
 }
 
 
+// Genotypes at loci can be counted in a single pass if the alleles of an
+// individual at these loci are determined by chromosome type and sex, which
+// is not the case for the second copy of haplodiploid males. If \e autosome
+// is true, all loci should be on autosomes or customized chromosomes so that
+// all genotypes have an allele on each homologous copy.
+static bool genoCountable(const Population & pop, const vectoru & loci, bool autosome)
+{
+	if (pop.isHaplodiploid())
+		return false;
+	if (!autosome)
+		return true;
+	for (size_t i = 0; i < loci.size(); ++i) {
+		size_t chromType = pop.chromType(pop.chromLocusPair(loci[i]).first);
+		if (chromType != AUTOSOME && chromType != CUSTOMIZED)
+			return false;
+	}
+	return true;
+}
+
+
+void statGenoCounts::count(Population & pop, const vectoru & loci, const subPopList & subPops)
+{
+	m_loci = loci;
+	std::sort(m_loci.begin(), m_loci.end());
+	m_loci.erase(std::unique(m_loci.begin(), m_loci.end()), m_loci.end());
+	m_counts.assign(subPops.size(), vector<tupleDict>(m_loci.size()));
+
+	DBG_DO(DBG_STATOR, cerr << "Counting genotypes at loci " << m_loci << endl);
+
+	size_t nLoci = m_loci.size();
+	size_t ply = pop.ploidy();
+	size_t totNumLoci = pop.totNumLoci();
+	// homologous copies that form the genotypes of males (2 * idx) and
+	// females (2 * idx + 1) at each locus
+	vector<vectoru> copies(2 * nLoci);
+	for (size_t idx = 0; idx < nLoci; ++idx) {
+		size_t chromType = pop.chromType(pop.chromLocusPair(m_loci[idx]).first);
+		for (size_t p = 0; p < ply; ++p) {
+			if (chromType == CHROMOSOME_X) {
+				if (p == 0)
+					copies[2 * idx].push_back(p);
+				copies[2 * idx + 1].push_back(p);
+			} else if (chromType == CHROMOSOME_Y) {
+				if (p == 1)
+					copies[2 * idx].push_back(p);
+			} else if (chromType != MITOCHONDRIAL || p == 0) {
+				copies[2 * idx].push_back(p);
+				copies[2 * idx + 1].push_back(p);
+			}
+		}
+	}
+
+	subPopList::const_iterator it = subPops.begin();
+	subPopList::const_iterator itEnd = subPops.end();
+	for (size_t spIdx = 0; it != itEnd; ++it, ++spIdx) {
+		vector<tupleDict> & counts = m_counts[spIdx];
+
+		pop.activateVirtualSubPop(*it);
+		// each thread counts genotypes of a block of individuals at all loci
+		// in dense arrays, which are merged after all individuals are counted
+#pragma omp parallel if(numThreads() > 1)
+		{
+			vector<denseGenoCounts> myCounts;
+			myCounts.reserve(2 * nLoci);
+			for (size_t i = 0; i < 2 * nLoci; ++i)
+				myCounts.push_back(denseGenoCounts(copies[i].size()));
+			vectoru alleles(ply);
+#ifdef _OPENMP
+			IndIterator ind = pop.indIterator(it->subPop(), omp_get_thread_num());
+#else
+			IndIterator ind = pop.indIterator(it->subPop());
+#endif
+			for (; ind.valid(); ++ind) {
+				GenoIterator geno = ind->genoBegin();
+				size_t female = ind->sex() == FEMALE ? 1 : 0;
+				for (size_t idx = 0; idx < nLoci; ++idx) {
+					const vectoru & myCopies = copies[2 * idx + female];
+					for (size_t p = 0; p < myCopies.size(); ++p)
+						alleles[p] = static_cast<size_t>(DEREF_ALLELE(geno + (myCopies[p] * totNumLoci + m_loci[idx])));
+					myCounts[2 * idx + female].add(alleles);
+				}
+			}
+#pragma omp critical
+			{
+				for (size_t i = 0; i < 2 * nLoci; ++i)
+					myCounts[i].addTo(counts[i / 2]);
+			}
+		}
+		pop.deactivateVirtualSubPop(it->subPop());
+	}
+}
+
+
+bool statGenoCounts::covers(const vectoru & loci) const
+{
+	for (size_t i = 0; i < loci.size(); ++i)
+		if (!std::binary_search(m_loci.begin(), m_loci.end(), loci[i]))
+			return false;
+	return true;
+}
+
+
+const tupleDict & statGenoCounts::counts(size_t sp, size_t loc) const
+{
+	vectoru::const_iterator it = std::lower_bound(m_loci.begin(), m_loci.end(), loc);
+
+	DBG_FAILIF(it == m_loci.end() || *it != loc, SystemError,
+		(boost::format("Genotypes at locus %1% are not counted") % loc).str());
+	return m_counts[sp][it - m_loci.begin()];
+}
+
+
 statAlleleFreq::statAlleleFreq(const lociList & loci, const subPopList & subPops,
 	const stringList & vars, const string & suffix)
 	: m_loci(loci), m_subPops(subPops), m_vars(), m_suffix(suffix)
@@ -977,12 +1122,34 @@ string statAlleleFreq::describe(bool /* format */) const
 }
 
 
-bool statAlleleFreq::apply(Population & pop) const
+bool statAlleleFreq::useGenoCounts(const Population & pop, vectoru & loci) const
+{
+#if defined(MUTANTALLELE) || defined(LONGALLELE)
+	// mutant alleles are counted sparsely, and long alleles do not fit in
+	// genotype counts
+	(void)pop;
+	(void)loci;
+	return false;
+#else
+	if (m_loci.empty())
+		return false;
+	const vectoru & myLoci = m_loci.elems(&pop);
+	if (!genoCountable(pop, myLoci, false))
+		return false;
+	loci.insert(loci.end(), myLoci.begin(), myLoci.end());
+	return true;
+#endif
+}
+
+
+bool statAlleleFreq::apply(Population & pop, const statGenoCounts * genoCounts) const
 {
 	if (m_loci.empty())
 		return true;
 
 	const vectoru & loci = m_loci.elems(&pop);
+	if (genoCounts != NULL && !genoCounts->covers(loci))
+		genoCounts = NULL;
 
 	// count for all specified subpopulations
 	ALLELECNTLIST alleleCnt(loci.size());
@@ -991,13 +1158,14 @@ bool statAlleleFreq::apply(Population & pop) const
 	subPopList subPops = m_subPops.expandFrom(pop);
 	subPopList::const_iterator it = subPops.begin();
 	subPopList::const_iterator itEnd = subPops.end();
-	for (; it != itEnd; ++it) {
+	for (size_t spIdx = 0; it != itEnd; ++it, ++spIdx) {
 		if (m_vars.contains(AlleleNum_sp_String))
 			pop.getVars().removeVar(subPopVar_String(*it, AlleleNum_String, m_suffix));
 		if (m_vars.contains(AlleleFreq_sp_String))
 			pop.getVars().removeVar(subPopVar_String(*it, AlleleFreq_String, m_suffix));
 
-		pop.activateVirtualSubPop(*it);
+		if (genoCounts == NULL)
+			pop.activateVirtualSubPop(*it);
 #ifdef MUTANTALLELE
 		/* the following counts alleles for all loci all at once and tend to
 		   use more memory than other modules (which counts loci one by one). In
@@ -1136,20 +1304,41 @@ bool statAlleleFreq::apply(Population & pop) const
 #  endif
 			size_t allAlleles = 0;
 
-			// go through all alleles
-			IndAlleleIterator a = pop.alleleIterator(loc, it->subPop());
-			// use allAllelel here because some marker does not have full number
-			// of alleles (e.g. markers on chromosome X and Y).
-			for (; a.valid(); ++a) {
-				Allele v = a.value();
+			if (genoCounts != NULL) {
+				// alleles of counted genotypes
+				const tupleDict & genotypes = genoCounts->counts(spIdx, loc);
+				tupleDict::const_iterator gt = genotypes.begin();
+				tupleDict::const_iterator gtEnd = genotypes.end();
+				for (; gt != gtEnd; ++gt) {
+					size_t cnt = static_cast<size_t>(gt->second);
+					for (size_t p = 0; p < gt->first.size(); ++p) {
+						size_t v = static_cast<size_t>(gt->first[p]);
 #  ifndef BINARYALLELE
 #    ifndef LONGALLELE
-				if (v >= alleles.size())
-					alleles.resize(v + 1, 0);
+						if (v >= alleles.size())
+							alleles.resize(v + 1, 0);
 #    endif
 #  endif
-				alleles[v]++;
-				allAlleles++;
+						alleles[v] += cnt;
+						allAlleles += cnt;
+					}
+				}
+			} else {
+				// go through all alleles
+				IndAlleleIterator a = pop.alleleIterator(loc, it->subPop());
+				// use allAllelel here because some marker does not have full number
+				// of alleles (e.g. markers on chromosome X and Y).
+				for (; a.valid(); ++a) {
+					Allele v = a.value();
+#  ifndef BINARYALLELE
+#    ifndef LONGALLELE
+					if (v >= alleles.size())
+						alleles.resize(v + 1, 0);
+#    endif
+#  endif
+					alleles[v]++;
+					allAlleles++;
+				}
 			}
 			// total allele count
 #  ifdef LONGALLELE
@@ -1269,12 +1458,26 @@ string statHeteroFreq::describe(bool /* format */) const
 }
 
 
-bool statHeteroFreq::apply(Population & pop) const
+bool statHeteroFreq::useGenoCounts(const Population & pop, vectoru & loci) const
+{
+	if (m_loci.empty() || pop.ploidy() != 2)
+		return false;
+	const vectoru & myLoci = m_loci.elems(&pop);
+	if (!genoCountable(pop, myLoci, true))
+		return false;
+	loci.insert(loci.end(), myLoci.begin(), myLoci.end());
+	return true;
+}
+
+
+bool statHeteroFreq::apply(Population & pop, const statGenoCounts * genoCounts) const
 {
 	if (m_loci.empty())
 		return true;
 
 	const vectoru & loci = m_loci.elems(&pop);
+	if (genoCounts != NULL && !genoCounts->covers(loci))
+		genoCounts = NULL;
 
 	DBG_FAILIF(pop.ploidy() != 2, ValueError,
 		"Heterozygote frequency can only be calculated for diploid populations.");
@@ -1289,8 +1492,9 @@ bool statHeteroFreq::apply(Population & pop) const
 	subPopList subPops = m_subPops.expandFrom(pop);
 	subPopList::const_iterator it = subPops.begin();
 	subPopList::const_iterator itEnd = subPops.end();
-	for (; it != itEnd; ++it) {
-		pop.activateVirtualSubPop(*it);
+	for (size_t spIdx = 0; it != itEnd; ++it, ++spIdx) {
+		if (genoCounts == NULL)
+			pop.activateVirtualSubPop(*it);
 
 		uintDict heteroCnt;
 		uintDict homoCnt;
@@ -1307,13 +1511,25 @@ bool statHeteroFreq::apply(Population & pop) const
 			size_t hetero = 0;
 			size_t homo = 0;
 
-			// go through all alleles
-			IndAlleleIterator a = pop.alleleIterator(loc, it->subPop());
-			for (; a.valid(); a += 2) {
-				if (a.value() != (a + 1).value())
-					hetero += 1;
-				else
-					homo += 1;
+			if (genoCounts != NULL) {
+				const tupleDict & genotypes = genoCounts->counts(spIdx, loc);
+				tupleDict::const_iterator gt = genotypes.begin();
+				tupleDict::const_iterator gtEnd = genotypes.end();
+				for (; gt != gtEnd; ++gt) {
+					if (gt->first[0] != gt->first[1])
+						hetero += static_cast<size_t>(gt->second);
+					else
+						homo += static_cast<size_t>(gt->second);
+				}
+			} else {
+				// go through all alleles
+				IndAlleleIterator a = pop.alleleIterator(loc, it->subPop());
+				for (; a.valid(); a += 2) {
+					if (a.value() != (a + 1).value())
+						hetero += 1;
+					else
+						homo += 1;
+				}
 			}
 #pragma omp critical
 			{
@@ -1440,12 +1656,26 @@ string statGenoFreq::describe(bool /* format */) const
 }
 
 
-bool statGenoFreq::apply(Population & pop) const
+bool statGenoFreq::useGenoCounts(const Population & pop, vectoru & loci) const
+{
+	if (m_loci.empty())
+		return false;
+	const vectoru & myLoci = m_loci.elems(&pop);
+	if (!genoCountable(pop, myLoci, false))
+		return false;
+	loci.insert(loci.end(), myLoci.begin(), myLoci.end());
+	return true;
+}
+
+
+bool statGenoFreq::apply(Population & pop, const statGenoCounts * genoCounts) const
 {
 	if (m_loci.empty())
 		return true;
 
 	const vectoru & loci = m_loci.elems(&pop);
+	if (genoCounts != NULL && !genoCounts->covers(loci))
+		genoCounts = NULL;
 
 	vectoru chromTypes;
 	for (size_t i = 0; i < loci.size(); ++i)
@@ -1461,13 +1691,14 @@ bool statGenoFreq::apply(Population & pop) const
 	subPopList::const_iterator it = subPops.begin();
 	subPopList::const_iterator itEnd = subPops.end();
 	size_t ply = pop.ploidy();
-	for (; it != itEnd; ++it) {
+	for (size_t spIdx = 0; it != itEnd; ++it, ++spIdx) {
 		if (m_vars.contains(GenotypeNum_sp_String))
 			pop.getVars().removeVar(subPopVar_String(*it, GenotypeNum_String, m_suffix));
 		if (m_vars.contains(GenotypeFreq_sp_String))
 			pop.getVars().removeVar(subPopVar_String(*it, GenotypeFreq_String, m_suffix));
 
-		pop.activateVirtualSubPop(*it);
+		if (genoCounts == NULL)
+			pop.activateVirtualSubPop(*it);
 
 #pragma omp parallel for if(numThreads() > 1)
 		for (ssize_t idx = 0; idx < static_cast<ssize_t>(loci.size()); ++idx) {
@@ -1478,8 +1709,27 @@ bool statGenoFreq::apply(Population & pop) const
 
 			// go through all alleles
 			IndIterator ind = pop.indIterator(it->subPop());
-			// the simple case, the speed is potentially faster
-			if (!pop.isHaplodiploid() && (chromTypes[idx] == AUTOSOME || chromTypes[idx] == CUSTOMIZED)) {
+			if (genoCounts != NULL) {
+				genotypes = genoCounts->counts(spIdx, loc);
+				tupleDict::const_iterator gt = genotypes.begin();
+				tupleDict::const_iterator gtEnd = genotypes.end();
+				for (; gt != gtEnd; ++gt)
+					allGenotypes += static_cast<size_t>(gt->second);
+			} else if (!pop.isHaplodiploid() && (chromTypes[idx] == AUTOSOME || chromTypes[idx] == CUSTOMIZED)) {
+				// the simple case, the speed is potentially faster
+#ifdef PACKED_ALLELE_BITS
+				if (packedAlleleCounts::packable(ply)) {
+					packedAlleleCounts packedGenotypes;
+					for (; ind.valid(); ++ind) {
+						boost::uint64_t key = 0;
+						for (size_t p = 0; p < ply; ++p)
+							key = packedAlleleCounts::pack(key, ind->allele(loc, p));
+						packedGenotypes.add(key);
+						allGenotypes++;
+					}
+					packedGenotypes.addTo(genotypes, ply);
+				} else
+#endif
 				for (; ind.valid(); ++ind) {
 					vectori genotype(ply);
 					for (size_t p = 0; p < ply; ++p)
@@ -1643,6 +1893,10 @@ bool statHaploFreq::apply(Population & pop) const
 			tupleDict haplotypes;
 			size_t allHaplotypes = 0;
 
+#ifdef PACKED_ALLELE_BITS
+			bool packed = packedAlleleCounts::packable(nLoci);
+			packedAlleleCounts packedHaplotypes;
+#endif
 			// go through all individual
 			IndIterator ind = pop.indIterator(it->subPop());
 			for (; ind.valid(); ++ind) {
@@ -1657,12 +1911,25 @@ bool statHaploFreq::apply(Population & pop) const
 						continue;
 					if (chromType == MITOCHONDRIAL && p > 0)
 						continue;
+					allHaplotypes++;
+#ifdef PACKED_ALLELE_BITS
+					if (packed) {
+						boost::uint64_t key = 0;
+						for (size_t idx = 0; idx < nLoci; ++idx)
+							key = packedAlleleCounts::pack(key, ind->allele(loci[idx], p));
+						packedHaplotypes.add(key);
+						continue;
+					}
+#endif
 					for (size_t idx = 0; idx < nLoci; ++idx)
 						haplotype[idx] = ind->allele(loci[idx], p);
 					haplotypes[haplotype]++;
-					allHaplotypes++;
 				}
 			}
+#ifdef PACKED_ALLELE_BITS
+			if (packed)
+				packedHaplotypes.addTo(haplotypes, nLoci);
+#endif
 			// total haplotype count
 			tupleDict::iterator dct = haplotypes.begin();
 			tupleDict::iterator dctEnd = haplotypes.end();
@@ -2581,6 +2848,307 @@ bool statLD::apply(Population & pop) const
 }
 
 
+statLDMatrix::statLDMatrix(const lociList & loci, double window, const subPopList & subPops,
+	const stringList & vars, const string & suffix)
+	: m_loci(loci), m_window(window), m_subPops(subPops), m_vars(), m_suffix(suffix)
+{
+	const char * allowedVars[] = {
+		LD_matrix_String, LD_prime_matrix_String, R2_matrix_String, ""
+	};
+	const char * defaultVars[] = { R2_matrix_String, "" };
+
+	m_vars.obtainFrom(vars, allowedVars, defaultVars);
+
+	DBG_FAILIF(window < 0, ValueError, "Parameter LDWindow should be non-negative.");
+}
+
+
+string statLDMatrix::describe(bool /* format */) const
+{
+	string desc;
+
+	if (!m_loci.empty()) {
+		desc += "calculate pairwise linkage disequilibrium between loci";
+		if (m_window > 0)
+			desc += (boost::format(" within distance %1%") % m_window).str();
+	}
+	return desc;
+}
+
+
+// if the p-th homologous copy of chromosomes of type chromType is counted for
+// an individual of specified sex.
+static bool countedHaplotype(size_t chromType, size_t p, Sex sex, bool haplodiploid)
+{
+	if (p == 1 && sex == MALE && haplodiploid)
+		return false;
+	if (chromType == CHROMOSOME_Y && sex == FEMALE)
+		return false;
+	if (((chromType == CHROMOSOME_X && p == 1) ||
+	     (chromType == CHROMOSOME_Y && p == 0)) && sex == MALE)
+		return false;
+	if (chromType == MITOCHONDRIAL && p > 0)
+		return false;
+	return true;
+}
+
+
+void statLDMatrix::packAlleles(Population & pop, const vectoru & loci, const vectoru & locType,
+                               const vectoru & chromTypes, vector<WORDTYPE> & bits, size_t & numWords,
+                               vector<vector<WORDTYPE> > & counted, vector<bool> & multiAllelic) const
+{
+	size_t nLoci = loci.size();
+	size_t nTypes = chromTypes.size();
+	size_t ply = pop.ploidy();
+	bool haplodiploid = pop.isHaplodiploid();
+
+	// collect haplotypes of all (virtual) subpopulations
+	vector<GenoIterator> haplos;
+	counted.assign(nTypes, vector<WORDTYPE>());
+	subPopList subPops = m_subPops.expandFrom(pop);
+	subPopList::const_iterator it = subPops.begin();
+	subPopList::const_iterator itEnd = subPops.end();
+	for (; it != itEnd; ++it) {
+		pop.activateVirtualSubPop(*it);
+		IndIterator ind = pop.indIterator(it->subPop());
+		for (; ind.valid(); ++ind) {
+			for (size_t p = 0; p < ply; ++p) {
+				size_t bit = haplos.size() % WORDBIT;
+				for (size_t t = 0; t < nTypes; ++t) {
+					if (bit == 0)
+						counted[t].push_back(0);
+					if (countedHaplotype(chromTypes[t], p, ind->sex(), haplodiploid))
+						counted[t].back() |= static_cast<WORDTYPE>(1) << bit;
+				}
+				haplos.push_back(ind->genoBegin(p));
+			}
+		}
+		pop.deactivateVirtualSubPop(it->subPop());
+	}
+	size_t nHaplos = haplos.size();
+	numWords = (nHaplos + WORDBIT - 1) / WORDBIT;
+
+	// find up to three distinct alleles at each locus, each thread going
+	// through a block of words of haplotypes
+	vector<vectoru> alleles(nLoci);
+#pragma omp parallel if(numThreads() > 1)
+	{
+		vector<vectoru> myAlleles(nLoci);
+#pragma omp for schedule(static)
+		for (ssize_t w = 0; w < static_cast<ssize_t>(numWords); ++w) {
+			size_t first = w * WORDBIT;
+			size_t last = std::min(first + WORDBIT, nHaplos);
+			for (size_t h = first; h < last; ++h) {
+				WORDTYPE mask = static_cast<WORDTYPE>(1) << (h - first);
+				for (size_t l = 0; l < nLoci; ++l) {
+					if (!(counted[locType[l]][w] & mask) || myAlleles[l].size() > 2)
+						continue;
+					size_t a = DEREF_ALLELE(haplos[h] + loci[l]);
+					if (find(myAlleles[l].begin(), myAlleles[l].end(), a) == myAlleles[l].end())
+						myAlleles[l].push_back(a);
+				}
+			}
+		}
+#pragma omp critical
+		{
+			for (size_t l = 0; l < nLoci; ++l)
+				for (size_t i = 0; i < myAlleles[l].size() && alleles[l].size() < 3; ++i)
+					if (find(alleles[l].begin(), alleles[l].end(), myAlleles[l][i]) == alleles[l].end())
+						alleles[l].push_back(myAlleles[l][i]);
+		}
+	}
+	// the smaller allele is the reference allele of a locus
+	vectoru refAllele(nLoci, 0);
+	multiAllelic.assign(nLoci, false);
+	for (size_t l = 0; l < nLoci; ++l) {
+		if (!alleles[l].empty())
+			refAllele[l] = *std::min_element(alleles[l].begin(), alleles[l].end());
+		multiAllelic[l] = alleles[l].size() > 2;
+	}
+
+	// transpose alleles into bitsets, words being disjoint among threads
+	bits.assign(nLoci * numWords, 0);
+#pragma omp parallel for if(numThreads() > 1)
+	for (ssize_t w = 0; w < static_cast<ssize_t>(numWords); ++w) {
+		size_t first = w * WORDBIT;
+		size_t last = std::min(first + WORDBIT, nHaplos);
+		for (size_t h = first; h < last; ++h) {
+			WORDTYPE mask = static_cast<WORDTYPE>(1) << (h - first);
+			for (size_t l = 0; l < nLoci; ++l)
+				if ((counted[locType[l]][w] & mask) &&
+				    static_cast<size_t>(DEREF_ALLELE(haplos[h] + loci[l])) != refAllele[l])
+					bits[l * numWords + w] |= mask;
+		}
+	}
+}
+
+
+bool statLDMatrix::apply(Population & pop, ostream * out) const
+{
+	if (m_loci.empty())
+		return true;
+
+	// loci are sorted so that nearby loci on a chromosome are adjacent
+	vectoru loci = m_loci.elems(&pop);
+	std::sort(loci.begin(), loci.end());
+	loci.erase(std::unique(loci.begin(), loci.end()), loci.end());
+	size_t nLoci = loci.size();
+
+	vectoru chroms(nLoci);
+	vectorf pos(nLoci);
+	vectoru locType(nLoci);
+	vectoru chromTypes;
+	for (size_t l = 0; l < nLoci; ++l) {
+		DBG_FAILIF(loci[l] >= pop.totNumLoci(), IndexError,
+			(boost::format("Locus index %1% out of range.") % loci[l]).str());
+		chroms[l] = pop.chromLocusPair(loci[l]).first;
+		pos[l] = pop.locusPos(loci[l]);
+		size_t chromType = pop.chromType(chroms[l]);
+		locType[l] = find(chromTypes.begin(), chromTypes.end(), chromType) - chromTypes.begin();
+		if (locType[l] == chromTypes.size())
+			chromTypes.push_back(chromType);
+	}
+
+	DBG_DO(DBG_STATOR, cerr << "Calculating LD matrix for " << nLoci << " loci" << endl);
+
+	vector<WORDTYPE> bits;
+	size_t numWords = 0;
+	vector<vector<WORDTYPE> > counted;
+	vector<bool> multiAllelic;
+	packAlleles(pop, loci, locType, chromTypes, bits, numWords, counted, multiAllelic);
+
+	// number of counted haplotypes for each chromosome type, and number of
+	// non-reference alleles at each locus
+	vectoru numHaplos(chromTypes.size(), 0);
+	for (size_t t = 0; t < chromTypes.size(); ++t)
+		for (size_t w = 0; w < numWords; ++w)
+			numHaplos[t] += countBits(counted[t][w]);
+	vectoru numAlleles(nLoci, 0);
+	for (size_t l = 0; l < nLoci; ++l)
+		for (size_t w = 0; w < numWords; ++w)
+			numAlleles[l] += countBits(bits[l * numWords + w]);
+
+	// the last locus that is paired with each locus, which does not decrease
+	// with locus because loci are sorted by position on each chromosome
+	vectoru lastPair(nLoci, nLoci - 1);
+	// half width of the band of matrices saved with a window
+	size_t band = 0;
+	if (m_window > 0) {
+		size_t j = 0;
+		for (size_t l = 0; l < nLoci; ++l) {
+			j = std::max(j, l);
+			while (j + 1 < nLoci && chroms[j + 1] == chroms[l] && pos[j + 1] - pos[l] <= m_window)
+				++j;
+			lastPair[l] = j;
+			band = std::max(band, j - l);
+		}
+	}
+
+	bool hasLD = m_vars.contains(LD_matrix_String);
+	bool hasD_prime = m_vars.contains(LD_prime_matrix_String);
+	bool hasR2 = m_vars.contains(R2_matrix_String);
+	// with a window, matrices are stored by band so that column band + j - i
+	// of row i holds the value between loci i and j
+	size_t numCols = m_window > 0 ? 2 * band + 1 : nLoci;
+	matrixf LD;
+	matrixf D_prime;
+	matrixf R2;
+	if (out == NULL) {
+		if (hasLD)
+			LD.assign(nLoci, vectorf(numCols, MISSING_VALUE));
+		if (hasD_prime)
+			D_prime.assign(nLoci, vectorf(numCols, MISSING_VALUE));
+		if (hasR2)
+			R2.assign(nLoci, vectorf(numCols, MISSING_VALUE));
+	}
+
+	// pairs are calculated in blocks of rows, and each thread handles a tile
+	// of columns of a block so that bitsets of both tiles fit in cache.
+	size_t tile = std::min<size_t>(256, std::max<size_t>(8, (1 << 15) / std::max<size_t>(numWords, 1)));
+	for (size_t i0 = 0; i0 < nLoci && numWords > 0; i0 += tile) {
+		size_t i1 = std::min(i0 + tile, nLoci);
+		size_t width = lastPair[i1 - 1] + 1 - i0;
+		vectorf blockLD((i1 - i0) * width, MISSING_VALUE);
+		vectorf blockD_prime((i1 - i0) * width, MISSING_VALUE);
+		vectorf blockR2((i1 - i0) * width, MISSING_VALUE);
+		size_t numTiles = (width + tile - 1) / tile;
+
+#pragma omp parallel for if(numThreads() > 1) schedule(dynamic)
+		for (ssize_t t = 0; t < static_cast<ssize_t>(numTiles); ++t) {
+			size_t j0 = i0 + t * tile;
+			size_t j1 = std::min(j0 + tile, i0 + width);
+			for (size_t i = i0; i < i1; ++i) {
+				if (multiAllelic[i])
+					continue;
+				double n = static_cast<double>(numHaplos[locType[i]]);
+				if (n == 0)
+					continue;
+				const WORDTYPE * bits1 = &bits[i * numWords];
+				size_t jEnd = std::min(j1, lastPair[i] + 1);
+				for (size_t j = std::max(i, j0); j < jEnd; ++j) {
+					if (multiAllelic[j] || locType[j] != locType[i])
+						continue;
+					const WORDTYPE * bits2 = &bits[j * numWords];
+					size_t numAB = 0;
+					for (size_t w = 0; w < numWords; ++w)
+						numAB += countBits(bits1[w] & bits2[w]);
+
+					double P_A = numAlleles[i] / n;
+					double P_B = numAlleles[j] / n;
+					double D = numAB / n - P_A * P_B;
+					double D_max = D > 0 ? std::min(P_A * (1 - P_B), (1 - P_A) * P_B) : std::min(P_A * P_B, (1 - P_A) * (1 - P_B));
+					size_t idx = (i - i0) * width + (j - i0);
+					// values are the same as those calculated by statLD for
+					// diallelic loci without primary alleles
+					blockLD[idx] = fabs(D);
+					blockD_prime[idx] = fcmp_eq(D_max, 0.) ? 0. : fabs(D / D_max);
+					blockR2[idx] = (fcmp_eq(P_A, 0) || fcmp_eq(P_B, 0) || fcmp_eq(P_A, 1) || fcmp_eq(P_B, 1)) ? 0. : D * D / P_A / (1 - P_A) / P_B / (1 - P_B);
+				}
+			}
+		}
+		// write pairs or save them to the matrices
+		for (size_t i = i0; i < i1; ++i) {
+			for (size_t j = i; j <= lastPair[i]; ++j) {
+				size_t idx = (i - i0) * width + (j - i0);
+				if (blockLD[idx] == MISSING_VALUE)
+					continue;
+				if (out != NULL) {
+					*out << loci[i] << " " << loci[j];
+					if (hasLD)
+						*out << " " << blockLD[idx];
+					if (hasD_prime)
+						*out << " " << blockD_prime[idx];
+					if (hasR2)
+						*out << " " << blockR2[idx];
+					*out << "\n";
+					continue;
+				}
+				size_t col_ij = m_window > 0 ? band + j - i : j;
+				size_t col_ji = m_window > 0 ? band + i - j : i;
+				if (hasLD)
+					LD[i][col_ij] = LD[j][col_ji] = blockLD[idx];
+				if (hasD_prime)
+					D_prime[i][col_ij] = D_prime[j][col_ji] = blockD_prime[idx];
+				if (hasR2)
+					R2[i][col_ij] = R2[j][col_ji] = blockR2[idx];
+			}
+		}
+	}
+	if (out != NULL)
+		return true;
+
+	// rows of matrices are stored as arrays of doubles instead of lists of
+	// Python floats, which take several times as much memory
+	if (hasLD)
+		pop.getVars().setMatrixVar(LD_matrix_String + m_suffix, LD);
+	if (hasD_prime)
+		pop.getVars().setMatrixVar(LD_prime_matrix_String + m_suffix, D_prime);
+	if (hasR2)
+		pop.getVars().setMatrixVar(R2_matrix_String + m_suffix, R2);
+	return true;
+}
+
+
 statAssociation::statAssociation(const lociList & loci,
 	const subPopList & subPops, const stringList & vars, const string & suffix)
 	: m_loci(loci), m_subPops(subPops), m_vars(), m_suffix(suffix)
@@ -3379,12 +3947,26 @@ vectoru statHWE::mapToCount(const GENOCNT & cnt) const
 }
 
 
-bool statHWE::apply(Population & pop) const
+bool statHWE::useGenoCounts(const Population & pop, vectoru & loci) const
+{
+	if (m_loci.empty() || pop.ploidy() != 2)
+		return false;
+	const vectoru & myLoci = m_loci.elems(&pop);
+	if (!genoCountable(pop, myLoci, true))
+		return false;
+	loci.insert(loci.end(), myLoci.begin(), myLoci.end());
+	return true;
+}
+
+
+bool statHWE::apply(Population & pop, const statGenoCounts * genoCounts) const
 {
 	if (m_loci.empty())
 		return true;
 
 	const vectoru & loci = m_loci.elems(&pop);
+	if (genoCounts != NULL && !genoCounts->covers(loci))
+		genoCounts = NULL;
 
 	DBG_FAILIF(pop.ploidy() != 2, ValueError,
 		"HWE test is only available for diploid populations.");
@@ -3403,24 +3985,39 @@ bool statHWE::apply(Population & pop) const
 	subPopList subPops = m_subPops.expandFrom(pop);
 	subPopList::const_iterator it = subPops.begin();
 	subPopList::const_iterator itEnd = subPops.end();
-	for (; it != itEnd; ++it) {
+	for (size_t spIdx = 0; it != itEnd; ++it, ++spIdx) {
 		GENOCNTLIST genoCnt(nLoci);
 
-		pop.activateVirtualSubPop(*it);
-
-		IndIterator ind = pop.indIterator(it->subPop());
-		for (; ind.valid(); ++ind) {
-			GenoIterator geno1 = ind->genoBegin(0);
-			GenoIterator geno2 = ind->genoBegin(1);
+		if (genoCounts != NULL) {
 			for (size_t idx = 0; idx < nLoci; ++idx) {
-				Allele a1 = DEREF_ALLELE(geno1 + loci[idx]);
-				Allele a2 = DEREF_ALLELE(geno2 + loci[idx]);
-				if (a1 > a2)
-					std::swap(a1, a2);
-				genoCnt[idx][GENOCNT::key_type(a1, a2)]++;
+				const tupleDict & genotypes = genoCounts->counts(spIdx, loci[idx]);
+				tupleDict::const_iterator gt = genotypes.begin();
+				tupleDict::const_iterator gtEnd = genotypes.end();
+				for (; gt != gtEnd; ++gt) {
+					size_t a1 = static_cast<size_t>(gt->first[0]);
+					size_t a2 = static_cast<size_t>(gt->first[1]);
+					if (a1 > a2)
+						std::swap(a1, a2);
+					genoCnt[idx][GENOCNT::key_type(a1, a2)] += static_cast<size_t>(gt->second);
+				}
 			}
+		} else {
+			pop.activateVirtualSubPop(*it);
+
+			IndIterator ind = pop.indIterator(it->subPop());
+			for (; ind.valid(); ++ind) {
+				GenoIterator geno1 = ind->genoBegin(0);
+				GenoIterator geno2 = ind->genoBegin(1);
+				for (size_t idx = 0; idx < nLoci; ++idx) {
+					Allele a1 = DEREF_ALLELE(geno1 + loci[idx]);
+					Allele a2 = DEREF_ALLELE(geno2 + loci[idx]);
+					if (a1 > a2)
+						std::swap(a1, a2);
+					genoCnt[idx][GENOCNT::key_type(a1, a2)]++;
+				}
+			}
+			pop.deactivateVirtualSubPop(it->subPop());
 		}
-		pop.deactivateVirtualSubPop(it->subPop());
 		//
 		// output variable.
 		if (m_vars.contains(HWE_sp_String)) {
@@ -447,6 +447,278 @@ private:
 };
 
 
+#if defined(BINARYALLELE)
+/// number of bits used by an allele in a packed allele sequence
+#  define PACKED_ALLELE_BITS 1
+#elif !defined(LONGALLELE) && !defined(MUTANTALLELE)
+#  define PACKED_ALLELE_BITS 8
+#endif
+
+#ifdef PACKED_ALLELE_BITS
+
+/// CPPONLY
+/// Counts of short allele sequences (haplotypes or genotypes) in modules with
+/// bounded alleles. A sequence is packed into a 64-bit key, and keys are
+/// stored in an open addressing hash table with a parallel array of counts
+/// (a zero count marks an empty slot), which avoids allocating a map node
+/// and an allele vector for each counted sequence.
+class packedAlleleCounts
+{
+public:
+	packedAlleleCounts() : m_size(0), m_mask(0), m_keys(), m_counts()
+	{
+	}
+
+
+	/// if a sequence of \e length alleles fits in a packed key
+	static bool packable(size_t length)
+	{
+		return length * PACKED_ALLELE_BITS <= 64;
+	}
+
+
+	/// append allele \e allele to packed sequence \e key
+	static boost::uint64_t pack(boost::uint64_t key, size_t allele)
+	{
+		return (key << PACKED_ALLELE_BITS) | static_cast<boost::uint64_t>(allele);
+	}
+
+
+	/// add \e cnt to the count of packed sequence \e key
+	void add(boost::uint64_t key, size_t cnt = 1)
+	{
+		if (2 * (m_size + 1) > m_keys.size())
+			rehash(m_keys.empty() ? 16 : 2 * m_keys.size());
+		size_t slot = hash(key);
+		while (m_counts[slot] != 0 && m_keys[slot] != key)
+			slot = (slot + 1) & m_mask;
+		if (m_counts[slot] == 0) {
+			m_keys[slot] = key;
+			++m_size;
+		}
+		m_counts[slot] += cnt;
+	}
+
+
+	/// add counts in \e rhs to this table
+	void merge(const packedAlleleCounts & rhs)
+	{
+		for (size_t slot = 0; slot < rhs.m_counts.size(); ++slot)
+			if (rhs.m_counts[slot] != 0)
+				add(rhs.m_keys[slot], rhs.m_counts[slot]);
+	}
+
+
+	/// add counts to \e dict, unpacking keys into sequences of \e length alleles
+	void addTo(tupleDict & dict, size_t length) const
+	{
+		const boost::uint64_t alleleMask = (static_cast<boost::uint64_t>(1) << PACKED_ALLELE_BITS) - 1;
+		vectori seq(length);
+
+		for (size_t slot = 0; slot < m_counts.size(); ++slot) {
+			if (m_counts[slot] == 0)
+				continue;
+			boost::uint64_t key = m_keys[slot];
+			for (size_t i = length; i > 0; --i) {
+				seq[i - 1] = static_cast<int>(key & alleleMask);
+				key >>= PACKED_ALLELE_BITS;
+			}
+			dict[seq] += static_cast<double>(m_counts[slot]);
+		}
+	}
+
+
+	/// number of distinct sequences
+	size_t size() const
+	{
+		return m_size;
+	}
+
+
+private:
+	size_t hash(boost::uint64_t key) const
+	{
+		return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) & m_mask;
+	}
+
+
+	void rehash(size_t capacity)
+	{
+		vector<boost::uint64_t> keys(capacity);
+		vectoru counts(capacity, 0);
+
+		m_keys.swap(keys);
+		m_counts.swap(counts);
+		m_mask = capacity - 1;
+		m_size = 0;
+		for (size_t slot = 0; slot < counts.size(); ++slot)
+			if (counts[slot] != 0)
+				add(keys[slot], counts[slot]);
+	}
+
+
+private:
+	/// number of occupied slots
+	size_t m_size;
+
+	/// table capacity minus one, capacity being a power of two
+	size_t m_mask;
+
+	vector<boost::uint64_t> m_keys;
+
+	vectoru m_counts;
+};
+
+#endif
+
+/// CPPONLY
+/// Counts of genotypes of a fixed number of alleles, kept in a dense array
+/// that is indexed by the alleles and that grows with the largest allele.
+/// Genotypes with alleles that would make the array too large are counted
+/// in a dictionary.
+class denseGenoCounts
+{
+public:
+	denseGenoCounts(size_t length = 0) : m_length(length), m_numAlleles(1),
+		m_counts(1, 0), m_others()
+	{
+	}
+
+
+	/// add a genotype with the first \e length alleles in \e alleles
+	void add(const vectoru & alleles)
+	{
+		size_t maxAllele = 0;
+
+		for (size_t p = 0; p < m_length; ++p)
+			if (alleles[p] > maxAllele)
+				maxAllele = alleles[p];
+		if (maxAllele >= m_numAlleles && !grow(maxAllele + 1)) {
+			m_others[vectori(alleles.begin(), alleles.begin() + m_length)] += 1;
+			return;
+		}
+		size_t idx = 0;
+		for (size_t p = 0; p < m_length; ++p)
+			idx = idx * m_numAlleles + alleles[p];
+		++m_counts[idx];
+	}
+
+
+	/// add counts to \e dict
+	void addTo(tupleDict & dict) const
+	{
+		vectori genotype(m_length);
+
+		for (size_t idx = 0; idx < m_counts.size(); ++idx) {
+			if (m_counts[idx] == 0)
+				continue;
+			for (size_t p = m_length, i = idx; p > 0; --p, i /= m_numAlleles)
+				genotype[p - 1] = static_cast<int>(i % m_numAlleles);
+			dict[genotype] += static_cast<double>(m_counts[idx]);
+		}
+		tupleDict::const_iterator it = m_others.begin();
+		tupleDict::const_iterator itEnd = m_others.end();
+		for (; it != itEnd; ++it)
+			dict[it->first] += it->second;
+	}
+
+
+private:
+	/// re-index counts for at least \e numAlleles alleles, return \c false
+	/// if the array would be too large
+	bool grow(size_t numAlleles)
+	{
+		// at most 4096 genotypes (64 alleles for diploid genotypes) are
+		// counted in the array
+		const size_t maxSize = 4096;
+
+		// leave room for more alleles if possible
+		size_t size = arraySize(2 * m_numAlleles, maxSize);
+		if (numAlleles <= 2 * m_numAlleles && size != 0)
+			numAlleles = 2 * m_numAlleles;
+		else
+			size = arraySize(numAlleles, maxSize);
+		if (size == 0)
+			return false;
+		vectoru counts(size, 0);
+		for (size_t idx = 0; idx < m_counts.size(); ++idx) {
+			if (m_counts[idx] == 0)
+				continue;
+			size_t newIdx = 0;
+			size_t scale = 1;
+			for (size_t p = 0, i = idx; p < m_length; ++p, i /= m_numAlleles, scale *= numAlleles)
+				newIdx += (i % m_numAlleles) * scale;
+			counts[newIdx] = m_counts[idx];
+		}
+		m_counts.swap(counts);
+		m_numAlleles = numAlleles;
+		return true;
+	}
+
+
+	/// size of an array for genotypes of \e numAlleles alleles, or 0 if it is
+	/// larger than \e maxSize
+	size_t arraySize(size_t numAlleles, size_t maxSize) const
+	{
+		if (numAlleles > maxSize)
+			return 0;
+		size_t size = 1;
+		for (size_t p = 0; p < m_length; ++p) {
+			size *= numAlleles;
+			if (size > maxSize)
+				return 0;
+		}
+		return size;
+	}
+
+
+private:
+	/// number of alleles in each genotype
+	size_t m_length;
+
+	/// alleles 0 to m_numAlleles - 1 are counted in m_counts
+	size_t m_numAlleles;
+
+	vectoru m_counts;
+
+	/// genotypes with alleles not counted in m_counts
+	tupleDict m_others;
+};
+
+
+/// CPPONLY
+/// Genotype counts at a set of loci in each (virtual) subpopulation,
+/// gathered in a single pass through the population so that statistics
+/// derived from genotypes (allele, heterozygote and genotype frequencies
+/// and HWE tests) do not scan the population one after another. Genotypes
+/// on sex and mitochondrial chromosomes consist of the alleles on the
+/// homologous copies that an individual has.
+class statGenoCounts
+{
+public:
+	statGenoCounts() : m_loci(), m_counts()
+	{
+	}
+
+
+	/// count genotypes at \e loci of individuals in \e subPops.
+	void count(Population & pop, const vectoru & loci, const subPopList & subPops);
+
+	/// if genotypes at all \e loci have been counted
+	bool covers(const vectoru & loci) const;
+
+	/// genotype counts at locus \e loc in the \e sp-th (virtual) subpopulation
+	const tupleDict & counts(size_t sp, size_t loc) const;
+
+private:
+	/// counted loci, sorted
+	vectoru m_loci;
+
+	/// genotype counts for each subpopulation and locus
+	vector<vector<tupleDict> > m_counts;
+};
+
+
 /// CPPONLY
 class statAlleleFreq
 {
@@ -472,7 +744,11 @@ public:
 	}
 
 
-	bool apply(Population & pop) const;
+	/// add loci of this statistic to \e loci and return \c true if it can
+	/// be calculated from genotype counts.
+	bool useGenoCounts(const Population & pop, vectoru & loci) const;
+
+	bool apply(Population & pop, const statGenoCounts * genoCounts = NULL) const;
 
 private:
 	/// which alleles?
@@ -503,7 +779,11 @@ public:
 
 	string describe(bool format = true) const;
 
-	bool apply(Population & pop) const;
+	/// add loci of this statistic to \e loci and return \c true if it can
+	/// be calculated from genotype counts.
+	bool useGenoCounts(const Population & pop, vectoru & loci) const;
+
+	bool apply(Population & pop, const statGenoCounts * genoCounts = NULL) const;
 
 private:
 	/// heteroFreq
@@ -530,7 +810,11 @@ public:
 
 	string describe(bool format = true) const;
 
-	bool apply(Population & pop) const;
+	/// add loci of this statistic to \e loci and return \c true if it can
+	/// be calculated from genotype counts.
+	bool useGenoCounts(const Population & pop, vectoru & loci) const;
+
+	bool apply(Population & pop, const statGenoCounts * genoCounts = NULL) const;
 
 private:
 	/// which genotypes
@@ -717,6 +1001,57 @@ private:
 	string m_suffix;
 };
 
+
+/// CPPONLY
+/// LD between all pairs of (or pairs of nearby) diallelic loci. Alleles at
+/// each locus are transposed into a bitset over all counted haplotypes so
+/// that haplotype counts of a pair of loci are obtained by AND and popcount
+/// of two bitsets, which are processed in cache-sized tiles of loci.
+class statLDMatrix
+{
+private:
+#define   LD_matrix_String          "LD_matrix"
+#define   LD_prime_matrix_String    "LD_prime_matrix"
+#define   R2_matrix_String          "R2_matrix"
+
+public:
+	statLDMatrix(const lociList & loci, double window, const subPopList & subPops,
+		const stringList & vars, const string & suffix);
+
+	string describe(bool format = true) const;
+
+	/// Calculate the LD matrix and write pairs of loci to \e out, or save
+	/// the matrix to population variables if \e out is \c NULL.
+	bool apply(Population & pop, ostream * out) const;
+
+	bool empty() const
+	{
+		return m_loci.empty();
+	}
+
+
+private:
+	/// Transpose alleles at \e loci into one bitset of \e numWords words for
+	/// each locus, with bits set for haplotypes with the larger of two
+	/// alleles. \e counted marks haplotypes that are counted at loci on
+	/// chromosomes of each type in \e chromTypes (\e locType being the index
+	/// of the type of each locus), and loci with more than two alleles are
+	/// marked in \e multiAllelic.
+	void packAlleles(Population & pop, const vectoru & loci, const vectoru & locType,
+		const vectoru & chromTypes, vector<WORDTYPE> & bits, size_t & numWords,
+		vector<vector<WORDTYPE> > & counted, vector<bool> & multiAllelic) const;
+
+private:
+	lociList m_loci;
+
+	/// maximal distance between loci on the same chromosome, 0 for all pairs
+	double m_window;
+
+	subPopList m_subPops;
+	stringList m_vars;
+	string m_suffix;
+};
+
 /// CPPONLY
 class statAssociation
 {
@@ -864,7 +1199,11 @@ public:
 
 	string describe(bool format = true) const;
 
-	bool apply(Population & pop) const;
+	/// add loci of this statistic to \e loci and return \c true if it can
+	/// be calculated from genotype counts.
+	bool useGenoCounts(const Population & pop, vectoru & loci) const;
+
+	bool apply(Population & pop, const statGenoCounts * genoCounts = NULL) const;
 
 private:
 	vectoru mapToCount(const GENOCNT & cnt) const;
@@ -1001,8 +1340,9 @@ public:
 	 *  population when it is applied to this population. This operator can
 	 *  be applied to specified replicates (parameter \e rep) at specified
 	 *  generations (parameter \e begin, \e end, \e step, and \e at). This
-	 *  operator does not produce any output (ignore parameter \e output)
-	 *  after statistics are calculated. Instead, it stores results in the
+	 *  operator does not produce any output (ignore parameter \e output,
+	 *  except for statistic \c LDMatrix) after statistics are calculated.
+	 *  Instead, it stores results in the
 	 *  local namespace of the population being applied. Other operators can
 	 *  retrieve these variables or evalulate expression directly in this
 	 *  local namespace. Please refer to operator \c BaseOperator for a
@@ -1302,6 +1642,28 @@ public:
 	 *       (virtual) subpopulation.
 	 *  \li \c CramerV_sp Cramer V statistics for each (virtual) subpopulation.
 	 *
+	 *  <b>LDMatrix</b>: Parameter \c LDMatrix accepts a list of loci (indexes,
+	 *  names, or \c ALL_AVAIL) and calculates LD between all pairs of them,
+	 *  or between pairs of loci on the same chromosome that are at most
+	 *  \e LDWindow apart if a positive \e LDWindow is given. This statistic
+	 *  is designed for a large number of diallelic loci. Its values are the
+	 *  same as those of statistic \c LD without primary alleles, and are set
+	 *  to \c MISSING_VALUE for pairs of loci with more than two alleles, on
+	 *  chromosomes of different types, or out of the window. If parameter
+	 *  \e output is specified, a line with two loci and requested measures
+	 *  is written for each calculated pair of loci. Otherwise, the following
+	 *  variables are set to matrices with rows of loci in ascending order.
+	 *  Each row is an \c array.array of doubles so a matrix can be converted
+	 *  to a NumPy array with <tt>numpy.array(m)</tt>. Columns are also loci
+	 *  in ascending order so that <tt>m[i][j]</tt> is the value between the
+	 *  i-th and j-th loci, unless a positive \e LDWindow is given. In this
+	 *  case, matrices are stored by band with <tt>2w+1</tt> columns, where
+	 *  \c w is the largest number of loci between two paired loci, and the
+	 *  value between the i-th and j-th loci is <tt>m[i][w+j-i]</tt>:
+	 *  \li \c LD_matrix Basic LD measure between pairs of loci.
+	 *  \li \c LD_prime_matrix Lewontin's D' measure between pairs of loci.
+	 *  \li \c R2_matrix (default) R2 measure between pairs of loci.
+	 *
 	 *  <b>association</b>: Parameter \c association accepts a list of loci,
 	 *  which can be a list of indexes, names, or \c ALL_AVAIL. At each locus,
 	 *  one or more statistical tests will be performed to test association
@@ -1563,7 +1925,10 @@ public:
 		const stringFunc & output = "",
 		int begin = 0, int end = -1, int step = 1, const intList & at = vectori(),
 		const intList & reps = intList(), const subPopList & subPops = subPopList(),
-		const stringList & infoFields = vectorstr());
+		const stringList & infoFields = vectorstr(),
+		//
+		const lociList & LDMatrix = vectoru(),
+		double LDWindow = 0);
 
 	~Stat()
 	{
@@ -1587,6 +1952,17 @@ public:
 	/// HIDDEN apply the \c Stat operator
 	virtual bool apply(Population & pop) const;
 
+	/// CPPONLY
+	bool canApplyConcurrently() const
+	{
+		return noOutput();
+	}
+
+
+private:
+	/// calculate the LD matrix, writing it to \e output if specified
+	bool applyLDMatrix(Population & pop) const;
+
 private:
 	const statPopSize m_popSize;
 	const statNumOfMales m_numOfMales;
@@ -1600,6 +1976,7 @@ private:
 	const statHaploHomoFreq m_haploHomoFreq;
 	const statInfo m_info;
 	const statLD m_LD;
+	const statLDMatrix m_LDMatrix;
 	const statAssociation m_association;
 	const statNeutrality m_neutrality;
 	const statStructure m_structure;
@@ -56,12 +56,18 @@ bool IdTagger::apply(Population & pop) const
 	size_t idx = pop.infoIdx(infoField(0));
 
 	size_t curGen = pop.curAncestralGen();
+	// reserve IDs at once because other replicates might be tagged in parallel
+	size_t numInds = 0;
+	for (int depth = pop.ancestralGens(); depth >= 0; --depth)
+		numInds += pop.popSize(depth);
+	ATOMICLONG id = fetchAndAdd(&g_indID, static_cast<ATOMICLONG>(numInds));
 	for (int depth = pop.ancestralGens(); depth >= 0; --depth) {
 		pop.useAncestralGen(depth);
 		for (size_t i = 0, iEnd = pop.popSize(); i < iEnd; ++i)
-			pop.individual(i).setInfo(static_cast<double>(g_indID++), idx);
+			pop.individual(i).setInfo(static_cast<double>(id++), idx);
 	}
 	pop.useAncestralGen(curGen);
+	pop.clearIDIndex();
 	return true;
 }
 
@@ -108,6 +108,20 @@ public:
 	}
 
 
+	/// CPPONLY
+	bool canApplyConcurrently() const
+	{
+		return true;
+	}
+
+
+	/// CPPONLY
+	bool dependsOnReplicateOrder() const
+	{
+		return true;
+	}
+
+
 };
 
 
@@ -55,6 +55,19 @@ void GenoTransmitter::initialize(const Individual & ind) const
 }
 
 
+vectoru & GenoTransmitter::breaksBuffer() const
+{
+#ifdef _OPENMP
+	vectoru & breaks = m_breaks[omp_get_thread_num()];
+#else
+	vectoru & breaks = m_breaks[0];
+#endif
+
+	breaks.clear();
+	return breaks;
+}
+
+
 void GenoTransmitter::clearChromosome(const Individual & ind, int ploidy, size_t chrom) const
 {
 	initializeIfNeeded(ind);
@@ -281,66 +294,21 @@ void MendelianGenoTransmitter::transmitGenotype(const Individual & parent,
 #ifdef BINARYALLELE
 	// for the simple case, use faster algorithm
 	if (m_chromX < 0 && m_chromY < 0 && !m_hasCustomizedChroms) {
-		// pointer to parental, and offspring chromosome copies
-		GenoIterator par[2];
-		GenoIterator off;
-#  ifdef LINEAGE
-		LineageIterator parLineage[2];
-		LineageIterator offLineage;
-#  endif
-
-		//
-		par[0] = parent.genoBegin(0);
-		par[1] = parent.genoBegin(1);
-		off = offspring.genoBegin(ploidy);
-#  ifdef LINEAGE
-		parLineage[0] = parent.lineageBegin(0);
-		parLineage[1] = parent.lineageBegin(1);
-		offLineage = offspring.lineageBegin(ploidy);
-#  endif
-
-		//
-		//
-		// 1. try to copy in blocks,
-		// 2. if two chromosomes can be copied together, copy together
-		// 3. if length is short, using the old method.
-		//
-		size_t parBegin = 0;
-		size_t parEnd = 0;
-		// first chromosome
-		parPloidy = getRNG().randBit();
-		//
-		int nextParPloidy = 0;
-		bool copyPar;
-		for (size_t ch = 0; ch < m_numChrom; ++ch) {
-			// if it is the last chromosome, copy anyway
-			if (ch == m_numChrom - 1)
-				copyPar = true;
-			else {                                                                 // is there a different chromosome?
-				nextParPloidy = getRNG().randBit();
-				copyPar = parPloidy != nextParPloidy;
-			}
-			if (copyPar) {
-				// end of this chromosome, is the beginning of the next
-				parEnd = m_chromIdx[ch + 1];
-				size_t length = parEnd - parBegin;
-				//
-				// the easiest case, try to get some speed up...
-				if (length == 1) {
-					off[parBegin] = par[parPloidy][parBegin];
-					LINEAGE_EXPR(offLineage[parBegin] = parLineage[parPloidy][parBegin]);
-				} else {
-					copyGenotype(par[parPloidy] + parBegin, off + parBegin, length);
-					LINEAGE_EXPR(copy(parLineage[parPloidy] + parBegin,
-							parLineage[parPloidy] + parBegin + length,
-							offLineage + parBegin));
-				}
-				//
-				if (ch != m_numChrom - 1)
-					parPloidy = nextParPloidy;
-				parBegin = parEnd;
+		// record the beginning of chromosomes that are copied from a
+		// different parental copy than the previous chromosome, and
+		// copy all of them word by word at once.
+		vectoru & breaks = breaksBuffer();
+		int firstPloidy = getRNG().randBit();
+		parPloidy = firstPloidy;
+		for (size_t ch = 1; ch < m_numChrom; ++ch) {
+			int nextParPloidy = getRNG().randBit();
+			if (nextParPloidy != parPloidy) {
+				breaks.push_back(m_chromIdx[ch]);
+				parPloidy = nextParPloidy;
 			}
 		}
+		blendGenotype(parent.genoBegin(0), parent.genoBegin(1), offspring.genoBegin(ploidy),
+			0, m_chromIdx[m_numChrom], breaks, firstPloidy);
 		return;
 	}
 #endif
@@ -528,11 +496,12 @@ bool MitochondrialGenoTransmitter::applyDuringMating(Population & pop, Populatio
 Recombinator::Recombinator(const floatList & rates, double intensity,
 	const lociList & loci, const floatList & convMode,
 	const stringFunc & output, int begin, int end, int step, const intList & at,
-	const intList & reps, const subPopList & subPops, const stringList & infoFields)
+	const intList & reps, const subPopList & subPops, const stringList & infoFields,
+	bool sparse)
 	:
 	GenoTransmitter(output, begin, end, step, at, reps, subPops, infoFields),
 	m_intensity(intensity), m_rates(rates.elems()), m_loci(loci),
-	m_recBeforeLoci(0), m_convMode(convMode.elems()), m_chromX(-1), m_chromY(-1), m_mitochondrial(-1),
+	m_recBeforeLoci(0), m_convMode(convMode.elems()), m_sparse(sparse), m_cumHazard(), m_chromX(-1), m_chromY(-1), m_mitochondrial(-1),
 	m_customizedBegin(-1), m_customizedEnd(-1), m_algorithm(0), m_debugOutput(NULL),
 #ifdef _OPENMP
 	m_bt(numThreads(), getRNG())
@@ -600,6 +569,172 @@ size_t Recombinator::markersConverted(size_t index, const Individual & ind) cons
 }
 
 
+void Recombinator::sampleBreaks(const Individual & parent, vectoru & breaks, int curCp,
+                                int forceFirstBegin, int forceFirstEnd,
+                                int forceSecondBegin, int forceSecondEnd) const
+{
+	// the last interval determines the initial copy and does not count
+	size_t nIntervals = m_recBeforeLoci.size() - 1;
+	vectoru::const_iterator recBegin = m_recBeforeLoci.begin();
+	vectoru::const_iterator recEnd = recBegin + nIntervals;
+
+	// intervals that are within sex chromosomes, at which a fixed copy is used.
+	size_t forceBegin[2];
+	size_t forceEnd[2];
+	int forceCp[2];
+	size_t nForce = 0;
+	if (forceFirstBegin >= 0) {
+		forceBegin[nForce] = lower_bound(recBegin, recEnd, static_cast<size_t>(forceFirstBegin)) - recBegin;
+		forceEnd[nForce] = lower_bound(recBegin, recEnd, static_cast<size_t>(forceFirstEnd)) - recBegin;
+		forceCp[nForce++] = 0;
+	}
+	if (forceSecondBegin >= 0) {
+		forceBegin[nForce] = lower_bound(recBegin, recEnd, static_cast<size_t>(forceSecondBegin)) - recBegin;
+		forceEnd[nForce] = lower_bound(recBegin, recEnd, static_cast<size_t>(forceSecondEnd)) - recBegin;
+		forceCp[nForce++] = 1;
+	}
+	if (nForce == 2 && forceBegin[1] < forceBegin[0]) {
+		std::swap(forceBegin[0], forceBegin[1]);
+		std::swap(forceEnd[0], forceEnd[1]);
+		std::swap(forceCp[0], forceCp[1]);
+	}
+
+	bool withConversion = static_cast<int>(m_convMode[0]) != NO_CONVERSION
+	                      && m_convMode[1] > 0.;
+	// end of a pending conversion, zero for none
+	size_t convEnd = 0;
+	size_t fc = 0;
+	size_t pos = 0;
+	double hazard = 0;
+	while (true) {
+		// the next crossover happens in the first interval with cumulative
+		// hazard reaching the exponential gap.
+		hazard += getRNG().randExponential(1.);
+		size_t idx = lower_bound(m_cumHazard.begin() + pos, m_cumHazard.begin() + nIntervals, hazard)
+		             - m_cumHazard.begin();
+		bool inForced = false;
+		for (; fc < nForce && forceBegin[fc] <= idx; ++fc) {
+			// a pending conversion ends at the end of a chromosome
+			if (convEnd > 0) {
+				curCp = (curCp + 1) % 2;
+				breaks.push_back(convEnd);
+				if (m_debugOutput)
+					*m_debugOutput << ' ' << convEnd - 1;
+				convEnd = 0;
+			}
+			if (forceBegin[fc] < forceEnd[fc] && curCp != forceCp[fc]) {
+				curCp = forceCp[fc];
+				breaks.push_back(m_recBeforeLoci[forceBegin[fc]]);
+				if (m_debugOutput)
+					*m_debugOutput << ' ' << m_recBeforeLoci[forceBegin[fc]] - 1;
+			}
+			// crossovers within the sex chromosome are ignored, and the
+			// search continues after it (the exponential is memoryless).
+			if (idx < forceEnd[fc]) {
+				pos = forceEnd[fc];
+				hazard = m_cumHazard[pos - 1];
+				inForced = true;
+				++fc;
+				break;
+			}
+		}
+		if (inForced)
+			continue;
+		if (idx >= nIntervals)
+			break;
+		size_t gt = m_recBeforeLoci[idx];
+		// a new crossover stops the previous conversion
+		if (convEnd > 0 && convEnd < gt) {
+			curCp = (curCp + 1) % 2;
+			breaks.push_back(convEnd);
+			if (m_debugOutput)
+				*m_debugOutput << ' ' << convEnd - 1;
+		}
+		convEnd = 0;
+		curCp = (curCp + 1) % 2;
+		breaks.push_back(gt);
+		if (m_debugOutput)
+			*m_debugOutput << ' ' << gt - 1;
+		if (withConversion &&
+		    parent.lociLeft(gt - 1) != 1 &&             // can not be at the end of a chromosome
+		    (m_convMode[1] == 1. || getRNG().randUniform() < m_convMode[1])) {
+			size_t convCount = markersConverted(gt, parent);
+			if (convCount > 0)
+				convEnd = gt + convCount;
+		}
+		// there can be only one crossover in each interval
+		pos = idx + 1;
+		hazard = m_cumHazard[idx];
+	}
+	if (convEnd > 0 && convEnd < m_recBeforeLoci.back()) {
+		curCp = (curCp + 1) % 2;
+		breaks.push_back(convEnd);
+		if (m_debugOutput)
+			*m_debugOutput << ' ' << convEnd - 1;
+	}
+}
+
+
+void Recombinator::copyWithBreaks(const Individual & parent, Individual & offspring, int ploidy,
+                                  const vectoru & breaks, int firstCp, int ignoreBegin, int ignoreEnd, size_t gtEnd) const
+{
+	GenoIterator cp[2];
+	cp[0] = parent.genoBegin(0);
+	cp[1] = parent.genoBegin(1);
+	GenoIterator off = offspring.genoBegin(ploidy);
+#ifdef LINEAGE
+	LineageIterator lineagep[2];
+	lineagep[0] = parent.lineageBegin(0);
+	lineagep[1] = parent.lineageBegin(1);
+	LineageIterator lineageOff = offspring.lineageBegin(ploidy);
+#endif
+
+	// regions that should not be copied
+	size_t skipBegin[2];
+	size_t skipEnd[2];
+	size_t nSkip = 0;
+	if (ignoreBegin >= 0) {
+		skipBegin[nSkip] = ignoreBegin;
+		skipEnd[nSkip++] = ignoreEnd;
+	}
+	if (m_customizedBegin >= 0) {
+		skipBegin[nSkip] = m_customizedBegin;
+		skipEnd[nSkip++] = m_customizedEnd;
+	}
+	if (nSkip == 2 && skipBegin[1] < skipBegin[0]) {
+		std::swap(skipBegin[0], skipBegin[1]);
+		std::swap(skipEnd[0], skipEnd[1]);
+	}
+	size_t gt = 0;
+	for (size_t i = 0; i <= nSkip; ++i) {
+		size_t regionEnd = i < nSkip ? std::min(skipBegin[i], gtEnd) : gtEnd;
+#ifdef BINARYALLELE
+		blendGenotype(cp[0], cp[1], off, gt, regionEnd, breaks, firstCp);
+#else
+		int curCp = firstCp;
+		vectoru::const_iterator br = breaks.begin();
+		vectoru::const_iterator brEnd = breaks.end();
+		for (; br != brEnd && *br <= gt; ++br)
+			curCp ^= 1;
+		while (gt < regionEnd) {
+			size_t segEnd = br == brEnd ? regionEnd : std::min(static_cast<size_t>(*br), regionEnd);
+#  ifdef MUTANTALLELE
+			copyGenotype(cp[curCp] + gt, cp[curCp] + segEnd, off + gt);
+#  else
+			copy(cp[curCp] + gt, cp[curCp] + segEnd, off + gt);
+#  endif
+			LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + segEnd, lineageOff + gt));
+			gt = segEnd;
+			for (; br != brEnd && *br <= gt; ++br)
+				curCp ^= 1;
+		}
+#endif
+		if (i < nSkip)
+			gt = std::max(gt, skipEnd[i]);
+	}
+}
+
+
 void Recombinator::initialize(const Individual & ind) const
 {
 	GenoTransmitter::initialize(ind);
@@ -739,8 +874,24 @@ void Recombinator::initialize(const Individual & ind) const
 	// handling of sex chromosomes etc.
 	//
 	// average recombination rate > 0.01, or with sex chromosomes
-	if (fabs(std::accumulate(vecP.begin(), vecP.end(), 0.) - 0.5 * ind.numChrom()) > 0.01 * vecP.size()
-	    || m_chromX > 0 || m_customizedBegin > 0)
+	if (m_sparse) {
+		// sparse: draw crossovers from the cumulative map, using -log(1-p) as the
+		// hazard of each interval so that a crossover happens in an interval
+		// with probability p.
+		m_algorithm = 3;
+		m_cumHazard.resize(vecP.size());
+		double hazard = 0;
+		for (size_t i = 0; i < vecP.size(); ++i) {
+			// rates are capped at 0.5 above. A rate of 1 would give an infinite
+			// hazard, after which every interval would have a crossover.
+			if (vecP[i] >= 1.)
+				throw SystemError((boost::format("Recombination rate %1% at locus %2% is out of range for sparse Recombinator.")
+						           % vecP[i] % m_recBeforeLoci[i]).str());
+			hazard -= log(1. - vecP[i]);
+			m_cumHazard[i] = hazard;
+		}
+	} else if (fabs(std::accumulate(vecP.begin(), vecP.end(), 0.) - 0.5 * ind.numChrom()) > 0.01 * vecP.size()
+	           || m_chromX > 0 || m_customizedBegin > 0)
 		m_algorithm = 0;
 	else if (uniform_rare) {
 		// uniform rare
@@ -751,7 +902,7 @@ void Recombinator::initialize(const Individual & ind) const
 	} else
 		m_algorithm = 1;
 
-	if (m_algorithm != 2) {
+	if (m_algorithm < 2) {
 #ifdef _OPENMP
 		for (size_t i = 0; i < numThreads(); i++)
 			m_bt[i].setParameter(vecP);
@@ -833,9 +984,9 @@ void Recombinator::transmitGenotype(const Individual & parent,
 	}
 	// get a new set of values.
 	// const BoolResults& bs = bt.trial();
-	if (m_algorithm != 2)
+	if (m_algorithm < 2)
 		bt.trial();
-	int curCp = m_algorithm == 2 ? getRNG().randBit() : (bt.trialSucc(m_recBeforeLoci.size() - 1) ? 0 : 1);
+	int curCp = m_algorithm >= 2 ? getRNG().randBit() : (bt.trialSucc(m_recBeforeLoci.size() - 1) ? 0 : 1);
 	curCp = forceFirstBegin == 0 ? 0 : (forceSecondBegin == 0 ? 1 : curCp);
 
 	if (m_debugOutput)
@@ -843,7 +994,7 @@ void Recombinator::transmitGenotype(const Individual & parent,
 
 	// the last one does not count, because it determines
 	// the initial copy of paternal chromosome
-	if (m_algorithm != 2)
+	if (m_algorithm < 2)
 		bt.setTrialSucc(m_recBeforeLoci.size() - 1, false);
 
 	// algorithm one:
@@ -860,7 +1011,23 @@ void Recombinator::transmitGenotype(const Individual & parent,
 	int last_cp = curCp;
 	size_t to_next = 0;
 #endif
-	if (m_algorithm == 0) {
+#ifdef BINARYALLELE
+	// loci at which the copy is switched, genotypes are copied word by
+	// word after all of them are determined.
+	vectoru & breaks = breaksBuffer();
+	int firstCp = curCp;
+	int blendCp = curCp;
+#endif
+	if (m_algorithm == 3) {
+#ifndef BINARYALLELE
+		vectoru & breaks = breaksBuffer();
+		int firstCp = curCp;
+#endif
+		sampleBreaks(parent, breaks, curCp, forceFirstBegin, forceFirstEnd,
+			forceSecondBegin, forceSecondEnd);
+		copyWithBreaks(parent, offspring, ploidy, breaks, firstCp, ignoreBegin, ignoreEnd,
+			m_recBeforeLoci.back());
+	} else if (m_algorithm == 0) {
 		// negative means no conversion is pending.
 		ssize_t convCount = -1;
 		size_t gtEnd = m_recBeforeLoci.back();
@@ -876,6 +1043,11 @@ void Recombinator::transmitGenotype(const Individual & parent,
 					last_gt = gt;
 					to_next = min((cp[curCp] + gt).to_next(), (off + gt).to_next());
 				}
+#elif defined(BINARYALLELE)
+				if (curCp != blendCp) {
+					breaks.push_back(gt);
+					blendCp = curCp;
+				}
 #else
 				off[gt] = cp[curCp][gt];
 #endif
@@ -935,6 +1107,9 @@ void Recombinator::transmitGenotype(const Individual & parent,
 				++bl;
 			}
 		}
+#ifdef BINARYALLELE
+		copyWithBreaks(parent, offspring, ploidy, breaks, firstCp, ignoreBegin, ignoreEnd, gtEnd);
+#endif
 	} else if (m_algorithm == 1) {
 #ifndef BINARYALLELE
 		size_t gt = 0, gtEnd = 0;
@@ -1047,12 +1222,9 @@ void Recombinator::transmitGenotype(const Individual & parent,
 		if (pos != Bernullitrials_T::npos) {
 			// first piece
 			gtEnd = m_recBeforeLoci[pos];
-			copyGenotype(cp[curCp] + gt, off + gt, m_recBeforeLoci[pos] - gt);
-			// for binary module, this is not needed, but it is kept here anyway, in case some
-			// people would like to implement lineage feature for binary modules
-			LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + m_recBeforeLoci[pos], lineageOff + gt));
 			gt = gtEnd;
 			curCp = (curCp + 1) % 2;
+			breaks.push_back(gt);
 			if (m_debugOutput)
 				*m_debugOutput << ' ' << gt - 1;
 			if (withConversion &&
@@ -1066,23 +1238,19 @@ void Recombinator::transmitGenotype(const Individual & parent,
 				if (convCount > 0) {
 					convEnd = gt + convCount;
 					if (convEnd < gtEnd) {
-						copyGenotype(cp[curCp] + gt, off + gt, convCount);
-						// not used for binary module
-						LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + gt + convCount, lineageOff + gt));
 						gt = convEnd;
 						curCp = (curCp + 1) % 2;
+						breaks.push_back(gt);
 						if (m_debugOutput)
 							*m_debugOutput << ' ' << gt - 1;
 					}
 					// no pending conversion
 					convCount = -1;
 				}
-				// copy from the end of conversion to the next recombination point
-				copyGenotype(cp[curCp] + gt, off + gt, m_recBeforeLoci[pos] - gt);
-				// not used for binary module
-				LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + m_recBeforeLoci[pos], lineageOff + gt));
+				// switch copy at the next recombination point
 				gt = gtEnd;
 				curCp = (curCp + 1) % 2;
+				breaks.push_back(gt);
 				if (m_debugOutput)
 					*m_debugOutput << ' ' << gt - 1;
 				// conversion event for this recombination event
@@ -1096,22 +1264,18 @@ void Recombinator::transmitGenotype(const Individual & parent,
 			}
 		}
 		gtEnd = m_recBeforeLoci.back();
-		// copy the last piece
+		// conversion in the last piece
 		if (convCount > 0) {
 			convEnd = gt + convCount;
 			if (convEnd < gtEnd) {
-				copyGenotype(cp[curCp] + gt, off + gt, convCount);
-				// not used for binary module
-				LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + gt + convCount, lineageOff + gt));
 				gt = convEnd;
 				curCp = (curCp + 1) % 2;
+				breaks.push_back(gt);
 				if (m_debugOutput)
 					*m_debugOutput << ' ' << gt - 1;
 			}
 		}
-		copyGenotype(cp[curCp] + gt, off + gt, gtEnd - gt);
-		// not used for binary module
-		LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + gtEnd, lineageOff + gt));
+		blendGenotype(cp[0], cp[1], off, 0, gtEnd, breaks, firstCp);
 #endif
 	} else {
 #ifndef BINARYALLELE
@@ -1239,12 +1403,9 @@ void Recombinator::transmitGenotype(const Individual & parent,
 		if (pos != Bernullitrials_T::npos) {
 			// first piece
 			gtEnd = m_recBeforeLoci[pos];
-			copyGenotype(cp[curCp] + gt, off + gt, m_recBeforeLoci[pos] - gt);
-			// for binary module, this is not needed, but it is kept here anyway, in case some
-			// people would like to implement lineage feature for binary modules
-			LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + m_recBeforeLoci[pos], lineageOff + gt));
 			gt = gtEnd;
 			curCp = (curCp + 1) % 2;
+			breaks.push_back(gt);
 			if (m_debugOutput)
 				*m_debugOutput << ' ' << gt - 1;
 			if (withConversion &&
@@ -1264,23 +1425,19 @@ void Recombinator::transmitGenotype(const Individual & parent,
 				if (convCount > 0) {
 					convEnd = gt + convCount;
 					if (convEnd < gtEnd) {
-						copyGenotype(cp[curCp] + gt, off + gt, convCount);
-						// not used for binary module
-						LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + gt + convCount, lineageOff + gt));
 						gt = convEnd;
 						curCp = (curCp + 1) % 2;
+						breaks.push_back(gt);
 						if (m_debugOutput)
 							*m_debugOutput << ' ' << gt - 1;
 					}
 					// no pending conversion
 					convCount = -1;
 				}
-				// copy from the end of conversion to the next recombination point
-				copyGenotype(cp[curCp] + gt, off + gt, m_recBeforeLoci[pos] - gt);
-				// not used for binary module
-				LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + m_recBeforeLoci[pos], lineageOff + gt));
+				// switch copy at the next recombination point
 				gt = gtEnd;
 				curCp = (curCp + 1) % 2;
+				breaks.push_back(gt);
 				if (m_debugOutput)
 					*m_debugOutput << ' ' << gt - 1;
 				// conversion event for this recombination event
@@ -1294,22 +1451,18 @@ void Recombinator::transmitGenotype(const Individual & parent,
 			}
 		}
 		gtEnd = m_recBeforeLoci.back();
-		// copy the last piece
+		// conversion in the last piece
 		if (convCount > 0) {
 			convEnd = gt + convCount;
 			if (convEnd < gtEnd) {
-				copyGenotype(cp[curCp] + gt, off + gt, convCount);
-				// not used for binary module
-				LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + gt + convCount, lineageOff + gt));
 				gt = convEnd;
 				curCp = (curCp + 1) % 2;
+				breaks.push_back(gt);
 				if (m_debugOutput)
 					*m_debugOutput << ' ' << gt - 1;
 			}
 		}
-		copyGenotype(cp[curCp] + gt, off + gt, gtEnd - gt);
-		// not used for binary module
-		LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + gtEnd, lineageOff + gt));
+		blendGenotype(cp[0], cp[1], off, 0, gtEnd, breaks, firstCp);
 #endif
 	}
 
@@ -51,7 +51,8 @@ public:
 		const intList & reps = intList(), const subPopList & subPops = subPopList(),
 		const stringList & infoFields = vectorstr()) :
 		BaseOperator(output, begin, end, step, at, reps, subPops, infoFields),
-		m_lastGenoStru(MaxTraitIndex), m_ploidy(0), m_hasCustomizedChroms(false), m_lociToCopy(0), m_chromIdx(0)
+		m_lastGenoStru(MaxTraitIndex), m_ploidy(0), m_hasCustomizedChroms(false), m_lociToCopy(0), m_chromIdx(0),
+		m_breaks(numThreads())
 	{
 	}
 
@@ -131,6 +132,13 @@ protected:
 	mutable bool m_hasCustomizedChroms;
 	mutable vectoru m_lociToCopy;
 	mutable vectoru m_chromIdx;
+
+	/// CPPONLY return an empty buffer of the calling thread to collect
+	/// loci at which copies of parental chromosomes are switched.
+	vectoru & breaksBuffer() const;
+
+private:
+	mutable vector<vectoru> m_breaks;
 };
 
 
@@ -554,6 +562,16 @@ public:
 	 *  Review Genetics, 2007). This translate to 0.1/0.9~0.1 to 15/16~0.94 of
 	 *  the gene conversion probability.
 	 *
+	 *  By default, a \c Recombinator draws a random number for each interval
+	 *  between adjacent loci. If \e sparse is set to \c True, it draws the
+	 *  locations of crossovers directly, using exponentially distributed gaps
+	 *  along the cumulative genetic map, so that the cost of transmitting a
+	 *  chromosome is proportional to the number of crossovers instead of the
+	 *  number of loci. The crossovers follow the same distribution but a
+	 *  different sequence of random numbers is used. This option is
+	 *  recommended for long chromosomes with dense markers and low
+	 *  recombination rates between them.
+	 *
 	 *  A \c Recombinator usually does not send any output. However, if an
 	 *  information field is given (parameter \e infoFields), this operator
 	 *  will treat this information field as an unique ID of parents and
@@ -587,7 +605,7 @@ public:
 		const stringFunc & output = "", int begin = 0, int end = -1, int step = 1,
 		const intList & at = vectori(),
 		const intList & reps = intList(), const subPopList & subPops = subPopList(),
-		const stringList & infoFields = vectorstr());
+		const stringList & infoFields = vectorstr(), bool sparse = false);
 
 
 	/// HIDDEN Deep copy of a Recombinator
@@ -638,6 +656,17 @@ private:
 	/// determine number of markers to convert
 	size_t markersConverted(size_t index, const Individual & ind) const;
 
+	/// find loci at which the copy is switched, by drawing crossovers from
+	/// the cumulative map.
+	void sampleBreaks(const Individual & parent, vectoru & breaks, int curCp,
+		int forceFirstBegin, int forceFirstEnd,
+		int forceSecondBegin, int forceSecondEnd) const;
+
+	/// copy loci before gtEnd, switching copies at \e breaks, but skip the
+	/// ignored region and customized chromosomes.
+	void copyWithBreaks(const Individual & parent, Individual & offspring, int ploidy,
+		const vectoru & breaks, int firstCp, int ignoreBegin, int ignoreEnd, size_t gtEnd) const;
+
 private:
 	/// intensity
 	const double m_intensity;
@@ -653,6 +682,12 @@ private:
 
 	const vectorf m_convMode;
 
+	/// draw crossovers directly from the cumulative map
+	const bool m_sparse;
+
+	/// cumulative -log(1-p) at m_recBeforeLoci, used by the sparse algorithm
+	mutable vectorf m_cumHazard;
+
 	// locataion of special chromosomes
 	mutable int m_chromX;
 	mutable int m_chromY;
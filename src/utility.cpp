@@ -119,8 +119,12 @@ using boost::cmatch;
 
 extern "C" PyObject * newcarrayobject(GenoIterator begin, GenoIterator end);
 
+extern "C" void setcarrayshape(PyObject * op, int ndim, const Py_ssize_t * shape);
+
 extern "C" PyObject * newcarrayobject_lineage(LineageIterator begin, LineageIterator end);
 
+extern "C" void setcarrayshape_lineage(PyObject * op, int ndim, const Py_ssize_t * shape);
+
 extern "C" PyObject * PyDefDict_New();
 
 extern "C" bool is_defdict(PyTypeObject * type);
@@ -426,6 +430,19 @@ RNG * g_RNG;
 RNG g_RNG;
 #endif
 
+// random number generator that overrides g_RNG for the current thread,
+// set by setThreadRNG.
+#ifdef _OPENMP
+#  if THREADPRIVATE_SUPPORT == 0
+vector<RNG *> g_threadRNGs;
+#  else
+RNG * g_threadRNG = NULL;
+#    pragma omp threadprivate(g_threadRNG)
+#  endif
+#else
+RNG * g_threadRNG = NULL;
+#endif
+
 void setOptions(const int numThreads, const char * name, unsigned long seed)
 {
 #ifdef _OPENMP
@@ -438,6 +455,7 @@ void setOptions(const int numThreads, const char * name, unsigned long seed)
 	}
 #  if THREADPRIVATE_SUPPORT == 0
 	g_RNGs.resize(g_numThreads);
+	g_threadRNGs.resize(g_numThreads, NULL);
 	if (seed == 0)
 		seed = g_RNGs[0] == NULL ? RNG::generateRandomSeed() : g_RNGs[0]->seed();
 	for (unsigned long i = 0; i < g_RNGs.size(); i++) {
@@ -496,21 +514,93 @@ ATOMICLONG fetchAndIncrement(ATOMICLONG * val)
 }
 
 
+ATOMICLONG fetchAndAdd(ATOMICLONG * val, ATOMICLONG num)
+{
+	if (g_numThreads == 1) {
+		ATOMICLONG old = *val;
+		*val += num;
+		return old;
+	} else
+#ifdef _WIN64
+		return InterlockedExchangeAdd64(val, num);
+#elif defined(_WIN32)
+		return InterlockedExchangeAdd(val, num);
+#else
+		return __sync_fetch_and_add(val, num);
+#endif
+}
+
+
+#if defined(_OPENMP) && THREADPRIVATE_SUPPORT == 0
+// Index of the calling thread in g_RNGs and g_threadRNGs, which is its number
+// in the innermost parallel region that is run by more than one thread, so
+// that a thread that runs a nested parallel region alone keeps its random
+// number generator instead of using the one of the first thread.
+static int threadRNGIndex()
+{
+#  if _OPENMP >= 200805
+	int level = omp_get_level();
+	while (level > 1 && omp_get_team_size(level) == 1)
+		--level;
+	return level == 0 ? 0 : omp_get_ancestor_thread_num(level);
+#  else
+	return omp_get_thread_num();
+#  endif
+}
+
+
+#endif
+
 // return the global RNG
 RNG & getRNG()
 {
 #ifdef _OPENMP
 #  if THREADPRIVATE_SUPPORT == 0
-	return *g_RNGs[omp_get_thread_num()];
+	int idx = threadRNGIndex();
+	RNG * rng = g_threadRNGs[idx];
+	return rng != NULL ? *rng : *g_RNGs[idx];
 #  else
-	return *g_RNG;
+	return g_threadRNG != NULL ? *g_threadRNG : *g_RNG;
 #  endif
 #else
-	return g_RNG;
+	return g_threadRNG != NULL ? *g_threadRNG : g_RNG;
 #endif
 }
 
 
+RNG * setThreadRNG(RNG * rng)
+{
+#if defined(_OPENMP) && THREADPRIVATE_SUPPORT == 0
+	int idx = threadRNGIndex();
+	RNG * old = g_threadRNGs[idx];
+	g_threadRNGs[idx] = rng;
+#else
+	RNG * old = g_threadRNG;
+	g_threadRNG = rng;
+#endif
+	return old;
+}
+
+
+RNGStream::RNGStream(const RNG & rng, RNGStreamType type, size_t rep, size_t call)
+	: m_RNG(NULL), m_savedRNG(NULL), m_type(type), m_rep(rep), m_call(call)
+{
+	if (rng.counterBased()) {
+		m_RNG = new RNG(rng.name(), rng.seed());
+		m_savedRNG = setThreadRNG(m_RNG);
+	}
+}
+
+
+RNGStream::~RNGStream()
+{
+	if (m_RNG != NULL) {
+		setThreadRNG(m_savedRNG);
+		delete m_RNG;
+	}
+}
+
+
 }
 
 namespace std {
@@ -1248,6 +1338,7 @@ const vectoru & lociList::elems(const Population * trait) const
 			if (m_func_gen == trait->gen())
 				return m_elems;
 
+			GILGuard gil(true);
 			PyObject * args = PyTuple_New(m_func.numArgs());
 			DBG_ASSERT(args, RuntimeError, "Failed to create a parameter tuple");
 
@@ -1465,20 +1556,28 @@ void PyObj_As_SizeTArray(PyObject * obj, vectoru & val)
 }
 
 
-PyObject * Allele_Vec_As_NumArray(GenoIterator begin, GenoIterator end)
+PyObject * Allele_Vec_As_NumArray(GenoIterator begin, GenoIterator end, const vectoru & shape)
 {
 	PyObject * res = newcarrayobject(begin, end);
 
 	DBG_FAILIF(res == NULL, ValueError, "Can not convert buf to Allele num array");
+	if (!shape.empty()) {
+		vector<Py_ssize_t> dims(shape.begin(), shape.end());
+		setcarrayshape(res, static_cast<int>(dims.size()), &dims[0]);
+	}
 	return res;
 }
 
 
-PyObject * Lineage_Vec_As_NumArray(LineageIterator begin, LineageIterator end)
+PyObject * Lineage_Vec_As_NumArray(LineageIterator begin, LineageIterator end, const vectoru & shape)
 {
 	PyObject * res = newcarrayobject_lineage(begin, end);
 
 	DBG_FAILIF(res == NULL, ValueError, "Can not convert buf to Lineage num array");
+	if (!shape.empty()) {
+		vector<Py_ssize_t> dims(shape.begin(), shape.end());
+		setcarrayshape_lineage(res, static_cast<int>(dims.size()), &dims[0]);
+	}
 	return res;
 }
 
@@ -1531,9 +1630,51 @@ SharedVariables::~SharedVariables()
 }
 
 
+#ifdef _OPENMP
+// held by exclusive GILGuards
+omp_nest_lock_t g_pythonLock;
+#endif
+
+// set while replicates are evolved in parallel without the GIL
+static bool g_gilGuardEnabled = false;
+
+GILGuard::GILGuard(bool exclusive) : m_enabled(g_gilGuardEnabled), m_exclusive(exclusive)
+{
+	if (!m_enabled)
+		return;
+	// wait for the lock before the GIL because a thread that holds the
+	// lock can release and acquire the GIL while it executes Python code
+#ifdef _OPENMP
+	if (m_exclusive)
+		omp_set_nest_lock(&g_pythonLock);
+#endif
+	m_state = PyGILState_Ensure();
+}
+
+
+GILGuard::~GILGuard()
+{
+	if (!m_enabled)
+		return;
+	PyGILState_Release(m_state);
+#ifdef _OPENMP
+	if (m_exclusive)
+		omp_unset_nest_lock(&g_pythonLock);
+#endif
+}
+
+
+void GILGuard::setEnabled(bool enabled)
+{
+	g_gilGuardEnabled = enabled;
+}
+
+
 // setvars C++ ==> Python
 PyObject * SharedVariables::setVar(const string & name, const PyObject * val)
 {
+	GILGuard gil;
+
 	// find the first piece
 	size_t i, s;
 
@@ -1700,6 +1841,8 @@ next:
 
 PyObject * SharedVariables::getVar(const string & name, bool nameError) const
 {
+	GILGuard gil;
+
 	DBG_ASSERT(m_dict != NULL, ValueError,
 		"Shared variables are not associated with any Python variable. You populaiton might not be part of a simulator.");
 
@@ -1806,6 +1949,8 @@ next:
 
 void SharedVariables::removeVar(const string & name)
 {
+	GILGuard gil;
+
 	DBG_ASSERT(m_dict != NULL, ValueError,
 		"Shared variables are not associated with any Python variable. You populaiton might not be part of a simulator.");
 
@@ -1914,6 +2059,8 @@ next:
 
 PyObject * SharedVariables::setVar(const string & name, const bool val)
 {
+	GILGuard gil;
+
 	PyObject * obj = val ? Py_True : Py_False;
 
 	Py_INCREF(obj);
@@ -1923,30 +2070,40 @@ PyObject * SharedVariables::setVar(const string & name, const bool val)
 
 PyObject * SharedVariables::setVar(const string & name, const long val)
 {
+	GILGuard gil;
+
 	return setVar(name, PyInt_FromLong(val));
 }
 
 
 PyObject * SharedVariables::setVar(const string & name, const size_t val)
 {
+	GILGuard gil;
+
 	return setVar(name, PyInt_FromSize_t(val));
 }
 
 
 PyObject * SharedVariables::setVar(const string & name, const double val)
 {
+	GILGuard gil;
+
 	return setVar(name, PyFloat_FromDouble(val));
 }
 
 
 PyObject * SharedVariables::setVar(const string & name, const string & val)
 {
+	GILGuard gil;
+
 	return setVar(name, Py_BuildValue("s", val.c_str()));
 }
 
 
 PyObject * SharedVariables::setVar(const string & name, const vectori & val)
 {
+	GILGuard gil;
+
 	PyObject * obj = PyList_New(0);
 	PyObject * item;
 
@@ -1962,6 +2119,8 @@ PyObject * SharedVariables::setVar(const string & name, const vectori & val)
 
 PyObject * SharedVariables::setVar(const string & name, const vectoru & val)
 {
+	GILGuard gil;
+
 	PyObject * obj = PyList_New(0);
 	PyObject * item;
 
@@ -1978,6 +2137,8 @@ PyObject * SharedVariables::setVar(const string & name, const vectoru & val)
 //CPPONLY
 PyObject * SharedVariables::setVar(const string & name, const vectorf & val)
 {
+	GILGuard gil;
+
 	PyObject * obj = PyList_New(0);
 	PyObject * item;
 
@@ -1991,8 +2152,67 @@ PyObject * SharedVariables::setVar(const string & name, const vectorf & val)
 }
 
 
+PyObject * SharedVariables::setVar(const string & name, const matrixf & val)
+{
+	GILGuard gil;
+
+	PyObject * obj = PyList_New(0);
+	PyObject * row;
+	PyObject * item;
+
+	for (matrixf::const_iterator it = val.begin();
+	     it < val.end(); ++it) {
+		row = PyList_New(0);
+		for (vectorf::const_iterator v = it->begin(); v < it->end(); ++v) {
+			item = PyFloat_FromDouble(*v);
+			PyList_Append(row, item);
+			Py_XDECREF(item);
+		}
+		PyList_Append(obj, row);
+		Py_XDECREF(row);
+	}
+	return setVar(name, obj);
+}
+
+
+PyObject * SharedVariables::setMatrixVar(const string & name, matrixf & val)
+{
+	GILGuard gil;
+
+	PyObject * arrayModule = PyImport_ImportModule("array");
+	if (arrayModule == NULL)
+		throw RuntimeError("Failed to import module array to store a matrix.");
+	PyObject * arrayType = PyObject_GetAttrString(arrayModule, "array");
+	Py_DECREF(arrayModule);
+	if (arrayType == NULL)
+		throw RuntimeError("Failed to import module array to store a matrix.");
+
+	PyObject * obj = PyList_New(val.size());
+	for (size_t i = 0; i < val.size(); ++i) {
+		// array.array('d', bytes) copies the bytes as doubles
+		PyObject * bytes = PyBytes_FromStringAndSize(val[i].empty() ? NULL :
+		                                             reinterpret_cast<const char *>(&val[i][0]),
+		                                             val[i].size() * sizeof(double));
+		PyObject * row = bytes == NULL ? NULL : PyObject_CallFunction(arrayType, const_cast<char *>("sO"), "d", bytes);
+		Py_XDECREF(bytes);
+		if (row == NULL) {
+			Py_DECREF(obj);
+			Py_DECREF(arrayType);
+			throw RuntimeError("Failed to store a matrix.");
+		}
+		// PyList_SET_ITEM steals the reference to row
+		PyList_SET_ITEM(obj, i, row);
+		vectorf().swap(val[i]);
+	}
+	Py_DECREF(arrayType);
+	return setVar(name, obj);
+}
+
+
 PyObject * SharedVariables::setVar(const string & name, const strDict & val)
 {
+	GILGuard gil;
+
 	PyObject * obj = PyDict_New();
 	PyObject * v;
 
@@ -2011,6 +2231,8 @@ PyObject * SharedVariables::setVar(const string & name, const strDict & val)
 
 PyObject * SharedVariables::setVar(const string & name, const intDict & val)
 {
+	GILGuard gil;
+
 	PyObject * obj = PyDefDict_New();
 	PyObject * u, * v;
 
@@ -2028,6 +2250,8 @@ PyObject * SharedVariables::setVar(const string & name, const intDict & val)
 
 void SharedVariables::getVarAsIntDict(const string & name, uintDict & res, bool nameError) const
 {
+	GILGuard gil;
+
 	res.clear();
 	PyObject * obj = getVar(name, nameError);
 
@@ -2044,6 +2268,8 @@ void SharedVariables::getVarAsIntDict(const string & name, uintDict & res, bool
 
 void SharedVariables::getVectorVarAsIntDict(const string & name, uintDict & res, bool nameError) const
 {
+	GILGuard gil;
+
 	res.clear();
 	PyObject * obj = getVar(name, nameError);
 
@@ -2059,6 +2285,8 @@ void SharedVariables::getVectorVarAsIntDict(const string & name, uintDict & res,
 
 PyObject * SharedVariables::setVar(const string & name, const uintDict & val)
 {
+	GILGuard gil;
+
 	PyObject * obj = PyDefDict_New();
 	PyObject * u, * v;
 
@@ -2075,6 +2303,8 @@ PyObject * SharedVariables::setVar(const string & name, const uintDict & val)
 
 PyObject * SharedVariables::setVar(const string & name, const tupleDict & val)
 {
+	GILGuard gil;
+
 	PyObject * obj = PyDefDict_New();
 	PyObject * u, * v;
 
@@ -3272,6 +3502,100 @@ void closeOutput(const string & output)
 }
 
 
+// A counter-based random number generator (Philox4x32-10, Salmon et al.
+// 2011, "Parallel random numbers: as easy as 1, 2, 3") that encrypts a
+// 128-bit counter with a 64-bit key. The key is derived from the seed, the
+// type of operation, replicate and call of the operation, and the counter
+// from generation, subpopulation and offspring index, so that any stream
+// can be reached in constant time.
+typedef struct
+{
+	uint32_t seedKey[2];
+	uint32_t key[2];
+	uint32_t ctr[4];
+	uint32_t out[4];
+	unsigned int idx;
+	// stream, replicate and call used to derive key
+	size_t stream;
+	size_t rep;
+	size_t call;
+} philox4x32_state_t;
+
+
+static void philox4x32_10(const uint32_t * ctr, const uint32_t * key, uint32_t * out)
+{
+	uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+	uint32_t k0 = key[0], k1 = key[1];
+
+	for (int round = 0; round < 10; ++round) {
+		if (round > 0) {
+			k0 += 0x9E3779B9U;
+			k1 += 0xBB67AE85U;
+		}
+		uint64_t p0 = static_cast<uint64_t>(0xD2511F53U) * c0;
+		uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57U) * c2;
+		uint32_t hi0 = static_cast<uint32_t>(p0 >> 32);
+		uint32_t hi1 = static_cast<uint32_t>(p1 >> 32);
+		c0 = hi1 ^ c1 ^ k0;
+		c1 = static_cast<uint32_t>(p1);
+		c2 = hi0 ^ c3 ^ k1;
+		c3 = static_cast<uint32_t>(p0);
+	}
+	out[0] = c0;
+	out[1] = c1;
+	out[2] = c2;
+	out[3] = c3;
+}
+
+
+static void philox4x32_set(void * vstate, unsigned long int seed)
+{
+	philox4x32_state_t * state = static_cast<philox4x32_state_t *>(vstate);
+	uint64_t s = seed;
+
+	state->seedKey[0] = static_cast<uint32_t>(s);
+	state->seedKey[1] = static_cast<uint32_t>(s >> 32);
+	state->key[0] = state->seedKey[0];
+	state->key[1] = state->seedKey[1];
+	state->ctr[0] = state->ctr[1] = state->ctr[2] = state->ctr[3] = 0;
+	state->idx = 4;
+	state->stream = 0;
+	state->rep = 0;
+	state->call = 0;
+}
+
+
+static unsigned long int philox4x32_get(void * vstate)
+{
+	philox4x32_state_t * state = static_cast<philox4x32_state_t *>(vstate);
+
+	if (state->idx == 4) {
+		philox4x32_10(state->ctr, state->key, state->out);
+		// increase the 128-bit counter
+		for (int i = 3; i >= 0 && ++state->ctr[i] == 0; --i) ;
+		state->idx = 0;
+	}
+	return state->out[state->idx++];
+}
+
+
+static double philox4x32_get_double(void * vstate)
+{
+	return philox4x32_get(vstate) / 4294967296.0;
+}
+
+
+static const gsl_rng_type philox4x32_type = {
+	"philox4x32",
+	0xffffffffUL,
+	0,
+	sizeof(philox4x32_state_t),
+	&philox4x32_set,
+	&philox4x32_get,
+	&philox4x32_get_double
+};
+
+
 // Random number generator
 RNG::RNG(const char * rng, unsigned long seed) : m_RNG(NULL)
 {
@@ -3395,7 +3719,11 @@ void RNG::set(const char * rng, unsigned long seed)
 		rng_name = getenv("GSL_RNG_TYPE");
 
 	// if a name is given ..... replace the existing RNG
-	if (rng_name != NULL && rng_name[0] != '\0') {
+	if (rng_name != NULL && strcmp(rng_name, philox4x32_type.name) == 0) {
+		if (m_RNG != NULL)
+			gsl_rng_free(m_RNG);
+		m_RNG = gsl_rng_alloc(&philox4x32_type);
+	} else if (rng_name != NULL && rng_name[0] != '\0') {
 		// locate the RNG
 		const gsl_rng_type ** t, ** t0 = gsl_rng_types_setup();
 
@@ -3436,6 +3764,50 @@ void RNG::set(const char * rng, unsigned long seed)
 	gsl_rng_set(m_RNG, m_seed);
 	m_bitByte = 0;
 	m_bitIndex = 0;
+	m_streamID = 0;
+	m_streamCalls = 0;
+}
+
+
+bool RNG::counterBased() const
+{
+	return m_RNG->type == &philox4x32_type;
+}
+
+
+void RNG::setStream(size_t stream, size_t rep, size_t call, size_t gen, size_t subPop, size_t index)
+{
+	DBG_FAILIF(!counterBased(), RuntimeError,
+		"Random number streams can only be set for a counter-based random number generator.");
+
+	philox4x32_state_t * state = static_cast<philox4x32_state_t *>(m_RNG->state);
+	// derive a key from seed, stream, replicate and call, which is cached
+	// because a thread usually moves among streams of the same call.
+	if (state->stream != stream || state->rep != rep || state->call != call) {
+		uint32_t ctr[4] = {
+			static_cast<uint32_t>(stream), static_cast<uint32_t>(rep),
+			static_cast<uint32_t>(static_cast<uint64_t>(rep) >> 32), static_cast<uint32_t>(call)
+		};
+		uint32_t out[4];
+		philox4x32_10(ctr, state->seedKey, out);
+		state->key[0] = out[0];
+		state->key[1] = out[1];
+		state->stream = stream;
+		state->rep = rep;
+		state->call = call;
+	}
+	state->ctr[0] = static_cast<uint32_t>(gen);
+	state->ctr[1] = static_cast<uint32_t>(subPop);
+	state->ctr[2] = static_cast<uint32_t>(index);
+	state->ctr[3] = 0;
+	state->idx = 4;
+	m_bitByte = 0;
+	m_bitIndex = 0;
+	// a stream ID that is unique with high probability
+	uint64_t id = ((static_cast<uint64_t>(state->key[0]) << 32) | state->key[1]) * 0x9E3779B97F4A7C15ULL;
+	id ^= (static_cast<uint64_t>(gen) << 32 | static_cast<uint32_t>(subPop)) * 0xBF58476D1CE4E5B9ULL;
+	id ^= static_cast<uint64_t>(index) * 0x94D049BB133111EBULL;
+	m_streamID = static_cast<ULONG>(id) | 1;
 }
 
 
@@ -3880,16 +4252,101 @@ size_t WeightedSampler::draw()
 }
 
 
+void WeightedSampler::draw(size_t * samples, size_t n)
+{
+	if (m_algorithm != 3) {
+		for (size_t i = 0; i < n; ++i)
+			samples[i] = draw();
+		return;
+	}
+	RNG & rng = getRNG();
+	const double * q = &m_q[0];
+	const size_t * a = &m_a[0];
+	for (size_t i = 0; i < n; ++i) {
+		double rN = rng.randUniform() * m_N;
+		size_t K = static_cast<size_t>(rN);
+		samples[i] = rN - K < q[K] ? K : a[K];
+	}
+}
+
+
 vectoru WeightedSampler::drawSamples(ULONG num)
 {
 	vectoru res(num);
 
-	for (size_t i = 0; i < num; ++i)
-		res[i] = draw();
+	if (num > 0)
+		draw(&res[0], num);
 	return res;
 }
 
 
+// weights are summed in blocks of this size so that the alias table does
+// not depend on the number of threads
+#define ALIAS_BLOCK_SIZE 4096
+
+void WeightedSampler::buildAliasTable()
+{
+	long numBlocks = static_cast<long>((m_N + ALIAS_BLOCK_SIZE - 1) / ALIAS_BLOCK_SIZE);
+	vectorf blockSum(numBlocks, 0.);
+
+#pragma omp parallel for if(numThreads() > 1 && numBlocks > 1)
+	for (long b = 0; b < numBlocks; ++b) {
+		size_t last = std::min((b + 1) * static_cast<size_t>(ALIAS_BLOCK_SIZE), m_N);
+		for (size_t i = b * ALIAS_BLOCK_SIZE; i < last; ++i)
+			blockSum[b] += m_q[i];
+	}
+	// sum of weight
+	double w = accumulate(blockSum.begin(), blockSum.end(), 0.0);
+
+	DBG_FAILIF(fcmp_le(w, 0), ValueError, "Sum of weight is <= 0.");
+
+	w = m_N / w;
+
+	// initialize q with N*p0,...N*p_k-1, and Y with values
+	m_a.resize(m_N);
+#pragma omp parallel for if(numThreads() > 1 && numBlocks > 1)
+	for (long i = 0; i < static_cast<long>(m_N); ++i) {
+		m_q[i] *= w;
+		m_a[i] = i;
+	}
+
+	// Pair small (q <= 1) and large (q > 1) items in one sweep through the
+	// table instead of keeping stacks of them. Small item i takes the rest
+	// of its slot from the current large item j. When j becomes small, it
+	// takes the rest of its slot from the next large item. Small items that
+	// have been paired have a[i] != i so they are skipped by the sweep.
+	size_t j = 0;
+	while (j < m_N && m_q[j] <= 1)
+		++j;
+	if (j == m_N)
+		return;
+	size_t i = 0;
+	while (i < m_N && m_q[i] > 1)
+		++i;
+	double r = m_q[j];
+	while (i < m_N) {
+		m_a[i] = j;
+		r -= 1 - m_q[i];
+		do
+			++i;
+		while (i < m_N && (m_q[i] > 1 || m_a[i] != i));
+		while (r <= 1) {
+			m_q[j] = r;
+			size_t k = j + 1;
+			while (k < m_N && m_q[k] <= 1)
+				++k;
+			// no large item left because of rounding errors
+			if (k == m_N)
+				return;
+			m_a[j] = k;
+			r = m_q[k] - (1 - r);
+			j = k;
+		}
+	}
+	m_q[j] = r;
+}
+
+
 // this is used for Bernullitrials and copyGenotype
 WORDTYPE g_bitMask[WORDBIT];
 
@@ -4210,13 +4667,13 @@ double Bernullitrials::probSuccRate() const
 // ###############################################
 
 Bernullitrials_T::Bernullitrials_T(RNG & /* rng */)
-	: m_N(1024), m_prob(0), m_table(0), m_pointer(0), m_cur(npos)
+	: m_N(1024), m_prob(0), m_table(0), m_pointer(0), m_cur(npos), m_streamID(0)
 {
 }
 
 
 Bernullitrials_T::Bernullitrials_T(RNG & /* rng */, const vectorf & prob, size_t N)
-	: m_N(N), m_prob(prob), m_table(N), m_pointer(N), m_cur(npos)
+	: m_N(N), m_prob(prob), m_table(N), m_pointer(N), m_cur(npos), m_streamID(0)
 {
 	//DBG_FAILIF(trials_T <= 0, ValueError, "trial number can not be zero.");
 	DBG_FAILIF(prob.empty(), ValueError, "probability table can not be empty.");
@@ -4301,13 +4758,14 @@ void Bernullitrials_T::doTrial()
 		}
 	}
 	m_cur = 0;
+	m_streamID = getRNG().streamID();
 }
 
 
 // get a trial corresponding to m_prob.
 void Bernullitrials_T::trial()
 {
-	if (m_cur == npos || m_cur == m_N - 1)  // reach the last trial
+	if (m_cur == npos || m_cur == m_N - 1 || m_streamID != getRNG().streamID())  // reach the last trial
 		doTrial();
 	else
 		m_cur++;
@@ -4454,6 +4912,9 @@ public:
 protected:
 	int overflow(int c)
 	{
+		// output can be written by replicates evolved in parallel
+		GILGuard gil;
+
 		// write out current buffer
 		if (pbase() != pptr()) {
 			// the end of string might not be \0
@@ -4678,6 +5139,7 @@ PyObject * moduleInfo()
 			PyList_Append(rngs, PyString_FromString((*t)->name));
 		gsl_rng_free(rng);
 	}
+	PyList_Append(rngs, PyString_FromString(philox4x32_type.name));
 	PyDict_SetItem(dict, PyString_FromString("availableRNGs"), rngs);
 	Py_DECREF(rngs);
 
@@ -4913,6 +5375,105 @@ void clearGenotype(GenoIterator to, size_t n)
 }
 
 
+// Return WORDBIT bits starting at bit off of p, of which only the lowest
+// n (<= WORDBIT) are used. The word after the one that contains bit off
+// is read only if some of the n bits live there so that the function
+// never reads beyond the end of the genotype storage.
+static inline WORDTYPE fetchBits(const WORDTYPE * p, size_t off, size_t n)
+{
+	p += off / WORDBIT;
+	off %= WORDBIT;
+	if (off == 0)
+		return *p;
+	WORDTYPE w = *p >> off;
+	if (off + n > WORDBIT)
+		w |= *(p + 1) << (WORDBIT - off);
+	return w;
+}
+
+
+void blendGenotype(GenoIterator cp0, GenoIterator cp1, GenoIterator to,
+                   size_t begin, size_t end, const vectoru & breaks, int firstCopy)
+{
+	if (begin >= end)
+		return;
+
+	const WORDTYPE * p0 = BITPTR(cp0);
+	const WORDTYPE * p1 = BITPTR(cp1);
+	size_t off0 = BITOFF(cp0) + begin;
+	size_t off1 = BITOFF(cp1) + begin;
+	size_t to_off = BITOFF(to) + begin;
+	WORDTYPE * to_p = const_cast<WORDTYPE *>(BITPTR(to)) + to_off / WORDBIT;
+
+	to_off %= WORDBIT;
+
+	// copy at locus begin
+	int cur = firstCopy;
+	vectoru::const_iterator br = breaks.begin();
+	vectoru::const_iterator brEnd = breaks.end();
+	for (; br != brEnd && *br <= begin; ++br)
+		cur ^= 1;
+
+	size_t pos = begin;
+	while (pos < end) {
+		// whole words that come from a single copy are copied in a tight
+		// loop that the compiler can unroll and vectorize.
+		if (to_off == 0) {
+			size_t next = br == brEnd ? end : std::min(static_cast<size_t>(*br), end);
+			size_t nWords = (next - pos) / WORDBIT;
+			if (nWords > 1) {
+				const WORDTYPE * fr = cur ? p1 : p0;
+				size_t & fr_off = cur ? off1 : off0;
+				fr += fr_off / WORDBIT;
+				size_t shift = fr_off % WORDBIT;
+				// the last word is left to the general code below to avoid
+				// reading beyond the end of the source
+				--nWords;
+				if (shift == 0) {
+					for (size_t i = 0; i < nWords; ++i)
+						to_p[i] = fr[i];
+				} else {
+					for (size_t i = 0; i < nWords; ++i)
+						to_p[i] = (fr[i] >> shift) | (fr[i + 1] << (WORDBIT - shift));
+				}
+				to_p += nWords;
+				pos += nWords * WORDBIT;
+				off0 += nWords * WORDBIT;
+				off1 += nWords * WORDBIT;
+			}
+		}
+		// number of bits to write to the current word
+		size_t n = std::min(WORDBIT - to_off, end - pos);
+		WORDTYPE valid = n == WORDBIT ? ~WORDTYPE(0) : g_bitMask[n];
+		// bits that should be taken from the second copy
+		WORDTYPE mask = cur ? ~WORDTYPE(0) : WORDTYPE(0);
+		for (; br != brEnd && *br < pos + n; ++br) {
+			mask ^= ~WORDTYPE(0) << (*br - pos);
+			cur ^= 1;
+		}
+		mask &= valid;
+		WORDTYPE w;
+		if (mask == 0)
+			w = fetchBits(p0, off0, n);
+		else if (mask == valid)
+			w = fetchBits(p1, off1, n);
+		else
+			w = (fetchBits(p0, off0, n) & ~mask) | (fetchBits(p1, off1, n) & mask);
+		if (n == WORDBIT)
+			*to_p = w;
+		else {
+			WORDTYPE dest = valid << to_off;
+			*to_p = (*to_p & ~dest) | ((w << to_off) & dest);
+		}
+		++to_p;
+		to_off = 0;
+		pos += n;
+		off0 += n;
+		off1 += n;
+	}
+}
+
+
 #endif
 
 #ifdef MUTANTALLELE
@@ -4938,6 +5499,9 @@ void clearGenotype(GenoIterator begin, GenoIterator end)
 bool initialize(PyObject * module)
 {
 	setOptions(1);
+#ifdef _OPENMP
+	omp_init_nest_lock(&g_pythonLock);
+#endif
 	// tie python stdout to cerr
 	std::cout.rdbuf(&g_pythonStdoutBuf);
 	std::cerr.rdbuf(&g_pythonStderrBuf);
@@ -5000,6 +5564,7 @@ bool initialize(PyObject * module)
 	// binary level genotype copy is compiler dependent and may
 	// fail on some systems. Such a test will make sure the binary
 	testCopyGenotype();
+	testBlendGenotype();
 #  endif
 #endif
 	return true;
@@ -5081,6 +5646,47 @@ void testCopyGenotype()
 }
 
 
+void testBlendGenotype()
+{
+	vectora cp0(1000);
+	vectora cp1(1000);
+	vectora to(1000);
+
+	for (size_t i = 0; i < 100; ++i) {
+		for (size_t j = 0; j < 1000; ++j) {
+			cp0[j] = getRNG().randInt(2) != 0;
+			cp1[j] = getRNG().randInt(2) != 0;
+			to[j] = getRNG().randInt(2) != 0;
+		}
+		size_t begin = getRNG().randInt(300);
+		size_t end = begin + getRNG().randInt(700);
+		vectoru breaks;
+		// mix long runs with dense breaks
+		size_t pos = getRNG().randInt(200);
+		while (pos < 1000) {
+			breaks.push_back(pos);
+			pos += 1 + getRNG().randInt(i % 2 ? 10 : 300);
+		}
+		int firstCopy = static_cast<int>(getRNG().randInt(2));
+		vectora expected(to);
+		int cur = firstCopy;
+		vectoru::const_iterator br = breaks.begin();
+		for (size_t j = 0; j < end; ++j) {
+			for (; br != breaks.end() && *br <= j; ++br)
+				cur ^= 1;
+			if (j >= begin)
+				expected[j] = cur ? cp1[j] : cp0[j];
+		}
+		blendGenotype(cp0.begin(), cp1.begin(), to.begin(), begin, end, breaks, firstCopy);
+		if (to != expected) {
+			cerr << "Blending loci " << begin << " to " << end << " with " << breaks.size() << " breaks" << endl;
+			throw SystemError("Allele blending test for your system fails.\n"
+				              "Please email simuPOP mailing list with detailed os and compiler information");
+		}
+	}
+}
+
+
 #  endif
 #endif
 
@@ -163,6 +163,9 @@ UINT numThreads();
 /// CPPONLY return val and increase val by 1, ensuring thread safety
 ATOMICLONG fetchAndIncrement(ATOMICLONG * val);
 
+/// CPPONLY atomically add \e num to \e val and return its previous value
+ATOMICLONG fetchAndAdd(ATOMICLONG * val, ATOMICLONG num);
+
 /// CPPONLY parallel sort by using tbb or gnu parallel
 template<class T1, class T2>
 void parallelSort(T1 start, T1 end, T2 cmp)
@@ -184,6 +187,20 @@ void parallelSort(T1 start, T1 end, T2 cmp)
 }
 
 
+/// CPPONLY number of set bits in a word
+inline size_t countBits(WORDTYPE word)
+{
+#if defined(__GNUC__)
+	return __builtin_popcountl(word);
+#else
+	size_t cnt = 0;
+	for (; word; word &= word - 1)
+		++cnt;
+	return cnt;
+#endif
+}
+
+
 /// a utility function to check keyboard stroke
 /// CPPONLY
 int simuPOP_kbhit();
@@ -649,6 +666,13 @@ public:
 	}
 
 
+	/// CPPONLY
+	bool fromFunc() const
+	{
+		return m_status == FROM_FUNC;
+	}
+
+
 	/// CPPONLY
 	/// return the index of loc in the index list
 	size_t indexOf(size_t loc) const;
@@ -1102,17 +1126,55 @@ void PyObj_As_IntArray(PyObject * obj, vectori & val);
 /// CPPONLY
 void PyObj_As_SizeTArray(PyObject * obj, vectoru & val);
 
-/// CPPONLY
-PyObject * Allele_Vec_As_NumArray(GenoIterator begin, GenoIterator end);
+/** CPPONLY
+ *  Expose alleles in [begin, end) as a carray object. If \e shape (at most
+ *  three dimensions) is given, the buffer of the array has this shape
+ *  instead of a single dimension.
+ */
+PyObject * Allele_Vec_As_NumArray(GenoIterator begin, GenoIterator end, const vectoru & shape = vectoru());
 
 /// CPPONLY
-PyObject * Lineage_Vec_As_NumArray(LineageIterator begin, LineageIterator end);
+PyObject * Lineage_Vec_As_NumArray(LineageIterator begin, LineageIterator end, const vectoru & shape = vectoru());
+
+/** CPPONLY
+ *  Acquire the Python GIL during the lifetime of this object so that Python
+ *  objects can be accessed from threads that do not hold it when replicates
+ *  are evolved in parallel. The interpreter releases the GIL while it
+ *  executes Python code, so \e exclusive should be set to also exclude
+ *  other exclusive guards, if a caller needs to be the only thread that calls
+ *  Python functions or changes states shared by replicates. Exclusive guards
+ *  can be nested in the same thread.
+ *
+ *  Guards do nothing unless they are enabled by \c setEnabled(true), which
+ *  is called by \c Simulator.evolve after it releases the GIL. Otherwise the
+ *  GIL is held by the thread that started the evolution, and worker threads
+ *  of its parallel regions would wait for it forever.
+ */
+class GILGuard
+{
+public:
+	GILGuard(bool exclusive = false);
+
+	~GILGuard();
+
+	/// enable or disable all guards, called outside of parallel regions.
+	static void setEnabled(bool enabled);
+
+private:
+	bool m_enabled;
+
+	bool m_exclusive;
+
+	PyGILState_STATE m_state;
+};
 
 // ///////////////////////////////////////////////////////
 /** CPPONLY shared variables.
 
    This class set and read Python variables using the given
-   dictionary.
+   dictionary. The Python GIL is acquired by these functions so
+   that they can be called by operators that are applied to
+   replicates evolved in parallel.
 
  */
 class SharedVariables
@@ -1178,6 +1240,8 @@ public:
 
 	bool hasVar(const string & name)
 	{
+		GILGuard gil;
+
 		// not null = has variable
 		return PyDict_GetItemString(m_dict, const_cast<char *>(name.c_str())) != NULL;
 	}
@@ -1210,6 +1274,14 @@ public:
 	///CPPONLY
 	PyObject * setVar(const string & name, const vectorf & val);
 
+	///CPPONLY
+	PyObject * setVar(const string & name, const matrixf & val);
+
+	///CPPONLY set a matrix as a list of rows of type \c array.array('d'),
+	///which take 8 bytes per element and can be converted to a NumPy array.
+	///Rows of \e val are released as they are converted.
+	PyObject * setMatrixVar(const string & name, matrixf & val);
+
 	///CPPONLY
 	PyObject * setVar(const string & name, const strDict & val);
 
@@ -1225,6 +1297,7 @@ public:
 	/// CPPONLY
 	bool getVarAsBool(const string & name, bool nameError = true) const
 	{
+		GILGuard gil;
 		bool val;
 
 		PyObj_As_Bool(getVar(name, nameError), val);
@@ -1235,6 +1308,7 @@ public:
 	/// CPPONLY
 	long getVarAsInt(const string & name, bool nameError = true) const
 	{
+		GILGuard gil;
 		long val;
 
 		PyObj_As_Int(getVar(name, nameError), val);
@@ -1245,6 +1319,7 @@ public:
 	/// CPPONLY
 	double getVarAsDouble(const string & name, bool nameError = true) const
 	{
+		GILGuard gil;
 		double val;
 
 		PyObj_As_Double(getVar(name, nameError), val);
@@ -1258,6 +1333,7 @@ public:
 	/// CPPONLY
 	string getVarAsString(const string & name, bool nameError = true) const
 	{
+		GILGuard gil;
 		string val;
 
 		PyObj_As_String(getVar(name, nameError), val);
@@ -1804,7 +1880,12 @@ public:
 	 *  random number source will be used to guarantee that random seeds are
 	 *  used even if more than one simuPOP sessions are started simultaneously.
 	 *  Names of supported random number generators are available from
-	 *  <tt>moduleInfo()['availableRNGs']</tt>.
+	 *  <tt>moduleInfo()['availableRNGs']</tt>. In addition to generators
+	 *  from the GSL library, a counter-based generator \c philox4x32 is
+	 *  provided, with which parallel mating, initialization of sex,
+	 *  migration and penetrance draw random numbers from streams keyed by
+	 *  generation, subpopulation and index of individual so that the results
+	 *  do not depend on the number of threads.
 	 */
 	RNG(const char * name = NULL, unsigned long seed = 0);
 
@@ -1845,6 +1926,48 @@ public:
 	static unsigned long generateRandomSeed();
 
 
+	/** CPPONLY Return \c true if this is a counter-based random number
+	 *  generator (\c philox4x32), which can be positioned at the beginning of
+	 *  any of its random number streams using function \c setStream.
+	 */
+	bool counterBased() const;
+
+
+	/** CPPONLY Return a new number for a call of an operation that draws
+	 *  random numbers from counter-based streams. Calls are numbered from
+	 *  \c 0 after the RNG is seeded, so that two operators applied to the
+	 *  same generation, or two populations evolved with the same seed, use
+	 *  independent streams.
+	 */
+	size_t newStreamCall()
+	{
+		return m_streamCalls++;
+	}
+
+
+	/** CPPONLY Position a counter-based random number generator at the
+	 *  beginning of a random number stream identified by its seed, the type of
+	 *  operation \e stream, replicate \e rep, the number \e call of the
+	 *  operation (returned by \c newStreamCall), generation \e gen,
+	 *  subpopulation \e subPop and an \e index (e.g. index of the first
+	 *  offspring generated from the stream). Random numbers drawn from a
+	 *  stream do not depend on how other streams have been used.
+	 */
+	void setStream(size_t stream, size_t rep, size_t call, size_t gen, size_t subPop, size_t index);
+
+
+	/** CPPONLY Return an ID of the stream set by the last call to
+	 *  \c setStream, or \c 0 if no stream has been set after the RNG is
+	 *  seeded. This allows objects that cache random numbers to detect a
+	 *  change of stream.
+	 */
+	ULONG streamID() const
+	{
+		return m_streamID;
+	}
+
+
+
 	/** Generate a random number following a rng_uniform [0, 1) distribution.
 	 *  <group>3-rng</group>
 	 */
@@ -1997,11 +2120,80 @@ private:
 	/// to reset a RNG when a new seed is set.
 	uint16_t m_bitByte;
 	UINT m_bitIndex;
+
+	/// ID of the current stream of a counter-based RNG
+	ULONG m_streamID;
+
+	/// number of calls returned by newStreamCall
+	size_t m_streamCalls;
 };
 
 /// return the currently used random number generator
 RNG & getRNG();
 
+/** CPPONLY Let the calling thread draw random numbers from \e rng instead of
+ *  its default random number generator until this function is called again
+ *  with \c NULL. This is used to give each replicate its own random number
+ *  stream when replicates are evolved in parallel. The previously set
+ *  random number generator (or \c NULL) is returned.
+ */
+RNG * setThreadRNG(RNG * rng);
+
+
+/// CPPONLY Types of operations that draw random numbers from counter-based streams
+enum RNGStreamType {
+	MATING_STREAM = 1,
+	INIT_SEX_STREAM = 2,
+	MIGRATION_STREAM = 3,
+	PENETRANCE_STREAM = 4
+};
+
+
+/** CPPONLY If random number generator \e rng (usually the RNG of the thread
+ *  that starts a parallel region) is counter-based, let the calling thread
+ *  draw random numbers from counter-based streams of call \e call (returned
+ *  by \c RNG::newStreamCall before the parallel region) during the lifetime
+ *  of this object. Function \c seek should be called before each fixed block
+ *  of work (e.g. a block of offspring) so that the random numbers used by
+ *  the block do not depend on the thread that processes it. This object
+ *  does nothing if \e rng is not counter-based.
+ */
+class RNGStream
+{
+public:
+	RNGStream(const RNG & rng, RNGStreamType type, size_t rep, size_t call);
+
+	~RNGStream();
+
+	/// return \c true if random numbers are drawn from counter-based streams
+	bool keyed() const
+	{
+		return m_RNG != NULL;
+	}
+
+
+	/// move to the stream for generation \e gen, subpopulation \e subPop and \e index
+	void seek(size_t gen, size_t subPop, size_t index)
+	{
+		if (m_RNG != NULL)
+			m_RNG->setStream(m_type, m_rep, m_call, gen, subPop, index);
+	}
+
+
+private:
+	RNGStream(const RNGStream &);
+
+	RNG * m_RNG;
+
+	RNG * m_savedRNG;
+
+	RNGStreamType m_type;
+
+	size_t m_rep;
+
+	size_t m_call;
+};
+
 /// CPPONLY
 void chisqTest(const vector<vectoru> & table, double & chisq, double & chisq_p);
 
@@ -2139,51 +2331,11 @@ public:
 			}
 			// the mos difficult case
 			m_algorithm = 3;
-			// sum of weight
-			double w = accumulate(first, last, 0.0);
-
-			DBG_FAILIF(fcmp_le(w, 0), ValueError, "Sum of weight is <= 0.");
-
-			w = m_N / w;
-
-			// initialize p with N*p0,...N*p_k-1
+			// weights are copied to m_q, which is turned into an alias table
 			m_q.resize(m_N);
-
 			for (size_t i = 0; i < m_N; ++i)
-				m_q[i] = *(first + i) * w;
-
-			// initialize Y with values
-			m_a.resize(m_N);
-			for (size_t i = 0; i < m_N; ++i)
-				m_a[i] = i;
-			// use two sets H and L
-			// for efficiency purpose, use a single vector.
-			size_t * HL = new size_t[m_N];
-			size_t * L = HL;
-			size_t * H = HL + m_N - 1;                                 // point to the end.
-
-			for (size_t i = 0; i < m_N; ++i) {
-				if (m_q[i] > 1)
-					*H-- = i;
-				else
-					*L++ = i;
-			}
-
-			//
-			size_t j, k;
-			while (L != HL && H != HL + m_N - 1) {
-				j = *(L - 1);
-				k = *(H + 1);
-				m_a[j] = k;
-				m_q[k] += m_q[j] - 1;
-
-				L--;                                                                    // remove j from L
-				if (m_q[k] < 1.) {
-					*L++ = k;                                                           // add k to L
-					++H;                                                                // remove k from H
-				}
-			}
-			delete[] HL;
+				m_q[i] = *(first + i);
+			buildAliasTable();
 		} else {
 			m_algorithm = 4;
 			for (size_t i = 0; i < sz; ++i) {
@@ -2218,11 +2370,20 @@ public:
 	 */
 	size_t draw();
 
+	/** CPPONLY
+	 *  Draw \e n random numbers to \e samples. This is equivalent to, but
+	 *  faster than, calling \c draw() \e n times.
+	 */
+	void draw(size_t * samples, size_t n);
+
 	/** Returns a list of \e n random numbers
 	 */
 	vectoru drawSamples(ULONG n = 1);
 
 private:
+	/// turn weights in m_q into an alias table (m_q, m_a)
+	void buildAliasTable();
+
 	/// which algorithm to use
 	int m_algorithm;
 
@@ -2483,6 +2644,10 @@ private:
 
 	/// current trial. Used when user want to access the table row by row
 	size_t m_cur;
+
+	/// stream of the RNG when the table was generated, the table is
+	/// regenerated if the RNG is moved to another counter-based stream.
+	ULONG m_streamID;
 };
 
 
@@ -2522,9 +2687,21 @@ void copyGenotype(GenoIterator fr, GenoIterator to, size_t n);
 /// will not do here.
 void clearGenotype(GenoIterator to, size_t n);
 
+/// CPPONLY
+/// Copy loci [begin, end) from two homologous copies \e cp0 and \e cp1 to
+/// \e to, word by word. Copying starts from copy \e firstCopy and switches
+/// to the other copy at each locus in \e breaks, which should be sorted.
+/// Breaks before \e begin are counted so that the same list can be used for
+/// several regions of the same chromosome set.
+void blendGenotype(GenoIterator cp0, GenoIterator cp1, GenoIterator to,
+	size_t begin, size_t end, const vectoru & breaks, int firstCopy);
+
 #  ifndef OPTIMIZED
 void testCopyGenotype();
 
+/// CPPONLY
+void testBlendGenotype();
+
 #  endif
 #endif
 
@@ -56,7 +56,7 @@ import time
 from simuOpt import simuOptions
 
 from simuPOP import moduleInfo, MALE, FEMALE, Population, PointMutator, getRNG,\
-    ALL_AVAIL, PyOperator, stat
+    ALL_AVAIL, PyOperator, ExportGenotype, stat
 import collections
 
 def viewVars(var, gui=None):
@@ -2897,6 +2897,30 @@ class Exporter(PyOperator):
         ``True`` which uses 'pop' as the column name. If present, the column is
         written with the string represenation of the (virtual) subpopulation.
 
+    PLINK (http://zzz.bwh.harvard.edu/plink/binary.shtml). This format writes
+    individuals, loci and genotypes to binary PLINK files ``output.fam``,
+    ``output.bim`` and ``output.bed``, where ``output`` should be a filename
+    prefix. VCF (Variant Call Format, version 4.2). This format writes phased
+    genotypes of individuals, with allele 0 as the reference allele, to
+    ``output``. Allele names are written as REF and ALT alleles if they are
+    distinct sequences of bases (A, C, G, T, N), otherwise ``N`` is written as
+    the reference allele and symbolic alleles ``<A1>``, ``<A2>``, ... are
+    written as alternative alleles. Locus positions are written as integers
+    and should be at least 1 for this format. These two formats are exported by operator
+    ``ExportGenotype``, which reads genotypes directly from the population and
+    is much faster than other formats, but only accepts a filename (or
+    ``!expr``) as ``output``, and does not show a progress bar. Appending to
+    existing files (``>>filename``) is not supported. They accept the following
+    parameters:
+
+    loci
+        Loci to be exported, default to all loci.
+
+    idField
+        Information field used to identify individuals (default to ``ind_id``).
+        Individuals are identified by their 1-based indexes if the population
+        does not have this field.
+
     This operator supports the usual applicability parameters such as begin,
     end, step, at, reps, and subPops. If subPops are specified, only
     individuals from specified (virtual) subPops are exported. Similar to
@@ -2933,6 +2957,19 @@ class Exporter(PyOperator):
             self.exporter = CSVExporter(*args, **kwargs)
         elif format.lower() == 'ms':
             self.exporter = MSExporter(*args, **kwargs)
+        elif format.lower() in ['plink', 'vcf']:
+            if args:
+                raise ValueError('Format {} only accepts keyword parameters.'.format(format))
+            if not isinstance(output, str):
+                raise ValueError('Format {} only accepts a filename as output.'.format(format))
+            if output.startswith('>>'):
+                raise ValueError('Format {} does not support appending to an existing file.'.format(format))
+            if output.startswith('>'):
+                output = output[1:]
+            if not output:
+                raise ValueError('Format {} requires a filename as output.'.format(format))
+            self.exporter = ExportGenotype(output=output, format=format,
+                subPops=subPops, **kwargs)
         else:
             raise ValueError('Unrecognized fileformat: {}.'.format(format))
         PyOperator.__init__(self, func=self._export, begin=begin, end=end,
@@ -2985,6 +3022,8 @@ class Exporter(PyOperator):
         return subPops
         
     def _export(self, pop):
+        if isinstance(self.exporter, ExportGenotype):
+            return self.exporter.apply(pop)
         bin_mode = False
         if hasattr(self.output, '_with_output') and hasattr(self.output, '_with_mode'):
             bin_mode  = 'b' in self.output._with_mode
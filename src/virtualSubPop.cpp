@@ -436,6 +436,15 @@ bool CombinedSplitter::contains(const Population & pop, size_t ind, vspID vsp) c
 }
 
 
+bool CombinedSplitter::positional() const
+{
+	for (size_t i = 0; i < m_splitters.size(); ++i)
+		if (!m_splitters[i]->positional())
+			return false;
+	return true;
+}
+
+
 void CombinedSplitter::activate(const Population & pop, size_t subPop, size_t virtualSubPop)
 {
 	const vspList & list = m_vspMap[virtualSubPop];
@@ -563,6 +572,15 @@ bool ProductSplitter::contains(const Population & pop, size_t ind, vspID vsp) co
 }
 
 
+bool ProductSplitter::positional() const
+{
+	for (size_t i = 0; i < m_splitters.size(); ++i)
+		if (!m_splitters[i]->positional())
+			return false;
+	return true;
+}
+
+
 void ProductSplitter::activate(const Population & pop, size_t subPop, size_t virtualSubPop)
 {
 	DBG_FAILIF(virtualSubPop >= m_numVSP, IndexError, "Subpopulation index out of range.");
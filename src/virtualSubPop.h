@@ -335,6 +335,16 @@ public:
 	 */
 	virtual bool contains(const Population & pop, size_t ind, vspID vsp) const = 0;
 
+	/// Whether or not membership of VSPs depends only on the positions of
+	/// individuals in a subpopulation and its size, but not on properties
+	/// such as sex, information fields or genotypes of individuals.
+	/// CPPONLY
+	virtual bool positional() const
+	{
+		return false;
+	}
+
+
 	/// mark individuals in the given vsp as visible, and others invisible.
 	/// CPPONLY
 	virtual void activate(const Population & pop, size_t subPop, size_t virtualSubPop) = 0;
@@ -450,6 +460,10 @@ public:
 	 */
 	bool contains(const Population & pop, size_t ind, vspID vsp) const;
 
+	/// if all splitters have positional membership.
+	/// CPPONLY
+	bool positional() const;
+
 	/// mark individuals in the given vsp as visible, and others invisible.
 	/// CPPONLY
 	void activate(const Population & pop, size_t subPop, size_t virtualSubPop);
@@ -517,6 +531,10 @@ public:
 	bool contains(const Population & pop, size_t ind, vspID vsp) const;
 
 
+	/// if all splitters have positional membership.
+	/// CPPONLY
+	bool positional() const;
+
 	/// mark individuals in the given vsp as visible, and others invisible.
 	/// CPPONLY
 	void activate(const Population & pop, size_t subPop, size_t virtualSubPop);
@@ -754,6 +772,13 @@ public:
 	 */
 	bool contains(const Population & pop, size_t ind, vspID vsp) const;
 
+	/// CPPONLY
+	bool positional() const
+	{
+		return true;
+	}
+
+
 	/// mark individuals in the given vsp as visible, and others invisible.
 	/// CPPONLY
 	void activate(const Population & pop, size_t subPop, size_t virtualSubPop);
@@ -808,6 +833,13 @@ public:
 	 */
 	bool contains(const Population & pop, size_t ind, vspID vsp) const;
 
+	/// CPPONLY
+	bool positional() const
+	{
+		return true;
+	}
+
+
 	/// mark individuals in the given vsp as visible, and others invisible.
 	/// CPPONLY
 	void activate(const Population & pop, size_t subPop, size_t virtualSubPop);
@@ -154,6 +154,70 @@ class TestPopulation(unittest.TestCase):
         self.assertEqual(pop.subPopSize((0, 'Female'), 2, sex=FEMALE_ONLY), 60)
         self.assertEqual(pop.subPopSize((0, 'Female'), 2, sex=PAIR_ONLY), 0)
 
+    def testCountIndFlag(self):
+        'Testing counting of sex and affection status across words of individuals'
+        # subpopulation sizes that are not multiples of word size
+        pop = Population(size=[131, 0, 64, 65, 1], ancGen=1)
+        initSex(pop)
+        pop.push(pop.clone())
+        initSex(pop)
+        for ind in pop.individuals():
+            ind.setAffected(random.random() < 0.3)
+        males = [len([x for x in pop.individuals(sp) if x.sex() == MALE]) for sp in range(5)]
+        affected = [len([x for x in pop.individuals(sp) if x.affected()]) for sp in range(5)]
+        self.assertEqual(pop.popSize(sex=MALE_ONLY), sum(males))
+        self.assertEqual(pop.popSize(sex=FEMALE_ONLY), pop.popSize() - sum(males))
+        pop.useAncestralGen(1)
+        ancMales = len([x for x in pop.individuals() if x.sex() == MALE])
+        pop.useAncestralGen(0)
+        self.assertEqual(pop.popSize(1, sex=MALE_ONLY), ancMales)
+        pop.setVirtualSplitter(SexSplitter())
+        for sp in range(5):
+            self.assertEqual(pop.subPopSize(sp, sex=MALE_ONLY), males[sp])
+            self.assertEqual(pop.subPopSize((sp, 0)), males[sp])
+            self.assertEqual(pop.subPopSize((sp, 1)), pop.subPopSize(sp) - males[sp])
+        pop.setVirtualSplitter(AffectionSplitter())
+        for sp in range(5):
+            self.assertEqual(pop.subPopSize((sp, 1)), affected[sp])
+            self.assertEqual(pop.subPopSize((sp, 0)), pop.subPopSize(sp) - affected[sp])
+            # sex of individuals in an activated virtual subpopulation
+            affMales = len([x for x in pop.individuals(sp) if x.affected() and x.sex() == MALE])
+            self.assertEqual(pop.subPopSize((sp, 1), sex=MALE_ONLY), affMales)
+            self.assertEqual(pop.subPopSize((sp, 1), sex=FEMALE_ONLY), affected[sp] - affMales)
+
+
+    def testActivatedVirtualSubPop(self):
+        'Testing iteration and size of an activated virtual subpopulation'
+        pop = Population(size=[203, 50], loci=1, infoFields='x')
+        initSex(pop)
+        pop.setVirtualSplitter(SexSplitter())
+        males = [i for i in range(203) if pop.individual(i).sex() == MALE]
+        pop.activateVirtualSubPop([0, 0])
+        self.assertEqual(pop.subPopSize([0, 0]), len(males))
+        self.assertEqual(pop.subPopSize([0, 1]), 203 - len(males))
+        pop.deactivateVirtualSubPop(0)
+        # values are assigned in order, by one or more threads
+        initInfo(pop, values=list(range(1, len(males) + 1)), infoFields='x', subPops=[(0, 0)])
+        self.assertEqual([pop.individual(i).info('x') for i in males],
+            list(range(1, len(males) + 1)))
+        self.assertEqual(sum(pop.indInfo('x', [0, 1])), 0)
+        self.assertEqual(sum(pop.indInfo('x', 1)), 0)
+        initInfo(pop, values=[1, 2], infoFields='x', subPops=[(0, 1)])
+        self.assertEqual([pop.individual(i).info('x') for i in range(203) if i not in males],
+            [1, 2] * ((203 - len(males)) // 2) + [1] * ((203 - len(males)) % 2))
+        # offsets from the beginning of the virtual subpopulation
+        pointMutate(pop, inds=[0, 5, len(males) - 1, len(males)], allele=1,
+            loci=0, subPops=[(0, 0)])
+        self.assertEqual([i for i in range(203) if pop.individual(i).allele(0) == 1],
+            [males[0], males[5], males[-1]])
+        # indexes of VSPs defined by positions are reused until the
+        # subpopulation is resized
+        pop.setVirtualSplitter(RangeSplitter([[0, 10], [5, 20]]))
+        pop.setIndInfo(range(253), 'x')
+        for vsp, x in ((0, range(10)), (1, range(5, 20)), (1, range(5, 20)), (0, range(10))):
+            self.assertEqual([ind.x for ind in pop.individuals([0, vsp])], list(x))
+        pop.removeIndividuals(range(3))
+        self.assertEqual([ind.x for ind in pop.individuals([0, 1])], list(range(8, 23)))
 
     def testLociPos(self):
         'Testing lociPos parameter of Population::Population'
@@ -196,6 +260,105 @@ class TestPopulation(unittest.TestCase):
         arr = pop.genotype(1)
         self.assertEqual(len(arr), pop.genoSize()*pop.subPopSize(1))
         self.assertRaises(IndexError, pop.genotype, 2)
+        # view genotypes through the buffer protocol
+        pop.setGenotype([1, 0, 1, 1, 0, 0, 1])
+        view = memoryview(pop.genotype(1))
+        self.assertEqual(view.shape, (2, 2, 3))
+        self.assertEqual(view.strides, (6 * view.itemsize, 3 * view.itemsize, view.itemsize))
+        self.assertEqual(sum(sum(view.tolist(), []), []), list(pop.genotype(1)))
+        self.assertEqual(view[1, 0, 2], pop.individual(1, 1).allele(2, 0))
+        self.assertEqual(memoryview(pop.genotype()).shape, (3, 2, 3))
+        self.assertEqual(memoryview(pop.individual(0).genotype()).shape, (2, 3))
+        self.assertEqual(memoryview(pop.individual(0).genotype(1)).shape, (3,))
+        self.assertEqual(memoryview(pop.genotype()[2:5]).shape, (3,))
+        if moduleInfo()['alleleType'] in ['binary', 'mutant']:
+            # alleles are exported as a read-only copy
+            self.assertTrue(view.readonly)
+            self.assertEqual(view.format, 'B')
+            self.assertRaises(TypeError, view.__setitem__, (0, 0, 0), 0)
+            pop.individual(0, 1).setAllele(0, 0)
+            self.assertEqual(view[0, 0, 0], 1)
+            self.assertEqual(memoryview(pop.genotype(1))[0, 0, 0], 0)
+        else:
+            self.assertFalse(view.readonly)
+            view[0, 0, 0] = 4
+            self.assertEqual(pop.individual(0, 1).allele(0), 4)
+        del view
+        self.assertEqual(memoryview(Population(0, loci=3).genotype()).shape, (0, 2, 3))
+
+    def testInfoView(self):
+        'Testing Population::infoView(field), infoView(field, subPop)'
+        pop = Population(size=[3, 4], infoFields=['a', 'b', 'c'])
+        pop.setIndInfo(range(7), 'b')
+        view = pop.infoView('b')
+        self.assertEqual(view.shape, (7,))
+        self.assertEqual(view.strides, (3 * view.itemsize,))
+        self.assertEqual(view.tolist(), list(range(7)))
+        view = pop.infoView(2, 1)
+        self.assertEqual(len(view), 4)
+        view[1] = 10
+        self.assertEqual(pop.individual(1, 1).info('c'), 10)
+        self.assertEqual(pop.indInfo('a'), tuple([0]*7))
+        self.assertRaises(IndexError, pop.infoView, 'b', 2)
+        self.assertTrue(view.obj is not None)
+        # functions that reallocate information fields are blocked
+        self.assertRaises(RuntimeError, pop.addInfoFields, 'd')
+        self.assertRaises(RuntimeError, pop.setInfoByColumn, True)
+        self.assertRaises(RuntimeError, pop.push, pop.clone())
+        self.assertRaises(RuntimeError, pop.evolve, matingScheme=RandomSelection(), gen=1)
+        del view
+        pop.addInfoFields('d')
+        # the view keeps the population alive
+        view = pop.infoView('c')
+        del pop
+        view[0] = 5
+        self.assertEqual(view.tolist(), [5] + [0]*6)
+        del view
+        # a population owned by a simulator could be destroyed with the
+        # simulator so it cannot be viewed
+        sim = Simulator(Population(size=[3, 4], infoFields='a'), rep=2)
+        self.assertRaises(ValueError, sim.population(0).infoView, 'a')
+        pop = sim.extract(0)
+        view = pop.infoView('a')
+        del sim
+        view[0] = 2
+        self.assertEqual(pop.indInfo('a')[0], 2)
+        del pop
+        self.assertEqual(view.tolist(), [2] + [0]*6)
+        del view
+
+    def testInfoByColumn(self):
+        'Testing Population(infoByColumn=True)'
+        pop = Population(size=[3, 4], infoFields=['a', 'b'], infoByColumn=True)
+        rpop = Population(size=[3, 4], infoFields=['a', 'b'])
+        for p in (pop, rpop):
+            p.setIndInfo([7, 3, 5, 1, 6, 2, 4], 'a')
+            p.setIndInfo(range(7), 'b')
+        view = pop.infoView('b')
+        self.assertEqual(view.strides, (view.itemsize,))
+        self.assertEqual(view.tolist(), list(range(7)))
+        itemsize = view.itemsize
+        del view
+        self.assertEqual(pop.individual(2).info('a'), 5)
+        self.assertEqual(pop.individual(2, 1).info('b'), 5)
+        # operations that move individuals around
+        for p in (pop, rpop):
+            p.sortIndividuals('a')
+            p.addInfoFields('c', 1)
+            p.removeIndividuals([0])
+            p.resize([4, 4])
+        self.assertEqual(pop.indInfo('a'), rpop.indInfo('a'))
+        self.assertEqual(pop.indInfo('b'), rpop.indInfo('b'))
+        self.assertEqual(pop.indInfo('c'), rpop.indInfo('c'))
+        self.assertEqual(pop.infoView('a').tolist(), list(rpop.indInfo('a')))
+        pop1 = pop.extractSubPops(1)
+        self.assertEqual(pop1.indInfo('b'), rpop.indInfo('b', 1))
+        self.assertEqual(pop1.infoView('b').strides, (itemsize,))
+        pop1 = pop.clone()
+        self.assertEqual(pop1.indInfo('b'), pop.indInfo('b'))
+        # the layout is kept during evolution
+        pop.evolve(matingScheme=RandomSelection(), gen=2)
+        self.assertEqual(pop.indInfo('c'), tuple([1] * 8))
 
 
 
@@ -324,6 +487,78 @@ class TestPopulation(unittest.TestCase):
         pop.setAncestralDepth(3)
         self.assertEqual(pop.ancestralGens(), 3)
 
+    def testClonalAncestralGens(self):
+        'Testing ancestral generations that share haplotypes'
+        pop = Population(size=[100, 200], loci=[300, 500], ancGen=-1, infoFields='ind_id')
+        pop.setAncestralSharing(True)
+        initGenotype(pop, freq=[0.5, 0.5])
+        IdTagger().apply(pop)
+        geno = [[list(ind.genotype()) for ind in pop.individuals()]]
+        def record(pop):
+            geno.insert(0, [list(ind.genotype()) for ind in pop.individuals()])
+            return True
+        pop.evolve(
+            matingScheme=RandomSelection(ops=[CloneGenoTransmitter(), IdTagger()]),
+            postOps=[SNPMutator(u=0.0001), PyOperator(record)],
+            gen=6)
+        self.assertEqual(pop.ancestralGens(), 6)
+        # individuals are accessible without switching generation
+        for gen in range(1, 7):
+            ind = pop.ancestor(10, gen)
+            self.assertEqual(list(ind.genotype()), geno[gen][10])
+            self.assertEqual(pop.indByID(ind.ind_id), ind)
+        pop1 = pop.clone()
+        for gen in range(7):
+            pop.useAncestralGen(gen)
+            self.assertEqual([list(ind.genotype()) for ind in pop.individuals()], geno[gen])
+        pop.useAncestralGen(0)
+        self.assertEqual(pop, pop1)
+        pop1.save('clonal.pop')
+        pop2 = loadPopulation('clonal.pop')
+        for gen in range(6, -1, -1):
+            pop2.useAncestralGen(gen)
+            self.assertEqual([list(ind.genotype()) for ind in pop2.individuals()], geno[gen])
+        os.remove('clonal.pop')
+
+    def testCompressedAncestralGens(self):
+        'Testing Population::setAncestralCompression(depth)'
+        pop = Population(size=[100, 200], loci=[300, 500], ancGen=-1, infoFields='ind_id')
+        pop.setAncestralCompression(1)
+        initGenotype(pop, freq=[0.95, 0.05])
+        IdTagger().apply(pop)
+        geno = [[list(ind.genotype()) for ind in pop.individuals()]]
+        def record(pop):
+            geno.insert(0, [list(ind.genotype()) for ind in pop.individuals()])
+            return True
+        pop.evolve(
+            matingScheme=RandomMating(ops=[MendelianGenoTransmitter(), IdTagger()]),
+            postOps=PyOperator(record),
+            gen=5)
+        self.assertEqual(pop.ancestralGens(), 5)
+        for gen in range(1, 6):
+            ind = pop.ancestor(20, gen)
+            self.assertEqual(list(ind.genotype()), geno[gen][20])
+            self.assertEqual(pop.indByID(ind.ind_id), ind)
+        pop1 = pop.clone()
+        for gen in range(6):
+            pop1.useAncestralGen(gen)
+            self.assertEqual([list(ind.genotype()) for ind in pop1.individuals()], geno[gen])
+        pop1.useAncestralGen(0)
+        # compressed again after evolving one more generation
+        pop.evolve(matingScheme=RandomMating(), gen=1)
+        pop.useAncestralGen(3)
+        self.assertEqual([list(ind.genotype()) for ind in pop.individuals()], geno[2])
+        # generations are compressed again when they are switched back
+        pop.useAncestralGen(4)
+        self.assertEqual([list(ind.genotype()) for ind in pop.individuals()], geno[3])
+        pop.useAncestralGen(3)
+        self.assertEqual([list(ind.genotype()) for ind in pop.individuals()], geno[2])
+        pop.useAncestralGen(0)
+        pop1.save('compressed.pop')
+        pop2 = loadPopulation('compressed.pop')
+        self.assertEqual(pop1, pop2)
+        os.remove('compressed.pop')
+
     def testAddChrom(self):
         'Testing Population::addChrom'
         pop = self.getPop(chromNames=['c1', 'c2'], lociPos=[1, 3, 5], lociNames = ['l1', 'l2', 'l3'], ancGen=5)
@@ -1198,6 +1433,26 @@ class TestPopulation(unittest.TestCase):
         # apply this function to an empty information would crash simuPOP (issue #19)
         pop = Population(size=0, infoFields='a')
         pop.setSubPopByIndInfo('a')
+        # exchange of individuals between subpopulations of unchanged sizes
+        pop = Population(size=[4, 4], loci=2, infoFields=['x', 'y'])
+        pop.setIndInfo(range(8), 'y')
+        pop.setIndInfo([0, 1, 0, 0, 1, 1, 0, 1], 'x')
+        for idx, ind in enumerate(pop.individuals()):
+            ind.setAllele(idx % 2, 0)
+            ind.setSex(MALE if idx < 4 else FEMALE)
+        pop.setSubPopByIndInfo('x')
+        self.assertEqual(pop.subPopSizes(), (4, 4))
+        self.assertEqual(sorted(pop.indInfo('y', 0)), [0, 2, 3, 6])
+        self.assertEqual(sorted(pop.indInfo('y', 1)), [1, 4, 5, 7])
+        for ind in pop.individuals():
+            self.assertEqual(ind.allele(0), int(ind.y) % 2)
+            self.assertEqual(ind.sex(), MALE if ind.y < 4 else FEMALE)
+        # individuals are kept in order when subpopulation sizes change
+        pop.setIndInfo([0, 1, 1, 1, -1, 1, 0, 1], 'x')
+        pop.setSubPopByIndInfo('x')
+        self.assertEqual(pop.subPopSizes(), (2, 5))
+        for ind in pop.individuals():
+            self.assertEqual(ind.allele(0), int(ind.y) % 2)
 
     def testSortIndividuals(self):
         'Testing Population::sortIndividuals(infoFields)'
@@ -1335,6 +1590,96 @@ class TestPopulation(unittest.TestCase):
         self.assertFalse('module_os' in pop1.vars())
         os.remove('popout')
 
+    def testSaveBinary(self):
+        'Testing Population::save(filename, binary=True)'
+        pop = self.getPop(ancGen=5, infoFields=['a', 'b'])
+        for gen in range(pop.ancestralGens(), -1, -1):
+            pop.useAncestralGen(gen)
+            initGenotype(pop, freq=[0.3, 0.7])
+            initSex(pop)
+            initInfo(pop, lambda:random.randint(0, 40), infoFields=['a', 'b'])
+        stat(pop, alleleFreq=list(range(pop.totNumLoci())))
+        for compress in [False, True]:
+            pop.save('popout', binary=True, compress=compress)
+            pop1 = loadPopulation('popout')
+            self.assertEqual(pop1.ancestralGens(), pop.ancestralGens())
+            for gen in range(pop.ancestralGens(), -1, -1):
+                pop.useAncestralGen(gen)
+                pop1.useAncestralGen(gen)
+                self.assertEqual(pop, pop1)
+                self.assertEqual(pop.indInfo('a'), pop1.indInfo('a'))
+                self.assertEqual(pop.subPopNames(), pop1.subPopNames())
+            self.assertEqual(pop.dvars().alleleFreq, pop1.dvars().alleleFreq)
+        # the current ancestral generation is kept
+        pop.useAncestralGen(2)
+        pop.save('popout', binary=True)
+        self.assertEqual(pop.curAncestralGen(), 2)
+        pop.useAncestralGen(0)
+        # saved by an operator during evolution
+        pop.evolve(matingScheme=RandomMating(),
+            finalOps=SavePopulation(output='popout', binary=True), gen=2)
+        pop1 = loadPopulation('popout')
+        self.assertEqual(pop, pop1)
+        # layout of information fields and flags of individuals are kept
+        pop = self.getPop(size=[20, 30], ancGen=2, infoFields=['a', 'b'], infoByColumn=True)
+        for gen in range(pop.ancestralGens(), -1, -1):
+            pop.useAncestralGen(gen)
+            initSex(pop)
+            initInfo(pop, lambda:random.randint(0, 40), infoFields=['a', 'b'])
+        pop.individual(3).setAffected(True)
+        for compress in [False, True]:
+            pop.save('popout', binary=True, compress=compress)
+            pop1 = loadPopulation('popout')
+            self.assertTrue(pop1.infoByColumn())
+            self.assertEqual(pop1.infoView('b').tolist(), list(pop.indInfo('b')))
+            self.assertTrue(pop1.individual(3).affected())
+            for gen in range(pop.ancestralGens(), -1, -1):
+                pop.useAncestralGen(gen)
+                pop1.useAncestralGen(gen)
+                self.assertEqual(pop, pop1)
+                self.assertEqual(pop.indInfo('a'), pop1.indInfo('a'))
+                self.assertEqual(pop.indInfo('b'), pop1.indInfo('b'))
+            sample = MappedPopulation('popout').extractIndividuals([3, 7, 40])
+            self.assertTrue(sample.infoByColumn())
+            self.assertEqual(sample.indInfo('a'), tuple(pop.individual(x).info('a') for x in [3, 7, 40]))
+            self.assertEqual(sample.indInfo('b'), tuple(pop.individual(x).info('b') for x in [3, 7, 40]))
+        os.remove('popout')
+
+    def testMappedPopulation(self):
+        'Testing MappedPopulation::extractIndividuals(indexes)'
+        pop = self.getPop(size=[200, 300, 100], ancGen=2, infoFields=['a', 'b'])
+        pop.setSubPopName('sp1', 1)
+        initGenotype(pop, freq=[0.3, 0.7])
+        initInfo(pop, lambda:random.randint(0, 40), infoFields=['a', 'b'])
+        pop.dvars().value = 5
+        for compress in [False, True]:
+            pop.save('popout', binary=True, compress=compress)
+            mapped = MappedPopulation('popout')
+            self.assertEqual(mapped.popSize(), 600)
+            self.assertEqual(mapped.subPopSizes(), (200, 300, 100))
+            self.assertEqual(mapped.ancestralGens(), 2)
+            self.assertEqual(mapped.lociNames(), pop.lociNames())
+            indexes = random.sample(range(600), 50) + [10, 10]
+            sample = mapped.extractIndividuals(indexes)
+            self.assertEqual(sample.popSize(), 50)
+            self.assertEqual(sample.ancestralGens(), 0)
+            self.assertEqual(sample.subPopNames(), pop.subPopNames())
+            self.assertEqual(sample.dvars().value, 5)
+            indexes = sorted(set(indexes))
+            self.assertEqual(sample.subPopSizes(),
+                tuple(len([x for x in indexes if pop.subPopBegin(sp) <= x < pop.subPopEnd(sp)]) for sp in range(3)))
+            for idx, ind in zip(indexes, sample.individuals()):
+                self.assertEqual(ind, pop.individual(idx))
+                self.assertEqual(ind.info('a'), pop.individual(idx).info('a'))
+            self.assertEqual(mapped.extractIndividuals([]).popSize(), 0)
+            self.assertRaises(IndexError, mapped.extractIndividuals, [600])
+            del mapped
+        os.remove('popout')
+        # only binary files can be mapped
+        pop.save('popout')
+        self.assertRaises(ValueError, MappedPopulation, 'popout')
+        os.remove('popout')
+
     def testCrossPlatformLoad(self):
         'Testing loading populations created from other platform and allele types'
         localFile = 'sample_%d_%s_v3.pop' % ( \
@@ -1694,6 +2039,40 @@ class TestPopulation(unittest.TestCase):
             ind = pop.indByID(id)
             self.assertEqual(ind.ind_id, id)
         self.assertRaises(IndexError, pop.indByID, 8000)
+        # IDs changed after individuals have been looked up
+        pop.setIndInfo([x + 10000 for x in pop.indInfo('ind_id')], 'ind_id')
+        self.assertEqual(pop.indByID(10001).ind_id, 10001)
+        self.assertRaises(IndexError, pop.indByID, 1)
+        # IDs changed through individuals are indexed after a stale entry
+        # or a missing ID is found, or after individuals are reordered
+        pop.individual(5).setInfo(20000, 'ind_id')
+        self.assertEqual(pop.indByID(20000).ind_id, 20000)
+        self.assertRaises(IndexError, pop.indByID, 10006)
+        pop.individual(6).setInfo(20001, 'ind_id')
+        self.assertEqual(pop.indByID(20001).ind_id, 20001)
+        # individuals are reordered
+        pop.sortIndividuals('ind_id', reverse=True)
+        self.assertEqual(pop.indByID(10010).ind_id, 10010)
+        # brand-new IDs assigned by retagging
+        IdTagger().apply(pop)
+        newID = pop.individual(7).ind_id
+        self.assertEqual(pop.indByID(newID).ind_id, newID)
+        self.assertEqual(pop.indByID(newID, ancGens=0), pop.individual(7))
+        self.assertRaises(IndexError, pop.indByID, 20000)
+        pop.useAncestralGen(2)
+        newID = pop.individual(7).ind_id
+        pop.useAncestralGen(0)
+        self.assertEqual(pop.indByID(newID, ancGens=2).ind_id, newID)
+        # individuals sharing an ID: population returns the first one and
+        # pedigree returns the last one
+        pop = Population(size=10, infoFields=['ind_id', 'x'])
+        pop.setIndInfo([1, 2, 3, 3, 3, 4, 5, 6, 7, 8], 'ind_id')
+        pop.setIndInfo(range(10), 'x')
+        self.assertEqual(pop.indByID(3).x, 2)
+        self.assertEqual(pop.indByID(4).x, 5)
+        ped = Pedigree(pop, infoFields='x', fatherField='', motherField='')
+        self.assertEqual(ped.indByID(3).x, 4)
+        self.assertEqual(ped.indByID(4).x, 5)
  
     def testIdentifyFamilies(self):
         'Testing Pedigree::identifyFamily'
@@ -1729,6 +2108,39 @@ class TestPopulation(unittest.TestCase):
                 self.assertEqual(len(list(p.allIndividuals())), sz)
         #
 
+    def testLocateRelatives(self):
+        'Testing Pedigree::locateRelatives'
+        pop = Population(100, infoFields=['ind_id', 'father_id', 'mother_id'], ancGen=2)
+        tagID(pop, reset=True)
+        pop.evolve(
+            initOps = InitSex(),
+            matingScheme=RandomMating(ops=[
+                MendelianGenoTransmitter(),
+                IdTagger(),
+                PedigreeTagger()]),
+            gen = 3
+        )
+        pop.addInfoFields(['off1', 'off2', 'off3', 'sib1', 'sib2'])
+        ped = Pedigree(pop, infoFields=ALL_AVAIL)
+        ped.locateRelatives(OFFSPRING, ['off1', 'off2', 'off3'], ancGens=ALL_AVAIL)
+        ped.locateRelatives(FULLSIBLING, ['sib1', 'sib2'], ancGens=ALL_AVAIL)
+        # offspring and full siblings in the order of individuals
+        offspring = {}
+        families = {}
+        ped.useAncestralGen(0)
+        for ind in ped.individuals():
+            offspring.setdefault(ind.father_id, []).append(ind.ind_id)
+            offspring.setdefault(ind.mother_id, []).append(ind.ind_id)
+            families.setdefault((ind.father_id, ind.mother_id), []).append(ind.ind_id)
+        for ind in ped.individuals():
+            sibs = [x for x in families[(ind.father_id, ind.mother_id)] if x != ind.ind_id][:2]
+            self.assertEqual([x for x in (ind.sib1, ind.sib2) if x != -1], sibs)
+        ped.useAncestralGen(1)
+        for ind in ped.individuals():
+            off = offspring.get(ind.ind_id, [])[:3]
+            self.assertEqual([x for x in (ind.off1, ind.off2, ind.off3) if x != -1], off)
+        ped.useAncestralGen(0)
+
     def testIdentifyAncestors(self):
         'Testing pedigree::identifyAncestors'
         pop = Population(100, infoFields=['ind_id', 'father_id'], ancGen=1)
@@ -1820,6 +2232,14 @@ class TestPopulation(unittest.TestCase):
         # set lineage per individual
         initLineage(pop, list(range(100)), mode=PER_INDIVIDUAL)
         self.assertEqual(pop.lineage(), sum([20 * [i] for i in range(100)], []))
+        # view lineages through the buffer protocol
+        view = memoryview(pop.lineage())
+        self.assertEqual(view.shape, (100, 2, 10))
+        self.assertEqual(view.strides, (20 * view.itemsize, 10 * view.itemsize, view.itemsize))
+        self.assertEqual(view[5, 1, 3], 5)
+        view[5, 1, 3] = 1000
+        self.assertEqual(pop.individual(5).alleleLineage(3, 1), 1000)
+        self.assertEqual(memoryview(pop.individual(5).lineage()).shape, (2, 10))
 
        
     def testAllIndividuals(self):
@@ -2070,6 +2490,33 @@ class TestPopulation(unittest.TestCase):
         arr = list(pop.mutants(1))
         self.assertEqual(len(arr), 4)
         #
+
+    def testManyMutants(self):
+        'Testing the storage of many mutants on long chromosomes'
+        pop = Population(size=[50, 50], loci=[5000, 3000])
+        geno = {}
+        for i in range(3000):
+            idx = random.randint(0, pop.popSize() * pop.genoSize() - 1)
+            geno[idx] = 1 if moduleInfo()['alleleType'] == 'binary' else random.randint(1, 3)
+        # set in random order
+        for idx, val in geno.items():
+            pop.individual(idx // pop.genoSize()).setAllele(val, idx % pop.genoSize())
+        mutants = [tuple(x) for x in pop.mutants()]
+        self.assertEqual(mutants, sorted(geno.items()))
+        # add individuals from itself
+        pop.addIndFrom(pop)
+        self.assertEqual([tuple(x) for x in pop.mutants()],
+            mutants + [(x + 100 * pop.genoSize(), y) for x,y in mutants])
+        for i in range(100):
+            self.assertEqual(pop.individual(i), pop.individual(100 + i))
+        # copy within the population
+        pop.resize([100, 100, 50, 50], propagate=True)
+        for i in range(50):
+            self.assertEqual(pop.individual(i), pop.individual(50 + i))
+        # remove part of the mutants
+        pop.removeIndividuals(range(0, 300, 2))
+        self.assertEqual(pop.popSize(), 150)
+        self.assertEqual(len(list(pop.mutants())), sum([len([x for x in pop.individual(i).genotype() if x != 0]) for i in range(pop.popSize())]))
         
 if __name__ == '__main__':
     unittest.main()
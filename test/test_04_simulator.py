@@ -66,6 +66,50 @@ class TestSimulator(unittest.TestCase):
             gen=10
         )
 
+    def testParallelReps(self):
+        'Testing Simulator::evolve() with replicates evolved in parallel'
+        def evolveReps(numThreads=1):
+            setOptions(numThreads=numThreads)
+            getRNG().set(seed=235)
+            pop = Population(size=[200, 80], loci=[3, 5], infoFields='fitness')
+            pop.setGenotype([0, 1, 1, 0, 1, 1, 0])
+            simu = Simulator(pop, rep=5)
+            gens = simu.evolve(
+                initOps = InitSex(sex=[MALE, FEMALE]),
+                # operators that call Python are applied with the GIL held,
+                # others are applied to replicates concurrently
+                preOps = [TerminateIf('rep == 2 and gen == 3'),
+                    Migrator(rate=[[0, 0.1], [0.2, 0]]),
+                    PyOperator(lambda pop: pop.popSize() > 0),
+                    MapSelector(loci=0, fitness={(0,0):1, (0,1):0.9, (1,0):0.9, (1,1):0.8})],
+                matingScheme = RandomMating(ops=Recombinator(rates=0.1)),
+                postOps = Stat(alleleFreq=0, popSize=True),
+                gen = 5, parallelReps = True
+            )
+            setOptions(numThreads=1)
+            return simu, gens
+        simu, gens = evolveReps()
+        self.assertEqual(gens, (5, 5, 3, 5, 5))
+        self.assertEqual([simu.dvars(x).gen for x in range(5)], [5, 5, 3, 5, 5])
+        # results are determined by the seed
+        simu1, gens1 = evolveReps()
+        self.assertEqual(simu, simu1)
+        # and do not depend on the number of threads
+        simu4, gens4 = evolveReps(4)
+        self.assertEqual(gens4, gens)
+        self.assertEqual(simu4, simu)
+        for rep in range(5):
+            self.assertEqual(simu4.dvars(rep).alleleFreq, simu.dvars(rep).alleleFreq)
+        # operators that depend on the order at which replicates are
+        # evolved are not allowed
+        simu = Simulator(Population(size=100, loci=2, infoFields='ind_id'), rep=3)
+        for ops in [dict(preOps=TerminateIf('gen == 2', stopAll=True)),
+                dict(postOps=RevertIf('False', 'dummy.pop')),
+                dict(postOps=IfElse(True, ifOps=TicToc(stopAfter=10))),
+                dict(matingScheme=RandomMating(ops=[MendelianGenoTransmitter(), IdTagger()]))]:
+            self.assertRaises(ValueError, simu.evolve, initOps=InitSex(), gen=3,
+                parallelReps=True, **ops)
+
     def testCreateSimulator(self):
         'Testing the construction of Simulator'
         pop = Population(size=[20, 80], loci=1)
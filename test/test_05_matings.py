@@ -274,7 +274,74 @@ class TestMatingSchemes(unittest.TestCase):
                 lastParent = parent
                 famSize.append(1)
         self.assertEqual(famSize, [1]*20000+[2]*10000)
-         
+
+    def testConcurrentHeteroMating(self):
+        'Testing heterogeneous mating schemes in the same subpopulation'
+        old_rng = getRNG().name()
+        def evolvePop():
+            # offspring of all mating schemes are generated in blocks
+            getRNG().set('philox4x32', 513)
+            pop = Population(size=[3000, 1000], loci=[2], infoFields=['father_idx', 'mother_idx'])
+            pop.setVirtualSplitter(ProportionSplitter([0.3, 0.7]))
+            pop.evolve(
+                initOps = InitSex(),
+                matingScheme = HeteroMating([
+                    RandomMating(numOffspring=3, subPops=[(0,0), 1], ops=[MendelianGenoTransmitter(), ParentsTagger()]),
+                    RandomMating(numOffspring=2, subPops=[(0,1)], ops=[MendelianGenoTransmitter(), ParentsTagger()]),
+                    ], shuffleOffspring=False),
+                gen = 3
+            )
+            return pop
+        pop = evolvePop()
+        parents = [(x, y) for x, y in zip(pop.indInfo('mother_idx', subPop=0),
+            pop.indInfo('father_idx', subPop=0))]
+        famSize = []
+        lastParent = (-1, -1)
+        for parent in parents:
+            if parent == lastParent:
+                famSize[-1] += 1
+            else:
+                lastParent = parent
+                famSize.append(1)
+        self.assertEqual(famSize, [3]*300+[2]*1050)
+        self.assertEqual(pop, evolvePop())
+        setRNG(name=old_rng)
+
+    def testConcurrentSubPops(self):
+        'Testing mating schemes that populate all subpopulations concurrently'
+        old_rng = getRNG().name()
+        def evolvePop(matingScheme):
+            getRNG().set('philox4x32', 1021)
+            pop = Population(size=[20]*100, loci=[2], infoFields=['father_idx', 'mother_idx'])
+            pop.evolve(
+                initOps = [InitSex(), InitGenotype(freq=[0.5, 0.5])],
+                matingScheme = matingScheme,
+                gen = 3
+            )
+            return pop
+        for ms in [RandomMating(ops=[MendelianGenoTransmitter(), ParentsTagger()]),
+                HeteroMating([
+                    RandomMating(subPops=ALL_AVAIL, ops=[MendelianGenoTransmitter(), ParentsTagger()]),
+                    RandomSelection(subPops=range(0, 100, 2), ops=[CloneGenoTransmitter(), ParentsTagger()])])]:
+            pop = evolvePop(ms)
+            self.assertEqual(pop.subPopSizes(), tuple([20]*100))
+            # parents are chosen from the same subpopulation
+            for sp in range(100):
+                for ind in pop.individuals(sp):
+                    self.assertEqual(int(ind.father_idx) // 20, sp)
+            self.assertEqual(pop, evolvePop(ms))
+        # the number of subpopulations shrinks from generation to generation
+        getRNG().set('philox4x32', 1021)
+        pop = Population(size=[20]*8, loci=[2])
+        pop.evolve(
+            initOps = [InitSex(), InitGenotype(freq=[0.5, 0.5])],
+            preOps = MergeSubPops(subPops=[0, 1]),
+            matingScheme = RandomMating(),
+            gen = 7
+        )
+        self.assertEqual(pop.subPopSizes(), (160,))
+        setRNG(name=old_rng)
+
     def testWeightingScheme(self):
         'Testing weighting schemes of heterogeneous mating schemes'
         pop = Population(size=[1000], loci=2, infoFields='mark')
@@ -126,6 +126,26 @@ class TestStat(unittest.TestCase):
         self.assertEqual(pop.dvars([0, 0]).propOfUnaffected, 0.5)
         self.assertEqual(pop.dvars([1, 1]).numOfUnaffected, 350)
 
+    def testCountFlagsOfVSP(self):
+        'Testing numOfMales and numOfAffected in subpopulations not aligned to words'
+        pop = Population(size=[131, 65, 1])
+        initSex(pop)
+        for ind in pop.individuals():
+            ind.setAffected(randint(0, 9) < 3)
+        pop.setVirtualSplitter(ProportionSplitter([0.3, 0.7]))
+        stat(pop, numOfMales=True, numOfAffected=True,
+            subPops=[(x, y) for x in range(3) for y in range(2)],
+            vars=['numOfMales_sp', 'numOfFemales_sp', 'numOfAffected_sp', 'numOfUnaffected_sp'])
+        for sp in range(3):
+            for vsp in range(2):
+                inds = list(pop.individuals([sp, vsp]))
+                males = len([x for x in inds if x.sex() == MALE])
+                affected = len([x for x in inds if x.affected()])
+                self.assertEqual(pop.dvars([sp, vsp]).numOfMales, males)
+                self.assertEqual(pop.dvars([sp, vsp]).numOfFemales, len(inds) - males)
+                self.assertEqual(pop.dvars([sp, vsp]).numOfAffected, affected)
+                self.assertEqual(pop.dvars([sp, vsp]).numOfUnaffected, len(inds) - affected)
+
     def testNumOfSegSites(self):
         'Testing the number of segregating sites'
         pop = Population(size=1000, loci=[10]*10)
@@ -543,7 +563,23 @@ class TestStat(unittest.TestCase):
             self.assertEqual(pop.dvars().haploFreq[(0, 1, 5)][(3, 3, 3)], 0.5)
             self.assertEqual(pop.dvars().haploFreq[(2, 5)][(1, 1)], 0.2)
             self.assertEqual(pop.dvars().haploFreq[(2, 5)][(2, 2)], 0.3)
-            self.assertEqual(pop.dvars().haploFreq[(2, 5)][(3, 3)], 0.5) 
+            self.assertEqual(pop.dvars().haploFreq[(2, 5)][(3, 3)], 0.5)
+
+    def testHaploNumCounts(self):
+        'Testing haplotype counts of short and long haplotypes'
+        pop = Population(size=[200, 100], ploidy=2, loci=[12])
+        initGenotype(pop, freq=[.2, .3, .5])
+        # short haplotypes are counted as packed keys in modules with bounded
+        # alleles, and long ones fall back to allele vectors
+        for loci in [(0, 3), (0, 2, 4, 6, 8, 9, 10, 11), tuple(range(12))]:
+            stat(pop, haploFreq=loci, vars=['haploNum', 'haploNum_sp'])
+            cnt = {}
+            for ind in pop.individuals():
+                for p in range(2):
+                    hap = tuple([ind.allele(x, p) for x in loci])
+                    cnt[hap] = cnt.get(hap, 0) + 1
+            self.assertEqual(pop.dvars().haploNum[loci], cnt)
+            self.assertEqual(sum(pop.dvars(1).haploNum[loci].values()), 200)
 
 
     def testHaploHomoFreq(self):
@@ -694,6 +730,54 @@ class TestStat(unittest.TestCase):
             self.assertAlmostEqual(ChiSq(pop.dvars(sp), 2, 4), pop.dvars(sp).LD_ChiSq[2][4])
             self.assertAlmostEqual(CramerV(pop.dvars(sp), 2, 4), pop.dvars(sp).CramerV[2][4])
 
+    def testLDMatrix(self):
+        '''Testing LD matrix between diallelic loci'''
+        pop = Population(size=[300, 200], ploidy=2, loci=[70, 5],
+            chromTypes=[AUTOSOME, CHROMOSOME_X])
+        initSex(pop)
+        initGenotype(pop, freq=[.3, .7])
+        initGenotype(pop, freq=[.2, .3, .5], loci=[3])
+        pairs = [[x, y] for x in [0, 1, 2, 40, 70, 72] for y in [1, 2, 69, 71, 74]
+            if x < y and (x < 70) == (y < 70)]
+        stat(pop, LD=pairs, LDMatrix=ALL_AVAIL, vars=['LD', 'LD_prime', 'R2',
+            'LD_matrix', 'LD_prime_matrix', 'R2_matrix'])
+        # loci on different types of chromosomes
+        self.assertEqual(pop.dvars().R2_matrix[1][71], MISSING_VALUE)
+        if moduleInfo()['alleleType'] != 'binary':
+            # multi-allelic locus
+            self.assertEqual(pop.dvars().R2_matrix[3][40], MISSING_VALUE)
+        for x, y in pairs:
+            for var in ['LD', 'LD_prime', 'R2']:
+                self.assertAlmostEqual(pop.vars()[var][x][y], pop.vars()[var + '_matrix'][x][y])
+                self.assertAlmostEqual(pop.vars()[var][x][y], pop.vars()[var + '_matrix'][y][x])
+        # pairs within a window on the same chromosome
+        stat(pop, LDMatrix=[0, 1, 2, 69, 70, 71], vars='R2_matrix')
+        full = pop.dvars().R2_matrix
+        self.assertEqual(len(full[0]), 6)
+        stat(pop, LDMatrix=[0, 1, 2, 69, 70, 71], LDWindow=1, vars='R2_matrix')
+        R2 = pop.dvars().R2_matrix
+        self.assertEqual(len(R2), 6)
+        # rows are stored as arrays of doubles, by band of loci i-1 to i+1
+        self.assertEqual(R2[0].typecode, 'd')
+        self.assertEqual(len(R2[0]), 3)
+        self.assertEqual(R2[0][0], MISSING_VALUE)
+        self.assertNotEqual(R2[0][2], MISSING_VALUE)
+        self.assertAlmostEqual(R2[0][2], full[0][1])
+        self.assertAlmostEqual(R2[1][0], full[1][0])
+        self.assertAlmostEqual(R2[1][1], full[1][1])
+        # loci 2 and 69 are too far apart, loci 69 and 70 on different chromosomes
+        self.assertEqual(R2[2][2], MISSING_VALUE)
+        self.assertEqual(R2[3][2], MISSING_VALUE)
+        self.assertAlmostEqual(R2[4][2], full[4][5])
+        # pairs written to a file
+        stat(pop, LDMatrix=[0, 1, 2], vars=['LD_matrix', 'R2_matrix'], output='LD.txt')
+        with open('LD.txt') as ld:
+            lines = [x.split() for x in ld.readlines()]
+        os.remove('LD.txt')
+        self.assertEqual([x[:2] for x in lines],
+            [['0', '0'], ['0', '1'], ['0', '2'], ['1', '1'], ['1', '2'], ['2', '2']])
+        self.assertEqual(len(lines[0]), 4)
+
 
     def testCombinedStats(self):
         '''Testing dependency of combined statistics'''
@@ -710,6 +794,50 @@ class TestStat(unittest.TestCase):
         pop.dvars().haploFreq[(1, 2)]
         pop.dvars().haploFreq[(1, 3)]
 
+    def testFusedGenotypeStats(self):
+        '''Testing statistics calculated from shared genotype counts'''
+        pop = Population(size=[500, 100], ploidy=2, loci=[5, 2],
+            chromTypes=[AUTOSOME, CHROMOSOME_X], infoFields='x')
+        initSex(pop)
+        initGenotype(pop, freq=[.2, .3, .5])
+        initInfo(pop, lambda: randint(0, 2), infoFields='x')
+        pop.setVirtualSplitter(InfoSplitter(field='x', values=[0, 1, 2]))
+        pop1 = pop.clone()
+        subPops = [(0, 0), (0, 2), 1]
+        statVars = ['alleleFreq', 'alleleFreq_sp', 'heteroFreq', 'heteroFreq_sp',
+            'genoNum', 'genoNum_sp', 'HWE', 'HWE_sp']
+        # calculated together
+        stat(pop, alleleFreq=[1, 2, 6], heteroFreq=[1, 3], genoFreq=[2, 4],
+            HWE=[1, 4], subPops=subPops, vars=statVars)
+        # calculated separately
+        for kwargs in [{'alleleFreq': [1, 2, 6]}, {'heteroFreq': [1, 3]},
+                {'genoFreq': [2, 4]}, {'HWE': [1, 4]}]:
+            stat(pop1, subPops=subPops, vars=statVars, **kwargs)
+        for var in ['alleleFreq', 'heteroFreq', 'genoNum', 'HWE']:
+            self.assertEqual(pop.vars()[var], pop1.vars()[var])
+            for sp in subPops:
+                self.assertEqual(pop.vars()['subPop'][sp][var], pop1.vars()['subPop'][sp][var])
+        # sex and mitochondrial chromosomes, and alleles that are too large
+        # to be counted in dense arrays
+        pop = Population(size=[300, 200], ploidy=2, loci=[2, 2, 1, 1],
+            chromTypes=[AUTOSOME, CHROMOSOME_X, CHROMOSOME_Y, MITOCHONDRIAL])
+        initSex(pop)
+        initGenotype(pop, freq=[.2, .3, .5])
+        for idx, ind in enumerate(pop.individuals()):
+            if idx % 7 == 0:
+                ind.setAllele(100, 0, 0)
+                ind.setAllele(100, 2, 0)
+        pop1 = pop.clone()
+        statVars = ['alleleNum', 'alleleNum_sp', 'genoNum', 'genoNum_sp']
+        stat(pop, alleleFreq=ALL_AVAIL, genoFreq=ALL_AVAIL, subPops=[0, 1],
+            vars=statVars)
+        stat(pop1, alleleFreq=ALL_AVAIL, subPops=[0, 1], vars=statVars)
+        stat(pop1, genoFreq=ALL_AVAIL, subPops=[0, 1], vars=statVars)
+        for var in ['alleleNum', 'genoNum']:
+            self.assertEqual(pop.vars()[var], pop1.vars()[var])
+            for sp in [0, 1]:
+                self.assertEqual(pop.vars()['subPop'][sp][var], pop1.vars()['subPop'][sp][var])
+
     def pairwiseDiff(self, sample, loci):
         'Calculating pairwise difference'
         diff = []
@@ -560,6 +560,77 @@ class TestSelector(unittest.TestCase):
             gen=100
         )
 
+    def testMapSelectorSexChrom(self):
+        'Testing map selector with genotypes on autosomes and chromosome X'
+        pop = Population(1000, loci=[2, 1], chromTypes=[AUTOSOME, CHROMOSOME_X],
+            infoFields=['fitness'])
+        initSex(pop)
+        initGenotype(pop, freq=[0.6, 0.4])
+        fitness = {}
+        for a in range(2):
+            for b in range(2):
+                for c in range(2):
+                    fitness[(a, b, c)] = 0.5 + a * 0.1 + b * 0.01 + c * 0.001
+                    for d in range(2):
+                        fitness[(a, b, c, d)] = 0.2 + a * 0.1 + b * 0.01 + c * 0.001 + d * 0.0001
+        MapSelector(loci=[1, 2], fitness=fitness).apply(pop)
+        for ind in pop.individuals():
+            if ind.sex() == MALE:
+                geno = (ind.allele(1, 0), ind.allele(1, 1), ind.allele(2, 0))
+            else:
+                geno = (ind.allele(1, 0), ind.allele(1, 1), ind.allele(2, 0), ind.allele(2, 1))
+            self.assertEqual(ind.fitness, fitness[geno])
+        # genotypes not in the dictionary
+        initGenotype(pop, freq=[0.6, 0.3, 0.1])
+        self.assertRaises(ValueError, MapSelector(loci=[1, 2], fitness=fitness).apply, pop)
+        # map selectors in a multi-locus selector are initialized with it
+        initGenotype(pop, freq=[0.6, 0.4])
+        MlSelector([MapSelector(loci=[1, 2], fitness=fitness),
+            MapSelector(loci=0, fitness={(0,0):1, (0,1):0.5, (1,1):0.25})],
+            mode=MULTIPLICATIVE).apply(pop)
+        for ind in pop.individuals():
+            if ind.sex() == MALE:
+                geno = (ind.allele(1, 0), ind.allele(1, 1), ind.allele(2, 0))
+            else:
+                geno = (ind.allele(1, 0), ind.allele(1, 1), ind.allele(2, 0), ind.allele(2, 1))
+            self.assertAlmostEqual(ind.fitness, fitness[geno] * 0.5 ** (ind.allele(0, 0) + ind.allele(0, 1)))
+
+    def testMaSelectorBlocks(self):
+        'Testing multi-allele selectors on populations evaluated in blocks'
+        pop = Population([3000, 2000], loci=[3], infoFields=['fitness'])
+        initSex(pop)
+        initGenotype(pop, freq=[.5, .2, .2, .1])
+        fitness = [1 - 0.01 * x for x in range(9)]
+        def index(ind, loci, wildtype):
+            idx = 0
+            for loc in loci:
+                idx = idx * 3 + 2 - (ind.allele(loc, 0) in wildtype) - (ind.allele(loc, 1) in wildtype)
+            return idx
+        MaSelector(loci=[2, 0], fitness=fitness, wildtype=[0, 2]).apply(pop)
+        for ind in pop.individuals():
+            self.assertEqual(ind.fitness, fitness[index(ind, [2, 0], [0, 2])])
+        # virtual subpopulations
+        pop.setVirtualSplitter(SexSplitter())
+        pop.setIndInfo(-1, 'fitness')
+        MaSelector(loci=[1], fitness=[1, 0.5, 0.25], subPops=[(1, 0)]).apply(pop)
+        for sp in range(2):
+            for ind in pop.individuals(sp):
+                if sp == 1 and ind.sex() == MALE:
+                    self.assertEqual(ind.fitness, [1, 0.5, 0.25][index(ind, [1], [0])])
+                else:
+                    self.assertEqual(ind.fitness, -1)
+        # multi-locus selector with a selector that applies to one subpopulation
+        MlSelector([
+            MaSelector(loci=[0], fitness=[1, 0.8, 0.6]),
+            MaSelector(loci=[1], fitness=[1, 0.9, 0.7], subPops=1)],
+            mode=MULTIPLICATIVE).apply(pop)
+        for sp in range(2):
+            for ind in pop.individuals(sp):
+                fit = [1, 0.8, 0.6][index(ind, [0], [0])]
+                if sp == 1:
+                    fit *= [1, 0.9, 0.7][index(ind, [1], [0])]
+                self.assertAlmostEqual(ind.fitness, fit)
+
     def testMultiLocusMapSelector(self):
         'Testing multiple loci map selector.'
         pop = Population(10, loci=[2],
@@ -765,6 +836,34 @@ class TestSelector(unittest.TestCase):
             ])
         self.assertEqual(self.geno, geno)
 
+    def testPySelectorCache(self):
+        'Testing the genotype cache of PySelector'
+        pop = Population(1000, loci=[3, 5], infoFields=['fitness', 'a'])
+        initSex(pop)
+        initGenotype(pop, freq=[0.3, 0.7])
+        initInfo(pop, lambda: random.randint(0, 1), infoFields='a')
+        calls = []
+        def sel(geno, a):
+            calls.append(geno)
+            return 1 - 0.1 * sum(geno) - 0.01 * a
+        PySelector(func=sel, loci=[1, 4]).apply(pop)
+        fitness = pop.indInfo('fitness')
+        self.assertEqual(len(calls), 1000)
+        calls = []
+        op = PySelector(func=sel, loci=[1, 4], cache=True)
+        op.apply(pop)
+        self.assertEqual(pop.indInfo('fitness'), fitness)
+        # 16 genotypes for two values of a
+        self.assertTrue(len(calls) <= 32)
+        self.assertEqual(op.cacheStats(), [1000 - len(calls), len(calls)])
+        # cached values are reused
+        op.apply(pop)
+        self.assertEqual(op.cacheStats()[1], len(calls))
+        op.clearCache()
+        self.assertEqual(op.cacheStats(), [0, 0])
+        # functions that accept ind cannot be cached
+        self.assertRaises(ValueError, PySelector, func=lambda ind: 1, cache=True)
+
     def pyGenoTest3(self, geno, mut):
         # for male, 
         self.genoX.append(geno[:6])
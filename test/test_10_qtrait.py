@@ -67,6 +67,12 @@ class TestQuanTrait(unittest.TestCase):
             self.assertEqual(len(geno), 4)
             return random.normalvariate(0, 0.5*sum(geno) ), 1
         pyQuanTrait(pop, loci=[2,6], func=qt1, infoFields=['qtrait1', 'qtrait2'])
+        # cached values for the same genotype
+        pyQuanTrait(pop, loci=[2,6], func=qt1, cache=True, infoFields=['qtrait1', 'qtrait2'])
+        values = {}
+        for ind in pop.individuals():
+            key = (ind.sex(), ind.allele(2, 0), ind.allele(2, 1), ind.allele(6, 0), ind.allele(6, 1))
+            self.assertEqual(values.setdefault(key, ind.qtrait1), ind.qtrait1)
 
     def testAncestralGen(self):
         'Testing parameter ancestralGen of qtrait... (FIXME)'
@@ -186,6 +186,36 @@ class TestMigrator(unittest.TestCase):
         for ind in pop.individuals(0):
             self.assertEqual(ind.sex(), MALE)
 
+    def testMigrateInfoByColumn(self):
+        'Testing migration of individuals that store information fields by column'
+        pop = Population(size=[4, 4], loci=2, infoFields=['migrate_to', 'y', 'z'],
+            infoByColumn=True)
+        pop.setIndInfo(range(8), 'y')
+        pop.setIndInfo(range(10, 18), 'z')
+        for idx, ind in enumerate(pop.individuals()):
+            ind.setAllele(idx % 2, 0)
+        # migrants take the places of each other if sizes are unchanged
+        pop.setIndInfo([0, 1, 0, 0, 1, 1, 0, 1], 'migrate_to')
+        migrate(pop, mode=BY_IND_INFO)
+        self.assertEqual(pop.subPopSizes(), (4, 4))
+        self.assertEqual(sorted(pop.indInfo('y', 0)), [0, 2, 3, 6])
+        self.assertEqual(sorted(pop.indInfo('y', 1)), [1, 4, 5, 7])
+        for sp in range(2):
+            for ind in pop.individuals(sp):
+                self.assertEqual(ind.migrate_to, sp)
+                self.assertEqual(ind.z, ind.y + 10)
+                self.assertEqual(ind.allele(0), int(ind.y) % 2)
+        # individuals are scattered if sizes change
+        pop.setIndInfo([0, 1, 1, 1, 1, 1, 0, 1], 'migrate_to')
+        migrate(pop, mode=BY_IND_INFO)
+        self.assertEqual(pop.subPopSizes(), (2, 6))
+        for sp in range(2):
+            for ind in pop.individuals(sp):
+                self.assertEqual(ind.migrate_to, sp)
+                self.assertEqual(ind.z, ind.y + 10)
+                self.assertEqual(ind.allele(0), int(ind.y) % 2)
+        self.assertEqual(list(pop.indInfo('z')), [x + 10 for x in pop.indInfo('y')])
+
 
 
     def testmigrateByProbability(self):
@@ -8,7 +8,7 @@
 # $LastChangedDate$
 #
 
-import unittest, os, sys
+import unittest, os, sys, random
 from simuOpt import setOptions
 setOptions(quiet=True)
 new_argv = []
@@ -294,14 +294,21 @@ class TestTransmitters(unittest.TestCase):
 
     def testRecombinatorAsGenoTransmitter(self):
         'Testing operator Recombinator as a genotype transmitter.'
+        self.checkRecombinatorAsGenoTransmitter(sparse=False)
+
+    def testSparseRecombinatorAsGenoTransmitter(self):
+        'Testing operator Recombinator(sparse=True) as a genotype transmitter.'
+        self.checkRecombinatorAsGenoTransmitter(sparse=True)
+
+    def checkRecombinatorAsGenoTransmitter(self, sparse):
         # test recombine on empty population
         pop = self.getPop(size=100, loci=[0])
         # this should be allowed.
-        applyDuringMatingOperator(Recombinator(rates=0),
+        applyDuringMatingOperator(Recombinator(rates=0, sparse=sparse),
             pop, pop, dad = 0, mom = 1, off=(2, pop.popSize()))
         #
         pop = self.getPop(size=100, loci=[20]*5)
-        applyDuringMatingOperator(Recombinator(rates=0),
+        applyDuringMatingOperator(Recombinator(rates=0, sparse=sparse),
             pop, pop, dad = 0, mom = 1, off=(2, pop.popSize()))
         for ch in range(5):
             # check if 1 is copied to 2.
@@ -315,7 +322,7 @@ class TestTransmitters(unittest.TestCase):
         # customized chromosomes are NOT copied
         pop = self.getPop(size=100, loci=[20]*7,
             chromTypes=[AUTOSOME]*5 + [CUSTOMIZED]*2)
-        applyDuringMatingOperator(Recombinator(rates=0),
+        applyDuringMatingOperator(Recombinator(rates=0, sparse=sparse),
             pop, pop, dad = 0, mom = 1, off=(2, pop.popSize()))
         for ch in range(7):
             # check if 1 is copied to 2.
@@ -333,7 +340,7 @@ class TestTransmitters(unittest.TestCase):
         pop = self.getPop(size=100, loci=[20]*9,
             chromTypes=[AUTOSOME]*5 + [CHROMOSOME_X, CHROMOSOME_Y] + [CUSTOMIZED]*2)
         pop.individual(2).setSex(MALE)
-        applyDuringMatingOperator(Recombinator(rates=0),
+        applyDuringMatingOperator(Recombinator(rates=0, sparse=sparse),
             pop, pop, dad = 0, mom = 1, off=(2, pop.popSize()))
         for ch in range(9):
             # check if 1 is copied to 2.
@@ -357,7 +364,7 @@ class TestTransmitters(unittest.TestCase):
         pop = self.getPop(size=100, loci=[20]*9,
             chromTypes=[AUTOSOME]*5 + [CHROMOSOME_X, CHROMOSOME_Y] + [CUSTOMIZED]*2)
         pop.individual(2).setSex(FEMALE)
-        applyDuringMatingOperator(Recombinator(rates=0),
+        applyDuringMatingOperator(Recombinator(rates=0, sparse=sparse),
             pop, pop, dad = 0, mom = 1, off=(2, pop.popSize()))
         for ch in range(9):
             # check if 1 is copied to 2.
@@ -385,7 +392,7 @@ class TestTransmitters(unittest.TestCase):
         # With non-zero recombination rate
         #
         pop = self.getPop(size=100, loci=[20]*5)
-        applyDuringMatingOperator(Recombinator(rates=0.1),
+        applyDuringMatingOperator(Recombinator(rates=0.1, sparse=sparse),
             pop, pop, dad = 0, mom = 1, off=(2, pop.popSize()))
         for index in range(pop.chromEnd(4)):
             ch,loc = pop.chromLocusPair(index)
@@ -400,7 +407,7 @@ class TestTransmitters(unittest.TestCase):
         # customized chromosomes are NOT copied
         pop = self.getPop(size=100, loci=[20]*7,
             chromTypes=[AUTOSOME]*5 + [CUSTOMIZED]*2)
-        applyDuringMatingOperator(Recombinator(rates=0.1),
+        applyDuringMatingOperator(Recombinator(rates=0.1, sparse=sparse),
             pop, pop, dad = 0, mom = 1, off=(2, pop.popSize()))
         for index in range(pop.chromEnd(6)):
             # check if 1 is copied to 2.
@@ -419,7 +426,7 @@ class TestTransmitters(unittest.TestCase):
         pop = self.getPop(size=100, loci=[20]*9,
             chromTypes=[AUTOSOME]*5 + [CHROMOSOME_X, CHROMOSOME_Y] + [CUSTOMIZED]*2)
         pop.individual(2).setSex(MALE)
-        applyDuringMatingOperator(Recombinator(rates=0.1),
+        applyDuringMatingOperator(Recombinator(rates=0.1, sparse=sparse),
             pop, pop, dad = 0, mom = 1, off=(2, pop.popSize()))
         for index in range(pop.chromEnd(8)):
             # check if 1 is copied to 2.
@@ -444,7 +451,7 @@ class TestTransmitters(unittest.TestCase):
         pop = self.getPop(size=100, loci=[20]*9,
             chromTypes=[AUTOSOME]*5 + [CHROMOSOME_X, CHROMOSOME_Y] + [CUSTOMIZED]*2)
         pop.individual(2).setSex(FEMALE)
-        applyDuringMatingOperator(Recombinator(rates=0.1),
+        applyDuringMatingOperator(Recombinator(rates=0.1, sparse=sparse),
             pop, pop, dad = 0, mom = 1, off=(2, pop.popSize()))
         for index in range(pop.chromEnd(8)):
             # check if 1 is copied to 2.
@@ -474,7 +481,7 @@ class TestTransmitters(unittest.TestCase):
         pop = self.getPop(size=100, loci=[20]*6,
             chromTypes=[AUTOSOME]*5 + [CHROMOSOME_X])
         pop.individual(2).setSex(MALE)
-        applyDuringMatingOperator(Recombinator(rates=0),
+        applyDuringMatingOperator(Recombinator(rates=0, sparse=sparse),
             pop, pop, dad = 0, mom = 1, off=(2, pop.popSize()))
         return
         for ch in range(6):
@@ -493,7 +500,7 @@ class TestTransmitters(unittest.TestCase):
         pop = self.getPop(size=100, loci=[20]*6,
             chromTypes=[AUTOSOME]*5 + [CHROMOSOME_X])
         pop.individual(2).setSex(FEMALE)
-        applyDuringMatingOperator(Recombinator(rates=0),
+        applyDuringMatingOperator(Recombinator(rates=0, sparse=sparse),
             pop, pop, dad = 0, mom = 1, off=(2, pop.popSize()))
         for ch in range(6):
             # check if 1 is copied to 2.
@@ -514,7 +521,7 @@ class TestTransmitters(unittest.TestCase):
         pop = self.getPop(size=100, loci=[20]*6,
             chromTypes=[AUTOSOME]*5 + [CHROMOSOME_Y])
         pop.individual(2).setSex(MALE)
-        applyDuringMatingOperator(Recombinator(rates=0),
+        applyDuringMatingOperator(Recombinator(rates=0, sparse=sparse),
             pop, pop, dad = 0, mom = 1, off=(2, pop.popSize()))
         for ch in range(9):
             # check if 1 is copied to 2.
@@ -532,7 +539,7 @@ class TestTransmitters(unittest.TestCase):
         pop = self.getPop(size=100, loci=[20]*6,
             chromTypes=[AUTOSOME]*5 + [CHROMOSOME_Y])
         pop.individual(2).setSex(FEMALE)
-        applyDuringMatingOperator(Recombinator(rates=0),
+        applyDuringMatingOperator(Recombinator(rates=0, sparse=sparse),
             pop, pop, dad = 0, mom = 1, off=(2, pop.popSize()))
         for ch in range(9):
             # check if 1 is copied to 2.
@@ -673,6 +680,43 @@ class TestTransmitters(unittest.TestCase):
             matingScheme = RandomMating(ops=Recombinator(rates = 1e-6)),
             gen=1 )
  
+    def testSparseRecRate(self):
+        'Testing recombination and conversion rates with sparse breakpoints'
+        a1, a2 = 0, 1
+        pop = Population(10000, loci=[2,3,2])
+        initSex(pop)
+        initGenotype(pop, genotype=[a1]*7+[a2]*7)
+        pop.evolve(postOps = Stat(haploFreq = [[0,1], [2,3], [3,4], [4,5], [5,6]]),
+            matingScheme = RandomMating(ops = Recombinator(rates = 0.1, sparse=True)),
+            gen=1)
+        for loci, freq in [((0,1), 0.05), ((2,3), 0.05), ((3,4), 0.05), ((4,5), 0.25), ((5,6), 0.05)]:
+            self.assertTrue(abs(pop.dvars().haploFreq[loci][(a1,a2)] - freq) < 0.01,
+                "Haplotype frequency %f at loci %s is not close to %f. This test may occasionally fail due to the randomness of outcome." \
+                % (pop.dvars().haploFreq[loci][(a1,a2)], loci, freq))
+        # conversion of one marker after recombination
+        pop = Population(10000, loci=[3,4])
+        initSex(pop)
+        initGenotype(pop, genotype=[a1]*7+[a2]*7)
+        pop.evolve(postOps = Stat(haploFreq = [[0,1], [1,2], [2,3]]),
+            matingScheme = RandomMating(ops=Recombinator(rates = 0.4,
+                convMode = (NUM_MARKERS, 1, 1), loci=[1,3], sparse=True)),
+            gen=1)
+        self.assertEqual(pop.dvars().haploFreq[(0,1)].setdefault((a1,a2), 0), 0.)
+        self.assertTrue(abs(pop.dvars().haploFreq[(1,2)][(a1,a2)] - 0.20) < 0.01,
+            "Haplotype frequency %f is not close to 0.20. This test may occasionally fail due to the randomness of outcome." \
+            % pop.dvars().haploFreq[(1,2)][(a1,a2)])
+        # rates above 0.5, including 1, are treated as 0.5
+        pop = Population(10000, loci=[4])
+        initSex(pop)
+        initGenotype(pop, genotype=[a1]*4+[a2]*4)
+        pop.evolve(postOps = Stat(haploFreq = [[0,1], [1,2], [2,3]]),
+            matingScheme = RandomMating(ops = Recombinator(rates = 1, sparse=True)),
+            gen=1)
+        for loci in [(0,1), (1,2), (2,3)]:
+            self.assertTrue(abs(pop.dvars().haploFreq[loci][(a1,a2)] - 0.25) < 0.015,
+                "Haplotype frequency %f at loci %s is not close to 0.25. This test may occasionally fail due to the randomness of outcome." \
+                % (pop.dvars().haploFreq[loci][(a1,a2)], loci))
+
     def testConversionRate(self):
         'Testing to see if we actually convert at this rate '
         a1, a2 = 0, 1
@@ -1134,6 +1178,32 @@ class TestTransmitters(unittest.TestCase):
 #                     self.assertEqual(ind.arrGenotype().count(a3), 0)
 
 
+    def testLongChromosomes(self):
+        'Testing the transmission of long chromosomes of unaligned lengths'
+        if moduleInfo()['alleleType'] == 'binary':
+            a1, a2 = 0, 1
+        else:
+            a1, a2 = 1, 2
+        for chromTypes, op, maxSwitch in [
+                ([AUTOSOME]*3, MendelianGenoTransmitter(), 2),
+                ([AUTOSOME]*3, Recombinator(rates=0.0005), 8),
+                ([AUTOSOME]*2 + [CHROMOSOME_X], Recombinator(rates=0.0005), 8)]:
+            pop = Population(size=100, loci=[333, 517, 65], chromTypes=chromTypes)
+            initSex(pop, sex=[MALE, FEMALE])
+            # the two copies differ at every locus so that the source of
+            # each offspring allele can be identified
+            geno = [random.choice([a1, a2]) for x in range(pop.totNumLoci())]
+            other = [a1 + a2 - x for x in geno]
+            initGenotype(pop, genotype=geno + other)
+            applyDuringMatingOperator(op, pop, pop, dad = 0, mom = 1, off=(2, pop.popSize()))
+            nLoci = 333 + 517
+            for idx in range(2, pop.popSize()):
+                for p in range(2):
+                    g = list(pop.individual(idx).genotype(p))[:nLoci]
+                    src = [x == y for x, y in zip(g, geno)]
+                    # a misplaced word would lead to a lot of switches
+                    self.assertTrue(sum([src[i] != src[i+1] for i in range(nLoci - 1)]) <= maxSwitch)
+
     def testHaplodiploid(self):
         'Testing recombination in haplodiploid populations'
         pop = Population(size=[20, 20], ploidy=HAPLODIPLOID, loci=[3,5])
@@ -287,6 +287,57 @@ class TestUtils(unittest.TestCase):
         self.assertEqual(seq, seq1)
         setRNG(name=old_rng)
 
+    def testCounterBasedRNG(self):
+        'Testing counter-based RNG philox4x32'
+        old_rng = getRNG().name()
+        self.assertTrue('philox4x32' in moduleInfo()['availableRNGs'])
+        def evolvePop(numThreads=1):
+            setOptions(numThreads=numThreads)
+            getRNG().set('philox4x32', 1234)
+            pop = Population(size=[500, 300], loci=[10, 20])
+            pop.evolve(
+                initOps=[InitSex(), InitGenotype(freq=[0.4, 0.6])],
+                preOps=Migrator(rate=[[0.9, 0.1], [0.2, 0.8]]),
+                matingScheme=RandomMating(ops=Recombinator(rates=0.01)),
+                gen=5
+            )
+            setOptions(numThreads=1)
+            return pop
+        pop = evolvePop()
+        self.assertEqual(getRNG().name(), 'philox4x32')
+        # results are determined by the seed
+        self.assertEqual(pop, evolvePop())
+        # and do not depend on the number of threads, including sex,
+        # migration, mating and recombination
+        pop4 = evolvePop(4)
+        self.assertEqual(pop4, pop)
+        self.assertEqual(pop4.subPopSizes(), pop.subPopSizes())
+        self.assertEqual([ind.sex() for ind in pop4.individuals()],
+            [ind.sex() for ind in pop.individuals()])
+        self.assertEqual(list(pop4.genotype()), list(pop.genotype()))
+        setRNG(name=old_rng)
+
+    def testIndependentRNGStreams(self):
+        'Testing independent streams of counter-based RNG in one generation'
+        old_rng = getRNG().name()
+        getRNG().set('philox4x32', 1234)
+        pop = Population(size=[500, 300], loci=1)
+        # two operators applied to the same generation
+        initSex(pop)
+        sex = [ind.sex() for ind in pop.individuals()]
+        initSex(pop)
+        self.assertNotEqual(sex, [ind.sex() for ind in pop.individuals()])
+        mapPenetrance(pop, loci=0, penetrance={(0, 0): 0.5})
+        affected = [ind.affected() for ind in pop.individuals()]
+        mapPenetrance(pop, loci=0, penetrance={(0, 0): 0.5})
+        self.assertNotEqual(affected, [ind.affected() for ind in pop.individuals()])
+        # two populations evolved with the same seed
+        pop1 = pop.clone()
+        pop.evolve(matingScheme=RandomMating(), gen=1)
+        pop1.evolve(matingScheme=RandomMating(), gen=1)
+        self.assertNotEqual(pop, pop1)
+        setRNG(name=old_rng)
+
     def testWeightedSampler(self):
         'Testing weighted sampler'
         sampler = WeightedSampler([1, 2, 3, 4])
@@ -354,6 +405,25 @@ class TestUtils(unittest.TestCase):
         self.assertEqual(num.count(7), 0)
         num = sampler.drawSamples(100000)
 
+    def testWeightedSamplerLarge(self):
+        'Testing weighted sampler with many weights'
+        weights = [0] * 20000
+        for i in range(0, 20000, 7):
+            weights[i] = 1 + i % 3
+        weights[100] = 5000
+        sampler = WeightedSampler(weights)
+        num = sampler.drawSamples(200000)
+        total = float(sum(weights))
+        self.assertAlmostEqual(num.count(100) / 200000., 5000 / total, places=2)
+        self.assertEqual(len([x for x in num if weights[x] == 0]), 0)
+        self.assertAlmostEqual(len([x for x in num if weights[x] == 3]) / 200000.,
+            sum([x for x in weights if x == 3]) / total, places=2)
+        # draw and drawSamples return the same numbers
+        getRNG().set(seed=1357)
+        num = [sampler.draw() for i in range(100)]
+        getRNG().set(seed=1357)
+        self.assertEqual(num, list(sampler.drawSamples(100)))
+
     def TestLargePedigree(self):
         'Testing getting large Pedigree, for simuUtils.ascertainPedigree'
         import simuUtil
@@ -1164,6 +1234,109 @@ class TestUtils(unittest.TestCase):
         # cleanup
         os.remove('pop.map')
 
+    def testExportPLINK(self):
+        'Testing export genotype in binary PLINK format'''
+        pop = Population(size=[4, 5], loci=[2, 4], ploidy=2,
+            lociNames=['a', 'b', 'c', 'd', 'e', 'f'])
+        initGenotype(pop, haplotypes=[0,1])
+        initSex(pop, sex=[MALE, FEMALE])
+        export(pop, format='plink', output='pop')
+        self.assertEqual(self.lineOfFile('pop.fam', 1), '1 1 0 0 1 1\n')
+        self.assertEqual(self.lineOfFile('pop.fam', 2), '2 2 0 0 2 1\n')
+        self.assertEqual(self.lineOfFile('pop.bim', 2), '1\tb\t0\t2\t1\t0\n')
+        self.assertEqual(self.lineOfFile('pop.bim', 3), '2\tc\t0\t1\t1\t0\n')
+        with open('pop.bed', 'rb') as bed:
+            data = bed.read()
+        # magic number, and 3 bytes for 9 individuals at each of the 6 loci
+        self.assertEqual(len(data), 3 + 6 * 3)
+        self.assertEqual(list(data[:9]), [0x6c, 0x1b, 0x01, 0xff, 0xff, 0x03, 0, 0, 0])
+        # test parameter subPops and loci
+        pop.setVirtualSplitter(SexSplitter())
+        export(pop, format='plink', output='pop', subPops=[(0,0)], loci=[1, 2])
+        self.assertEqual(self.lineOfFile('pop.fam', 2), '2 2 0 0 1 1\n')
+        with open('pop.bed', 'rb') as bed:
+            self.assertEqual(list(bed.read()), [0x6c, 0x1b, 0x01, 0, 0x0f])
+        # haploid male genotypes on chromosome X
+        pop = Population(size=4, loci=[1, 1], ploidy=2,
+            chromTypes=[CHROMOSOME_X, CHROMOSOME_Y])
+        initSex(pop, sex=[MALE, FEMALE])
+        for ind in pop.individuals():
+            ind.setGenotype([1, 0], ploidy=0)
+            ind.setGenotype([0, 1], ploidy=1)
+        export(pop, format='plink', output='pop')
+        self.assertEqual(self.lineOfFile('pop.bim', 1), 'X\t.\t0\t1\t1\t0\n')
+        with open('pop.bed', 'rb') as bed:
+            # X: 00 for males and 10 for females, Y: 00 for males and 01
+            # (missing) for females
+            self.assertEqual(list(bed.read()), [0x6c, 0x1b, 0x01, 0x88, 0x44])
+        # base-pair positions are written as integers
+        pop = Population(size=4, loci=2, lociPos=[1234567, 150000000])
+        export(pop, format='plink', output='pop')
+        self.assertEqual(self.lineOfFile('pop.bim', 1), '1\t.\t0\t1234567\t1\t0\n')
+        self.assertEqual(self.lineOfFile('pop.bim', 2), '1\t.\t0\t150000000\t1\t0\n')
+        # an empty population has only the magic number in the bed file
+        pop = Population(size=0, loci=2)
+        export(pop, format='plink', output='pop')
+        self.assertEqual(os.path.getsize('pop.fam'), 0)
+        with open('pop.bed', 'rb') as bed:
+            self.assertEqual(list(bed.read()), [0x6c, 0x1b, 0x01])
+        for ext in ['bed', 'bim', 'fam']:
+            os.remove('pop.' + ext)
+
+    def testExportVCF(self):
+        'Testing export genotype in VCF format'''
+        pop = Population(size=[4, 5], loci=[2, 4], ploidy=2,
+            lociNames=['a', 'b', 'c', 'd', 'e', 'f'], infoFields='ind_id')
+        for ind in pop.individuals():
+            ind.setGenotype([0, 1], ploidy=0)
+            ind.setGenotype([1, 0], ploidy=1)
+        tagID(pop, reset=True)
+        export(pop, format='vcf', output='pop.vcf')
+        self.assertEqual(self.lineOfFile('pop.vcf', 1), '##fileformat=VCFv4.2\n')
+        # allele names 0 and 1 are written as symbolic alleles
+        self.assertEqual(self.lineOfFile('pop.vcf', 5),
+            '##ALT=<ID=A1,Description="Allele 1">\n')
+        self.assertEqual(self.lineOfFile('pop.vcf', 7),
+            '\t'.join(['#CHROM', 'POS', 'ID', 'REF', 'ALT', 'QUAL', 'FILTER',
+                'INFO', 'FORMAT'] + [str(x) for x in range(1, 10)]) + '\n')
+        self.assertEqual(self.lineOfFile('pop.vcf', 8),
+            '\t'.join(['1', '1', 'a', 'N', '<A1>', '.', 'PASS', '.', 'GT'] + ['0|1'] * 9) + '\n')
+        self.assertEqual(self.lineOfFile('pop.vcf', 11),
+            '\t'.join(['2', '2', 'd', 'N', '<A1>', '.', 'PASS', '.', 'GT'] + ['1|0'] * 9) + '\n')
+        with open('pop.vcf') as vcf:
+            self.assertEqual(len(vcf.readlines()), 7 + 6)
+        # test parameter loci
+        export(pop, format='vcf', output='pop.vcf', loci=[0])
+        self.assertEqual(self.lineOfFile('pop.vcf', 3), '##contig=<ID=1>\n')
+        with open('pop.vcf') as vcf:
+            self.assertEqual(len(vcf.readlines()), 6 + 1)
+        # '>filename' is accepted, but appending and empty filenames are not
+        export(pop, format='vcf', output='>pop.vcf', loci=[0])
+        with open('pop.vcf') as vcf:
+            self.assertEqual(len(vcf.readlines()), 6 + 1)
+        self.assertRaises(ValueError, export, pop, format='vcf', output='>>pop.vcf')
+        self.assertRaises(ValueError, export, pop, format='vcf', output='>')
+        # allele names that are bases are written as REF and ALT alleles
+        pop = Population(size=3, loci=2, alleleNames=['A', 'GT'])
+        for ind in pop.individuals():
+            ind.setGenotype([0, 1])
+        export(pop, format='vcf', output='pop.vcf')
+        self.assertEqual(self.lineOfFile('pop.vcf', 5),
+            '\t'.join(['#CHROM', 'POS', 'ID', 'REF', 'ALT', 'QUAL', 'FILTER',
+                'INFO', 'FORMAT'] + ['1', '2', '3']) + '\n')
+        self.assertEqual(self.lineOfFile('pop.vcf', 6),
+            '\t'.join(['1', '1', '.', 'A', '.', '.', 'PASS', '.', 'GT'] + ['0|0'] * 3) + '\n')
+        self.assertEqual(self.lineOfFile('pop.vcf', 7),
+            '\t'.join(['1', '2', '.', 'A', 'GT', '.', 'PASS', '.', 'GT'] + ['1|1'] * 3) + '\n')
+        # base-pair positions are written as integers, and must be positive
+        pop = Population(size=3, loci=2, lociPos=[1234567, 150000000], alleleNames=['A', 'C'])
+        export(pop, format='vcf', output='pop.vcf')
+        self.assertEqual(self.lineOfFile('pop.vcf', 6).split('\t')[1], '1234567')
+        self.assertEqual(self.lineOfFile('pop.vcf', 7).split('\t')[1], '150000000')
+        pop = Population(size=3, loci=2, lociPos=[0.5, 2])
+        self.assertRaises(ValueError, export, pop, format='vcf', output='pop.vcf')
+        os.remove('pop.vcf')
+
     def testExportPhylip(self):
         'Testing export genotype in phylip format'''
         pop = Population(size=[4,5], loci=[20, 90], ploidy=2)